@@ -7,7 +7,7 @@ class MyProjectConan(ConanFile):
     version = "1.7.5"
     license = "MIT"
     settings = "os", "compiler", "build_type", "arch"
-    requires = ("sqlitecpp/3.3.1", "fmt/11.0.0", "benchmark/1.8.4")
+    requires = ("sqlitecpp/3.3.1", "fmt/11.0.0", "benchmark/1.8.4", "zlib/1.3.1")
     generators = "CMakeToolchain", "CMakeDeps"
 
     def layout(self):
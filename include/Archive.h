@@ -0,0 +1,40 @@
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "Task.h"
+
+/**
+ * @brief A completed task moved out of the 'tasks' table, with the tags it had.
+ */
+struct ArchivedTask {
+    Task task;                     ///< The task as it was when archived.
+    std::vector<std::string> tags; ///< Its tags in name order.
+};
+
+/**
+ * @brief Serializes and zlib-compresses a block of archived tasks.
+ *
+ * Descriptions of one block are compressed together, so the repetitive
+ * text of similar tasks shrinks much more than it would row by row.
+ *
+ * @param tasks Tasks to store.
+ * @param rawSize Set to the size of the block before compression.
+ * @return The compressed block.
+ */
+std::string encodeArchiveBlock(const std::vector<ArchivedTask> &tasks, size_t &rawSize);
+
+/**
+ * @brief Decompresses and parses a block written by encodeArchiveBlock.
+ *
+ * @param data Compressed block.
+ * @param size Size of the compressed block.
+ * @param rawSize Size of the block before compression.
+ * @return The tasks in the order they were stored.
+ * @throws std::runtime_error if the block is corrupt.
+ */
+std::vector<ArchivedTask> decodeArchiveBlock(const void *data, size_t size, size_t rawSize);
+
+#endif // ARCHIVE_H
@@ -0,0 +1,42 @@
+#ifndef CLIENT_H
+#define CLIENT_H
+
+#include <string>
+
+/**
+ * @class Client
+ * @brief Thin client that forwards requests to a running todolist Server.
+ *
+ * See Server.h for the request/response protocol.
+ */
+class Client {
+
+public:
+    /**
+     * @brief Connects to the server listening on the given socket path.
+     *
+     * @param socketPath Filesystem path of the Unix domain socket.
+     * @throws std::runtime_error if the connection cannot be established.
+     */
+    explicit Client(const std::string &socketPath);
+
+    /**
+     * @brief Closes the connection.
+     */
+    ~Client();
+
+    /**
+     * @brief Sends one request line and waits for its response.
+     *
+     * @param request Request line without the trailing newline.
+     * @param body Receives the response body lines.
+     * @return Status line of the response ("OK" or "ERR <message>").
+     */
+    std::string send(const std::string &request, std::string &body);
+
+private:
+    int fd; ///< Connected socket descriptor.
+    std::string buffer; ///< Bytes received past the last complete response.
+};
+
+#endif // CLIENT_H
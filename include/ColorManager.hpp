@@ -2,31 +2,32 @@
 #define COLORMANAGER_HPP
 
 #include <string>
+#include <string_view>
 
 using std::string;
 
 /**
  * @brief Namespace for managing terminal text and background colors.
  *
- * This namespace provides inline functions for various text and background colors
+ * This namespace provides constexpr functions for various text and background colors
  * to be used in terminal output. It includes standard colors, bright colors,
  * and background colors.
  */
 
-// Why inline?
-// Inline constants are preferred for terminal colors for efficiency and ease of use.
+// Why constexpr string_view?
+// The escape sequences are compile-time literals: no static initialization,
+// no heap strings, and renderers that skip colors pay nothing for them.
 
 namespace Color
 {
     /**
      * @brief Reset color to default.
      *
-     * @return const string& Reference to the RESET color string.
+     * @return std::string_view View of the RESET escape sequence.
      */
-    inline const string &RESET()
+    constexpr std::string_view RESET() noexcept
     {
-        static const string s = "\033[0m";
-        return s;
+        return "\033[0m";
     }
 
     // Standard text colors
@@ -34,89 +35,81 @@ namespace Color
     /**
      * @brief Black text color.
      *
-     * @return const string& Reference to the BLACK color string.
+     * @return std::string_view View of the BLACK escape sequence.
      */
-    inline const string &BLACK()
+    constexpr std::string_view BLACK() noexcept
     {
-        static const string s = "\033[30m";
-        return s;
+        return "\033[30m";
     }
 
     /**
      * @brief Red text color.
      *
-     * @return const string& Reference to the RED color string.
+     * @return std::string_view View of the RED escape sequence.
      */
-    inline const string &RED()
+    constexpr std::string_view RED() noexcept
     {
-        static const string s = "\033[31m";
-        return s;
+        return "\033[31m";
     }
 
     /**
      * @brief Green text color.
      *
-     * @return const string& Reference to the GREEN color string.
+     * @return std::string_view View of the GREEN escape sequence.
      */
-    inline const string &GREEN()
+    constexpr std::string_view GREEN() noexcept
     {
-        static const string s = "\033[32m";
-        return s;
+        return "\033[32m";
     }
 
     /**
      * @brief Yellow text color.
      *
-     * @return const string& Reference to the YELLOW color string.
+     * @return std::string_view View of the YELLOW escape sequence.
      */
-    inline const string &YELLOW()
+    constexpr std::string_view YELLOW() noexcept
     {
-        static const string s = "\033[33m";
-        return s;
+        return "\033[33m";
     }
 
     /**
      * @brief Blue text color.
      *
-     * @return const string& Reference to the BLUE color string.
+     * @return std::string_view View of the BLUE escape sequence.
      */
-    inline const string &BLUE()
+    constexpr std::string_view BLUE() noexcept
     {
-        static const string s = "\033[34m";
-        return s;
+        return "\033[34m";
     }
 
     /**
      * @brief Magenta text color.
      *
-     * @return const string& Reference to the MAGENTA color string.
+     * @return std::string_view View of the MAGENTA escape sequence.
      */
-    inline const string &MAGENTA()
+    constexpr std::string_view MAGENTA() noexcept
     {
-        static const string s = "\033[35m";
-        return s;
+        return "\033[35m";
     }
 
     /**
      * @brief Cyan text color.
      *
-     * @return const string& Reference to the CYAN color string.
+     * @return std::string_view View of the CYAN escape sequence.
      */
-    inline const string &CYAN()
+    constexpr std::string_view CYAN() noexcept
     {
-        static const string s = "\033[36m";
-        return s;
+        return "\033[36m";
     }
 
     /**
      * @brief White text color.
      *
-     * @return const string& Reference to the WHITE color string.
+     * @return std::string_view View of the WHITE escape sequence.
      */
-    inline const string &WHITE()
+    constexpr std::string_view WHITE() noexcept
     {
-        static const string s = "\033[37m";
-        return s;
+        return "\033[37m";
     }
 
     // Bright text colors
@@ -124,89 +117,81 @@ namespace Color
     /**
      * @brief Bright black text color.
      *
-     * @return const string& Reference to the BRIGHT_BLACK color string.
+     * @return std::string_view View of the BRIGHT_BLACK escape sequence.
      */
-    inline const string &BRIGHT_BLACK()
+    constexpr std::string_view BRIGHT_BLACK() noexcept
     {
-        static const string s = "\033[90m";
-        return s;
+        return "\033[90m";
     }
 
     /**
      * @brief Bright red text color.
      *
-     * @return const string& Reference to the BRIGHT_RED color string.
+     * @return std::string_view View of the BRIGHT_RED escape sequence.
      */
-    inline const string &BRIGHT_RED()
+    constexpr std::string_view BRIGHT_RED() noexcept
     {
-        static const string s = "\033[91m";
-        return s;
+        return "\033[91m";
     }
 
     /**
      * @brief Bright green text color.
      *
-     * @return const string& Reference to the BRIGHT_GREEN color string.
+     * @return std::string_view View of the BRIGHT_GREEN escape sequence.
      */
-    inline const string &BRIGHT_GREEN()
+    constexpr std::string_view BRIGHT_GREEN() noexcept
     {
-        static const string s = "\033[92m";
-        return s;
+        return "\033[92m";
     }
 
     /**
      * @brief Bright yellow text color.
      *
-     * @return const string& Reference to the BRIGHT_YELLOW color string.
+     * @return std::string_view View of the BRIGHT_YELLOW escape sequence.
      */
-    inline const string &BRIGHT_YELLOW()
+    constexpr std::string_view BRIGHT_YELLOW() noexcept
     {
-        static const string s = "\033[93m";
-        return s;
+        return "\033[93m";
     }
 
     /**
      * @brief Bright blue text color.
      *
-     * @return const string& Reference to the BRIGHT_BLUE color string.
+     * @return std::string_view View of the BRIGHT_BLUE escape sequence.
      */
-    inline const string &BRIGHT_BLUE()
+    constexpr std::string_view BRIGHT_BLUE() noexcept
     {
-        static const string s = "\033[94m";
-        return s;
+        return "\033[94m";
     }
 
     /**
      * @brief Bright magenta text color.
      *
-     * @return const string& Reference to the BRIGHT_MAGENTA color string.
+     * @return std::string_view View of the BRIGHT_MAGENTA escape sequence.
      */
-    inline const string &BRIGHT_MAGENTA()
+    constexpr std::string_view BRIGHT_MAGENTA() noexcept
     {
-        static const string s = "\033[95m";
-        return s;
+        return "\033[95m";
     }
 
     /**
      * @brief Bright cyan text color.
      *
-     * @return const string& Reference to the BRIGHT_CYAN color string.
+     * @return std::string_view View of the BRIGHT_CYAN escape sequence.
      */
-    inline const string &BRIGHT_CYAN()
+    constexpr std::string_view BRIGHT_CYAN() noexcept
     {
-        static const string s = "\033[96m";
-        return s;
+        return "\033[96m";
     }
 
     /**
      * @brief Bright white text color.
      *
-     * @return const string& Reference to the BRIGHT_WHITE color string.
+     * @return std::string_view View of the BRIGHT_WHITE escape sequence.
      */
-    inline const string &BRIGHT_WHITE()
+    constexpr std::string_view BRIGHT_WHITE() noexcept
     {
-        static const string s = "\033[97m";
-        return s;
+        return "\033[97m";
     }
 
     // Background colors
@@ -214,89 +199,81 @@ namespace Color
     /**
      * @brief Black background color.
      *
-     * @return const string& Reference to the BG_BLACK color string.
+     * @return std::string_view View of the BG_BLACK escape sequence.
      */
-    inline const string &BG_BLACK()
+    constexpr std::string_view BG_BLACK() noexcept
     {
-        static const string s = "\033[40m";
-        return s;
+        return "\033[40m";
     }
 
     /**
      * @brief Red background color.
      *
-     * @return const string& Reference to the BG_RED color string.
+     * @return std::string_view View of the BG_RED escape sequence.
      */
-    inline const string &BG_RED()
+    constexpr std::string_view BG_RED() noexcept
     {
-        static const string s = "\033[41m";
-        return s;
+        return "\033[41m";
     }
 
     /**
      * @brief Green background color.
      *
-     * @return const string& Reference to the BG_GREEN color string.
+     * @return std::string_view View of the BG_GREEN escape sequence.
      */
-    inline const string &BG_GREEN()
+    constexpr std::string_view BG_GREEN() noexcept
     {
-        static const string s = "\033[42m";
-        return s;
+        return "\033[42m";
     }
 
     /**
      * @brief Yellow background color.
      *
-     * @return const string& Reference to the BG_YELLOW color string.
+     * @return std::string_view View of the BG_YELLOW escape sequence.
      */
-    inline const string &BG_YELLOW()
+    constexpr std::string_view BG_YELLOW() noexcept
     {
-        static const string s = "\033[43m";
-        return s;
+        return "\033[43m";
     }
 
     /**
      * @brief Blue background color.
      *
-     * @return const string& Reference to the BG_BLUE color string.
+     * @return std::string_view View of the BG_BLUE escape sequence.
      */
-    inline const string &BG_BLUE()
+    constexpr std::string_view BG_BLUE() noexcept
     {
-        static const string s = "\033[44m";
-        return s;
+        return "\033[44m";
     }
 
     /**
      * @brief Magenta background color.
      *
-     * @return const string& Reference to the BG_MAGENTA color string.
+     * @return std::string_view View of the BG_MAGENTA escape sequence.
      */
-    inline const string &BG_MAGENTA()
+    constexpr std::string_view BG_MAGENTA() noexcept
     {
-        static const string s = "\033[45m";
-        return s;
+        return "\033[45m";
     }
 
     /**
      * @brief Cyan background color.
      *
-     * @return const string& Reference to the BG_CYAN color string.
+     * @return std::string_view View of the BG_CYAN escape sequence.
      */
-    inline const string &BG_CYAN()
+    constexpr std::string_view BG_CYAN() noexcept
     {
-        static const string s = "\033[46m";
-        return s;
+        return "\033[46m";
     }
 
     /**
      * @brief White background color.
      *
-     * @return const string& Reference to the BG_WHITE color string.
+     * @return std::string_view View of the BG_WHITE escape sequence.
      */
-    inline const string &BG_WHITE()
+    constexpr std::string_view BG_WHITE() noexcept
     {
-        static const string s = "\033[47m";
-        return s;
+        return "\033[47m";
     }
 
     // High intensity background colors
@@ -304,89 +281,81 @@ namespace Color
     /**
      * @brief Bright black background color.
      *
-     * @return const string& Reference to the BG_BRIGHT_BLACK color string.
+     * @return std::string_view View of the BG_BRIGHT_BLACK escape sequence.
      */
-    inline const string &BG_BRIGHT_BLACK()
+    constexpr std::string_view BG_BRIGHT_BLACK() noexcept
     {
-        static const string s = "\033[100m";
-        return s;
+        return "\033[100m";
     }
 
     /**
      * @brief Bright red background color.
      *
-     * @return const string& Reference to the BG_BRIGHT_RED color string.
+     * @return std::string_view View of the BG_BRIGHT_RED escape sequence.
      */
-    inline const string &BG_BRIGHT_RED()
+    constexpr std::string_view BG_BRIGHT_RED() noexcept
     {
-        static const string s = "\033[101m";
-        return s;
+        return "\033[101m";
     }
 
     /**
      * @brief Bright green background color.
      *
-     * @return const string& Reference to the BG_BRIGHT_GREEN color string.
+     * @return std::string_view View of the BG_BRIGHT_GREEN escape sequence.
      */
-    inline const string &BG_BRIGHT_GREEN()
+    constexpr std::string_view BG_BRIGHT_GREEN() noexcept
     {
-        static const string s = "\033[102m";
-        return s;
+        return "\033[102m";
     }
 
     /**
      * @brief Bright yellow background color.
      *
-     * @return const string& Reference to the BG_BRIGHT_YELLOW color string.
+     * @return std::string_view View of the BG_BRIGHT_YELLOW escape sequence.
      */
-    inline const string &BG_BRIGHT_YELLOW()
+    constexpr std::string_view BG_BRIGHT_YELLOW() noexcept
     {
-        static const string s = "\033[103m";
-        return s;
+        return "\033[103m";
     }
 
     /**
      * @brief Bright blue background color.
      *
-     * @return const string& Reference to the BG_BRIGHT_BLUE color string.
+     * @return std::string_view View of the BG_BRIGHT_BLUE escape sequence.
      */
-    inline const string &BG_BRIGHT_BLUE()
+    constexpr std::string_view BG_BRIGHT_BLUE() noexcept
     {
-        static const string s = "\033[104m";
-        return s;
+        return "\033[104m";
     }
 
     /**
      * @brief Bright magenta background color.
      *
-     * @return const string& Reference to the BG_BRIGHT_MAGENTA color string.
+     * @return std::string_view View of the BG_BRIGHT_MAGENTA escape sequence.
      */
-    inline const string &BG_BRIGHT_MAGENTA()
+    constexpr std::string_view BG_BRIGHT_MAGENTA() noexcept
     {
-        static const string s = "\033[105m";
-        return s;
+        return "\033[105m";
     }
 
     /**
      * @brief Bright cyan background color.
      *
-     * @return const string& Reference to the BG_BRIGHT_CYAN color string.
+     * @return std::string_view View of the BG_BRIGHT_CYAN escape sequence.
      */
-    inline const string &BG_BRIGHT_CYAN()
+    constexpr std::string_view BG_BRIGHT_CYAN() noexcept
     {
-        static const string s = "\033[106m";
-        return s;
+        return "\033[106m";
     }
 
     /**
      * @brief Bright white background color.
      *
-     * @return const string& Reference to the BG_BRIGHT_WHITE color string.
+     * @return std::string_view View of the BG_BRIGHT_WHITE escape sequence.
      */
-    inline const string &BG_BRIGHT_WHITE()
+    constexpr std::string_view BG_BRIGHT_WHITE() noexcept
     {
-        static const string s = "\033[107m";
-        return s;
+        return "\033[107m";
     }
 }
 
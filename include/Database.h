@@ -2,12 +2,100 @@
 #define DATABASE_H
 
 #include <vector>
+#include <string>
+#include <utility>
 #include "Task.h"
 #include <future>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <chrono>
+#include <atomic>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <unordered_map>
+#include "Archive.h"
+#include "Migrations.h"
+#include "Recurrence.h"
+#include "TaskQuery.h"
 #include <SQLiteCpp/SQLiteCpp.h> // SQLiteCpp is a C++ library for accessing SQLite databases
 
 using std::future;
 
+/**
+ * @brief Rows changed in the 'tasks' table since a given change-log sequence.
+ */
+struct TaskChanges {
+    std::vector<Task> upserted; ///< Current state of inserted or updated tasks.
+    std::vector<int> deleted;   ///< IDs of tasks that no longer exist.
+    int64_t lastSeq = 0;        ///< Highest change-log sequence covered by this delta.
+    bool cleared = false;       ///< The table was cleared; the caller must reload everything.
+    std::vector<std::pair<int, std::string>> tags; ///< (task ID, tag) pairs of the upserted tasks.
+    std::vector<std::pair<int, int>> dependencies; ///< (task ID, prerequisite ID) edges of the upserted tasks, in order.
+};
+
+/**
+ * @brief A removed task with the rows that were removed along with it, enough to restore it.
+ */
+struct TaskRecord {
+    Task task;                                     ///< The task, including its due time.
+    std::vector<std::string> tags;                 ///< Names of its tags.
+    std::vector<std::pair<int, int>> dependencies; ///< (task ID, prerequisite ID) edges it was part of.
+};
+
+/**
+ * @brief Progress of an online backup, reported after every step.
+ */
+struct BackupProgress {
+    int remainingPages = 0; ///< Pages still to copy.
+    int totalPages = 0;     ///< Pages in the database being backed up.
+};
+
+/**
+ * @brief SQLite's memory use, read with Database::getMemoryStatsAsync.
+ *
+ * The process figures cover every connection, including those other
+ * Database objects and background work open; the rest are the connection's.
+ */
+struct SqliteMemoryStats {
+    int64_t processBytes = 0;     ///< Memory SQLite has allocated in the process.
+    int64_t processPeakBytes = 0; ///< Highest processBytes since the process started.
+    int64_t pageCacheBytes = 0;   ///< Page cache of the connection.
+    int64_t pageCacheLimit = 0;   ///< Page cache size the connection may grow to, from PRAGMA cache_size.
+    int64_t schemaBytes = 0;      ///< Parsed schema of the connection.
+    int64_t statementBytes = 0;   ///< Prepared statements of the connection, cached filter queries included.
+    int64_t cacheHits = 0;        ///< Page reads served by the page cache.
+    int64_t cacheMisses = 0;      ///< Page reads that went to the file.
+};
+
+/**
+ * @brief How a Database waits out other processes' write locks.
+ *
+ * SQLite first waits up to timeout for a lock. A write that still finds the
+ * file locked when it begins or commits its transaction is retried up to
+ * retries more times, after a delay that doubles from backoff up to
+ * maxBackoff and is jittered so competing processes do not retry in step.
+ * Reads only wait for timeout.
+ */
+struct BusyPolicy {
+    std::chrono::milliseconds timeout{5000};   ///< Wait inside SQLite for each lock attempt.
+    int retries = 8;                           ///< Further attempts once a wait timed out.
+    std::chrono::milliseconds backoff{5};      ///< Delay before the first retry.
+    std::chrono::milliseconds maxBackoff{500}; ///< Cap on the delay between retries.
+};
+
+/**
+ * @brief How a Database opens its file.
+ */
+enum class AccessMode {
+    ReadWrite, ///< Creates the file and schema if needed; the default.
+    ReadOnly,  ///< Opens an existing file read-only and memory-maps it. Sees other processes' commits.
+    Immutable  ///< Copies the file to a private snapshot and opens that with immutable=1:
+               ///< no locks and no change detection, for reports over a fixed point in time.
+};
+
 /**
  * @class Database
  * @brief Manages SQLite database operations asynchronously.
@@ -24,8 +112,11 @@ public:
      * @brief Constructs a Database object and initializes the connection asynchronously.
      *
      * @param dbFilename Filename of the SQLite database.
+     * @param mode How to open the file; read-only modes reject every mutation.
+     * @param busy How long to wait for, and how often to retry, locks held by other processes.
      */
-    explicit Database(const std::string &dbFilename);
+    explicit Database(const std::string &dbFilename, AccessMode mode = AccessMode::ReadWrite,
+                      const BusyPolicy &busy = BusyPolicy());
 
     /**
      * @brief Destructs the Database object and finalizes the connection asynchronously.
@@ -36,9 +127,52 @@ public:
      * @brief Asynchronous initialization of the database connection.
      *
      * @param dbFilename Filename of the SQLite database.
+     * @param mode How to open the file.
      * @return Future object for the initialization task.
      */
-    future<void> initializeAsync(const std::string &dbFilename);
+    future<void> initializeAsync(const std::string &dbFilename, AccessMode mode = AccessMode::ReadWrite);
+
+    /**
+     * @brief Reads the schema version (PRAGMA user_version) asynchronously.
+     *
+     * The version only counts migrations whose backfill has finished.
+     *
+     * @return Future object containing the schema version.
+     */
+    future<int> getSchemaVersionAsync() const;
+
+    /**
+     * @brief Runs the pending migration backfills asynchronously.
+     *
+     * The schema statements of every migration are applied when the
+     * database is opened; this walks the rows they left to fill. Each chunk
+     * of at most chunkRows rows is one short transaction on a separate
+     * connection, and its position is stored with it, so other statements
+     * (and other processes) keep running in between, and an interrupted run
+     * resumes where it stopped. Does nothing in read-only modes.
+     *
+     * @param chunkRows Maximum number of rows per transaction.
+     * @param progress Called after every chunk, on the migration thread.
+     * @return Future object containing true once the schema is at the latest
+     *         version, or false if stopMigrations() interrupted it.
+     */
+    future<bool> migrateAsync(int chunkRows = 10000,
+                              std::function<void(const MigrationProgress &)> progress = nullptr);
+
+    /**
+     * @brief Asks a running migrateAsync to return after its current chunk.
+     */
+    void stopMigrations();
+
+    /**
+     * @brief Returns true if the database was opened in a read-only mode.
+     */
+    bool isReadOnly() const { return accessMode != AccessMode::ReadWrite; }
+
+    /**
+     * @brief Returns how many times a write was retried because the file was locked.
+     */
+    uint64_t busyRetryCount() const { return busyRetries.load(std::memory_order_relaxed); }
 
     /**
      * @brief Asynchronous destruction of the database connection.
@@ -51,13 +185,15 @@ public:
      * @brief Adds a task to the database asynchronously.
      *
      * @param description Description of the task to be added.
-     * @return Future object for the add task operation.
+     * @return Future object containing the ID of the new task.
      */
-    future<void> addTaskAsync(const std::string &description);
+    future<int> addTaskAsync(const std::string &description);
 
     /**
      * @brief Retrieves all tasks from the database asynchronously.
      *
+     * Tasks are returned in ascending ID order.
+     *
      * @return Future object containing a vector of Task objects.
      */
     future<std::vector<Task>> getTasksAsync() const;
@@ -78,6 +214,56 @@ public:
      */
     future<void> deleteTaskAsync(int id);
 
+    /**
+     * @brief Deletes every task matching a filter asynchronously, in one statement.
+     *
+     * @param filter Tasks to delete; the limit keeps the lowest IDs.
+     * @return Future object containing the number of tasks deleted.
+     */
+    future<int> deleteWhereAsync(const TaskQuery &filter);
+
+    /**
+     * @brief Marks every pending task matching a filter as done asynchronously, in one statement.
+     *
+     * Tasks that are already done keep their completion time.
+     *
+     * @param filter Tasks to complete; the limit keeps the lowest IDs.
+     * @return Future object containing the number of tasks marked done.
+     */
+    future<int> markDoneWhereAsync(const TaskQuery &filter);
+
+    /**
+     * @brief Retrieves the tasks matching a filter asynchronously.
+     *
+     * An ID range with a limit reads a single stretch of the primary key, which is
+     * how TaskCache loads its pages and how large lists are streamed in batches.
+     *
+     * @param filter Tasks to return; the limit keeps the lowest IDs.
+     * @return Future object containing the tasks in ascending ID order.
+     */
+    future<std::vector<Task>> getTasksWhereAsync(const TaskQuery &filter) const;
+
+    /**
+     * @brief Counts the tasks matching a filter asynchronously.
+     *
+     * @param filter Tasks to count; the limit caps the count.
+     * @return Future object containing the number of matching tasks.
+     */
+    future<size_t> countWhereAsync(const TaskQuery &filter) const;
+
+    /**
+     * @brief Retrieves the tasks matching a filter expression asynchronously.
+     *
+     * The expression is compiled by compileFilter. Its prepared statement is
+     * cached under the compiled condition, so later expressions of the same
+     * shape only bind their constants and skip SQLite's parsing and planning.
+     *
+     * @param expression Filter expression such as `done=0 and text~"deploy"`.
+     * @return Future object containing the tasks in ascending ID order; it
+     *         throws std::invalid_argument if the expression is malformed.
+     */
+    future<std::vector<Task>> getTasksMatchingAsync(const std::string &expression) const;
+
     /**
      * @brief Clears all tasks from the database asynchronously.
      *
@@ -85,8 +271,451 @@ public:
      */
     future<void> clearAllDataAsync();
 
+    /**
+     * @brief Deletes every task matching a filter asynchronously, returning what was deleted.
+     *
+     * @param filter Tasks to delete; the limit keeps the lowest IDs.
+     * @return Future object containing the deleted tasks in ascending ID order.
+     */
+    future<std::vector<TaskRecord>> takeTasksAsync(const TaskQuery &filter);
+
+    /**
+     * @brief Inserts tasks removed by takeTasksAsync again, with their IDs, tags and dependencies.
+     *
+     * @param records Tasks to restore; must outlive the future.
+     * @return Future object for the restore operation.
+     * @throws std::invalid_argument if one of the IDs has been taken since; nothing is restored then.
+     */
+    future<void> restoreTasksAsync(const std::vector<TaskRecord> &records);
+
+    /**
+     * @brief Marks a task as not done asynchronously.
+     *
+     * @param id ID of the task.
+     * @return Future object for the update operation.
+     */
+    future<void> reopenTaskAsync(int id);
+
+    /**
+     * @brief Clears all tasks like clearAllDataAsync, but keeps the old tables in a stash.
+     *
+     * @return Future object containing the stash ID, for restoreStashAsync or dropStashAsync.
+     */
+    future<int> stashAllDataAsync();
+
+    /**
+     * @brief Replaces the task tables with the ones kept in a stash, which is consumed.
+     *
+     * @param stash ID returned by stashAllDataAsync.
+     * @return Future object for the restore operation.
+     * @throws std::invalid_argument if the stash does not exist.
+     */
+    future<void> restoreStashAsync(int stash);
+
+    /**
+     * @brief Deletes a stash asynchronously.
+     *
+     * @param stash ID returned by stashAllDataAsync.
+     * @return Future object for the drop operation.
+     */
+    future<void> dropStashAsync(int stash);
+
+    /**
+     * @brief Reads SQLite's data version for this connection asynchronously.
+     *
+     * The value changes whenever another connection (typically another
+     * todolist process) commits to the database file, so comparing it
+     * against a previously read value is a cheap staleness check.
+     *
+     * @return Future object containing the current PRAGMA data_version.
+     */
+    future<int64_t> getDataVersionAsync() const;
+
+    /**
+     * @brief Reads the highest sequence number in the change log asynchronously.
+     *
+     * @return Future object containing the last change-log sequence (0 if empty).
+     */
+    future<int64_t> getLastChangeSeqAsync() const;
+
+    /**
+     * @brief Reads SQLite's memory statistics asynchronously.
+     *
+     * @return Future object containing the process and connection figures.
+     */
+    future<SqliteMemoryStats> getMemoryStatsAsync() const;
+
+    /**
+     * @brief Retrieves the tasks changed after a change-log sequence asynchronously.
+     *
+     * The change log is filled by triggers on the 'tasks' table, so changes
+     * made by any process sharing the file are included.
+     *
+     * @param seq Sequence of the last change already applied by the caller.
+     * @return Future object containing the changed and deleted tasks.
+     */
+    future<TaskChanges> getChangesSinceAsync(int64_t seq) const;
+
+    /**
+     * @brief Writes the changes after a change-log sequence to a stream asynchronously.
+     *
+     * The batch is read in one transaction on a separate connection, so it is
+     * a consistent cut. If the log no longer reaches back to seq, because the
+     * table was cleared or the entries were acknowledged, the batch holds
+     * every task and replaces the receiver's contents. Only tasks and their
+     * tags are exported; recurring task templates stay local.
+     *
+     * @param seq Sequence of the last change the receiver has applied.
+     * @param out Stream to write to; must outlive the future.
+     * @return Future object containing the last sequence covered by the batch.
+     */
+    future<int64_t> exportChangesAsync(int64_t seq, std::ostream &out) const;
+
+    /**
+     * @brief Applies a batch written by exportChangesAsync asynchronously.
+     *
+     * The whole batch is applied in one transaction together with the new
+     * applied sequence, so an interrupted or truncated batch changes nothing.
+     * Changes made this way enter this file's own change log, so caches on
+     * it pick them up as usual.
+     *
+     * @param in Stream to read from; must outlive the future.
+     * @return Future object containing the sequence applied up to.
+     * @throws std::runtime_error if the batch is malformed or does not start at
+     *         or before the applied sequence.
+     */
+    future<int64_t> applyChangesAsync(std::istream &in);
+
+    /**
+     * @brief Reads the sequence applied up to by applyChangesAsync asynchronously.
+     *
+     * @return Future object containing the sequence (0 if nothing was applied).
+     */
+    future<int64_t> getAppliedSeqAsync() const;
+
+    /**
+     * @brief Truncates the change log up to an acknowledged sequence asynchronously.
+     *
+     * A reader still behind seq afterwards gets a delta with cleared set, so
+     * it reloads instead of missing changes.
+     *
+     * @param seq Sequence the receiver has applied.
+     * @return Future object containing the number of entries removed.
+     */
+    future<int> acknowledgeChangesAsync(int64_t seq);
+
+    /**
+     * @brief Adds a tag to a task asynchronously, creating the tag if needed.
+     *
+     * @param id ID of the task to tag.
+     * @param tag Tag name.
+     * @return Future object for the add tag operation.
+     * @throws std::invalid_argument if the task does not exist.
+     */
+    future<void> addTagAsync(int id, const std::string &tag);
+
+    /**
+     * @brief Removes a tag from a task asynchronously.
+     *
+     * @param id ID of the task.
+     * @param tag Tag name.
+     * @return Future object for the remove tag operation.
+     */
+    future<void> removeTagAsync(int id, const std::string &tag);
+
+    /**
+     * @brief Retrieves every (task ID, tag) pair asynchronously.
+     *
+     * @return Future object containing the pairs ordered by tag, then task ID.
+     */
+    future<std::vector<std::pair<int, std::string>>> getTaskTagsAsync() const;
+
+    /**
+     * @brief Makes a task wait for another one asynchronously.
+     *
+     * The check for cycles and the insert run in one IMMEDIATE transaction,
+     * so two processes cannot close a cycle between them. Adding an existing
+     * edge has no effect.
+     *
+     * @param id ID of the task that waits.
+     * @param prerequisiteId ID of the task that must be done first.
+     * @return Future object for the add operation.
+     * @throws std::invalid_argument if either task does not exist or the edge would close a cycle.
+     */
+    future<void> addDependencyAsync(int id, int prerequisiteId);
+
+    /**
+     * @brief Removes a dependency between two tasks asynchronously.
+     *
+     * @param id ID of the task that waits.
+     * @param prerequisiteId ID of the task it waits for.
+     * @return Future object for the remove operation.
+     */
+    future<void> removeDependencyAsync(int id, int prerequisiteId);
+
+    /**
+     * @brief Sets or clears the due time of a task asynchronously.
+     *
+     * @param id ID of the task.
+     * @param dueTime Timestamp the task is due at, or 0 to clear it.
+     * @return Future object for the update operation.
+     */
+    future<void> setDueTimeAsync(int id, int64_t dueTime);
+
+    /**
+     * @brief Retrieves the due times of pending tasks asynchronously.
+     *
+     * @param after Only due times later than this are returned.
+     * @return Future object containing (task ID, due time) pairs in ascending ID order.
+     */
+    future<std::vector<std::pair<int, int64_t>>> getDueTimesAsync(int64_t after) const;
+
+    /**
+     * @brief Retrieves every dependency edge asynchronously.
+     *
+     * @return Future object containing (task ID, prerequisite ID) pairs in ascending order.
+     */
+    future<std::vector<std::pair<int, int>>> getDependenciesAsync() const;
+
+    /**
+     * @brief Stores a recurring task template asynchronously.
+     *
+     * No task is created here; see materializeRecurrenceAsync.
+     *
+     * @param description Description of the tasks made from the template.
+     * @param rule When occurrences fall.
+     * @param firstTime Start of the first occurrence's window.
+     * @return Future object containing the template ID.
+     */
+    future<int> addRecurrenceAsync(const std::string &description, const RecurrenceRule &rule, int64_t firstTime);
+
+    /**
+     * @brief Retrieves every recurring task template asynchronously.
+     *
+     * @return Future object containing the templates in ID order.
+     */
+    future<std::vector<Recurrence>> getRecurrencesAsync() const;
+
+    /**
+     * @brief Deletes a recurring task template asynchronously.
+     *
+     * A task already made from it stays and becomes an ordinary task.
+     *
+     * @param id ID of the template.
+     * @return Future object for the delete operation.
+     */
+    future<void> deleteRecurrenceAsync(int id);
+
+    /**
+     * @brief Creates a template's next task if its window has arrived, asynchronously.
+     *
+     * Nothing is created while the template still has an open task or
+     * before nextTime. The check and the insert share one transaction, so
+     * processes racing on the same template create a single task.
+     *
+     * @param id ID of the template.
+     * @param now Current time.
+     * @return Future object containing the template after the call; its id is
+     *         0 if it no longer exists.
+     */
+    future<Recurrence> materializeRecurrenceAsync(int id, int64_t now);
+
+    /**
+     * @brief Copies the database to a file asynchronously with SQLite's online backup API.
+     *
+     * Copies at most pagesPerStep pages per step and pauses between steps,
+     * so foreground statements are never held up for more than one step.
+     * Writes made through this connection meanwhile are carried into the
+     * copy; a commit by another process restarts it. The copy is written
+     * next to destPath and renamed over it once complete, so destPath is
+     * always a consistent database.
+     *
+     * @param destPath File to write the backup to; replaced if it exists.
+     * @param pagesPerStep Maximum number of pages copied per step.
+     * @param progress Called after every step, on the backup thread.
+     * @return Future object for the backup operation.
+     */
+    future<void> backupAsync(const std::string &destPath, int pagesPerStep = 256,
+                             std::function<void(const BackupProgress &)> progress = nullptr);
+
+    /**
+     * @brief Starts a background thread that runs backupAsync every interval.
+     *
+     * @param destPath File to write each backup to.
+     * @param interval Time between backups; the first one runs after one interval.
+     */
+    void startBackups(const std::string &destPath, std::chrono::minutes interval);
+
+    /**
+     * @brief Stops the backup thread, waiting for a running backup to finish.
+     */
+    void stopBackups();
+
+    /**
+     * @brief Moves tasks completed before a time into compressed archive blocks asynchronously.
+     *
+     * Runs on its own connection, one IMMEDIATE transaction per block, so
+     * other writers wait for at most one block. Archived tasks leave the
+     * 'tasks' table through the change log, so caches drop them on their
+     * next refresh. A partly filled newest block is topped up first, so
+     * frequent small runs still produce full blocks.
+     *
+     * @param completedBefore Tasks completed before this time are archived.
+     * @param blockTasks Maximum number of tasks per block.
+     * @return Future object containing the number of tasks archived.
+     */
+    future<int> archiveCompletedAsync(int64_t completedBefore, int blockTasks = 1024);
+
+    /**
+     * @brief Finds archived tasks whose description contains a text asynchronously.
+     *
+     * Blocks are decompressed one at a time, newest first.
+     *
+     * @param text Text to look for, ignoring ASCII case; empty matches every task.
+     * @param limit Maximum number of tasks returned.
+     * @return Future object containing the matches, most recently completed blocks first.
+     */
+    future<std::vector<ArchivedTask>> searchArchiveAsync(const std::string &text, size_t limit) const;
+
+    /**
+     * @brief Retrieves the archived tasks completed within [from, to) asynchronously.
+     *
+     * Only blocks whose completion range overlaps the interval are decompressed.
+     *
+     * @param from Start of the interval.
+     * @param to End of the interval, exclusive.
+     * @return Future object containing the tasks in ID order.
+     */
+    future<std::vector<ArchivedTask>> getArchivedTasksAsync(int64_t from, int64_t to) const;
+
+    /**
+     * @brief Starts a background thread that archives old completed tasks every interval.
+     *
+     * Does nothing in read-only modes.
+     *
+     * @param olderThan Tasks completed longer ago than this are archived.
+     * @param interval Time between runs; the first one runs immediately.
+     */
+    void startArchiving(std::chrono::hours olderThan, std::chrono::minutes interval = std::chrono::minutes(60));
+
+    /**
+     * @brief Stops the archiving thread, letting a running run finish its current block.
+     */
+    void stopArchiving();
+
+    /**
+     * @brief Switches an existing file to incremental auto_vacuum with a one-time VACUUM.
+     *
+     * New files are created in this mode; older ones keep their free pages for
+     * reuse until converted. The VACUUM rewrites the whole file and blocks
+     * writers meanwhile, so this is an explicit maintenance step.
+     *
+     * @return Future object containing true if the file was converted.
+     */
+    future<bool> enableIncrementalVacuumAsync();
+
+    /**
+     * @brief Starts a background thread that reclaims free pages in bounded steps.
+     *
+     * Only files in incremental auto_vacuum mode are shrunk. Does nothing in
+     * read-only modes.
+     *
+     * @param pagesPerStep Maximum number of pages released per incremental_vacuum step.
+     * @param interval Time between checks of the free-page count.
+     */
+    void startMaintenance(int pagesPerStep = 256, std::chrono::milliseconds interval = std::chrono::milliseconds(1000));
+
+    /**
+     * @brief Stops the maintenance thread if it is running.
+     */
+    void stopMaintenance();
+
 private:
+    /**
+     * @brief Creates the 'tasks' table and its change-log triggers if missing.
+     */
+    void createSchema();
+
+    /**
+     * @brief Applies the schema statements of the migrations newer than the file.
+     */
+    void applyMigrationSchemas();
+
+    /**
+     * @brief Replaces the task tables with empty ones and logs a single 'C' entry.
+     *
+     * Must run inside a write transaction.
+     */
+    void clearTables();
+
+    /**
+     * @brief Renames the task tables, adding or removing a prefix.
+     *
+     * Must run inside a write transaction.
+     */
+    void renameTaskTables(const std::string &fromPrefix, const std::string &toPrefix);
+
+    /**
+     * @brief Drops the tables of a stash and forgets it.
+     *
+     * Call createSchema afterwards, since the live tables may lack the
+     * indexes the stash held. Must run inside a write transaction.
+     */
+    void dropStash(int stash);
+
+    /**
+     * @brief Runs body inside a BEGIN IMMEDIATE transaction and commits it.
+     *
+     * Taking the write lock up front means a transaction never has to
+     * upgrade a read lock, which SQLite refuses without waiting when another
+     * connection wants to write too. BEGIN and COMMIT are retried under the
+     * busy policy; body runs once, and any exception rolls it back. Holds
+     * connectionMutex exclusively throughout, so concurrent calls on this
+     * Database queue up instead of nesting a BEGIN inside another thread's
+     * transaction, and no reader runs on db meanwhile.
+     *
+     * @return Whatever body returns.
+     */
+    template <typename Body>
+    auto writeTransaction(Body &&body) -> decltype(body());
+
+    /**
+     * @brief Takes connectionMutex shared, for statements that only read db.
+     *
+     * Readers run alongside each other but never inside another thread's
+     * write transaction, so they see neither its uncommitted rows nor the
+     * tables a clear renamed away, and its ROLLBACK cannot abort them.
+     *
+     * @return Lock to hold until the read's statements are finished.
+     */
+    std::shared_lock<std::shared_mutex> readLock() const;
+
     SQLite::Database *db; ///< Pointer to the SQLite database instance.
+    AccessMode accessMode = AccessMode::ReadWrite; ///< Mode the connection was opened with.
+    std::string snapshotPath;                      ///< Private copy opened in Immutable mode, removed on finalization.
+    std::string filename;                          ///< File the connection was opened on.
+    std::string dueColumn = "dueTime";             ///< Read as a task's due time; "0" on read-only files that predate it.
+    BusyPolicy busyPolicy;                         ///< Lock waits and retries, fixed at construction.
+    std::atomic<uint64_t> busyRetries{0};          ///< Writes retried because the file was locked.
+    mutable std::shared_mutex connectionMutex;     ///< Exclusive for a whole writeTransaction, shared by readers of db.
+    mutable std::mutex filterMutex;                ///< Guards filterStatements and serializes their use.
+    mutable std::unordered_map<std::string, std::unique_ptr<SQLite::Statement>> filterStatements; ///< Filter queries by compiled condition.
+    std::mutex migrationMutex;                     ///< Held while a backfill runs, so finalization waits for it.
+    std::atomic<bool> migrationStop{false};        ///< Set to interrupt a running backfill.
+    std::thread maintenanceThread;           ///< Background page-reclaiming thread.
+    std::mutex maintenanceMutex;             ///< Guards maintenanceStop.
+    std::condition_variable maintenanceWake; ///< Wakes the maintenance thread early to stop.
+    bool maintenanceStop = false;            ///< Set to ask the maintenance thread to exit.
+    std::mutex backupMutex;                  ///< Serializes backups to keep one copy in flight.
+    std::thread backupThread;                ///< Periodic backup thread.
+    std::mutex backupTimerMutex;             ///< Guards backupStop.
+    std::condition_variable backupWake;      ///< Wakes the backup thread early to stop.
+    bool backupStop = false;                 ///< Set to ask the backup thread to exit.
+    std::thread archiveThread;               ///< Periodic archiving thread.
+    std::mutex archiveTimerMutex;            ///< Guards archiveStop.
+    std::condition_variable archiveWake;     ///< Wakes the archiving thread early to stop.
+    bool archiveStop = false;                ///< Set to ask the archiving thread to exit.
+    std::atomic<bool> archiveInterrupt{false}; ///< Set to end a running archive run after its current block.
 };
 
 #endif // DATABASE_H
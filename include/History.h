@@ -0,0 +1,68 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <vector>
+#include "TaskQuery.h"
+
+/**
+ * @brief Bucket size of a history report. Buckets are aligned in UTC.
+ */
+enum class HistoryGranularity {
+    Day,   ///< Calendar days.
+    Week,  ///< ISO weeks starting on Monday.
+    Month  ///< Calendar months.
+};
+
+/**
+ * @brief Output format of a history report.
+ */
+enum class HistoryFormat {
+    Sparkline, ///< One sparkline row each for created and completed tasks.
+    Csv        ///< "period,created,completed" rows.
+};
+
+/**
+ * @brief Number of tasks created and completed in one bucket.
+ */
+struct HistoryBucket {
+    int64_t bucket = 0;     ///< Bucket number: days, weeks or months since the Unix epoch.
+    uint64_t created = 0;   ///< Tasks created in the bucket.
+    uint64_t completed = 0; ///< Tasks completed in the bucket.
+};
+
+/**
+ * @brief Buckets creation and completion times in a single pass over the columns.
+ *
+ * Only timestamps in [from, to) are counted. The result holds only the
+ * non-empty buckets, so a stray timestamp far from the rest costs one
+ * bucket rather than every bucket in between.
+ *
+ * @param columns Columns of the tasks to report on.
+ * @param granularity Bucket size.
+ * @param from Inclusive lower bound on the timestamps counted.
+ * @param to Exclusive upper bound on the timestamps counted.
+ * @return Non-empty buckets in ascending order.
+ */
+std::vector<HistoryBucket> buildHistory(const TaskColumns &columns, HistoryGranularity granularity,
+                                        int64_t from = std::numeric_limits<int64_t>::min(),
+                                        int64_t to = std::numeric_limits<int64_t>::max());
+
+/**
+ * @brief Writes buckets as a report in the requested format.
+ *
+ * Empty buckets between the given ones are filled in, except across runs
+ * of more than 400 empty buckets: the CSV skips those and the sparkline
+ * marks them with a single break.
+ *
+ * @param out Stream to write to.
+ * @param buckets Buckets returned by buildHistory.
+ * @param granularity Granularity the buckets were built with.
+ * @param format Output format.
+ */
+void writeHistory(std::ostream &out, const std::vector<HistoryBucket> &buckets,
+                  HistoryGranularity granularity, HistoryFormat format);
+
+#endif // HISTORY_H
@@ -0,0 +1,51 @@
+#ifndef MIGRATIONS_H
+#define MIGRATIONS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief One step of the schema history.
+ *
+ * The schema statements run in a single transaction when the database is
+ * opened; they must be cheap (adding a nullable column, replacing a
+ * trigger). Work proportional to the table size goes into the backfill,
+ * which Database::migrateAsync runs in bounded chunks, each in its own
+ * transaction, so it can be interrupted and resumed at any point.
+ */
+struct Migration {
+    int version;                     ///< Value of PRAGMA user_version once the migration is complete.
+    const char *description;         ///< Shown in progress reports.
+    std::vector<const char *> schema; ///< Statements applied when the database is opened.
+    const char *backfillTable;       ///< Table whose rows the backfill walks in ID order, or nullptr.
+    const char *backfill;            ///< UPDATE over the IDs in (?1, ?2]; must be idempotent. nullptr if none.
+};
+
+/**
+ * @brief Progress of a running backfill, reported after every chunk.
+ */
+struct MigrationProgress {
+    int version = 0;          ///< Migration being backfilled.
+    std::string description;  ///< Its description.
+    int64_t rowsDone = 0;     ///< Rows covered so far, including earlier interrupted runs.
+    int64_t rowsTotal = 0;    ///< Rows in the table when this run started, plus rowsDone of earlier runs.
+    bool finished = false;    ///< The backfill is complete.
+};
+
+/**
+ * @brief Schema version of databases created before migrations were tracked.
+ */
+constexpr int BASELINE_SCHEMA_VERSION = 1;
+
+/**
+ * @brief Returns every migration in ascending version order.
+ */
+const std::vector<Migration> &migrations();
+
+/**
+ * @brief Returns the version a fully migrated database has.
+ */
+int latestSchemaVersion();
+
+#endif // MIGRATIONS_H
@@ -0,0 +1,75 @@
+#ifndef RECURRENCE_H
+#define RECURRENCE_H
+
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Period unit of a recurrence rule.
+ */
+enum class Frequency {
+    Hourly,
+    Daily,
+    Weekly
+};
+
+/**
+ * @brief Subset of an iCalendar RRULE: a fixed period of interval units.
+ *
+ * Written as "FREQ=DAILY;INTERVAL=2". Calendar-dependent rules such as
+ * monthly ones or BYDAY lists are not supported.
+ */
+struct RecurrenceRule {
+    Frequency frequency = Frequency::Daily;
+    int interval = 1; ///< Number of frequency units between occurrences; at least 1.
+};
+
+/**
+ * @brief Template a recurring task is materialized from.
+ *
+ * At most one task per template exists while it is open. The next one is
+ * only created once that task is done or deleted and nextTime has passed.
+ */
+struct Recurrence {
+    int id = 0;              ///< Template ID; 0 if the template does not exist.
+    std::string description; ///< Description given to every materialized task.
+    RecurrenceRule rule;     ///< When occurrences fall.
+    int64_t nextTime = 0;    ///< Start of the next occurrence's window.
+    int taskId = 0;          ///< Open task materialized from the template, or 0 if none.
+};
+
+/**
+ * @brief Parses a rule such as "FREQ=WEEKLY;INTERVAL=2" (case-insensitive).
+ *
+ * A bare frequency ("daily", "weekly", "hourly") is accepted as shorthand
+ * for an interval of 1.
+ *
+ * @param text Rule to parse.
+ * @param rule Set to the parsed rule on success.
+ * @return True if the text is a valid rule.
+ */
+bool parseRecurrenceRule(const std::string &text, RecurrenceRule &rule);
+
+/**
+ * @brief Formats a rule in the form parseRecurrenceRule accepts.
+ */
+std::string formatRecurrenceRule(const RecurrenceRule &rule);
+
+/**
+ * @brief Returns the length of a rule's period in seconds.
+ */
+int64_t recurrencePeriod(const RecurrenceRule &rule);
+
+/**
+ * @brief Returns the first occurrence after a time, counting periods from a start.
+ *
+ * Occurrences missed while nothing ran are skipped rather than caught up.
+ *
+ * @param rule Rule the occurrences follow.
+ * @param start An occurrence.
+ * @param after Time the result must be later than.
+ * @return start if it is later than after, else the earliest start + k * period > after.
+ */
+int64_t nextOccurrence(const RecurrenceRule &rule, int64_t start, int64_t after);
+
+#endif // RECURRENCE_H
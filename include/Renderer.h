@@ -0,0 +1,97 @@
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include <memory>
+#include <ostream>
+#include <string>
+#include "Task.h"
+
+/**
+ * @brief Output formats understood by makeRenderer().
+ */
+enum class OutputFormat {
+    Plain,     ///< Human-readable text without escape sequences.
+    Ansi,      ///< Human-readable text colored with ColorManager escapes.
+    JsonLines  ///< One JSON object per task, one task per line.
+};
+
+/**
+ * @class TaskRenderer
+ * @brief Writes tasks to an output stream in a specific format.
+ *
+ * Renderers are stateless and stream each task as it is visited, so
+ * listing never builds an intermediate document.
+ */
+class TaskRenderer {
+
+public:
+    virtual ~TaskRenderer() = default;
+
+    /**
+     * @brief Writes one task, including its line terminator.
+     *
+     * @param out Stream to write to.
+     * @param task Task to render.
+     */
+    virtual void render(std::ostream &out, const Task &task) const = 0;
+};
+
+/**
+ * @class PlainRenderer
+ * @brief Renders tasks as plain text, for pipes and files.
+ */
+class PlainRenderer : public TaskRenderer {
+
+public:
+    void render(std::ostream &out, const Task &task) const override;
+};
+
+/**
+ * @class AnsiRenderer
+ * @brief Renders tasks as colored text, for terminals.
+ */
+class AnsiRenderer : public TaskRenderer {
+
+public:
+    void render(std::ostream &out, const Task &task) const override;
+};
+
+/**
+ * @class JsonLinesRenderer
+ * @brief Renders tasks as JSON Lines, for scripts.
+ *
+ * Each task becomes
+ * {"id":..,"description":..,"done":..,"createdTime":..,"completedTime":..,"dueTime":..}
+ * with timestamps as Unix seconds; dueTime is 0 when the task has no due time.
+ */
+class JsonLinesRenderer : public TaskRenderer {
+
+public:
+    void render(std::ostream &out, const Task &task) const override;
+};
+
+/**
+ * @brief Creates the renderer for an output format.
+ *
+ * @param format Requested output format.
+ * @return Owning pointer to the renderer.
+ */
+std::unique_ptr<TaskRenderer> makeRenderer(OutputFormat format);
+
+/**
+ * @brief Picks the default format for standard output.
+ *
+ * @return OutputFormat::Ansi when stdout is a terminal, OutputFormat::Plain otherwise.
+ */
+OutputFormat detectOutputFormat();
+
+/**
+ * @brief Parses a format name ("plain", "ansi" or "json").
+ *
+ * @param name Format name as given on the command line.
+ * @param format Receives the parsed format on success.
+ * @return True if the name was recognized.
+ */
+bool parseOutputFormat(const std::string &name, OutputFormat &format);
+
+#endif // RENDERER_H
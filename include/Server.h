@@ -0,0 +1,119 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "TaskManager.h"
+
+/**
+ * @class Server
+ * @brief Serves TaskManager operations to local clients over a Unix domain socket.
+ *
+ * A single Server keeps one Database/TaskManager pair hot for every client,
+ * so clients skip startup and the full table load. Connections are
+ * multiplexed on one thread with an epoll event loop; requests execute on a
+ * fixed pool of worker threads so a slow request never stalls the other
+ * clients. Each connection has at most one request in flight, so its
+ * responses keep the order of its requests. When the pool's queue is full a
+ * request is answered "ERR server busy" instead of queued. Request lines
+ * longer than 64 KiB close the connection.
+ *
+ * Protocol: each request is one line, one of
+ *   ADD <description> | LIST [plain|ansi|json] | DONE <id> | DELETE <id> | CLEAR
+ *   | FILTER plain|ansi|json <expression>
+ * Each response is a status line ("OK" or "ERR <message>"), zero or more
+ * body lines, and a terminating empty line. Line breaks inside a message or
+ * task description are sent escaped as backslash-n and backslash-r, so every
+ * task is exactly one body line and no payload can end a response early.
+ */
+class Server {
+
+public:
+    /**
+     * @brief Constructs a Server bound to the given socket path.
+     *
+     * @param taskManager TaskManager that executes the requests.
+     * @param socketPath Filesystem path of the Unix domain socket.
+     */
+    Server(TaskManager &taskManager, const std::string &socketPath);
+
+    /**
+     * @brief Stops the workers once their current requests finish, closes all
+     * connections and removes the socket file.
+     */
+    ~Server();
+
+    /**
+     * @brief Runs the event loop until stop() is called.
+     */
+    void run();
+
+    /**
+     * @brief Asks the event loop to return. Safe to call from a signal handler.
+     */
+    void stop();
+
+private:
+    /**
+     * @brief Per-client connection state.
+     */
+    struct Connection {
+        uint64_t serial = 0;   ///< Distinguishes this connection from later ones reusing the descriptor.
+        std::string input;     ///< Bytes received but not yet parsed into a request.
+        std::string output;    ///< Response bytes not yet written to the socket.
+        bool busy = false;     ///< A request of this connection is executing on a worker.
+        bool closing = false;  ///< The client shut down its side; close once everything is answered.
+    };
+
+    /**
+     * @brief Request line waiting for a worker.
+     */
+    struct Job {
+        int fd;              ///< Client socket descriptor the request came from.
+        uint64_t serial;     ///< Serial of the connection that sent the request.
+        std::string request; ///< Request line without the trailing newline.
+    };
+
+    /**
+     * @brief Response produced by a worker, waiting to be handed to the loop.
+     */
+    struct Completion {
+        int fd;               ///< Client socket descriptor the request came from.
+        uint64_t serial;      ///< Serial of the connection that sent the request.
+        std::string response; ///< Framed response.
+    };
+
+    void acceptClients();
+    void readClient(int fd);
+    void writeClient(int fd);
+    void closeClient(int fd);
+    void updateClient(int fd);
+    void dispatchRequest(int fd);
+    void deliverCompletions();
+    void runWorker();
+    std::string handleRequest(const std::string &request);
+
+    TaskManager &taskManager; ///< Reference to the served TaskManager.
+    std::string socketPath;   ///< Path of the listening socket.
+    int listenFd;             ///< Listening socket descriptor.
+    int epollFd;              ///< epoll instance descriptor.
+    int wakeFd;               ///< eventfd used by stop() to wake the loop.
+    int doneFd;               ///< eventfd used by workers to report finished requests.
+    uint64_t nextSerial;      ///< Serial handed to the next accepted connection.
+    std::unordered_map<int, Connection> connections; ///< Open client connections by descriptor.
+    std::vector<std::thread> workers;     ///< Fixed pool executing requests off the loop thread.
+    std::mutex queueMutex;                ///< Guards queue and stopping.
+    std::condition_variable queueReady;   ///< Wakes a worker when a job is queued, or all of them to stop.
+    std::deque<Job> queue;                ///< Requests waiting for a worker, at most MAX_QUEUED_REQUESTS.
+    bool stopping;                        ///< Tells the workers to exit.
+    std::mutex completedMutex;            ///< Guards completed.
+    std::vector<Completion> completed;    ///< Finished requests not yet delivered by the loop.
+};
+
+#endif // SERVER_H
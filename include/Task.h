@@ -17,6 +17,7 @@ private:
     bool done;               ///< Flag indicating whether the task is completed.
     time_t createdTime;      ///< Timestamp indicating when the task was created.
     time_t completedTime;    ///< Timestamp indicating when the task was completed.
+    time_t dueTime = 0;      ///< Timestamp the task is due at, or 0 if it has no due time.
 
 public:
     /**
@@ -49,6 +50,13 @@ public:
      */
     std::string getDescription() const;
 
+    /**
+     * @brief Gets the heap memory held by the description.
+     *
+     * @return Bytes allocated for the description, or 0 if it fits in the string itself.
+     */
+    size_t getDescriptionHeapBytes() const;
+
     /**
      * @brief Checks if the task is completed.
      *
@@ -81,6 +89,20 @@ public:
      * @param time The completion time to set.
      */
     void setCompletedTime(time_t time);
+
+    /**
+     * @brief Gets the timestamp the task is due at.
+     *
+     * @return The due time of the task, or 0 if it has none.
+     */
+    time_t getDueTime() const;
+
+    /**
+     * @brief Sets the due time of the task.
+     *
+     * @param time The due time to set, or 0 to clear it.
+     */
+    void setDueTime(time_t time);
 };
 
 #endif // TASK_H
@@ -0,0 +1,115 @@
+#ifndef TASKCACHE_H
+#define TASKCACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include "Database.h"
+#include "Task.h"
+
+/**
+ * @brief Counters of a TaskCache, read with TaskCache::stats.
+ */
+struct TaskCacheStats {
+    uint64_t hits = 0;      ///< Lookups answered from a resident page.
+    uint64_t misses = 0;    ///< Lookups that had to read their page from the database.
+    uint64_t evictions = 0; ///< Pages dropped to stay within the budget.
+    size_t bytes = 0;       ///< Estimated memory held by the resident pages.
+    size_t pages = 0;       ///< Number of resident pages.
+};
+
+/**
+ * @class TaskCache
+ * @brief Memory-bounded cache of tasks in pages of consecutive IDs.
+ *
+ * Page n holds the tasks with IDs in [n * pageTasks, (n + 1) * pageTasks).
+ * A lookup that misses reads its whole page from the database, so nearby
+ * tasks are fetched with the same statement. Pages are evicted in least
+ * recently used order once their estimated size exceeds the budget.
+ *
+ * Writers call invalidate after committing; a page read concurrently with
+ * an invalidation is returned to its caller but not kept, so the cache never
+ * holds a page older than the last invalidation. Thread-safe.
+ */
+class TaskCache {
+public:
+    /**
+     * @brief Creates an empty cache.
+     *
+     * @param db Database the pages are read from.
+     * @param budgetBytes Memory the resident pages may use.
+     * @param pageTasks Number of IDs covered by a page.
+     */
+    TaskCache(Database &db, size_t budgetBytes, int pageTasks = 256);
+
+    /**
+     * @brief Returns the task with the given ID, reading its page on a miss.
+     *
+     * @param id Task ID.
+     * @return The task, or std::nullopt if it does not exist.
+     */
+    std::optional<Task> find(int id);
+
+    /**
+     * @brief Drops the pages holding any of the given IDs.
+     *
+     * @param ids IDs of tasks that were inserted, updated or deleted.
+     */
+    void invalidate(const std::vector<int> &ids);
+
+    /**
+     * @brief Drops every page.
+     */
+    void clear();
+
+    /**
+     * @brief Returns the hit, miss and eviction counts and the current size.
+     */
+    TaskCacheStats stats() const;
+
+    /**
+     * @brief Returns the memory budget in bytes.
+     */
+    size_t budget() const { return budgetBytes; }
+
+    /**
+     * @brief Estimates the memory a task takes in a page, including its description.
+     */
+    static size_t taskBytes(const Task &task);
+
+private:
+    using Page = std::shared_ptr<const std::vector<Task>>;
+
+    struct Entry {
+        Page tasks;                          ///< Tasks of the page in ascending ID order.
+        size_t bytes = 0;                    ///< Estimated size of the page.
+        std::list<int>::iterator position;   ///< Place in recency.
+    };
+
+    /**
+     * @brief Inserts a freshly read page and evicts until the budget holds.
+     *
+     * Caller must hold mutex.
+     */
+    void insert(int pageNumber, Page tasks);
+
+    Database &database;
+    const size_t budgetBytes;
+    const int pageTasks;
+    mutable std::mutex mutex;                ///< Guards pages, recency, bytes and generation.
+    std::unordered_map<int, Entry> pages;    ///< Resident pages by page number.
+    std::list<int> recency;                  ///< Page numbers, most recently used first.
+    size_t bytes = 0;                        ///< Sum of the resident pages' sizes.
+    uint64_t generation = 0;                 ///< Incremented by every invalidation.
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> evictions{0};
+};
+
+#endif // TASKCACHE_H
@@ -0,0 +1,49 @@
+#ifndef TASKFILTER_H
+#define TASKFILTER_H
+
+#include <cstdint>
+#include <string>
+#include <variant>
+#include <vector>
+
+/**
+ * @brief Constant of a filter expression, bound to one SQL parameter.
+ */
+using FilterValue = std::variant<int64_t, std::string>;
+
+/**
+ * @brief Filter expression translated to a WHERE condition over 'tasks'.
+ *
+ * Constants never appear in the condition, only '?' placeholders, so two
+ * expressions that differ only in their constants compile to the same
+ * condition and can share one prepared statement.
+ */
+struct CompiledFilter {
+    std::string condition;               ///< WHERE condition with '?' placeholders.
+    std::vector<FilterValue> parameters; ///< Values of the placeholders, in order.
+};
+
+/**
+ * @brief Compiles a filter expression such as `done=0 and created>2026-01-01 and text~"deploy"`.
+ *
+ * An expression combines comparisons with `and`, `or`, `not` and
+ * parentheses. A comparison is a field, an operator and a value:
+ *
+ * - `id`, `done`, `created`, `completed` and `due` take `= != < <= > >=`
+ *   and an integer; the time fields also take a local date `YYYY-MM-DD`,
+ *   optionally followed by `THH:MM`.
+ * - `text` and `tag` take `=`, `!=` and `~` (contains, ignoring ASCII case)
+ *   and a word or a double-quoted string, where `\"` and `\\` are escapes.
+ *
+ * Every comparison becomes a plain predicate on its column, so ID ranges
+ * use the primary key, `done` with `completed` the (done, completedTime)
+ * index, and `tag` the tag tables' keys. `done` without `completed` is kept
+ * off that index, which would otherwise win over an ID range.
+ *
+ * @param expression Expression to compile; an empty one matches every task.
+ * @return The condition and its parameters.
+ * @throws std::invalid_argument if the expression is malformed, naming the offset.
+ */
+CompiledFilter compileFilter(const std::string &expression);
+
+#endif // TASKFILTER_H
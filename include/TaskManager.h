@@ -3,20 +3,79 @@
 
 #include <vector>
 #include <string>
+#include <map>
+#include <set>
+#include <unordered_map>
 #include "Task.h"
 #include "Database.h"
+#include "Renderer.h"
+#include "TaskQuery.h"
+#include "History.h"
+#include "TrigramIndex.h"
+#include "TaskCache.h"
+#include "TimerWheel.h"
 #include <future> // For std::future
+#include <memory> // For std::shared_ptr
+#include <mutex>  // For std::mutex
+#include <shared_mutex> // For std::shared_mutex
+#include <queue>  // For std::priority_queue
+#include <deque>  // For std::deque
+#include <functional> // For std::greater, std::function
+#include <optional> // For std::optional
+#include <thread> // For std::thread
+#include <condition_variable> // For std::condition_variable
+#include <utility> // For std::pair
+#include <cstdint>
 
 using std::future;
 using std::string;
 using std::vector;
 
+// Immutable view of the cached tasks. Readers hold on to a snapshot for as
+// long as they need it; writers never modify a published snapshot, they
+// build and publish the next one.
+struct TaskSnapshot
+{
+    vector<Task> tasks;   // Cached tasks in ascending ID order; empty with a cache budget
+    uint64_t version = 0; // Incremented on every publish
+    // Sorted task IDs per tag. Lists that did not change are shared between snapshots.
+    std::map<string, std::shared_ptr<const vector<int>>> tagPostings;
+    // Column-oriented copy of tasks used by the query engine; row i is tasks[i].
+    TaskColumns columns;
+};
+
+// Estimated memory held by a TaskManager, read with TaskManager::memoryStats.
+// Sizes count heap allocations by capacity, not by what is in use.
+struct TaskMemoryStats
+{
+    size_t tasks = 0;             // Tasks in the current snapshot; 0 with a cache budget
+    size_t taskBytes = 0;         // The snapshot's vector of Task objects
+    size_t descriptionBytes = 0;  // Heap buffers of descriptions too long to be stored inline
+    size_t columnBytes = 0;       // Column copy of the tasks used by the query engine
+    size_t tagBytes = 0;          // Tag posting lists, including their map nodes
+    size_t searchIndexBytes = 0;  // Trigram index; 0 until the first search builds it
+    size_t cacheBytes = 0;        // Resident pages of the task cache; 0 without a cache budget
+    size_t cacheBudget = 0;       // Budget of the task cache; 0 without one
+
+    // Sum of the structures above.
+    size_t total() const
+    {
+        return taskBytes + descriptionBytes + columnBytes + tagBytes + searchIndexBytes + cacheBytes;
+    }
+};
+
 // TaskManager class manages a collection of tasks and interacts with the database.
 class TaskManager
 {
 public:
     // Constructor to initialize TaskManager with a reference to the Database.
-    TaskManager(Database &db);
+    // A nonzero cacheBudget (in bytes) stops it from holding every task: lookups
+    // by ID then go through a TaskCache of that size, and listings, queries,
+    // searches and reports read the database in batches. Tag postings stay in memory.
+    TaskManager(Database &db, size_t cacheBudget = 0);
+
+    // Stops the reminder thread, if started, and drops the stashes kept for undo.
+    ~TaskManager();
 
     // Asynchronous addition of a new task with the given description.
     future<void> addTaskAsync(const string &description);
@@ -30,12 +89,281 @@ public:
     // Asynchronous deletion of a task by its ID.
     future<void> deleteTaskAsync(int id);
 
-    // Asynchronous clearing of all tasks data from the database.
+    // Asynchronous deletion of every task matching a filter with a single
+    // statement, followed by one cache update. The future holds the count.
+    future<int> deleteWhereAsync(const TaskQuery &filter);
+
+    // Asynchronously marks every pending task matching a filter as done with a
+    // single statement, followed by one cache update. The future holds the count.
+    future<int> markDoneWhereAsync(const TaskQuery &filter);
+
+    // Asynchronous clearing of all tasks data from the database. The old
+    // tables are kept in a stash while the clear can be undone.
     future<void> clearAllDataAsync();
 
+    // Asynchronously reverts the latest undoable change made through this
+    // TaskManager: adding, completing or deleting a task, or clearing all data.
+    // The future holds what was undone, or an empty string if there was
+    // nothing; it throws std::invalid_argument if the change can no longer be
+    // reverted, e.g. because a deleted task's ID was reused, and the log is
+    // emptied.
+    future<string> undoAsync();
+
+    // Asynchronously reapplies the latest undone change. Any new undoable
+    // change empties the redo list. The future holds what was redone, or an
+    // empty string if there was nothing.
+    future<string> redoAsync();
+
+    // Asynchronous tagging of a task by its ID. Throws std::invalid_argument
+    // if the task does not exist.
+    future<void> addTagAsync(int id, const string &tag);
+
+    // Asynchronous removal of a tag from a task by its ID.
+    future<void> removeTagAsync(int id, const string &tag);
+
+    // Returns the cached tasks that carry all of the given tags, optionally only
+    // pending ones, by intersecting the in-memory posting lists.
+    vector<Task> tasksWithTags(const vector<string> &tags, bool pendingOnly) const;
+
+    // Asynchronous listing of the tasks that carry all of the given tags.
+    future<void> listTasksWithTagsAsync(const vector<string> &tags, bool pendingOnly) const;
+
+    // Asynchronously returns the tasks matching a filter expression such as
+    // `done=0 and created>2026-01-01 and text~"deploy"` (see compileFilter),
+    // read from the database. The future throws std::invalid_argument if the
+    // expression is malformed.
+    future<vector<Task>> filterTasksAsync(const string &expression) const;
+
+    // Asynchronous listing of the tasks matching a filter expression.
+    future<void> listTasksMatchingAsync(const string &expression) const;
+
+    // Asynchronously makes a task wait until another one is done. The future
+    // throws std::invalid_argument if either task is missing or the edge would
+    // close a cycle.
+    future<void> addDependencyAsync(int id, int prerequisiteId);
+
+    // Asynchronous removal of a dependency between two tasks.
+    future<void> removeDependencyAsync(int id, int prerequisiteId);
+
+    // Asynchronous retrieval of the pending tasks whose prerequisites are all
+    // done, in ID order. Served from a ready set that every change updates
+    // incrementally, so the dependency graph is never walked.
+    future<vector<Task>> readyTasksAsync() const;
+
+    // Returns the IDs of the tasks the given task waits for, done or not.
+    vector<int> prerequisitesOf(int id) const;
+
+    // Asynchronously sets the time a task is due at; 0 clears it.
+    future<void> setDueTimeAsync(int id, int64_t dueTime);
+
+    // Starts a thread that calls notify once for every pending task whose due
+    // time passes while it runs, within about a second. The thread also picks
+    // up changes from other processes every second, so due times set there are
+    // honored. Due times already past when it starts are not reported. Calling
+    // it again only replaces the callback.
+    void startReminders(std::function<void(const Task &)> notify);
+
+    // Stops the reminder thread and waits for a running notification to
+    // return. Must not be called from the callback.
+    void stopReminders();
+
+    // Returns the number of future due times waiting to fire.
+    size_t pendingReminders() const;
+
+    // Returns the cached tasks matching a query, evaluated over the snapshot's columns.
+    vector<Task> queryTasks(const TaskQuery &query) const;
+
+    // Counts the cached tasks matching a query without copying them.
+    size_t countTasks(const TaskQuery &query) const;
+
+    // Asynchronous report of tasks created and completed per day/week/month
+    // within [from, to), computed in one pass over the cached columns.
+    future<void> historyReportAsync(HistoryGranularity granularity, int64_t from, int64_t to, HistoryFormat format) const;
+
+    // Returns up to limit cached tasks whose description contains the query,
+    // allowing a few typos for longer queries. Best matches come first.
+    // The trigram index behind it is built on first use and then kept up to date.
+    vector<Task> searchTasks(const string &query, size_t limit) const;
+
+    // Asynchronously stores a recurring task template and creates its first task
+    // if firstTime has already passed. The future holds the template ID.
+    future<int> addRecurrenceAsync(const string &description, const RecurrenceRule &rule, int64_t firstTime);
+
+    // Asynchronous retrieval of the recurring task templates.
+    future<vector<Recurrence>> getRecurrencesAsync() const;
+
+    // Asynchronous deletion of a recurring task template; a task already made from it stays.
+    future<void> deleteRecurrenceAsync(int id);
+
+    // Asynchronously creates the next task of every template whose window has
+    // arrived by now and that has no open task. Only the due entries of a
+    // min-heap of next-fire times are examined, so this is cheap when nothing
+    // is due. The future holds the number of tasks that appeared.
+    future<int> materializeDueAsync(int64_t now);
+
+    // Returns a copy of the cached tasks without touching the database.
+    // With a cache budget, reads every task from the database instead.
+    vector<Task> getTasks() const;
+
+    // Returns the task with the given ID, or std::nullopt if there is none.
+    // With a cache budget, reads its page from the database on a miss.
+    std::optional<Task> getTask(int id) const;
+
+    // Visits every task in ascending ID order until visit returns false. With a
+    // cache budget, tasks are read in batches that bypass the cache, so a full
+    // scan does not evict the pages of recent lookups.
+    void forEachTask(const std::function<bool(const Task &)> &visit) const;
+
+    // Returns the hit, miss and eviction counts of the task cache; all zero
+    // without a cache budget.
+    TaskCacheStats cacheStats() const;
+
+    // Estimates the memory held by the snapshot, its descriptions, columns and
+    // tag postings, the search index and the task cache. Walks every cached
+    // task, so it costs about as much as a listing.
+    TaskMemoryStats memoryStats() const;
+
+    // Returns the current snapshot of the cached tasks. Never blocks on writers.
+    std::shared_ptr<const TaskSnapshot> snapshot() const;
+
+    // Sets the renderer used by listTasksAsync (ANSI colors by default).
+    void setRenderer(std::shared_ptr<const TaskRenderer> newRenderer);
+
+    // Returns true if the database is read-only; every mutation then fails.
+    bool isReadOnly() const;
+
+    // Asynchronously picks up changes committed by other processes. Checks
+    // PRAGMA data_version first and only fetches the changed rows, then creates
+    // the recurring tasks that have become due; the future holds true if a new
+    // snapshot was published.
+    future<bool> refreshAsync();
+
 private:
+    // Throws if the database was opened read-only, before any work is done.
+    void checkWritable() const;
+
+    // Reloads all tasks from the database and publishes them as the next snapshot.
+    // Caller must hold writeMutex.
+    void reloadTasks();
+
+    // Fetches the change-log delta since lastChangeSeq and publishes it.
+    // Returns true if anything changed. Caller must hold writeMutex.
+    bool syncChanges();
+
+    // Merges a delta into the current snapshot and publishes the result.
+    // Caller must hold writeMutex.
+    void applyChanges(const TaskChanges &changes);
+
+    // Numbers the snapshot's version and makes it current. The snapshot's
+    // columns must already be built. Caller must hold writeMutex.
+    void publish(std::shared_ptr<TaskSnapshot> next);
+
+    // Updates the search index, if built, with a delta applied on top of previous.
+    // Caller must hold writeMutex.
+    void indexChanges(const TaskSnapshot &previous, const TaskChanges &changes);
+
+    // Drops the search index so the next search rebuilds it from the current snapshot.
+    void resetSearchIndex();
+
+    // Rebuilds the dependency graph and the ready set from the database and the
+    // current snapshot. Caller must hold writeMutex.
+    void loadDependencies();
+
+    // Updates the dependency graph and the ready set with a delta that was just
+    // published. Caller must hold writeMutex and readyMutex.
+    void applyDependencyChanges(const TaskChanges &changes);
+
+    // Records whether a task is pending and adjusts the blocker counts of its
+    // dependents. Caller must hold readyMutex.
+    void setPending(int id, bool pending);
+
+    // Replaces a task's prerequisites, which must be sorted. Caller must hold readyMutex.
+    void setPrerequisites(int id, const vector<int> &prerequisites);
+
+    // One change in the undo log, with what it takes to revert and reapply it.
+    struct UndoEntry
+    {
+        enum class Kind { Add, Done, Delete, Clear };
+        Kind kind;
+        string label;               // What the change did, e.g. "delete task 3"
+        int id = 0;                 // Task added, completed or deleted
+        vector<TaskRecord> records; // Delete: the task to restore on undo. Add: the task to restore on redo
+        int stash = 0;              // Clear: stash holding the cleared tables until redone or dropped
+    };
+
+    // Appends a change that was just made, dropping the oldest beyond the limit,
+    // and empties the redo list. Caller must hold writeMutex.
+    void recordUndo(UndoEntry entry);
+
+    // Reverts (undo) or reapplies (redo) a logged change and publishes the
+    // result. Caller must hold writeMutex.
+    void applyUndo(UndoEntry &entry, bool undo);
+
+    // Releases what an entry that leaves the log holds, such as its stash.
+    void discardUndo(UndoEntry &entry);
+
+    // Empties the undo and redo lists. Caller must hold writeMutex.
+    void discardUndoLog();
+
+    // Rebuilds the timer wheel from the pending tasks due in the future.
+    // Caller must hold writeMutex.
+    void loadReminders();
+
+    // Schedules or cancels the timers of the tasks in a published delta.
+    // Caller must hold writeMutex.
+    void applyReminderChanges(const TaskChanges &changes);
+
+    // Body of the reminder thread.
+    void runReminders();
+
+    // Rebuilds the next-fire heap and the open recurring tasks from the database.
+    // Does nothing in read-only mode. Caller must hold writeMutex.
+    void loadRecurrences();
+
+    // Materializes the heap entries due by now and returns how many tasks
+    // appeared; the caller publishes them. Caller must hold writeMutex.
+    int materializeDue(int64_t now);
+
+    // Verifies every task against a search query, keeping the best limit hits.
+    // Used instead of the trigram index when a cache budget is set.
+    vector<Task> scanSearch(const string &query, int maxEdits, size_t limit) const;
+
+    // Streams the tasks matching a filter from the database in batches, until visit returns false.
+    void streamTasks(TaskQuery filter, const std::function<bool(const Task &)> &visit) const;
+
     Database &database; // Reference to the Database
-    vector<Task> tasks; // Vector to store tasks
+    std::unique_ptr<TaskCache> cache; // Pages of tasks when a cache budget is set; null otherwise
+    std::shared_ptr<const TaskSnapshot> current; // Published snapshot, accessed only via std::atomic_load/store
+    std::mutex writeMutex; // Serializes writers so snapshot versions are published in order
+    int64_t lastChangeSeq = 0;    // Change-log sequence the current snapshot reflects
+    int64_t lastDataVersion = -1; // PRAGMA data_version seen by the last refresh
+    std::shared_ptr<const TaskRenderer> renderer; // Output format of listTasksAsync, accessed via std::atomic_load/store
+    mutable std::shared_mutex searchMutex; // Guards searchIndex: searches share it, updates and the lazy build are exclusive
+    mutable TrigramIndex searchIndex;      // Trigrams of the cached descriptions
+    mutable bool searchIndexBuilt = false; // False until the first search that needs the index
+    using FireTime = std::pair<int64_t, int>; // (next fire time, template ID)
+    // Templates without an open task, earliest first. Guarded by writeMutex.
+    std::priority_queue<FireTime, vector<FireTime>, std::greater<FireTime>> fireTimes;
+    std::map<int, int> recurringTasks; // Open task ID -> template ID. Guarded by writeMutex.
+    // A task with dependency edges, in either direction.
+    struct DependencyNode
+    {
+        vector<int> prerequisites; // Tasks this one waits for, sorted
+        vector<int> dependents;    // Tasks waiting for this one
+        int blockers = 0;          // Prerequisites that are still pending
+        bool pending = false;      // The task exists and is not done
+    };
+    mutable std::mutex readyMutex; // Guards dependencyGraph and readyIds; writers also hold writeMutex
+    std::unordered_map<int, DependencyNode> dependencyGraph; // Only tasks that have edges
+    std::set<int> readyIds; // Pending tasks without pending prerequisites
+    mutable std::mutex reminderMutex; // Guards reminders, notifyReminder and reminderStop; writers also hold writeMutex
+    TimerWheel reminders; // Future due times of pending tasks, by task ID
+    std::function<void(const Task &)> notifyReminder; // Callback of the reminder thread
+    std::thread reminderThread; // Fires reminders while running
+    std::condition_variable reminderWake; // Wakes the reminder thread early to stop
+    bool reminderStop = false; // Set to ask the reminder thread to exit
+    std::deque<UndoEntry> undoLog; // Undoable changes, oldest first. Guarded by writeMutex.
+    vector<UndoEntry> redoLog;     // Undone changes, most recently undone last. Guarded by writeMutex.
 };
 
 #endif // TASKMANAGER_H
\ No newline at end of file
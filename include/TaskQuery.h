@@ -0,0 +1,94 @@
+#ifndef TASKQUERY_H
+#define TASKQUERY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "Task.h"
+
+/**
+ * @brief Column-oriented copy of a task list for predicate evaluation.
+ *
+ * Row i of every column describes the i-th task of the list it was built
+ * from. Timestamps are stored as contiguous 64-bit arrays and the done flag
+ * as a bitmap, so filters scan dense memory instead of Task objects.
+ */
+struct TaskColumns {
+    std::vector<int> ids;                ///< Task IDs.
+    std::vector<int64_t> createdTimes;   ///< Creation timestamps.
+    std::vector<int64_t> completedTimes; ///< Completion timestamps (0 while pending).
+    std::vector<uint64_t> doneBits;      ///< Bit i is set when row i is done.
+
+    /**
+     * @brief Returns the number of rows.
+     */
+    size_t size() const { return ids.size(); }
+};
+
+/**
+ * @brief Conjunction of predicates over the task columns.
+ *
+ * Ranges are half-open [from, to); a range left at its defaults is not
+ * evaluated at all. The same query also selects the rows of the bulk
+ * operations in Database, where it is translated to SQL.
+ */
+struct TaskQuery {
+    enum class Status { Any, Pending, Done };
+
+    Status status = Status::Any;                                    ///< Completion status filter.
+    int64_t createdFrom = std::numeric_limits<int64_t>::min();      ///< Inclusive lower bound on createdTime.
+    int64_t createdTo = std::numeric_limits<int64_t>::max();        ///< Exclusive upper bound on createdTime.
+    int64_t completedFrom = std::numeric_limits<int64_t>::min();    ///< Inclusive lower bound on completedTime.
+    int64_t completedTo = std::numeric_limits<int64_t>::max();      ///< Exclusive upper bound on completedTime.
+    int idFrom = std::numeric_limits<int>::min();                   ///< Inclusive lower bound on the task ID.
+    int idTo = std::numeric_limits<int>::max();                     ///< Exclusive upper bound on the task ID.
+    size_t limit = std::numeric_limits<size_t>::max();              ///< Maximum number of rows selected.
+};
+
+/**
+ * @brief Builds the columns for a task list.
+ *
+ * @param tasks Tasks to transpose.
+ * @return Columns with one row per task, in the same order.
+ */
+TaskColumns buildColumns(const std::vector<Task> &tasks);
+
+/**
+ * @brief Builds the columns of a task list from those of its previous version and a delta.
+ *
+ * Rows the delta leaves alone are copied from previous in runs, so a small
+ * delta does not read every Task back. The result equals buildColumns on
+ * the merged task list.
+ *
+ * @param previous Columns of the list before the delta, in ID order.
+ * @param upserted Added or changed tasks, in ID order.
+ * @param deleted IDs of the removed tasks, in ascending order.
+ * @return Columns of the merged list.
+ */
+TaskColumns mergeColumns(const TaskColumns &previous, const std::vector<Task> &upserted, const std::vector<int> &deleted);
+
+/**
+ * @brief Evaluates a query and returns the positions of the matching rows.
+ *
+ * The ID range is resolved by binary search, since rows are in ID order.
+ * Rows are processed 64 at a time: each predicate produces a 64-bit mask
+ * with branch-free comparisons, the masks are ANDed, and only set bits are
+ * expanded into the selection vector.
+ *
+ * @param columns Columns to scan.
+ * @param query Predicates and limit.
+ * @return Ascending row positions, at most query.limit of them.
+ */
+std::vector<uint32_t> selectRows(const TaskColumns &columns, const TaskQuery &query);
+
+/**
+ * @brief Counts the rows matching a query without materializing them.
+ *
+ * @param columns Columns to scan.
+ * @param query Predicates and limit.
+ * @return Number of matching rows, capped at query.limit.
+ */
+size_t countRows(const TaskColumns &columns, const TaskQuery &query);
+
+#endif // TASKQUERY_H
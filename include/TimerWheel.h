@@ -0,0 +1,115 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class TimerWheel
+ * @brief Hierarchical timing wheel keyed by task ID, with one-second ticks.
+ *
+ * Level l has 64 slots of 64^l ticks each, so five levels cover about 34
+ * years ahead of the current tick. A timer is linked into the slot of the
+ * lowest level whose range holds its delay; when a level wraps, the next slot
+ * of the level above is cascaded down. Scheduling and cancelling are O(1) and
+ * every timer is moved at most once per level, however many are pending.
+ *
+ * Timers live in one pool linked by index, so millions of them take a few
+ * allocations. Not thread-safe.
+ */
+class TimerWheel {
+public:
+    /**
+     * @brief Callback of advance, given the task ID and due time of a timer that fired.
+     */
+    using FireFunction = std::function<void(int id, int64_t due)>;
+
+    /**
+     * @brief Creates an empty wheel.
+     *
+     * @param now Current time in seconds; timers due at or before it fire on the next advance.
+     */
+    explicit TimerWheel(int64_t now = 0);
+
+    /**
+     * @brief Schedules a timer, replacing the task's earlier one.
+     *
+     * A due time at or before the current tick fires on the next tick.
+     *
+     * @param id Task ID.
+     * @param due Time in seconds the timer fires at.
+     */
+    void schedule(int id, int64_t due);
+
+    /**
+     * @brief Cancels the task's timer.
+     *
+     * @param id Task ID.
+     * @return True if the task had a pending timer.
+     */
+    bool cancel(int id);
+
+    /**
+     * @brief Moves the wheel to a new time, firing every timer due up to it in order.
+     *
+     * @param now Current time in seconds; earlier times are ignored.
+     * @param fire Called once for every timer that fired, after it was removed.
+     */
+    void advance(int64_t now, const FireFunction &fire);
+
+    /**
+     * @brief Removes every timer and restarts the wheel at a new time.
+     */
+    void clear(int64_t now);
+
+    /**
+     * @brief Returns the number of pending timers.
+     */
+    size_t size() const { return index.size(); }
+
+    /**
+     * @brief Returns the time of the last tick processed.
+     */
+    int64_t now() const { return current; }
+
+private:
+    static constexpr int SLOT_BITS = 6;
+    static constexpr int SLOTS = 1 << SLOT_BITS;
+    static constexpr int LEVELS = 5;
+    static constexpr int32_t NONE = -1;
+
+    struct Timer {
+        int64_t due = 0;     ///< Time the timer fires at.
+        int id = 0;          ///< Task ID.
+        int32_t prev = NONE; ///< Previous timer in the slot, or NONE.
+        int32_t next = NONE; ///< Next timer in the slot, or next free timer in the pool.
+        int32_t slot = NONE; ///< Slot the timer is linked into, or NONE if free.
+    };
+
+    /**
+     * @brief Links a timer into the slot its due time falls into, no earlier than earliest.
+     */
+    void link(int32_t timer, int64_t earliest);
+
+    /**
+     * @brief Unlinks a timer from its slot.
+     */
+    void unlink(int32_t timer);
+
+    /**
+     * @brief Returns a timer to the pool.
+     */
+    void release(int32_t timer);
+
+    std::vector<Timer> timers;                  ///< Pool of linked and free timers.
+    int32_t freeTimers = NONE;                  ///< First free timer in the pool.
+    std::array<int32_t, LEVELS * SLOTS> slots;  ///< First timer of every slot, level by level.
+    std::unordered_map<int, int32_t> index;     ///< Pending timer of every scheduled task ID.
+    int64_t current;                            ///< Last tick processed.
+};
+
+#endif // TIMERWHEEL_H
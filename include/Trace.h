@@ -0,0 +1,127 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Opt-in span tracing written as Chrome trace-event JSON.
+ *
+ * Spans are appended to a buffer owned by the recording thread, so
+ * recording takes no lock. While tracing is off, a span costs one
+ * atomic load. The file can be opened in chrome://tracing or Perfetto.
+ */
+namespace Trace
+{
+    namespace detail
+    {
+        extern std::atomic<bool> active; ///< True between start() and stop().
+    }
+
+    /**
+     * @brief Returns true while spans are being recorded.
+     */
+    inline bool enabled() noexcept
+    {
+        return detail::active.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Starts recording; the trace is written to path by stop() or at exit.
+     *
+     * Starting again after stop() begins a new trace with empty buffers.
+     *
+     * @param path File to write the Chrome trace JSON to.
+     */
+    void start(const std::string &path);
+
+    /**
+     * @brief Stops recording and writes every recorded span. Later calls do nothing.
+     */
+    void stop();
+
+    /**
+     * @brief Returns microseconds since start(), or -1 while tracing is off.
+     */
+    int64_t now() noexcept;
+
+    /**
+     * @brief Records a span on the calling thread's track.
+     *
+     * @param name Span name; must outlive the trace (a string literal).
+     * @param category Span category; must outlive the trace.
+     * @param begin Start time from now().
+     * @param end End time from now().
+     */
+    void record(const char *name, const char *category, int64_t begin, int64_t end) noexcept;
+
+    /**
+     * @class Scope
+     * @brief Records a span from construction to destruction.
+     */
+    class Scope {
+    public:
+        /**
+         * @brief Starts an "exec" span.
+         *
+         * @param name Span name; must be a string literal.
+         */
+        explicit Scope(const char *name) noexcept : name(name), begin(enabled() ? now() : -1) {}
+
+        /**
+         * @brief Records the "queue" span an asynchronous call spent waiting for
+         * its thread, then starts its "exec" span.
+         *
+         * @param name Span name; must be a string literal.
+         * @param enqueued now() taken when the call was made.
+         */
+        Scope(const char *name, int64_t enqueued) noexcept : name(name), begin(enabled() ? now() : -1)
+        {
+            if (enqueued >= 0 && begin >= 0) {
+                record(name, "queue", enqueued, begin);
+            }
+        }
+
+        /**
+         * @brief Ends the span and records it.
+         */
+        ~Scope()
+        {
+            if (begin >= 0) {
+                finish();
+            }
+        }
+
+        /**
+         * @brief Attaches a numeric argument shown with the span. At most three are kept.
+         *
+         * @param key Argument name; must be a string literal.
+         * @param value Argument value.
+         */
+        void arg(const char *key, int64_t value) noexcept;
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        void finish() noexcept;
+
+        const char *name;
+        int64_t begin;              ///< -1 if tracing was off when the scope began.
+        const char *argKeys[3] = {};
+        int64_t argValues[3] = {};
+        int argCount = 0;
+    };
+}
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+/// Traces the rest of the enclosing block.
+#define TRACE_SCOPE(name) ::Trace::Scope TRACE_CONCAT(traceScope, __LINE__)(name)
+
+/// Traces the rest of an asynchronous task's body, preceded by its wait since enqueued.
+#define TRACE_ASYNC_SCOPE(name, enqueued) ::Trace::Scope TRACE_CONCAT(traceScope, __LINE__)(name, enqueued)
+
+#endif // TRACE_H
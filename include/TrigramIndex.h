@@ -0,0 +1,106 @@
+#ifndef TRIGRAMINDEX_H
+#define TRIGRAMINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief A candidate visited by TrigramIndex::forEachCandidate.
+ */
+struct TrigramCandidate {
+    int id = 0;        ///< Task ID.
+    int minEdits = 0;  ///< Lower bound on the edit distance implied by the missing trigrams.
+};
+
+/**
+ * @class TrigramIndex
+ * @brief Inverted index from the case-folded trigrams of task descriptions to task IDs.
+ *
+ * Each posting list holds sorted task IDs. New tasks get the highest IDs, so
+ * adding a task appends to its posting lists. The index only proposes
+ * candidates; callers verify them against the text with substringEditDistance.
+ * Not thread-safe: callers serialize updates against searches.
+ */
+class TrigramIndex {
+public:
+    /**
+     * @brief Adds a task's description to the index. Adding the same pair twice has no effect.
+     *
+     * @param id Task ID.
+     * @param description Task description.
+     */
+    void insert(int id, const std::string &description);
+
+    /**
+     * @brief Removes a task's description from the index.
+     *
+     * @param id Task ID.
+     * @param description Description the task was inserted with.
+     */
+    void erase(int id, const std::string &description);
+
+    /**
+     * @brief Removes every entry.
+     */
+    void clear();
+
+    /**
+     * @brief Returns the tasks that may lie within maxEdits of a substring of the query.
+     *
+     * An edit, counting a swap of adjacent characters as one, destroys at most
+     * four of the query's trigrams, so a task must share at least
+     * (trigrams - 4 * maxEdits) of them, and never fewer than one.
+     *
+     * Candidates are visited in order of ascending minEdits, then ascending
+     * ID, until the visitor returns false, so callers that stop early do not
+     * pay for materializing the rest.
+     *
+     * @param query Search text of at least three characters.
+     * @param maxEdits Edit budget of the search.
+     * @param visit Called for each candidate; returns false to stop.
+     */
+    void forEachCandidate(const std::string &query, int maxEdits,
+                          const std::function<bool(const TrigramCandidate &)> &visit) const;
+
+    /**
+     * @brief Returns the number of distinct trigrams indexed.
+     */
+    size_t size() const { return postings.size(); }
+
+    /**
+     * @brief Estimates the heap memory held by the index: hash buckets, nodes and posting lists.
+     */
+    size_t memoryBytes() const;
+
+private:
+    std::unordered_map<uint32_t, std::vector<int>> postings; ///< Sorted task IDs per trigram.
+    int maxId = 0;                                           ///< Largest ID ever inserted.
+};
+
+/**
+ * @brief Returns the case-folded trigrams of a text, without duplicates.
+ *
+ * @param text Text to split.
+ * @return Sorted trigram keys; empty if the text is shorter than three bytes.
+ */
+std::vector<uint32_t> trigramsOf(const std::string &text);
+
+/**
+ * @brief Computes the smallest edit distance between a pattern and any substring of a text.
+ *
+ * Insertions, deletions, substitutions and swaps of adjacent characters each
+ * count as one edit. Comparison is case-insensitive for ASCII letters. A
+ * result of 0 means the pattern occurs in the text.
+ *
+ * @param pattern Text searched for.
+ * @param text Text searched in.
+ * @param maxEdits Distance above which the computation may stop early.
+ * @return The distance, or maxEdits + 1 if it exceeds maxEdits.
+ */
+int substringEditDistance(const std::string &pattern, const std::string &text, int maxEdits);
+
+#endif // TRIGRAMINDEX_H
@@ -0,0 +1,162 @@
+#include "Archive.h"
+#include <cstdint>
+#include <stdexcept>
+#include <utility> // For std::move
+#include <zlib.h>
+
+using std::string;
+using std::vector;
+
+namespace
+{
+    /// Version byte at the start of every block, before compression.
+    constexpr unsigned char BLOCK_FORMAT = 1;
+
+    /**
+     * @brief Appends an unsigned integer in little-endian base-128, 7 bits per byte.
+     */
+    void putVarint(string &out, uint64_t value)
+    {
+        while (value >= 0x80) {
+            out += static_cast<char>((value & 0x7f) | 0x80);
+            value >>= 7;
+        }
+        out += static_cast<char>(value);
+    }
+
+    /**
+     * @brief Appends a signed integer, zigzag-encoded so small negatives stay short.
+     */
+    void putSigned(string &out, int64_t value)
+    {
+        putVarint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+    }
+
+    /**
+     * @brief Appends a length-prefixed string.
+     */
+    void putString(string &out, const string &text)
+    {
+        putVarint(out, text.size());
+        out += text;
+    }
+
+    /**
+     * @brief Reads the fields written by the put functions, failing on overrun.
+     */
+    class Reader
+    {
+    public:
+        Reader(const string &data) : data(data) {}
+
+        bool atEnd() const { return position == data.size(); }
+
+        uint64_t varint()
+        {
+            uint64_t value = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                if (position == data.size()) {
+                    break;
+                }
+                const auto byte = static_cast<unsigned char>(data[position++]);
+                value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+                if (!(byte & 0x80)) {
+                    return value;
+                }
+            }
+            throw std::runtime_error("corrupt archive block");
+        }
+
+        int64_t signedValue()
+        {
+            const uint64_t value = varint();
+            return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+        }
+
+        string text()
+        {
+            const uint64_t size = varint();
+            if (size > data.size() - position) {
+                throw std::runtime_error("corrupt archive block");
+            }
+            string value = data.substr(position, size);
+            position += size;
+            return value;
+        }
+
+    private:
+        const string &data;
+        size_t position = 0;
+    };
+}
+
+/**
+ * @brief Serializes and zlib-compresses a block of archived tasks.
+ *
+ * Each task is stored as varints for the ID and the zigzag-encoded
+ * timestamps, followed by the length-prefixed description and tags.
+ *
+ * @param tasks Tasks to store.
+ * @param rawSize Set to the size of the block before compression.
+ * @return The compressed block.
+ */
+string encodeArchiveBlock(const vector<ArchivedTask> &tasks, size_t &rawSize)
+{
+    string raw(1, static_cast<char>(BLOCK_FORMAT));
+    for (const ArchivedTask &archived : tasks) {
+        putVarint(raw, static_cast<uint32_t>(archived.task.getId()));
+        putSigned(raw, static_cast<int64_t>(archived.task.getCreatedTime()));
+        putSigned(raw, static_cast<int64_t>(archived.task.getCompletedTime()));
+        putString(raw, archived.task.getDescription());
+        putVarint(raw, archived.tags.size());
+        for (const string &tag : archived.tags) {
+            putString(raw, tag);
+        }
+    }
+    rawSize = raw.size();
+
+    uLongf compressedSize = compressBound(static_cast<uLong>(raw.size()));
+    string compressed(compressedSize, '\0');
+    if (compress2(reinterpret_cast<Bytef *>(&compressed[0]), &compressedSize,
+                  reinterpret_cast<const Bytef *>(raw.data()), static_cast<uLong>(raw.size()), Z_BEST_COMPRESSION) != Z_OK) {
+        throw std::runtime_error("cannot compress archive block");
+    }
+    compressed.resize(compressedSize);
+    return compressed;
+}
+
+/**
+ * @brief Decompresses and parses a block written by encodeArchiveBlock.
+ *
+ * @param data Compressed block.
+ * @param size Size of the compressed block.
+ * @param rawSize Size of the block before compression.
+ * @return The tasks in the order they were stored.
+ */
+vector<ArchivedTask> decodeArchiveBlock(const void *data, size_t size, size_t rawSize)
+{
+    string raw(rawSize, '\0');
+    uLongf decompressedSize = static_cast<uLongf>(rawSize);
+    if (rawSize == 0 ||
+        uncompress(reinterpret_cast<Bytef *>(&raw[0]), &decompressedSize, static_cast<const Bytef *>(data),
+                   static_cast<uLong>(size)) != Z_OK ||
+        decompressedSize != rawSize || static_cast<unsigned char>(raw[0]) != BLOCK_FORMAT) {
+        throw std::runtime_error("corrupt archive block");
+    }
+
+    vector<ArchivedTask> tasks;
+    Reader reader(raw);
+    reader.varint(); // Format byte, checked above
+    while (!reader.atEnd()) {
+        const int id = static_cast<int>(reader.varint());
+        const int64_t createdTime = reader.signedValue();
+        const int64_t completedTime = reader.signedValue();
+        const string description = reader.text();
+        ArchivedTask archived{Task(id, description, true, static_cast<time_t>(createdTime), static_cast<time_t>(completedTime)), {}};
+        for (uint64_t tags = reader.varint(); tags > 0; --tags) {
+            archived.tags.push_back(reader.text());
+        }
+        tasks.push_back(std::move(archived));
+    }
+    return tasks;
+}
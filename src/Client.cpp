@@ -0,0 +1,82 @@
+#ifdef __linux__
+
+#include "Client.h"
+#include <cstring>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <errno.h>
+
+using std::string;
+
+/**
+ * @brief Connects to the server listening on the given socket path.
+ *
+ * @param socketPath Filesystem path of the Unix domain socket.
+ */
+Client::Client(const string &socketPath) : fd(-1)
+{
+    sockaddr_un address{};
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Socket path too long: " + socketPath);
+    }
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0) {
+        int error = errno;
+        if (fd >= 0) close(fd);
+        throw std::runtime_error("Cannot connect to " + socketPath + ": " + std::strerror(error));
+    }
+}
+
+/**
+ * @brief Closes the connection.
+ */
+Client::~Client()
+{
+    if (fd >= 0) close(fd);
+}
+
+/**
+ * @brief Sends one request line and blocks until the framed response arrives.
+ *
+ * @param request Request line without the trailing newline.
+ * @param body Receives the response body lines.
+ * @return Status line of the response ("OK" or "ERR <message>").
+ */
+string Client::send(const string &request, string &body)
+{
+    string line = request + '\n';
+    size_t written = 0;
+    while (written < line.size()) {
+        ssize_t sent = ::send(fd, line.data() + written, line.size() - written, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(string("send: ") + std::strerror(errno));
+        }
+        written += static_cast<size_t>(sent);
+    }
+
+    // A response ends at the first empty line
+    size_t end;
+    while ((end = buffer.find("\n\n")) == string::npos) {
+        char chunk[4096];
+        ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+        if (received < 0 && errno == EINTR) continue;
+        if (received <= 0) {
+            throw std::runtime_error("Connection closed by server");
+        }
+        buffer.append(chunk, static_cast<size_t>(received));
+    }
+
+    size_t statusEnd = buffer.find('\n');
+    string status = buffer.substr(0, statusEnd);
+    body = buffer.substr(statusEnd + 1, end - statusEnd);
+    buffer.erase(0, end + 2);
+    return status;
+}
+
+#endif // __linux__
@@ -1,24 +1,564 @@
 #include "Database.h"
+#include "Trace.h"
+#include "TaskFilter.h"
 #include <SQLiteCpp/SQLiteCpp.h>
 #include <SQLiteCpp/VariadicBind.h>
+#include <SQLiteCpp/Backup.h>
+#include <sqlite3.h> // For the backup step result codes and memory statistics
 #include <iostream>
 #include <ctime>  // For std::time
 #include <future> // For std::future
+#include <string> // For std::to_string
+#include <filesystem> // For std::filesystem::temp_directory_path, remove
+#include <random>     // For std::random_device
+#include <algorithm>  // For std::max, std::min
+#include <limits>     // For std::numeric_limits
+#include <istream>    // For std::getline
+#include <ostream>
+#include <stdexcept>  // For std::runtime_error, std::invalid_argument
+#include <cctype>     // For std::tolower
+#include <unordered_map>
+#include <type_traits> // For std::is_void_v
 
 using std::async;
 using std::future;
 using std::launch;
 using std::string;
 
+namespace
+{
+    /// Bytes of the file memory-mapped in read-only modes; SQLite caps it at the file size.
+    constexpr int64_t READONLY_MMAP_SIZE = int64_t(1) << 30;
+
+    /// Pause between backup steps, during which foreground statements get the connection.
+    constexpr std::chrono::milliseconds BACKUP_STEP_PAUSE(5);
+
+    /// Tables moved into a stash by a clear that can be undone, in the order they are renamed.
+    const char *const STASHED_TABLES[] = {"tasks", "task_tags", "task_deps", "recurrences", "archive_blocks"};
+
+    /**
+     * @brief Returns the prefix of the tables kept in a stash.
+     */
+    string stashPrefix(int stash)
+    {
+        return "undo_" + std::to_string(stash) + "_";
+    }
+
+    /// Seconds after which a stash is dropped by the next stash, in case its process died without dropping it.
+    constexpr int64_t STASH_LIFETIME = 24 * 3600;
+
+    /// Prepared filter statements kept per connection; the cache starts over when it is full.
+    constexpr size_t FILTER_STATEMENTS = 64;
+
+    /**
+     * @brief Returns the busy timeout of a policy in the form SQLite takes it.
+     */
+    int timeoutMs(const BusyPolicy &policy)
+    {
+        return static_cast<int>(std::min<int64_t>(policy.timeout.count(), std::numeric_limits<int>::max()));
+    }
+
+    /**
+     * @brief Returns true if an error means the file was locked by another connection.
+     */
+    bool isBusy(const SQLite::Exception &e)
+    {
+        const int code = e.getErrorCode() & 0xff; // Primary code, e.g. SQLITE_BUSY for SQLITE_BUSY_SNAPSHOT
+        return code == SQLITE_BUSY || code == SQLITE_LOCKED;
+    }
+
+    /**
+     * @brief Sleeps before a retry: exponential in the attempt, capped, with jitter.
+     *
+     * The delay is drawn from the upper half of the capped exponential, so
+     * processes that collided spread out while each still backs off.
+     */
+    void backOff(const BusyPolicy &policy, int attempt)
+    {
+        thread_local std::mt19937 generator(std::random_device{}());
+        const int64_t base = std::max<int64_t>(policy.backoff.count(), 1);
+        const int64_t cap = std::max<int64_t>(policy.maxBackoff.count(), base);
+        const int64_t delay = attempt >= 30 ? cap : std::min(cap, base << attempt);
+        std::uniform_int_distribution<int64_t> jitter(delay / 2, delay);
+        std::this_thread::sleep_for(std::chrono::milliseconds(jitter(generator)));
+    }
+
+    /**
+     * @brief Runs step, retrying it while it fails because the file is locked.
+     *
+     * step must be safe to repeat after a busy failure: a single statement,
+     * or a whole transaction that rolled back.
+     *
+     * @param policy Number of retries and delays between them.
+     * @param retries Incremented on every retry.
+     * @return Whatever step returns.
+     */
+    template <typename Step>
+    auto retryBusy(const BusyPolicy &policy, std::atomic<uint64_t> &retries, Step &&step) -> decltype(step())
+    {
+        for (int attempt = 0;; ++attempt) {
+            try {
+                return step();
+            }
+            catch (const SQLite::Exception &e) {
+                if (!isBusy(e) || attempt >= policy.retries) {
+                    throw;
+                }
+            }
+            retries.fetch_add(1, std::memory_order_relaxed);
+            TRACE_SCOPE("Database::busyRetry");
+            backOff(policy, attempt);
+        }
+    }
+
+    /// First field of the header line of a change batch.
+    constexpr const char *CHANGE_BATCH_MAGIC = "todolist-changes";
+
+    /// Format version written in the header line of a change batch.
+    constexpr int CHANGE_BATCH_VERSION = 2; // 2 added the due time to 'U' entries
+
+    /// (last sequence, cleared) of the change log after ?1. 'C' marks a clear; 'P' marks
+    /// entries up to its taskId that were acknowledged and removed.
+    constexpr const char *CHANGE_RANGE_SQL =
+        "SELECT COALESCE(MAX(seq), ?1), COUNT(CASE WHEN op = 'C' OR (op = 'P' AND taskId > ?1) THEN 1 END) "
+        "FROM task_changes WHERE seq > ?1";
+
+    /// (id, exists, description, done, createdTime, completedTime, dueTime) of the tasks logged within (?1, ?2].
+    string changedTasksSql(const string &dueColumn)
+    {
+        return "SELECT c.taskId, t.id IS NOT NULL, t.description, t.done, t.createdTime, t.completedTime, " + dueColumn +
+               " FROM (SELECT DISTINCT taskId FROM task_changes WHERE seq > ?1 AND seq <= ?2 AND op <> 'P') c "
+               "LEFT JOIN tasks t ON t.id = c.taskId ORDER BY c.taskId";
+    }
+
+    /// (taskId, tag) of the tasks logged within (?1, ?2].
+    constexpr const char *CHANGED_TAGS_SQL =
+        "SELECT tt.taskId, g.name FROM task_tags tt JOIN tags g ON g.id = tt.tagId "
+        "WHERE tt.taskId IN (SELECT taskId FROM task_changes WHERE seq > ?1 AND seq <= ?2 AND op <> 'P')";
+
+    /// (taskId, dependsOn) of the tasks logged within (?1, ?2].
+    constexpr const char *CHANGED_DEPENDENCIES_SQL =
+        "SELECT d.taskId, d.dependsOn FROM task_deps d "
+        "WHERE d.taskId IN (SELECT taskId FROM task_changes WHERE seq > ?1 AND seq <= ?2 AND op <> 'P') "
+        "ORDER BY d.taskId, d.dependsOn";
+
+    /**
+     * @brief Escapes backslashes, tabs and line breaks so a field fits on one batch line.
+     */
+    string escapeField(const string &text)
+    {
+        string escaped;
+        escaped.reserve(text.size());
+        for (char c : text) {
+            switch (c) {
+            case '\\': escaped += "\\\\"; break;
+            case '\t': escaped += "\\t"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\r': escaped += "\\r"; break;
+            default: escaped += c;
+            }
+        }
+        return escaped;
+    }
+
+    /**
+     * @brief Reverses escapeField.
+     */
+    string unescapeField(const string &text)
+    {
+        string unescaped;
+        unescaped.reserve(text.size());
+        for (size_t i = 0; i < text.size(); ++i) {
+            if (text[i] != '\\' || i + 1 == text.size()) {
+                unescaped += text[i];
+                continue;
+            }
+            const char c = text[++i];
+            unescaped += c == 't' ? '\t' : c == 'n' ? '\n' : c == 'r' ? '\r' : c;
+        }
+        return unescaped;
+    }
+
+    /**
+     * @brief Splits a batch line into its tab-separated fields.
+     */
+    std::vector<string> splitFields(const string &line)
+    {
+        std::vector<string> fields;
+        size_t start = 0;
+        for (size_t tab = line.find('\t'); tab != string::npos; tab = line.find('\t', start)) {
+            fields.push_back(line.substr(start, tab - start));
+            start = tab + 1;
+        }
+        fields.push_back(line.substr(start));
+        return fields;
+    }
+
+    /**
+     * @brief Parses an integer field of a batch line.
+     *
+     * @throws std::runtime_error if the field is not an integer.
+     */
+    int64_t parseField(const string &field)
+    {
+        size_t used = 0;
+        int64_t value = 0;
+        try {
+            value = std::stoll(field, &used);
+        }
+        catch (const std::logic_error &) {
+            used = 0;
+        }
+        if (field.empty() || used != field.size()) {
+            throw std::runtime_error("malformed change batch field: " + field);
+        }
+        return value;
+    }
+
+    /// Completed tasks in the archive run's selection order; ?1 is the cutoff, ?2 the limit.
+    constexpr const char *ARCHIVABLE_TASKS_SQL =
+        "SELECT id FROM tasks WHERE done = 1 AND completedTime < ?1 ORDER BY completedTime, id LIMIT ?2";
+
+    /**
+     * @brief Decodes the block in columns (rawSize, data) of the current row.
+     */
+    std::vector<ArchivedTask> readArchiveBlock(SQLite::Statement &query, int rawSizeColumn)
+    {
+        const SQLite::Column data = query.getColumn(rawSizeColumn + 1);
+        return decodeArchiveBlock(data.getBlob(), static_cast<size_t>(data.getBytes()),
+                                  static_cast<size_t>(query.getColumn(rawSizeColumn).getInt64()));
+    }
+
+    /**
+     * @brief Moves up to one block of archivable tasks into 'archive_blocks' in one transaction.
+     *
+     * The newest block is rewritten with the new tasks appended while it has
+     * room; otherwise a new block is started.
+     *
+     * @return Number of tasks moved; 0 once nothing is left to archive.
+     */
+    int archiveBlock(SQLite::Database &db, int64_t completedBefore, int blockTasks)
+    {
+        SQLite::Transaction transaction(db, SQLite::TransactionBehavior::IMMEDIATE);
+        std::vector<ArchivedTask> block;
+        int64_t blockId = 0;
+        {
+            SQLite::Statement newest(db, "SELECT id, taskCount, rawSize, data FROM archive_blocks ORDER BY id DESC LIMIT 1");
+            if (newest.executeStep() && newest.getColumn(1).getInt() < blockTasks) {
+                blockId = newest.getColumn(0).getInt64();
+                block = readArchiveBlock(newest, 2);
+            }
+        }
+        const size_t kept = block.size();
+
+        SQLite::Statement tasks(db, string("SELECT id, description, createdTime, completedTime FROM tasks WHERE id IN (") +
+                                        ARCHIVABLE_TASKS_SQL + ") ORDER BY id");
+        tasks.bind(1, completedBefore);
+        tasks.bind(2, blockTasks - static_cast<int>(kept));
+        std::unordered_map<int, size_t> positions;
+        while (tasks.executeStep()) {
+            positions[tasks.getColumn(0).getInt()] = block.size();
+            block.push_back(ArchivedTask{Task(tasks.getColumn(0).getInt(), tasks.getColumn(1).getText(), true,
+                                              static_cast<time_t>(tasks.getColumn(2).getInt64()),
+                                              static_cast<time_t>(tasks.getColumn(3).getInt64())),
+                                         {}});
+        }
+        if (block.size() == kept) {
+            return 0;
+        }
+
+        SQLite::Statement tags(db, string("SELECT tt.taskId, g.name FROM task_tags tt JOIN tags g ON g.id = tt.tagId "
+                                          "WHERE tt.taskId IN (") + ARCHIVABLE_TASKS_SQL + ") ORDER BY g.name");
+        tags.bind(1, completedBefore);
+        tags.bind(2, blockTasks - static_cast<int>(kept));
+        while (tags.executeStep()) {
+            block[positions.at(tags.getColumn(0).getInt())].tags.push_back(tags.getColumn(1).getText());
+        }
+
+        SQLite::Statement remove(db, string("DELETE FROM tasks WHERE id IN (") + ARCHIVABLE_TASKS_SQL + ")");
+        remove.bind(1, completedBefore);
+        remove.bind(2, blockTasks - static_cast<int>(kept));
+        remove.exec();
+
+        int64_t firstId = std::numeric_limits<int64_t>::max(), lastId = std::numeric_limits<int64_t>::min();
+        int64_t completedFrom = std::numeric_limits<int64_t>::max(), completedTo = std::numeric_limits<int64_t>::min();
+        for (const ArchivedTask &archived : block) {
+            firstId = std::min<int64_t>(firstId, archived.task.getId());
+            lastId = std::max<int64_t>(lastId, archived.task.getId());
+            completedFrom = std::min<int64_t>(completedFrom, archived.task.getCompletedTime());
+            completedTo = std::max<int64_t>(completedTo, archived.task.getCompletedTime());
+        }
+        size_t rawSize = 0;
+        const string data = encodeArchiveBlock(block, rawSize);
+        SQLite::Statement store(db, blockId
+            ? "UPDATE archive_blocks SET firstId = ?1, lastId = ?2, completedFrom = ?3, completedTo = ?4, taskCount = ?5, "
+              "rawSize = ?6, data = ?7 WHERE id = ?8"
+            : "INSERT INTO archive_blocks (firstId, lastId, completedFrom, completedTo, taskCount, rawSize, data) "
+              "VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7)");
+        store.bind(1, firstId);
+        store.bind(2, lastId);
+        store.bind(3, completedFrom);
+        store.bind(4, completedTo);
+        store.bind(5, static_cast<int>(block.size()));
+        store.bind(6, static_cast<int64_t>(rawSize));
+        store.bind(7, data.data(), static_cast<int>(data.size()));
+        if (blockId) {
+            store.bind(8, blockId);
+        }
+        store.exec();
+        transaction.commit();
+        return static_cast<int>(block.size() - kept);
+    }
+
+    /**
+     * @brief Returns text with ASCII letters lowered, for case-insensitive matching.
+     */
+    string lowerAscii(string text)
+    {
+        for (char &c : text) {
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        return text;
+    }
+
+    /**
+     * @brief Returns the change-log sequence the file was last synced up to, or 0.
+     */
+    int64_t appliedSeq(SQLite::Database &db)
+    {
+        if (!db.tableExists("sync_state")) {
+            return 0; // Read-only files created before syncing existed
+        }
+        SQLite::Statement query(db, "SELECT value FROM sync_state WHERE name = 'appliedSeq'");
+        return query.executeStep() ? query.getColumn(0).getInt64() : 0;
+    }
+
+    /**
+     * @brief Translates a query into a WHERE condition over 'tasks', with its parameters.
+     *
+     * Only the predicates that are set are emitted, so SQLite can pick the
+     * primary key for ID ranges and the (done, completedTime) index for
+     * completed-before cleanups. The status alone is written as +done: done
+     * has two values, and SQLite would otherwise scan half the index rather
+     * than take an ID range.
+     */
+    string filterCondition(const TaskQuery &filter, std::vector<int64_t> &parameters)
+    {
+        string condition;
+        auto add = [&condition](const char *predicate) {
+            condition += condition.empty() ? predicate : string(" AND ") + predicate;
+        };
+        const bool completedBound = filter.completedFrom != std::numeric_limits<int64_t>::min() ||
+                                    filter.completedTo != std::numeric_limits<int64_t>::max();
+        if (filter.status == TaskQuery::Status::Done) {
+            add(completedBound ? "done = 1" : "+done = 1");
+        }
+        else if (filter.status == TaskQuery::Status::Pending) {
+            add(completedBound ? "done = 0" : "+done = 0");
+        }
+        if (filter.idFrom != std::numeric_limits<int>::min()) {
+            add("id >= ?");
+            parameters.push_back(filter.idFrom);
+        }
+        if (filter.idTo != std::numeric_limits<int>::max()) {
+            add("id < ?");
+            parameters.push_back(filter.idTo);
+        }
+        if (filter.createdFrom != std::numeric_limits<int64_t>::min()) {
+            add("createdTime >= ?");
+            parameters.push_back(filter.createdFrom);
+        }
+        if (filter.createdTo != std::numeric_limits<int64_t>::max()) {
+            add("createdTime < ?");
+            parameters.push_back(filter.createdTo);
+        }
+        if (filter.completedFrom != std::numeric_limits<int64_t>::min()) {
+            add("completedTime >= ?");
+            parameters.push_back(filter.completedFrom);
+        }
+        if (filter.completedTo != std::numeric_limits<int64_t>::max()) {
+            add("completedTime < ?");
+            parameters.push_back(filter.completedTo);
+        }
+        if (condition.empty()) {
+            condition = "1";
+        }
+        if (filter.limit != std::numeric_limits<size_t>::max()) {
+            condition = "id IN (SELECT id FROM tasks WHERE " + condition + " ORDER BY id LIMIT ?)";
+            parameters.push_back(static_cast<int64_t>(std::min<size_t>(filter.limit, std::numeric_limits<int64_t>::max())));
+        }
+        return condition;
+    }
+
+    /**
+     * @brief Reads a template from a row of (id, description, rule, nextTime, taskId).
+     */
+    Recurrence readRecurrence(SQLite::Statement &query)
+    {
+        Recurrence recurrence;
+        recurrence.id = query.getColumn(0).getInt();
+        recurrence.description = query.getColumn(1).getText();
+        parseRecurrenceRule(query.getColumn(2).getText(), recurrence.rule);
+        recurrence.nextTime = query.getColumn(3).getInt64();
+        recurrence.taskId = query.getColumn(4).getInt();
+        return recurrence;
+    }
+
+    /**
+     * @brief Returns the schema version of an existing file; files older than
+     * version tracking report the baseline.
+     */
+    int schemaVersion(SQLite::Database &db)
+    {
+        const int version = db.execAndGet("PRAGMA user_version").getInt();
+        return version == 0 ? BASELINE_SCHEMA_VERSION : version;
+    }
+
+    /**
+     * @brief Moves user_version past every consecutive completed migration.
+     *
+     * Must run inside the write transaction that completed a migration.
+     */
+    void advanceSchemaVersion(SQLite::Database &db)
+    {
+        int version = schemaVersion(db);
+        SQLite::Statement next(db, "SELECT done FROM schema_migrations WHERE version = ?");
+        for (;; ++version) {
+            next.reset();
+            next.bind(1, version + 1);
+            if (!next.executeStep() || next.getColumn(0).getInt() == 0) {
+                break;
+            }
+        }
+        next.reset();
+        db.exec("DELETE FROM schema_migrations WHERE version <= " + std::to_string(version));
+        db.exec("PRAGMA user_version = " + std::to_string(version));
+    }
+
+    /**
+     * @brief Backfills one migration chunk by chunk until it is complete or stop is set.
+     *
+     * Every chunk re-reads its starting point inside its own IMMEDIATE
+     * transaction and stores the new one before committing, so concurrent
+     * runs in several processes never repeat or skip rows.
+     *
+     * @return False if stop interrupted the backfill.
+     */
+    bool runBackfill(SQLite::Database &db, const Migration &migration, int chunkRows,
+                     const std::function<void(const MigrationProgress &)> &progress, const std::atomic<bool> &stop)
+    {
+        const string table = migration.backfillTable;
+        SQLite::Statement state(db, "SELECT lastId, rowsDone, done FROM schema_migrations WHERE version = ?");
+        state.bind(1, migration.version);
+        if (!state.executeStep() || state.getColumn(2).getInt() != 0) {
+            return true;
+        }
+        MigrationProgress report;
+        report.version = migration.version;
+        report.description = migration.description;
+        report.rowsDone = state.getColumn(1).getInt64();
+        const int64_t startId = state.getColumn(0).getInt64();
+        state.reset();
+        {
+            SQLite::Statement remaining(db, "SELECT COUNT(*) FROM " + table + " WHERE id > ?");
+            remaining.bind(1, startId);
+            remaining.executeStep();
+            report.rowsTotal = report.rowsDone + remaining.getColumn(0).getInt64();
+        }
+
+        SQLite::Statement bound(db, "SELECT id FROM " + table + " WHERE id > ? ORDER BY id LIMIT 1 OFFSET ?");
+        SQLite::Statement tail(db, "SELECT COUNT(*), COALESCE(MAX(id), ?1) FROM " + table + " WHERE id > ?1");
+        SQLite::Statement update(db, migration.backfill);
+        SQLite::Statement save(db, "UPDATE schema_migrations SET lastId = ?, rowsDone = ?, done = ? WHERE version = ?");
+        while (!report.finished) {
+            if (stop.load()) {
+                return false;
+            }
+            Trace::Scope span("Database::migrationChunk");
+            SQLite::Transaction transaction(db, SQLite::TransactionBehavior::IMMEDIATE);
+            state.reset();
+            if (!state.executeStep() || state.getColumn(2).getInt() != 0) {
+                return true; // Finished by another process
+            }
+            const int64_t lastId = state.getColumn(0).getInt64();
+            const int64_t rowsDone = state.getColumn(1).getInt64();
+            state.reset();
+
+            int64_t upper = 0, rows = chunkRows;
+            bound.reset();
+            bound.bind(1, lastId);
+            bound.bind(2, chunkRows - 1);
+            if (bound.executeStep()) {
+                upper = bound.getColumn(0).getInt64();
+            }
+            else {
+                tail.reset();
+                tail.bind(1, lastId);
+                tail.executeStep();
+                rows = tail.getColumn(0).getInt64();
+                upper = tail.getColumn(1).getInt64();
+                tail.reset();
+                report.finished = true;
+            }
+            bound.reset();
+
+            update.reset();
+            update.bind(1, lastId);
+            update.bind(2, upper);
+            update.exec();
+
+            report.rowsDone = rowsDone + rows;
+            report.rowsTotal = std::max(report.rowsTotal, report.rowsDone);
+            save.reset();
+            save.bind(1, upper);
+            save.bind(2, report.rowsDone);
+            save.bind(3, report.finished ? 1 : 0);
+            save.bind(4, migration.version);
+            save.exec();
+            if (report.finished) {
+                advanceSchemaVersion(db);
+            }
+            transaction.commit();
+            span.arg("rows", rows);
+            if (progress) {
+                progress(report);
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Builds a file: URI for a path, percent-encoding the characters URIs reserve.
+     */
+    string fileUri(const string &path, const string &query)
+    {
+        string uri = "file:";
+        for (char c : path) {
+            if (c == '%' || c == '?' || c == '#') {
+                static const char HEX[] = "0123456789ABCDEF";
+                uri += '%';
+                uri += HEX[static_cast<unsigned char>(c) >> 4];
+                uri += HEX[static_cast<unsigned char>(c) & 0xF];
+            }
+            else {
+                uri += c;
+            }
+        }
+        return uri + "?" + query;
+    }
+}
+
 /**
  * @brief Constructs a Database object and initializes the database asynchronously.
  *
  * @param dbFilename Filename of the SQLite database.
+ * @param mode How to open the file.
+ * @param busy Lock waits and retries for this connection and the ones it opens.
  */
-Database::Database(const string &dbFilename) : db(nullptr)
+Database::Database(const string &dbFilename, AccessMode mode, const BusyPolicy &busy) : db(nullptr), busyPolicy(busy)
 {
     // Constructor initializes the database asynchronously
-    initializeAsync(dbFilename).get(); // Wait for initialization to complete
+    initializeAsync(dbFilename, mode).get(); // Wait for initialization to complete
 }
 
 /**
@@ -33,16 +573,66 @@ Database::~Database()
 /**
  * @brief Asynchronous initialization of the database connection and creation of the 'tasks' table if it doesn't exist.
  *
+ * Read-only modes never create or alter anything. They set a large
+ * mmap_size so reads are served straight from the page cache instead of
+ * being copied through the pager, and query_only as a second guard against
+ * writes. ReadOnly connections wait out a writer's commit rather than
+ * failing. Immutable mode first copies the file with VACUUM INTO, which reads
+ * one consistent transaction, so immutable=1 is safe on the copy.
+ *
  * @param dbFilename Filename of the SQLite database.
+ * @param mode How to open the file.
  * @return Future object for the initialization task.
  */
-future<void> Database::initializeAsync(const string &dbFilename)
+future<void> Database::initializeAsync(const string &dbFilename, AccessMode mode)
 {
-    return async(launch::async, [this, dbFilename]()
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, dbFilename, mode, enqueued]()
                  {
+        TRACE_ASYNC_SCOPE("Database::initializeAsync", enqueued);
         try {
-            db = new SQLite::Database(dbFilename, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
-            db->exec("CREATE TABLE IF NOT EXISTS tasks (id INTEGER PRIMARY KEY, description TEXT, done INTEGER, createdTime INTEGER, completedTime INTEGER)");
+            accessMode = mode;
+            if (mode == AccessMode::Immutable) {
+                SQLite::Database source(dbFilename, SQLite::OPEN_READONLY);
+                snapshotPath = (std::filesystem::temp_directory_path() /
+                                ("todolist-snapshot-" + std::to_string(std::random_device{}()) + ".db")).string();
+                SQLite::Statement copy(source, "VACUUM INTO ?");
+                copy.bind(1, snapshotPath);
+                copy.exec();
+                db = new SQLite::Database(fileUri(snapshotPath, "immutable=1"), SQLite::OPEN_READONLY | SQLite::OPEN_URI);
+            }
+            else if (mode == AccessMode::ReadOnly) {
+                db = new SQLite::Database(dbFilename, SQLite::OPEN_READONLY, timeoutMs(busyPolicy));
+            }
+            if (mode != AccessMode::ReadWrite) {
+                db->exec("PRAGMA mmap_size = " + std::to_string(READONLY_MMAP_SIZE));
+                db->exec("PRAGMA query_only = 1");
+                if (db->execAndGet("SELECT COUNT(*) FROM pragma_table_info('tasks') WHERE name = 'dueTime'").getInt() == 0) {
+                    dueColumn = "0"; // Written before due times existed
+                }
+                return;
+            }
+
+            filename = dbFilename;
+            db = new SQLite::Database(dbFilename, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE, timeoutMs(busyPolicy));
+            // Processes starting together race to create the schema; every step is idempotent
+            retryBusy(busyPolicy, busyRetries, [this] {
+                const bool existing = db->tableExists("tasks");
+
+                // Freed pages are returned to the OS by the maintenance thread instead of lingering.
+                // Older files keep their free pages for reuse until enableIncrementalVacuumAsync converts them.
+                if (!existing) {
+                    db->exec("PRAGMA auto_vacuum = INCREMENTAL");
+                }
+
+                createSchema();
+                if (existing) {
+                    applyMigrationSchemas();
+                }
+                else {
+                    db->exec("PRAGMA user_version = " + std::to_string(latestSchemaVersion()));
+                }
+            });
         }
         catch (const SQLite::Exception &e) {
             std::cerr << "SQLite error (constructor): " << e.what() << std::endl;
@@ -50,17 +640,258 @@ future<void> Database::initializeAsync(const string &dbFilename)
         } });
 }
 
+/**
+ * @brief Creates the 'tasks' table and its change-log triggers if they don't exist.
+ *
+ * Creates the latest schema; existing files are brought up to it by
+ * applyMigrationSchemas and migrateAsync. Must run on a thread that owns the
+ * connection for the duration of the call.
+ */
+void Database::createSchema()
+{
+    db->exec("CREATE TABLE IF NOT EXISTS tasks (id INTEGER PRIMARY KEY, description TEXT, done INTEGER, createdTime INTEGER, completedTime INTEGER, updatedTime INTEGER, dueTime INTEGER)");
+
+    // Change log filled by triggers so every process sharing the file can fetch deltas
+    db->exec("CREATE INDEX IF NOT EXISTS tasks_done_completed ON tasks (done, completedTime)"); // Bulk cleanups by filter
+
+    db->exec("CREATE TABLE IF NOT EXISTS task_changes (seq INTEGER PRIMARY KEY AUTOINCREMENT, taskId INTEGER NOT NULL, op TEXT NOT NULL)");
+    db->exec("CREATE TRIGGER IF NOT EXISTS task_changes_insert AFTER INSERT ON tasks BEGIN "
+             "INSERT INTO task_changes (taskId, op) VALUES (NEW.id, 'I'); END");
+    db->exec("CREATE TRIGGER IF NOT EXISTS task_changes_update AFTER UPDATE OF description, done, createdTime, completedTime, dueTime ON tasks BEGIN "
+             "INSERT INTO task_changes (taskId, op) VALUES (NEW.id, 'U'); END");
+    db->exec("CREATE TRIGGER IF NOT EXISTS task_changes_delete AFTER DELETE ON tasks BEGIN "
+             "INSERT INTO task_changes (taskId, op) VALUES (OLD.id, 'D'); END");
+
+    // Tags: (tagId, taskId) is the primary key so per-tag lookups are index range scans
+    db->exec("CREATE TABLE IF NOT EXISTS tags (id INTEGER PRIMARY KEY, name TEXT NOT NULL UNIQUE)");
+    db->exec("CREATE TABLE IF NOT EXISTS task_tags (tagId INTEGER NOT NULL, taskId INTEGER NOT NULL, PRIMARY KEY (tagId, taskId)) WITHOUT ROWID");
+    db->exec("CREATE INDEX IF NOT EXISTS task_tags_task ON task_tags (taskId)");
+    db->exec("CREATE TRIGGER IF NOT EXISTS task_tags_cleanup AFTER DELETE ON tasks BEGIN "
+             "DELETE FROM task_tags WHERE taskId = OLD.id; END");
+    db->exec("CREATE TRIGGER IF NOT EXISTS task_changes_tag AFTER INSERT ON task_tags BEGIN "
+             "INSERT INTO task_changes (taskId, op) VALUES (NEW.taskId, 'T'); END");
+    db->exec("CREATE TRIGGER IF NOT EXISTS task_changes_untag AFTER DELETE ON task_tags BEGIN "
+             "INSERT INTO task_changes (taskId, op) VALUES (OLD.taskId, 'T'); END");
+
+    // Dependencies: taskId cannot start before dependsOn is done. Edge changes log an 'E' entry for
+    // the waiting task, so deltas carry its current prerequisites the way 'T' entries carry tags
+    db->exec("CREATE TABLE IF NOT EXISTS task_deps (taskId INTEGER NOT NULL, dependsOn INTEGER NOT NULL, "
+             "PRIMARY KEY (taskId, dependsOn)) WITHOUT ROWID");
+    db->exec("CREATE INDEX IF NOT EXISTS task_deps_prerequisite ON task_deps (dependsOn)");
+    db->exec("CREATE TRIGGER IF NOT EXISTS task_deps_cleanup AFTER DELETE ON tasks BEGIN "
+             "DELETE FROM task_deps WHERE taskId = OLD.id OR dependsOn = OLD.id; END");
+    db->exec("CREATE TRIGGER IF NOT EXISTS task_changes_depend AFTER INSERT ON task_deps BEGIN "
+             "INSERT INTO task_changes (taskId, op) VALUES (NEW.taskId, 'E'); END");
+    db->exec("CREATE TRIGGER IF NOT EXISTS task_changes_undepend AFTER DELETE ON task_deps BEGIN "
+             "INSERT INTO task_changes (taskId, op) VALUES (OLD.taskId, 'E'); END");
+
+    // Recurring task templates; taskId is the open task made from the template, released when it is done or deleted
+    db->exec("CREATE TABLE IF NOT EXISTS recurrences (id INTEGER PRIMARY KEY, description TEXT NOT NULL, rule TEXT NOT NULL, "
+             "nextTime INTEGER NOT NULL, taskId INTEGER)");
+    db->exec("CREATE INDEX IF NOT EXISTS recurrences_task ON recurrences (taskId)");
+    db->exec("CREATE TRIGGER IF NOT EXISTS recurrences_release_done AFTER UPDATE OF done ON tasks WHEN NEW.done = 1 BEGIN "
+             "UPDATE recurrences SET taskId = NULL WHERE taskId = NEW.id; END");
+    db->exec("CREATE TRIGGER IF NOT EXISTS recurrences_release_delete AFTER DELETE ON tasks BEGIN "
+             "UPDATE recurrences SET taskId = NULL WHERE taskId = OLD.id; END");
+
+    // Bookkeeping of delta syncs, such as the primary's sequence a replica has applied
+    db->exec("CREATE TABLE IF NOT EXISTS sync_state (name TEXT PRIMARY KEY, value INTEGER NOT NULL)");
+
+    // Old completed tasks, moved out of 'tasks' in zlib-compressed blocks; see Archive.h
+    db->exec("CREATE TABLE IF NOT EXISTS archive_blocks (id INTEGER PRIMARY KEY, firstId INTEGER NOT NULL, lastId INTEGER NOT NULL, "
+             "completedFrom INTEGER NOT NULL, completedTo INTEGER NOT NULL, taskCount INTEGER NOT NULL, "
+             "rawSize INTEGER NOT NULL, data BLOB NOT NULL)");
+
+    // Task tables of clears that can still be undone, renamed with the prefix undo_<id>_
+    db->exec("CREATE TABLE IF NOT EXISTS undo_stashes (id INTEGER PRIMARY KEY AUTOINCREMENT, createdTime INTEGER NOT NULL)");
+}
+
+/**
+ * @brief Replaces the task tables with empty ones and logs a single 'C' entry.
+ *
+ * A plain DELETE would fire the change-log triggers once per row, which
+ * also disables SQLite's truncate optimization. Dropping and recreating the
+ * tables only frees their pages, and the 'C' entry tells other caches to
+ * reload. Must run inside a write transaction.
+ */
+void Database::clearTables()
+{
+    db->exec("DROP TABLE IF EXISTS tasks"); // Also drops the change-log triggers
+    db->exec("DROP TABLE IF EXISTS task_tags"); // Dropping skips the per-row untag trigger
+    db->exec("DROP TABLE IF EXISTS task_deps");
+    db->exec("DELETE FROM task_changes");   // Nothing before the clear is relevant any more
+    db->exec("DELETE FROM recurrences");
+    db->exec("DELETE FROM archive_blocks");
+    createSchema();
+    db->exec("INSERT INTO task_changes (taskId, op) VALUES (0, 'C')");
+}
+
+/**
+ * @brief Renames the task tables, adding or removing a prefix.
+ *
+ * Renaming only rewrites the schema, whatever the size of the tables.
+ * Trigger and index names are schema-wide, and both would travel with their
+ * table, so those of the tables being renamed are dropped first; createSchema
+ * recreates them for the live tables. A stash therefore holds only rows, and
+ * restoring it rebuilds its indexes. Must run inside a write transaction.
+ *
+ * @param fromPrefix Prefix of the tables to rename; empty for the live tables.
+ * @param toPrefix Prefix they get; empty to make them live.
+ */
+void Database::renameTaskTables(const string &fromPrefix, const string &toPrefix)
+{
+    string tables;
+    for (const char *table : STASHED_TABLES) {
+        tables += (tables.empty() ? "'" : ", '") + fromPrefix + table + "'";
+    }
+    std::vector<std::pair<string, string>> objects; // (type, name)
+    // Indexes without SQL back a PRIMARY KEY or UNIQUE constraint and cannot be dropped
+    SQLite::Statement query(*db, "SELECT type, name FROM sqlite_master WHERE type IN ('trigger', 'index') "
+                                 "AND sql IS NOT NULL AND tbl_name IN (" + tables + ")");
+    while (query.executeStep()) {
+        objects.emplace_back(query.getColumn(0).getText(), query.getColumn(1).getText());
+    }
+    query.reset();
+    for (const auto &object : objects) {
+        db->exec((object.first == "index" ? "DROP INDEX \"" : "DROP TRIGGER \"") + object.second + "\"");
+    }
+    for (const char *table : STASHED_TABLES) {
+        db->exec("ALTER TABLE " + fromPrefix + table + " RENAME TO " + toPrefix + table);
+    }
+}
+
+/**
+ * @brief Drops the tables of a stash and forgets it.
+ *
+ * Must run inside a write transaction, which also keeps readers off the
+ * connection: SQLite refuses to drop a table while a statement is reading.
+ *
+ * @param stash ID returned by stashAllDataAsync.
+ */
+void Database::dropStash(int stash)
+{
+    for (const char *table : STASHED_TABLES) {
+        db->exec("DROP TABLE IF EXISTS " + stashPrefix(stash) + table);
+    }
+    db->exec("DELETE FROM undo_stashes WHERE id = " + std::to_string(stash));
+}
+
+/**
+ * @brief Applies the schema statements of the migrations newer than the file.
+ *
+ * Each migration's statements run in one IMMEDIATE transaction together with
+ * its schema_migrations row, so a process opening the file concurrently sees
+ * either none or all of them. Migrations without a backfill complete here;
+ * the others are left for migrateAsync.
+ */
+void Database::applyMigrationSchemas()
+{
+    db->exec("CREATE TABLE IF NOT EXISTS schema_migrations (version INTEGER PRIMARY KEY, "
+             "lastId INTEGER NOT NULL DEFAULT 0, rowsDone INTEGER NOT NULL DEFAULT 0, done INTEGER NOT NULL DEFAULT 0)");
+    for (const Migration &migration : migrations()) {
+        SQLite::Transaction transaction(*db, SQLite::TransactionBehavior::IMMEDIATE);
+        SQLite::Statement applied(*db, "SELECT COUNT(*) FROM schema_migrations WHERE version = ?");
+        applied.bind(1, migration.version);
+        applied.executeStep();
+        if (migration.version <= schemaVersion(*db) || applied.getColumn(0).getInt() > 0) {
+            continue;
+        }
+        applied.reset();
+        for (const char *statement : migration.schema) {
+            db->exec(statement);
+        }
+        SQLite::Statement record(*db, "INSERT INTO schema_migrations (version, done) VALUES (?, ?)");
+        record.bind(1, migration.version);
+        record.bind(2, migration.backfill ? 0 : 1);
+        record.exec();
+        advanceSchemaVersion(*db);
+        transaction.commit();
+    }
+}
+
+/**
+ * @brief Runs body inside a BEGIN IMMEDIATE transaction and commits it.
+ *
+ * BEGIN IMMEDIATE takes the write lock before anything is read, so the
+ * transaction never asks to upgrade a read lock: SQLite fails such an
+ * upgrade at once when another connection also waits to write, since
+ * waiting could deadlock. A BEGIN that found the file locked did nothing
+ * and a COMMIT that found it locked left the transaction open, so both are
+ * retried as they are; body itself runs once, since it may consume input.
+ * The connection is shared by every thread, so connectionMutex, held
+ * exclusively, keeps a second writer from issuing BEGIN inside the first
+ * one's transaction and keeps readers out until it ends.
+ *
+ * @param body Statements of the transaction.
+ * @return Whatever body returns.
+ */
+template <typename Body>
+auto Database::writeTransaction(Body &&body) -> decltype(body())
+{
+    std::unique_lock<std::shared_mutex> lock(connectionMutex);
+    retryBusy(busyPolicy, busyRetries, [this] { db->exec("BEGIN IMMEDIATE"); });
+    try {
+        if constexpr (std::is_void_v<decltype(body())>) {
+            body();
+            retryBusy(busyPolicy, busyRetries, [this] { db->exec("COMMIT"); });
+        }
+        else {
+            auto result = body();
+            retryBusy(busyPolicy, busyRetries, [this] { db->exec("COMMIT"); });
+            return result;
+        }
+    }
+    catch (...) {
+        try {
+            db->exec("ROLLBACK");
+        }
+        catch (const SQLite::Exception &) {
+            // SQLite already rolled back, e.g. after an I/O error
+        }
+        throw;
+    }
+}
+
+/**
+ * @brief Takes connectionMutex shared, for statements that only read db.
+ *
+ * @return Lock to hold until the read's statements are finished.
+ */
+std::shared_lock<std::shared_mutex> Database::readLock() const
+{
+    return std::shared_lock<std::shared_mutex>(connectionMutex);
+}
+
 /**
  * @brief Asynchronous destruction of the database connection.
  *
+ * Stops the maintenance thread first so it never touches a closed connection.
+ *
  * @return Future object for the finalization task.
  */
 future<void> Database::finalizeAsync()
 {
-    return async(launch::async, [this]()
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, enqueued]()
                  {
+        TRACE_ASYNC_SCOPE("Database::finalizeAsync", enqueued);
         try {
+            stopMaintenance();
+            stopBackups();
+            stopArchiving();
+            stopMigrations();
+            std::lock_guard<std::mutex> migrationLock(migrationMutex);
+            std::unique_lock<std::shared_mutex> connectionLock(connectionMutex);
+            {
+                std::lock_guard<std::mutex> filterLock(filterMutex);
+                filterStatements.clear(); // Statements must be finalized before their connection closes
+            }
             delete db;
+            db = nullptr;
+            if (!snapshotPath.empty()) {
+                std::error_code ignored;
+                std::filesystem::remove(snapshotPath, ignored);
+            }
         }
         catch (const SQLite::Exception &e) {
             std::cerr << "SQLite error (destructor): " << e.what() << std::endl;
@@ -72,18 +903,27 @@ future<void> Database::finalizeAsync()
  * @brief Asynchronous addition of a task to the 'tasks' table.
  *
  * @param description Description of the task to be added.
- * @return Future object for the add task operation.
+ * @return Future object containing the ID of the new task.
  */
-future<void> Database::addTaskAsync(const string &description)
+future<int> Database::addTaskAsync(const string &description)
 {
-    return async(launch::async, [this, description]()
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, description, enqueued]() -> int
                  {
+        TRACE_ASYNC_SCOPE("Database::addTaskAsync", enqueued);
         try {
-            time_t now = std::time(nullptr);
-            SQLite::Statement query(*db, "INSERT INTO tasks (description, done, createdTime, completedTime) VALUES (?, 0, ?, 0)");
-            query.bind(1, description);
-            query.bind(2, static_cast<int>(now));
-            query.exec();
+            return writeTransaction([&] {
+                time_t now = std::time(nullptr);
+                // RETURNING rather than the last insert rowid, which other threads on the connection can move
+                SQLite::Statement query(*db, "INSERT INTO tasks (description, done, createdTime, completedTime, updatedTime) VALUES (?1, 0, ?2, 0, ?2) "
+                                             "RETURNING id");
+                query.bind(1, description);
+                query.bind(2, static_cast<int>(now));
+                query.executeStep();
+                const int id = query.getColumn(0).getInt();
+                query.executeStep(); // Completes the statement
+                return id;
+            });
         }
         catch (const SQLite::Exception &e) {
             std::cerr << "SQLite error (addTask): " << e.what() << std::endl;
@@ -98,19 +938,37 @@ future<void> Database::addTaskAsync(const string &description)
  */
 future<std::vector<Task>> Database::getTasksAsync() const
 {
-    return async(launch::async, [this]() -> std::vector<Task>
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, enqueued]() -> std::vector<Task>
                  {
+        Trace::Scope span("Database::getTasksAsync", enqueued);
         std::vector<Task> tasks;
         try {
-            SQLite::Statement query(*db, "SELECT id, description, done, createdTime, completedTime FROM tasks");
-            while (query.executeStep()) {
+            auto reading = readLock();
+            SQLite::Statement query(*db, "SELECT id, description, done, createdTime, completedTime, " + dueColumn + " FROM tasks ORDER BY id");
+            // Split the time between SQLite stepping and Task construction, only while tracing
+            const bool timed = Trace::enabled();
+            int64_t stepTime = 0, buildTime = 0;
+            for (;;) {
+                const int64_t stepStart = timed ? Trace::now() : 0;
+                const bool row = query.executeStep();
+                const int64_t stepEnd = timed ? Trace::now() : 0;
+                stepTime += stepEnd - stepStart;
+                if (!row) {
+                    break;
+                }
                 tasks.emplace_back(
                     query.getColumn(0).getInt(),
                     query.getColumn(1).getText(),
                     query.getColumn(2).getInt() == 1,
                     static_cast<time_t>(query.getColumn(3).getInt64()),
                     static_cast<time_t>(query.getColumn(4).getInt64()));
+                tasks.back().setDueTime(static_cast<time_t>(query.getColumn(5).getInt64()));
+                buildTime += timed ? Trace::now() - stepEnd : 0;
             }
+            span.arg("rows", static_cast<int64_t>(tasks.size()));
+            span.arg("stepUs", stepTime);
+            span.arg("buildUs", buildTime);
         }
         catch (const SQLite::Exception &e) {
             std::cerr << "SQLite error (getTasks): " << e.what() << std::endl;
@@ -127,14 +985,18 @@ future<std::vector<Task>> Database::getTasksAsync() const
  */
 future<void> Database::markTaskDoneAsync(int id)
 {
-    return async(launch::async, [this, id]()
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, id, enqueued]()
                  {
+        TRACE_ASYNC_SCOPE("Database::markTaskDoneAsync", enqueued);
         try {
-            time_t now = std::time(nullptr);
-            SQLite::Statement query(*db, "UPDATE tasks SET done = 1, completedTime = ? WHERE id = ?");
-            query.bind(1, static_cast<int>(now));
-            query.bind(2, id);
-            query.exec();
+            writeTransaction([&] {
+                time_t now = std::time(nullptr);
+                SQLite::Statement query(*db, "UPDATE tasks SET done = 1, completedTime = ?1, updatedTime = ?1 WHERE id = ?2");
+                query.bind(1, static_cast<int>(now));
+                query.bind(2, id);
+                query.exec();
+            });
         }
         catch (const SQLite::Exception &e) {
             std::cerr << "SQLite error (markTaskDone): " << e.what() << std::endl;
@@ -150,12 +1012,16 @@ future<void> Database::markTaskDoneAsync(int id)
  */
 future<void> Database::deleteTaskAsync(int id)
 {
-    return async(launch::async, [this, id]()
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, id, enqueued]()
                  {
+        TRACE_ASYNC_SCOPE("Database::deleteTaskAsync", enqueued);
         try {
-            SQLite::Statement query(*db, "DELETE FROM tasks WHERE id = ?");
-            query.bind(1, id);
-            query.exec();
+            writeTransaction([&] {
+                SQLite::Statement query(*db, "DELETE FROM tasks WHERE id = ?");
+                query.bind(1, id);
+                query.exec();
+            });
         }
         catch (const SQLite::Exception &e) {
             std::cerr << "SQLite error (deleteTask): " << e.what() << std::endl;
@@ -163,22 +1029,1764 @@ future<void> Database::deleteTaskAsync(int id)
         } });
 }
 
+/**
+ * @brief Asynchronous deletion of every task matching a filter.
+ *
+ * One DELETE replaces a round trip per task. The change-log triggers still
+ * record each row, and the caller fetches them with one delta.
+ *
+ * @param filter Tasks to delete.
+ * @return Future object containing the number of tasks deleted.
+ */
+future<int> Database::deleteWhereAsync(const TaskQuery &filter)
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, filter, enqueued]() -> int
+                 {
+        TRACE_ASYNC_SCOPE("Database::deleteWhereAsync", enqueued);
+        try {
+            return writeTransaction([&] {
+                std::vector<int64_t> parameters;
+                SQLite::Statement query(*db, "DELETE FROM tasks WHERE " + filterCondition(filter, parameters));
+                for (size_t i = 0; i < parameters.size(); ++i) {
+                    query.bind(static_cast<int>(i) + 1, parameters[i]);
+                }
+                return query.exec();
+            });
+        }
+        catch (const SQLite::Exception &e) {
+            std::cerr << "SQLite error (deleteWhere): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Asynchronous completion of every pending task matching a filter.
+ *
+ * @param filter Tasks to complete.
+ * @return Future object containing the number of tasks marked done.
+ */
+future<int> Database::markDoneWhereAsync(const TaskQuery &filter)
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, filter, enqueued]() -> int
+                 {
+        TRACE_ASYNC_SCOPE("Database::markDoneWhereAsync", enqueued);
+        try {
+            return writeTransaction([&] {
+                std::vector<int64_t> parameters{static_cast<int64_t>(std::time(nullptr))};
+                SQLite::Statement query(*db, "UPDATE tasks SET done = 1, completedTime = ?1, updatedTime = ?1 WHERE done = 0 AND " +
+                                                 filterCondition(filter, parameters));
+                for (size_t i = 0; i < parameters.size(); ++i) {
+                    query.bind(static_cast<int>(i) + 1, parameters[i]);
+                }
+                return query.exec();
+            });
+        }
+        catch (const SQLite::Exception &e) {
+            std::cerr << "SQLite error (markDoneWhere): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Asynchronous retrieval of the tasks matching a filter.
+ *
+ * @param filter Tasks to return.
+ * @return Future object containing the tasks in ascending ID order.
+ */
+future<std::vector<Task>> Database::getTasksWhereAsync(const TaskQuery &filter) const
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, filter, enqueued]() -> std::vector<Task>
+                 {
+        Trace::Scope span("Database::getTasksWhereAsync", enqueued);
+        std::vector<Task> tasks;
+        try {
+            auto reading = readLock();
+            std::vector<int64_t> parameters;
+            SQLite::Statement query(*db, "SELECT id, description, done, createdTime, completedTime, " + dueColumn + " FROM tasks WHERE " +
+                                             filterCondition(filter, parameters) + " ORDER BY id");
+            for (size_t i = 0; i < parameters.size(); ++i) {
+                query.bind(static_cast<int>(i) + 1, parameters[i]);
+            }
+            while (query.executeStep()) {
+                tasks.emplace_back(
+                    query.getColumn(0).getInt(),
+                    query.getColumn(1).getText(),
+                    query.getColumn(2).getInt() == 1,
+                    static_cast<time_t>(query.getColumn(3).getInt64()),
+                    static_cast<time_t>(query.getColumn(4).getInt64()));
+                tasks.back().setDueTime(static_cast<time_t>(query.getColumn(5).getInt64()));
+            }
+            span.arg("rows", static_cast<int64_t>(tasks.size()));
+        }
+        catch (const SQLite::Exception &e) {
+            std::cerr << "SQLite error (getTasksWhere): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        }
+        return tasks; });
+}
+
+/**
+ * @brief Asynchronous count of the tasks matching a filter.
+ *
+ * @param filter Tasks to count.
+ * @return Future object containing the number of matching tasks.
+ */
+future<size_t> Database::countWhereAsync(const TaskQuery &filter) const
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, filter, enqueued]() -> size_t
+                 {
+        TRACE_ASYNC_SCOPE("Database::countWhereAsync", enqueued);
+        try {
+            auto reading = readLock();
+            std::vector<int64_t> parameters;
+            SQLite::Statement query(*db, "SELECT COUNT(*) FROM tasks WHERE " + filterCondition(filter, parameters));
+            for (size_t i = 0; i < parameters.size(); ++i) {
+                query.bind(static_cast<int>(i) + 1, parameters[i]);
+            }
+            query.executeStep();
+            return static_cast<size_t>(query.getColumn(0).getInt64());
+        }
+        catch (const SQLite::Exception &e) {
+            std::cerr << "SQLite error (countWhere): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Asynchronous retrieval of the tasks matching a filter expression.
+ *
+ * Expressions that compile to the same condition share one prepared
+ * statement, which is reset and rebound on every use. SQLite prepares it
+ * again by itself if the schema changed meanwhile, e.g. after a clear.
+ *
+ * @param expression Filter expression.
+ * @return Future object containing the tasks in ascending ID order.
+ */
+future<std::vector<Task>> Database::getTasksMatchingAsync(const string &expression) const
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, expression, enqueued]() -> std::vector<Task>
+                 {
+        Trace::Scope span("Database::getTasksMatchingAsync", enqueued);
+        const CompiledFilter filter = compileFilter(expression); // Throws std::invalid_argument
+        std::vector<Task> tasks;
+        try {
+            auto reading = readLock();
+            std::lock_guard<std::mutex> lock(filterMutex);
+            auto it = filterStatements.find(filter.condition);
+            span.arg("cached", it != filterStatements.end() ? 1 : 0);
+            if (it == filterStatements.end()) {
+                if (filterStatements.size() >= FILTER_STATEMENTS) {
+                    filterStatements.clear();
+                }
+                auto statement = std::make_unique<SQLite::Statement>(
+                    *db, "SELECT id, description, done, createdTime, completedTime, " + dueColumn + " FROM tasks WHERE " +
+                             filter.condition + " ORDER BY id");
+                it = filterStatements.emplace(filter.condition, std::move(statement)).first;
+            }
+            SQLite::Statement &query = *it->second;
+            query.reset();
+            query.clearBindings();
+            for (size_t i = 0; i < filter.parameters.size(); ++i) {
+                if (const int64_t *number = std::get_if<int64_t>(&filter.parameters[i])) {
+                    query.bind(static_cast<int>(i) + 1, *number);
+                }
+                else {
+                    query.bind(static_cast<int>(i) + 1, std::get<string>(filter.parameters[i]));
+                }
+            }
+            while (query.executeStep()) {
+                tasks.emplace_back(
+                    query.getColumn(0).getInt(),
+                    query.getColumn(1).getText(),
+                    query.getColumn(2).getInt() == 1,
+                    static_cast<time_t>(query.getColumn(3).getInt64()),
+                    static_cast<time_t>(query.getColumn(4).getInt64()));
+                tasks.back().setDueTime(static_cast<time_t>(query.getColumn(5).getInt64()));
+            }
+            query.reset(); // A statement left running would block the drops of a later clear
+            span.arg("rows", static_cast<int64_t>(tasks.size()));
+        }
+        catch (const SQLite::Exception &e) {
+            std::cerr << "SQLite error (getTasksMatching): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        }
+        return tasks; });
+}
+
 /**
  * @brief Asynchronous clearing of all tasks from the 'tasks' table.
  *
+ * The freed pages are reclaimed later by the maintenance thread.
+ *
  * @return Future object for the clear all data operation.
  */
 future<void> Database::clearAllDataAsync()
 {
-    return async(launch::async, [this]()
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, enqueued]()
                  {
+        TRACE_ASYNC_SCOPE("Database::clearAllDataAsync", enqueued);
         try {
-            SQLite::Transaction transaction(*db);
-            db->exec("DELETE FROM tasks"); // Delete all rows from 'tasks' table
-            transaction.commit(); // Commit the transaction
+            writeTransaction([&] {
+                clearTables();
+            });
         }
         catch (const SQLite::Exception &e) {
             std::cerr << "SQLite error (clearAllData): " << e.what() << std::endl;
             throw; // Rethrow the exception to propagate it further
         } });
 }
+
+/**
+ * @brief Asynchronous deletion of the tasks matching a filter, keeping what was deleted.
+ *
+ * The tasks, their tags and their dependency edges are read and the tasks
+ * deleted in one IMMEDIATE transaction, so the records match what was
+ * removed. The cleanup triggers then remove the tags and edges.
+ *
+ * @param filter Tasks to delete.
+ * @return Future object containing the deleted tasks in ascending ID order.
+ */
+future<std::vector<TaskRecord>> Database::takeTasksAsync(const TaskQuery &filter)
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, filter, enqueued]() -> std::vector<TaskRecord>
+                 {
+        TRACE_ASYNC_SCOPE("Database::takeTasksAsync", enqueued);
+        std::vector<TaskRecord> records;
+        try {
+            writeTransaction([&] {
+                std::vector<int64_t> parameters;
+                const string condition = filterCondition(filter, parameters);
+                const string taken = "(SELECT id FROM tasks WHERE " + condition + ")";
+                auto prepare = [this, &parameters](const string &sql, int copies) {
+                    SQLite::Statement statement(*db, sql);
+                    int index = 1;
+                    for (int copy = 0; copy < copies; ++copy) {
+                        for (int64_t parameter : parameters) {
+                            statement.bind(index++, parameter);
+                        }
+                    }
+                    return statement;
+                };
+
+                SQLite::Statement tasks = prepare("SELECT id, description, done, createdTime, completedTime, dueTime FROM tasks WHERE " +
+                                                  condition + " ORDER BY id", 1);
+                std::unordered_map<int, size_t> positions;
+                while (tasks.executeStep()) {
+                    Task task(tasks.getColumn(0).getInt(), tasks.getColumn(1).getText(), tasks.getColumn(2).getInt() == 1,
+                              static_cast<time_t>(tasks.getColumn(3).getInt64()), static_cast<time_t>(tasks.getColumn(4).getInt64()));
+                    task.setDueTime(static_cast<time_t>(tasks.getColumn(5).getInt64()));
+                    positions.emplace(task.getId(), records.size());
+                    records.push_back(TaskRecord{std::move(task), {}, {}});
+                }
+                if (records.empty()) {
+                    return;
+                }
+
+                SQLite::Statement tags = prepare("SELECT tt.taskId, g.name FROM task_tags tt JOIN tags g ON g.id = tt.tagId "
+                                                 "WHERE tt.taskId IN " + taken, 1);
+                while (tags.executeStep()) {
+                    records[positions.at(tags.getColumn(0).getInt())].tags.push_back(tags.getColumn(1).getText());
+                }
+                // An edge between two taken tasks is kept once, with the task that waits
+                SQLite::Statement edges = prepare("SELECT taskId, dependsOn FROM task_deps WHERE taskId IN " + taken +
+                                                  " OR dependsOn IN " + taken, 2);
+                while (edges.executeStep()) {
+                    const std::pair<int, int> edge(edges.getColumn(0).getInt(), edges.getColumn(1).getInt());
+                    auto owner = positions.find(edge.first);
+                    records[owner != positions.end() ? owner->second : positions.at(edge.second)].dependencies.push_back(edge);
+                }
+
+                prepare("DELETE FROM tasks WHERE " + condition, 1).exec();
+            });
+        }
+        catch (const SQLite::Exception &e) {
+            std::cerr << "SQLite error (takeTasks): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        }
+        return records; });
+}
+
+/**
+ * @brief Asynchronous restore of tasks returned by takeTasksAsync.
+ *
+ * Tasks keep their IDs, so references to them held elsewhere stay valid.
+ * Dependency edges are restored once both of their tasks exist again.
+ *
+ * @param records Tasks to restore; must outlive the future.
+ * @return Future object for the restore operation.
+ */
+future<void> Database::restoreTasksAsync(const std::vector<TaskRecord> &records)
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, &records, enqueued]()
+                 {
+        TRACE_ASYNC_SCOPE("Database::restoreTasksAsync", enqueued);
+        try {
+            writeTransaction([&] {
+                SQLite::Statement exists(*db, "SELECT COUNT(*) FROM tasks WHERE id = ?");
+                SQLite::Statement insert(*db, "INSERT INTO tasks (id, description, done, createdTime, completedTime, updatedTime, dueTime) "
+                                              "VALUES (?, ?, ?, ?, ?, ?, NULLIF(?, 0))");
+                SQLite::Statement insertTag(*db, "INSERT OR IGNORE INTO tags (name) VALUES (?)");
+                SQLite::Statement link(*db, "INSERT OR IGNORE INTO task_tags (tagId, taskId) SELECT id, ? FROM tags WHERE name = ?");
+                const int64_t now = std::time(nullptr);
+                for (const TaskRecord &record : records) {
+                    const Task &task = record.task;
+                    exists.bind(1, task.getId());
+                    exists.executeStep();
+                    if (exists.getColumn(0).getInt() > 0) {
+                        throw std::invalid_argument("task " + std::to_string(task.getId()) + " already exists");
+                    }
+                    exists.reset();
+                    insert.bind(1, task.getId());
+                    insert.bind(2, task.getDescription());
+                    insert.bind(3, task.isDone() ? 1 : 0);
+                    insert.bind(4, static_cast<int64_t>(task.getCreatedTime()));
+                    insert.bind(5, static_cast<int64_t>(task.getCompletedTime()));
+                    insert.bind(6, now);
+                    insert.bind(7, static_cast<int64_t>(task.getDueTime()));
+                    insert.exec();
+                    insert.reset();
+                    for (const string &tag : record.tags) {
+                        insertTag.bind(1, tag);
+                        insertTag.exec();
+                        insertTag.reset();
+                        link.bind(1, task.getId());
+                        link.bind(2, tag);
+                        link.exec();
+                        link.reset();
+                    }
+                }
+                SQLite::Statement depend(*db, "INSERT OR IGNORE INTO task_deps (taskId, dependsOn) SELECT ?1, ?2 "
+                                              "WHERE EXISTS (SELECT 1 FROM tasks WHERE id = ?1) AND EXISTS (SELECT 1 FROM tasks WHERE id = ?2)");
+                for (const TaskRecord &record : records) {
+                    for (const auto &edge : record.dependencies) {
+                        depend.bind(1, edge.first);
+                        depend.bind(2, edge.second);
+                        depend.exec();
+                        depend.reset();
+                    }
+                }
+            });
+        }
+        catch (const SQLite::Exception &e) {
+            std::cerr << "SQLite error (restoreTasks): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Asynchronous marking of a task as not done.
+ *
+ * @param id ID of the task.
+ * @return Future object for the update operation.
+ */
+future<void> Database::reopenTaskAsync(int id)
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, id, enqueued]()
+                 {
+        TRACE_ASYNC_SCOPE("Database::reopenTaskAsync", enqueued);
+        try {
+            writeTransaction([&] {
+                SQLite::Statement query(*db, "UPDATE tasks SET done = 0, completedTime = 0, updatedTime = ?1 WHERE id = ?2");
+                query.bind(1, static_cast<int64_t>(std::time(nullptr)));
+                query.bind(2, id);
+                query.exec();
+            });
+        }
+        catch (const SQLite::Exception &e) {
+            std::cerr << "SQLite error (reopenTask): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Asynchronous clearing of all tasks that keeps the old tables in a stash.
+ *
+ * Instead of being dropped, the task tables are renamed to undo_<id>_*, which
+ * costs the same whatever their size. Like a clear, it logs a single 'C'
+ * entry so other caches reload. Stashes older than STASH_LIFETIME are
+ * dropped on the way, so those of a process that died do not stay forever.
+ *
+ * @return Future object containing the stash ID.
+ */
+future<int> Database::stashAllDataAsync()
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, enqueued]() -> int
+                 {
+        TRACE_ASYNC_SCOPE("Database::stashAllDataAsync", enqueued);
+        try {
+            return writeTransaction([&] {
+                const int64_t now = std::time(nullptr);
+                std::vector<int> stale;
+                SQLite::Statement expired(*db, "SELECT id FROM undo_stashes WHERE createdTime < ?");
+                expired.bind(1, now - STASH_LIFETIME);
+                while (expired.executeStep()) {
+                    stale.push_back(expired.getColumn(0).getInt());
+                }
+                for (int id : stale) {
+                    dropStash(id);
+                }
+
+                SQLite::Statement stash(*db, "INSERT INTO undo_stashes (createdTime) VALUES (?) RETURNING id");
+                stash.bind(1, now);
+                stash.executeStep();
+                const int id = stash.getColumn(0).getInt();
+                stash.reset();
+                renameTaskTables("", stashPrefix(id));
+                db->exec("DELETE FROM task_changes");
+                createSchema();
+                db->exec("INSERT INTO task_changes (taskId, op) VALUES (0, 'C')");
+                return id;
+            });
+        }
+        catch (const SQLite::Exception &e) {
+            std::cerr << "SQLite error (stashAllData): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Asynchronous restore of the task tables kept in a stash.
+ *
+ * The live task tables are dropped and the stashed ones renamed back, so
+ * no row is copied; tasks added since the stash was made are lost. Their
+ * triggers and indexes are recreated, and a 'C' entry makes other caches
+ * reload.
+ *
+ * @param stash ID returned by stashAllDataAsync.
+ * @return Future object for the restore operation.
+ */
+future<void> Database::restoreStashAsync(int stash)
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, stash, enqueued]()
+                 {
+        TRACE_ASYNC_SCOPE("Database::restoreStashAsync", enqueued);
+        try {
+            writeTransaction([&] {
+                SQLite::Statement exists(*db, "SELECT COUNT(*) FROM undo_stashes WHERE id = ?");
+                exists.bind(1, stash);
+                exists.executeStep();
+                if (exists.getColumn(0).getInt() == 0) {
+                    throw std::invalid_argument("no such stash");
+                }
+                exists.reset();
+                for (const char *table : STASHED_TABLES) {
+                    db->exec(string("DROP TABLE IF EXISTS ") + table); // Also drops their triggers
+                }
+                renameTaskTables(stashPrefix(stash), "");
+                db->exec("DELETE FROM undo_stashes WHERE id = " + std::to_string(stash)); // Its tables are live again
+                db->exec("DELETE FROM task_changes");
+                createSchema();
+                db->exec("INSERT INTO task_changes (taskId, op) VALUES (0, 'C')");
+            });
+        }
+        catch (const SQLite::Exception &e) {
+            std::cerr << "SQLite error (restoreStash): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Asynchronous deletion of a stash.
+ *
+ * The freed pages are reclaimed later by the maintenance thread.
+ *
+ * @param stash ID returned by stashAllDataAsync.
+ * @return Future object for the drop operation.
+ */
+future<void> Database::dropStashAsync(int stash)
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, stash, enqueued]()
+                 {
+        TRACE_ASYNC_SCOPE("Database::dropStashAsync", enqueued);
+        try {
+            writeTransaction([&] {
+                dropStash(stash);
+                createSchema(); // Stashes made by older versions held the live tables' indexes
+            });
+        }
+        catch (const SQLite::Exception &e) {
+            std::cerr << "SQLite error (dropStash): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Asynchronous read of the schema version.
+ *
+ * @return Future object containing the schema version.
+ */
+future<int> Database::getSchemaVersionAsync() const
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, enqueued]() -> int
+                 {
+        TRACE_ASYNC_SCOPE("Database::getSchemaVersionAsync", enqueued);
+        try {
+            auto reading = readLock();
+            return schemaVersion(*db);
+        }
+        catch (const SQLite::Exception &e) {
+            std::cerr << "SQLite error (getSchemaVersion): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Asynchronous backfill of the pending migrations.
+ *
+ * The backfill opens its own connection: a transaction on the shared one
+ * would take in the statements other threads run on it meanwhile.
+ *
+ * @param chunkRows Maximum number of rows per transaction.
+ * @param progress Called after every chunk.
+ * @return Future object containing true once the schema is at the latest version.
+ */
+future<bool> Database::migrateAsync(int chunkRows, std::function<void(const MigrationProgress &)> progress)
+{
+    int64_t enqueued = Trace::now();
+    migrationStop = false;
+    return async(launch::async, [this, chunkRows, progress, enqueued]() -> bool
+                 {
+        TRACE_ASYNC_SCOPE("Database::migrateAsync", enqueued);
+        std::lock_guard<std::mutex> lock(migrationMutex);
+        try {
+            if (isReadOnly()) {
+                auto reading = readLock();
+                return schemaVersion(*db) == latestSchemaVersion();
+            }
+            SQLite::Database connection(filename, SQLite::OPEN_READWRITE, timeoutMs(busyPolicy));
+            if (!connection.tableExists("schema_migrations")) {
+                return true; // Created at the latest version, so nothing was ever pending
+            }
+            // Committed chunks are recorded, so a retry resumes where the busy one stopped
+            return retryBusy(busyPolicy, busyRetries, [&] {
+                for (const Migration &migration : migrations()) {
+                    if (migration.backfill && !runBackfill(connection, migration, std::max(chunkRows, 1), progress, migrationStop)) {
+                        return false;
+                    }
+                }
+                return schemaVersion(connection) == latestSchemaVersion();
+            });
+        }
+        catch (const SQLite::Exception &e) {
+            std::cerr << "SQLite error (migrate): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Asks a running migrateAsync to return after its current chunk.
+ */
+void Database::stopMigrations()
+{
+    migrationStop = true;
+}
+
+/**
+ * @brief Asynchronous read of PRAGMA data_version for this connection.
+ *
+ * @return Future object containing the current data version.
+ */
+future<int64_t> Database::getDataVersionAsync() const
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, enqueued]() -> int64_t
+                 {
+        TRACE_ASYNC_SCOPE("Database::getDataVersionAsync", enqueued);
+        try {
+            auto reading = readLock();
+            return db->execAndGet("PRAGMA data_version").getInt64();
+        }
+        catch (const SQLite::Exception &e) {
+            std::cerr << "SQLite error (getDataVersion): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Asynchronous read of SQLite's memory statistics.
+ *
+ * Process totals come from sqlite3_status64 and the connection's figures
+ * from sqlite3_db_status. The cache limit follows PRAGMA cache_size: a
+ * negative value is in KiB, a positive one in pages.
+ *
+ * @return Future object containing the statistics.
+ */
+future<SqliteMemoryStats> Database::getMemoryStatsAsync() const
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, enqueued]() -> SqliteMemoryStats
+                 {
+        TRACE_ASYNC_SCOPE("Database::getMemoryStatsAsync", enqueued);
+        try {
+            auto reading = readLock();
+            SqliteMemoryStats stats;
+            sqlite3_int64 current = 0, highwater = 0;
+            sqlite3_status64(SQLITE_STATUS_MEMORY_USED, &current, &highwater, 0);
+            stats.processBytes = current;
+            stats.processPeakBytes = highwater;
+
+            const auto connection = [this](int op) {
+                int value = 0, unused = 0;
+                sqlite3_db_status(db->getHandle(), op, &value, &unused, 0);
+                return static_cast<int64_t>(value);
+            };
+            stats.pageCacheBytes = connection(SQLITE_DBSTATUS_CACHE_USED);
+            stats.schemaBytes = connection(SQLITE_DBSTATUS_SCHEMA_USED);
+            stats.statementBytes = connection(SQLITE_DBSTATUS_STMT_USED);
+            stats.cacheHits = connection(SQLITE_DBSTATUS_CACHE_HIT);
+            stats.cacheMisses = connection(SQLITE_DBSTATUS_CACHE_MISS);
+
+            const int64_t cacheSize = db->execAndGet("PRAGMA cache_size").getInt64();
+            stats.pageCacheLimit = cacheSize < 0 ? -cacheSize * 1024 : cacheSize * db->execAndGet("PRAGMA page_size").getInt64();
+            return stats;
+        }
+        catch (const SQLite::Exception &e) {
+            std::cerr << "SQLite error (getMemoryStats): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Asynchronous read of the highest sequence in the 'task_changes' log.
+ *
+ * @return Future object containing the last change-log sequence.
+ */
+future<int64_t> Database::getLastChangeSeqAsync() const
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, enqueued]() -> int64_t
+                 {
+        TRACE_ASYNC_SCOPE("Database::getLastChangeSeqAsync", enqueued);
+        try {
+            auto reading = readLock();
+            return db->execAndGet("SELECT COALESCE(MAX(seq), 0) FROM task_changes").getInt64();
+        }
+        catch (const SQLite::Exception &e) {
+            std::cerr << "SQLite error (getLastChangeSeq): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Asynchronous retrieval of the tasks changed after a change-log sequence.
+ *
+ * Each changed id is joined against the current 'tasks' row, so a task
+ * touched several times is reported once in its latest state, and a task
+ * whose row is gone is reported as deleted.
+ *
+ * @param seq Sequence of the last change already applied by the caller.
+ * @return Future object containing the delta.
+ */
+future<TaskChanges> Database::getChangesSinceAsync(int64_t seq) const
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, seq, enqueued]() -> TaskChanges
+                 {
+        TRACE_ASYNC_SCOPE("Database::getChangesSinceAsync", enqueued);
+        TaskChanges changes;
+        try {
+            auto reading = readLock();
+            SQLite::Statement last(*db, CHANGE_RANGE_SQL);
+            last.bind(1, static_cast<int64_t>(seq));
+            last.executeStep();
+            changes.lastSeq = last.getColumn(0).getInt64();
+            changes.cleared = last.getColumn(1).getInt() > 0;
+            if (changes.lastSeq == seq || changes.cleared) {
+                return changes;
+            }
+
+            SQLite::Statement query(*db, changedTasksSql(dueColumn));
+            query.bind(1, static_cast<int64_t>(seq));
+            query.bind(2, static_cast<int64_t>(changes.lastSeq));
+            while (query.executeStep()) {
+                if (query.getColumn(1).getInt() == 0) {
+                    changes.deleted.push_back(query.getColumn(0).getInt());
+                    continue;
+                }
+                changes.upserted.emplace_back(
+                    query.getColumn(0).getInt(),
+                    query.getColumn(2).getText(),
+                    query.getColumn(3).getInt() == 1,
+                    static_cast<time_t>(query.getColumn(4).getInt64()),
+                    static_cast<time_t>(query.getColumn(5).getInt64()));
+                changes.upserted.back().setDueTime(static_cast<time_t>(query.getColumn(6).getInt64()));
+            }
+
+            SQLite::Statement tags(*db, CHANGED_TAGS_SQL);
+            tags.bind(1, static_cast<int64_t>(seq));
+            tags.bind(2, static_cast<int64_t>(changes.lastSeq));
+            while (tags.executeStep()) {
+                changes.tags.emplace_back(tags.getColumn(0).getInt(), tags.getColumn(1).getText());
+            }
+
+            if (changes.upserted.empty() || !db->tableExists("task_deps")) {
+                return changes; // Older files opened read-only have no dependencies
+            }
+            SQLite::Statement dependencies(*db, CHANGED_DEPENDENCIES_SQL);
+            dependencies.bind(1, static_cast<int64_t>(seq));
+            dependencies.bind(2, static_cast<int64_t>(changes.lastSeq));
+            while (dependencies.executeStep()) {
+                changes.dependencies.emplace_back(dependencies.getColumn(0).getInt(), dependencies.getColumn(1).getInt());
+            }
+        }
+        catch (const SQLite::Exception &e) {
+            std::cerr << "SQLite error (getChangesSince): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        }
+        return changes; });
+}
+
+/**
+ * @brief Asynchronous export of the changes after a change-log sequence.
+ *
+ * The batch is one header line, one line per upserted ('U'), deleted ('D')
+ * or tag ('T') entry, and a closing "end" line. Text fields are escaped so
+ * every entry stays on one line. A full batch, sent when seq is 0 or the
+ * log no longer reaches back to it, lists every task instead of a delta.
+ *
+ * The read transaction on a separate connection keeps the batch
+ * consistent; writers wait for it through their busy timeout.
+ *
+ * @param seq Sequence of the last change the receiver has applied.
+ * @param out Stream to write to; must outlive the future.
+ * @return Future object containing the last sequence covered by the batch.
+ */
+future<int64_t> Database::exportChangesAsync(int64_t seq, std::ostream &out) const
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, seq, &out, enqueued]() -> int64_t
+                 {
+        TRACE_ASYNC_SCOPE("Database::exportChangesAsync", enqueued);
+        try {
+            SQLite::Database connection(db->getFilename(), SQLite::OPEN_READONLY | SQLite::OPEN_URI, timeoutMs(busyPolicy));
+            SQLite::Transaction transaction(connection);
+            SQLite::Statement range(connection, CHANGE_RANGE_SQL);
+            range.bind(1, seq);
+            range.executeStep();
+            const int64_t lastSeq = range.getColumn(0).getInt64();
+            const bool full = seq <= 0 || range.getColumn(1).getInt() > 0;
+            range.reset();
+            out << CHANGE_BATCH_MAGIC << '\t' << CHANGE_BATCH_VERSION << '\t' << seq << '\t' << lastSeq << '\t' << (full ? 1 : 0) << '\n';
+
+            const string due = "COALESCE(" + dueColumn + ", 0)";
+            SQLite::Statement tasks(connection, full ? "SELECT id, 1, description, done, createdTime, completedTime, " + due + " FROM tasks ORDER BY id"
+                                                     : changedTasksSql(due));
+            SQLite::Statement tags(connection, full ? "SELECT tt.taskId, g.name FROM task_tags tt JOIN tags g ON g.id = tt.tagId"
+                                                    : CHANGED_TAGS_SQL);
+            if (!full) {
+                tasks.bind(1, seq);
+                tasks.bind(2, lastSeq);
+                tags.bind(1, seq);
+                tags.bind(2, lastSeq);
+            }
+            while (tasks.executeStep()) {
+                if (tasks.getColumn(1).getInt() == 0) {
+                    out << "D\t" << tasks.getColumn(0).getInt() << '\n';
+                    continue;
+                }
+                out << "U\t" << tasks.getColumn(0).getInt() << '\t' << tasks.getColumn(3).getInt() << '\t'
+                    << tasks.getColumn(4).getInt64() << '\t' << tasks.getColumn(5).getInt64() << '\t'
+                    << tasks.getColumn(6).getInt64() << '\t' << escapeField(tasks.getColumn(2).getText()) << '\n';
+            }
+            while (tags.executeStep()) {
+                out << "T\t" << tags.getColumn(0).getInt() << '\t' << escapeField(tags.getColumn(1).getText()) << '\n';
+            }
+            out << "end\n";
+            out.flush();
+            transaction.commit();
+            if (!out) {
+                throw std::runtime_error("cannot write the change batch");
+            }
+            return lastSeq;
+        }
+        catch (const SQLite::Exception &e) {
+            std::cerr << "SQLite error (exportChanges): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Asynchronous application of a batch written by exportChangesAsync.
+ *
+ * Upserts keep the sender's IDs, timestamps and due times. A task's tags are replaced
+ * by the 'T' entries that follow it. The batch and the new applied sequence
+ * commit in one IMMEDIATE transaction, so a batch without its closing line
+ * is rolled back as a whole.
+ *
+ * @param in Stream to read from; must outlive the future.
+ * @return Future object containing the sequence applied up to.
+ */
+future<int64_t> Database::applyChangesAsync(std::istream &in)
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, &in, enqueued]() -> int64_t
+                 {
+        TRACE_ASYNC_SCOPE("Database::applyChangesAsync", enqueued);
+        try {
+            string line;
+            std::vector<string> fields;
+            if (std::getline(in, line)) {
+                fields = splitFields(line);
+            }
+            if (fields.size() != 5 || fields[0] != CHANGE_BATCH_MAGIC || parseField(fields[1]) != CHANGE_BATCH_VERSION) {
+                throw std::runtime_error("not a change batch");
+            }
+            const int64_t fromSeq = parseField(fields[2]);
+            const int64_t lastSeq = parseField(fields[3]);
+            const bool full = parseField(fields[4]) != 0;
+
+            return writeTransaction([&] {
+                const int64_t applied = appliedSeq(*db);
+                if (!full && fromSeq > applied) {
+                    throw std::runtime_error("change batch starts after sequence " + std::to_string(fromSeq) +
+                                             " but only " + std::to_string(applied) + " is applied");
+                }
+                if (full) {
+                    clearTables();
+                }
+
+                SQLite::Statement upsert(*db,
+                    "INSERT INTO tasks (id, done, createdTime, completedTime, dueTime, description, updatedTime) "
+                    "VALUES (?1, ?2, ?3, ?4, NULLIF(?5, 0), ?6, MAX(?3, ?4)) ON CONFLICT (id) DO UPDATE SET "
+                    "description = excluded.description, done = excluded.done, createdTime = excluded.createdTime, "
+                    "completedTime = excluded.completedTime, dueTime = excluded.dueTime, updatedTime = excluded.updatedTime");
+                SQLite::Statement untag(*db, "DELETE FROM task_tags WHERE taskId = ?");
+                SQLite::Statement remove(*db, "DELETE FROM tasks WHERE id = ?");
+                SQLite::Statement insertTag(*db, "INSERT OR IGNORE INTO tags (name) VALUES (?)");
+                SQLite::Statement link(*db, "INSERT OR IGNORE INTO task_tags (tagId, taskId) SELECT id, ? FROM tags WHERE name = ?");
+                bool complete = false;
+                while (!complete && std::getline(in, line)) {
+                    fields = splitFields(line);
+                    if (fields.size() == 1 && fields[0] == "end") {
+                        complete = true;
+                    }
+                    else if (fields.size() == 7 && fields[0] == "U") {
+                        const int64_t id = parseField(fields[1]);
+                        upsert.reset();
+                        upsert.bind(1, id);
+                        upsert.bind(2, static_cast<int>(parseField(fields[2])));
+                        upsert.bind(3, parseField(fields[3]));
+                        upsert.bind(4, parseField(fields[4]));
+                        upsert.bind(5, parseField(fields[5]));
+                        upsert.bind(6, unescapeField(fields[6]));
+                        upsert.exec();
+                        if (!full) {
+                            untag.reset();
+                            untag.bind(1, id);
+                            untag.exec();
+                        }
+                    }
+                    else if (fields.size() == 2 && fields[0] == "D") {
+                        remove.reset();
+                        remove.bind(1, parseField(fields[1]));
+                        remove.exec();
+                    }
+                    else if (fields.size() == 3 && fields[0] == "T") {
+                        const string tag = unescapeField(fields[2]);
+                        insertTag.reset();
+                        insertTag.bind(1, tag);
+                        insertTag.exec();
+                        link.reset();
+                        link.bind(1, parseField(fields[1]));
+                        link.bind(2, tag);
+                        link.exec();
+                    }
+                    else {
+                        throw std::runtime_error("malformed change batch line: " + line);
+                    }
+                }
+                if (!complete) {
+                    throw std::runtime_error("change batch is truncated");
+                }
+
+                const int64_t nowApplied = full ? lastSeq : std::max(applied, lastSeq);
+                SQLite::Statement record(*db, "INSERT INTO sync_state (name, value) VALUES ('appliedSeq', ?) "
+                                              "ON CONFLICT (name) DO UPDATE SET value = excluded.value");
+                record.bind(1, nowApplied);
+                record.exec();
+                return nowApplied;
+            });
+        }
+        catch (const SQLite::Exception &e) {
+            std::cerr << "SQLite error (applyChanges): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        }
+        catch (const std::runtime_error &e) {
+            std::cerr << "Sync error (applyChanges): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Asynchronous read of the sequence applied up to by applyChangesAsync.
+ *
+ * @return Future object containing the sequence (0 if nothing was applied).
+ */
+future<int64_t> Database::getAppliedSeqAsync() const
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, enqueued]() -> int64_t
+                 {
+        TRACE_ASYNC_SCOPE("Database::getAppliedSeqAsync", enqueued);
+        try {
+            auto reading = readLock();
+            return appliedSeq(*db);
+        }
+        catch (const SQLite::Exception &e) {
+            std::cerr << "SQLite error (getAppliedSeq): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Asynchronous truncation of the change log up to an acknowledged sequence.
+ *
+ * The removed entries are replaced by one 'P' entry whose taskId is the
+ * highest removed sequence, so getChangesSinceAsync and exportChangesAsync
+ * can tell a reader that fell behind it to reload.
+ *
+ * @param seq Sequence the receiver has applied.
+ * @return Future object containing the number of entries removed.
+ */
+future<int> Database::acknowledgeChangesAsync(int64_t seq)
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, seq, enqueued]() -> int
+                 {
+        TRACE_ASYNC_SCOPE("Database::acknowledgeChangesAsync", enqueued);
+        try {
+            return writeTransaction([&] {
+                SQLite::Statement last(*db, "SELECT COALESCE(MIN(MAX(seq), ?), 0) FROM task_changes");
+                last.bind(1, seq);
+                last.executeStep();
+                const int64_t horizon = last.getColumn(0).getInt64();
+                last.reset();
+
+                SQLite::Statement pending(*db, "SELECT COUNT(*) FROM task_changes WHERE seq <= ? AND op <> 'P'");
+                pending.bind(1, horizon);
+                pending.executeStep();
+                const int removed = pending.getColumn(0).getInt();
+                pending.reset();
+                if (removed == 0) {
+                    return 0; // Only earlier markers are left; replacing them would just churn the log
+                }
+
+                SQLite::Statement prune(*db, "DELETE FROM task_changes WHERE seq <= ?");
+                prune.bind(1, horizon);
+                prune.exec();
+                SQLite::Statement mark(*db, "INSERT INTO task_changes (taskId, op) VALUES (?, 'P')");
+                mark.bind(1, horizon);
+                mark.exec();
+                return removed;
+            });
+        }
+        catch (const SQLite::Exception &e) {
+            std::cerr << "SQLite error (acknowledgeChanges): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Asynchronous conversion of the file to incremental auto_vacuum.
+ *
+ * Runs on its own connection, since VACUUM cannot run while statements of
+ * other threads are open on the shared one. The VACUUM rewrites the whole
+ * file and holds the write lock until it is done.
+ *
+ * @return Future object containing true if the file was converted, or
+ *         false if it already was in incremental mode.
+ */
+future<bool> Database::enableIncrementalVacuumAsync()
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, enqueued]() -> bool
+                 {
+        TRACE_ASYNC_SCOPE("Database::enableIncrementalVacuumAsync", enqueued);
+        try {
+            if (isReadOnly()) {
+                throw std::runtime_error("Database is opened read-only");
+            }
+            SQLite::Database connection(filename, SQLite::OPEN_READWRITE, timeoutMs(busyPolicy));
+            if (connection.execAndGet("PRAGMA auto_vacuum").getInt() == 2) {
+                return false;
+            }
+            retryBusy(busyPolicy, busyRetries, [&connection] {
+                connection.exec("PRAGMA auto_vacuum = INCREMENTAL");
+                connection.exec("VACUUM");
+            });
+            return true;
+        }
+        catch (const SQLite::Exception &e) {
+            std::cerr << "SQLite error (enableIncrementalVacuum): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Starts the background thread that reclaims free pages.
+ *
+ * Every interval the thread checks PRAGMA freelist_count and, while pages
+ * are free, runs PRAGMA incremental_vacuum in steps of pagesPerStep,
+ * sleeping briefly between steps so writers are never held up for more
+ * than one bounded step. It works on its own connection and skips files
+ * that are not in incremental auto_vacuum mode.
+ *
+ * @param pagesPerStep Maximum number of pages released per step.
+ * @param interval Time between freelist checks.
+ */
+void Database::startMaintenance(int pagesPerStep, std::chrono::milliseconds interval)
+{
+    stopMaintenance();
+    if (isReadOnly()) {
+        return; // incremental_vacuum writes to the file
+    }
+    maintenanceStop = false;
+    maintenanceThread = std::thread([this, pagesPerStep, interval]()
+                                    {
+        std::unique_lock<std::mutex> lock(maintenanceMutex);
+        std::unique_ptr<SQLite::Database> connection;
+        while (!maintenanceWake.wait_for(lock, interval, [this] { return maintenanceStop; })) {
+            try {
+                // Its own connection, so a step never runs inside another thread's transaction
+                if (!connection) {
+                    connection.reset(new SQLite::Database(filename, SQLite::OPEN_READWRITE, timeoutMs(busyPolicy)));
+                }
+                // Without auto_vacuum the free pages stay for reuse; incremental_vacuum would not release them
+                if (connection->execAndGet("PRAGMA auto_vacuum").getInt() != 2) {
+                    continue;
+                }
+                while (!maintenanceStop && connection->execAndGet("PRAGMA freelist_count").getInt() > 0) {
+                    // Taking the write lock up front waits for writers instead of failing on an upgrade
+                    retryBusy(busyPolicy, busyRetries, [&connection] { connection->exec("BEGIN IMMEDIATE"); });
+                    try {
+                        connection->exec("PRAGMA incremental_vacuum(" + std::to_string(pagesPerStep) + ")");
+                        retryBusy(busyPolicy, busyRetries, [&connection] { connection->exec("COMMIT"); });
+                    }
+                    catch (const SQLite::Exception &) {
+                        try {
+                            connection->exec("ROLLBACK");
+                        }
+                        catch (const SQLite::Exception &) {
+                            // SQLite already rolled back
+                        }
+                        throw;
+                    }
+                    maintenanceWake.wait_for(lock, std::chrono::milliseconds(5), [this] { return maintenanceStop; });
+                }
+            }
+            catch (const SQLite::Exception &e) {
+                // A busy database is retried on the next tick
+                std::cerr << "SQLite error (maintenance): " << e.what() << std::endl;
+            }
+        } });
+}
+
+/**
+ * @brief Stops the maintenance thread, waiting for the current step to finish.
+ */
+void Database::stopMaintenance()
+{
+    if (!maintenanceThread.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(maintenanceMutex);
+        maintenanceStop = true;
+    }
+    maintenanceWake.notify_all();
+    maintenanceThread.join();
+}
+
+/**
+ * @brief Asynchronous online backup of the database to a file.
+ *
+ * The shared connection is the source, so this process's own writes during
+ * the backup are applied to the copy instead of restarting it. A step that
+ * finds the file locked by another process is retried after the pause.
+ *
+ * @param destPath File to write the backup to.
+ * @param pagesPerStep Maximum number of pages copied per step.
+ * @param progress Called after every step.
+ * @return Future object for the backup operation.
+ */
+future<void> Database::backupAsync(const string &destPath, int pagesPerStep, std::function<void(const BackupProgress &)> progress)
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, destPath, pagesPerStep, progress, enqueued]()
+                 {
+        TRACE_ASYNC_SCOPE("Database::backupAsync", enqueued);
+        std::lock_guard<std::mutex> lock(backupMutex);
+        const string partialPath = destPath + ".partial";
+        std::error_code ignored;
+        try {
+            std::filesystem::remove(partialPath, ignored);
+            {
+                SQLite::Database destination(partialPath, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+                SQLite::Backup backup(destination, *db);
+                BackupProgress report;
+                for (;;) {
+                    int result;
+                    {
+                        TRACE_SCOPE("Database::backupStep");
+                        auto reading = readLock(); // Copies committed pages only, never a writer's open transaction
+                        result = backup.executeStep(std::max(pagesPerStep, 1));
+                    }
+                    report.remainingPages = backup.getRemainingPageCount();
+                    report.totalPages = backup.getTotalPageCount();
+                    if (progress) {
+                        progress(report);
+                    }
+                    if (result == SQLITE_DONE) {
+                        break;
+                    }
+                    std::this_thread::sleep_for(BACKUP_STEP_PAUSE); // Also the retry delay after SQLITE_BUSY or SQLITE_LOCKED
+                }
+            }
+            std::filesystem::rename(partialPath, destPath);
+        }
+        catch (const SQLite::Exception &e) {
+            std::filesystem::remove(partialPath, ignored);
+            std::cerr << "SQLite error (backup): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        }
+        catch (const std::filesystem::filesystem_error &e) {
+            std::filesystem::remove(partialPath, ignored);
+            std::cerr << "Filesystem error (backup): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Starts the background thread that backs up the database every interval.
+ *
+ * A failed backup is logged by backupAsync and retried at the next interval.
+ *
+ * @param destPath File to write each backup to.
+ * @param interval Time between backups.
+ */
+void Database::startBackups(const string &destPath, std::chrono::minutes interval)
+{
+    stopBackups();
+    backupStop = false;
+    backupThread = std::thread([this, destPath, interval]()
+                               {
+        std::unique_lock<std::mutex> lock(backupTimerMutex);
+        while (!backupWake.wait_for(lock, interval, [this] { return backupStop; })) {
+            lock.unlock();
+            try {
+                backupAsync(destPath).get();
+            }
+            catch (const std::exception &) {
+                // Already reported; the next interval tries again
+            }
+            lock.lock();
+        } });
+}
+
+/**
+ * @brief Stops the backup thread, waiting for a running backup to finish.
+ */
+void Database::stopBackups()
+{
+    if (!backupThread.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(backupTimerMutex);
+        backupStop = true;
+    }
+    backupWake.notify_all();
+    backupThread.join();
+}
+
+/**
+ * @brief Asynchronous archiving of the tasks completed before a time.
+ *
+ * Tasks are taken in completion order, so every block covers a narrow
+ * completion range and exports by date decompress few blocks.
+ *
+ * @param completedBefore Tasks completed before this time are archived.
+ * @param blockTasks Maximum number of tasks per block.
+ * @return Future object containing the number of tasks archived.
+ */
+future<int> Database::archiveCompletedAsync(int64_t completedBefore, int blockTasks)
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, completedBefore, blockTasks, enqueued]() -> int
+                 {
+        TRACE_ASYNC_SCOPE("Database::archiveCompletedAsync", enqueued);
+        int archived = 0;
+        try {
+            if (isReadOnly()) {
+                return 0;
+            }
+            SQLite::Database connection(filename, SQLite::OPEN_READWRITE, timeoutMs(busyPolicy));
+            while (!archiveInterrupt) {
+                const int moved = retryBusy(busyPolicy, busyRetries, [&] {
+                    return archiveBlock(connection, completedBefore, std::max(blockTasks, 1)); // One transaction
+                });
+                if (moved == 0) {
+                    break;
+                }
+                archived += moved;
+            }
+        }
+        catch (const SQLite::Exception &e) {
+            std::cerr << "SQLite error (archiveCompleted): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        }
+        catch (const std::runtime_error &e) {
+            std::cerr << "Archive error (archiveCompleted): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        }
+        return archived; });
+}
+
+/**
+ * @brief Asynchronous search of the archived task descriptions.
+ *
+ * @param text Text to look for, ignoring ASCII case; empty matches every task.
+ * @param limit Maximum number of tasks returned.
+ * @return Future object containing the matches, most recently completed blocks first.
+ */
+future<std::vector<ArchivedTask>> Database::searchArchiveAsync(const string &text, size_t limit) const
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, text, limit, enqueued]() -> std::vector<ArchivedTask>
+                 {
+        TRACE_ASYNC_SCOPE("Database::searchArchiveAsync", enqueued);
+        std::vector<ArchivedTask> matches;
+        try {
+            auto reading = readLock();
+            if (limit == 0 || !db->tableExists("archive_blocks")) {
+                return matches; // Read-only files created before archiving existed
+            }
+            const string needle = lowerAscii(text);
+            SQLite::Statement blocks(*db, "SELECT rawSize, data FROM archive_blocks ORDER BY id DESC");
+            while (matches.size() < limit && blocks.executeStep()) {
+                for (ArchivedTask &archived : readArchiveBlock(blocks, 0)) {
+                    if (lowerAscii(archived.task.getDescription()).find(needle) != string::npos) {
+                        matches.push_back(std::move(archived));
+                        if (matches.size() == limit) {
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+        catch (const SQLite::Exception &e) {
+            std::cerr << "SQLite error (searchArchive): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        }
+        catch (const std::runtime_error &e) {
+            std::cerr << "Archive error (searchArchive): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        }
+        return matches; });
+}
+
+/**
+ * @brief Asynchronous retrieval of the archived tasks completed within [from, to).
+ *
+ * @param from Start of the interval.
+ * @param to End of the interval, exclusive.
+ * @return Future object containing the tasks in ID order.
+ */
+future<std::vector<ArchivedTask>> Database::getArchivedTasksAsync(int64_t from, int64_t to) const
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, from, to, enqueued]() -> std::vector<ArchivedTask>
+                 {
+        TRACE_ASYNC_SCOPE("Database::getArchivedTasksAsync", enqueued);
+        std::vector<ArchivedTask> tasks;
+        try {
+            auto reading = readLock();
+            if (to <= from || !db->tableExists("archive_blocks")) {
+                return tasks;
+            }
+            SQLite::Statement blocks(*db, "SELECT rawSize, data FROM archive_blocks WHERE completedTo >= ? AND completedFrom < ?");
+            blocks.bind(1, from);
+            blocks.bind(2, to);
+            while (blocks.executeStep()) {
+                for (ArchivedTask &archived : readArchiveBlock(blocks, 0)) {
+                    const int64_t completed = static_cast<int64_t>(archived.task.getCompletedTime());
+                    if (completed >= from && completed < to) {
+                        tasks.push_back(std::move(archived));
+                    }
+                }
+            }
+            std::sort(tasks.begin(), tasks.end(), [](const ArchivedTask &a, const ArchivedTask &b) {
+                return a.task.getId() < b.task.getId();
+            });
+        }
+        catch (const SQLite::Exception &e) {
+            std::cerr << "SQLite error (getArchivedTasks): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        }
+        catch (const std::runtime_error &e) {
+            std::cerr << "Archive error (getArchivedTasks): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        }
+        return tasks; });
+}
+
+/**
+ * @brief Starts the background thread that archives old completed tasks.
+ *
+ * @param olderThan Tasks completed longer ago than this are archived.
+ * @param interval Time between runs; the first one runs immediately.
+ */
+void Database::startArchiving(std::chrono::hours olderThan, std::chrono::minutes interval)
+{
+    stopArchiving();
+    if (isReadOnly()) {
+        return;
+    }
+    archiveStop = false;
+    archiveThread = std::thread([this, olderThan, interval]()
+                                {
+        std::unique_lock<std::mutex> lock(archiveTimerMutex);
+        do {
+            lock.unlock();
+            const int64_t cutoff = static_cast<int64_t>(std::time(nullptr)) -
+                                   std::chrono::duration_cast<std::chrono::seconds>(olderThan).count();
+            try {
+                archiveCompletedAsync(cutoff).get();
+            }
+            catch (const std::exception &) {
+                // Already reported; the next interval tries again
+            }
+            lock.lock();
+        } while (!archiveWake.wait_for(lock, interval, [this] { return archiveStop; })); });
+}
+
+/**
+ * @brief Stops the archiving thread, letting a running run finish its current block.
+ */
+void Database::stopArchiving()
+{
+    if (!archiveThread.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(archiveTimerMutex);
+        archiveStop = true;
+    }
+    archiveInterrupt = true;
+    archiveWake.notify_all();
+    archiveThread.join();
+    archiveInterrupt = false;
+}
+
+/**
+ * @brief Asynchronous tagging of a task, creating the tag if needed.
+ *
+ * The task is checked inside the write transaction, so no tag is created
+ * for a task that does not exist.
+ *
+ * @param id ID of the task to tag.
+ * @param tag Tag name.
+ * @return Future object for the add tag operation.
+ */
+future<void> Database::addTagAsync(int id, const string &tag)
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, id, tag, enqueued]()
+                 {
+        TRACE_ASYNC_SCOPE("Database::addTagAsync", enqueued);
+        try {
+            writeTransaction([&] {
+                SQLite::Statement exists(*db, "SELECT COUNT(*) FROM tasks WHERE id = ?");
+                exists.bind(1, id);
+                exists.executeStep();
+                if (exists.getColumn(0).getInt() == 0) {
+                    throw std::invalid_argument("no such task");
+                }
+                SQLite::Statement insertTag(*db, "INSERT OR IGNORE INTO tags (name) VALUES (?)");
+                insertTag.bind(1, tag);
+                insertTag.exec();
+                SQLite::Statement link(*db,
+                    "INSERT OR IGNORE INTO task_tags (tagId, taskId) "
+                    "SELECT id, ? FROM tags WHERE name = ?");
+                link.bind(1, id);
+                link.bind(2, tag);
+                link.exec();
+            });
+        }
+        catch (const SQLite::Exception &e) {
+            std::cerr << "SQLite error (addTag): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Asynchronous removal of a tag from a task.
+ *
+ * @param id ID of the task.
+ * @param tag Tag name.
+ * @return Future object for the remove tag operation.
+ */
+future<void> Database::removeTagAsync(int id, const string &tag)
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, id, tag, enqueued]()
+                 {
+        TRACE_ASYNC_SCOPE("Database::removeTagAsync", enqueued);
+        try {
+            writeTransaction([&] {
+                SQLite::Statement query(*db, "DELETE FROM task_tags WHERE taskId = ? AND tagId = (SELECT id FROM tags WHERE name = ?)");
+                query.bind(1, id);
+                query.bind(2, tag);
+                query.exec();
+            });
+        }
+        catch (const SQLite::Exception &e) {
+            std::cerr << "SQLite error (removeTag): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Asynchronous retrieval of every (task ID, tag) pair.
+ *
+ * @return Future object containing the pairs ordered by tag name, then task ID.
+ */
+future<std::vector<std::pair<int, string>>> Database::getTaskTagsAsync() const
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, enqueued]() -> std::vector<std::pair<int, string>>
+                 {
+        TRACE_ASYNC_SCOPE("Database::getTaskTagsAsync", enqueued);
+        std::vector<std::pair<int, string>> pairs;
+        try {
+            auto reading = readLock();
+            SQLite::Statement query(*db, "SELECT tt.taskId, g.name FROM task_tags tt JOIN tags g ON g.id = tt.tagId ORDER BY g.name, tt.taskId");
+            while (query.executeStep()) {
+                pairs.emplace_back(query.getColumn(0).getInt(), query.getColumn(1).getText());
+            }
+        }
+        catch (const SQLite::Exception &e) {
+            std::cerr << "SQLite error (getTaskTags): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        }
+        return pairs; });
+}
+
+/**
+ * @brief Asynchronous addition of a dependency between two tasks.
+ *
+ * The edge closes a cycle exactly when the task that waits is already among
+ * the prerequisites, direct or indirect, of the task it would wait for; a
+ * recursive query walks those along the primary key.
+ *
+ * @param id ID of the task that waits.
+ * @param prerequisiteId ID of the task that must be done first.
+ * @return Future object for the add operation.
+ */
+future<void> Database::addDependencyAsync(int id, int prerequisiteId)
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, id, prerequisiteId, enqueued]()
+                 {
+        TRACE_ASYNC_SCOPE("Database::addDependencyAsync", enqueued);
+        try {
+            writeTransaction([&] {
+                SQLite::Statement exists(*db, "SELECT COUNT(*) FROM tasks WHERE id IN (?1, ?2)");
+                exists.bind(1, id);
+                exists.bind(2, prerequisiteId);
+                exists.executeStep();
+                if (exists.getColumn(0).getInt() != (id == prerequisiteId ? 1 : 2)) {
+                    throw std::invalid_argument("no such task");
+                }
+                SQLite::Statement reachable(*db,
+                    "WITH RECURSIVE prerequisites(id) AS (SELECT ?1 UNION "
+                    "SELECT d.dependsOn FROM task_deps d JOIN prerequisites p ON d.taskId = p.id) "
+                    "SELECT COUNT(*) FROM prerequisites WHERE id = ?2");
+                reachable.bind(1, prerequisiteId);
+                reachable.bind(2, id);
+                reachable.executeStep();
+                if (reachable.getColumn(0).getInt() > 0) {
+                    throw std::invalid_argument("task " + std::to_string(id) + " cannot wait for task " +
+                                                std::to_string(prerequisiteId) + ": that would create a cycle");
+                }
+                SQLite::Statement insert(*db, "INSERT OR IGNORE INTO task_deps (taskId, dependsOn) VALUES (?, ?)");
+                insert.bind(1, id);
+                insert.bind(2, prerequisiteId);
+                insert.exec();
+            });
+        }
+        catch (const SQLite::Exception &e) {
+            std::cerr << "SQLite error (addDependency): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Asynchronous removal of a dependency between two tasks.
+ *
+ * @param id ID of the task that waits.
+ * @param prerequisiteId ID of the task it waits for.
+ * @return Future object for the remove operation.
+ */
+future<void> Database::removeDependencyAsync(int id, int prerequisiteId)
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, id, prerequisiteId, enqueued]()
+                 {
+        TRACE_ASYNC_SCOPE("Database::removeDependencyAsync", enqueued);
+        try {
+            writeTransaction([&] {
+                SQLite::Statement query(*db, "DELETE FROM task_deps WHERE taskId = ? AND dependsOn = ?");
+                query.bind(1, id);
+                query.bind(2, prerequisiteId);
+                query.exec();
+            });
+        }
+        catch (const SQLite::Exception &e) {
+            std::cerr << "SQLite error (removeDependency): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Asynchronous update of a task's due time.
+ *
+ * The change is logged like any other update, so every process sharing the
+ * file reschedules its reminder.
+ *
+ * @param id ID of the task.
+ * @param dueTime Timestamp the task is due at, or 0 to clear it.
+ * @return Future object for the update operation.
+ */
+future<void> Database::setDueTimeAsync(int id, int64_t dueTime)
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, id, dueTime, enqueued]()
+                 {
+        TRACE_ASYNC_SCOPE("Database::setDueTimeAsync", enqueued);
+        try {
+            writeTransaction([&] {
+                SQLite::Statement query(*db, "UPDATE tasks SET dueTime = NULLIF(?1, 0), updatedTime = ?2 WHERE id = ?3");
+                query.bind(1, dueTime);
+                query.bind(2, static_cast<int64_t>(std::time(nullptr)));
+                query.bind(3, id);
+                query.exec();
+            });
+        }
+        catch (const SQLite::Exception &e) {
+            std::cerr << "SQLite error (setDueTime): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Asynchronous retrieval of the due times of pending tasks.
+ *
+ * Reads two columns instead of whole tasks, so schedulers can be rebuilt
+ * without materializing the task list.
+ *
+ * @param after Only due times later than this are returned.
+ * @return Future object containing (task ID, due time) pairs in ascending ID order.
+ */
+future<std::vector<std::pair<int, int64_t>>> Database::getDueTimesAsync(int64_t after) const
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, after, enqueued]() -> std::vector<std::pair<int, int64_t>>
+                 {
+        TRACE_ASYNC_SCOPE("Database::getDueTimesAsync", enqueued);
+        std::vector<std::pair<int, int64_t>> dueTimes;
+        try {
+            auto reading = readLock();
+            SQLite::Statement query(*db, "SELECT id, " + dueColumn + " FROM tasks WHERE done = 0 AND " +
+                                             dueColumn + " > ? ORDER BY id");
+            query.bind(1, after);
+            while (query.executeStep()) {
+                dueTimes.emplace_back(query.getColumn(0).getInt(), query.getColumn(1).getInt64());
+            }
+        }
+        catch (const SQLite::Exception &e) {
+            std::cerr << "SQLite error (getDueTimes): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        }
+        return dueTimes; });
+}
+
+/**
+ * @brief Asynchronous retrieval of every dependency edge.
+ *
+ * @return Future object containing (task ID, prerequisite ID) pairs in ascending order.
+ */
+future<std::vector<std::pair<int, int>>> Database::getDependenciesAsync() const
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, enqueued]() -> std::vector<std::pair<int, int>>
+                 {
+        TRACE_ASYNC_SCOPE("Database::getDependenciesAsync", enqueued);
+        std::vector<std::pair<int, int>> edges;
+        try {
+            auto reading = readLock();
+            if (!db->tableExists("task_deps")) {
+                return edges; // An older file opened read-only
+            }
+            SQLite::Statement query(*db, "SELECT taskId, dependsOn FROM task_deps ORDER BY taskId, dependsOn");
+            while (query.executeStep()) {
+                edges.emplace_back(query.getColumn(0).getInt(), query.getColumn(1).getInt());
+            }
+        }
+        catch (const SQLite::Exception &e) {
+            std::cerr << "SQLite error (getDependencies): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        }
+        return edges; });
+}
+
+/**
+ * @brief Asynchronous storage of a recurring task template.
+ *
+ * @param description Description of the tasks made from the template.
+ * @param rule When occurrences fall.
+ * @param firstTime Start of the first occurrence's window.
+ * @return Future object containing the template ID.
+ */
+future<int> Database::addRecurrenceAsync(const string &description, const RecurrenceRule &rule, int64_t firstTime)
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, description, rule, firstTime, enqueued]() -> int
+                 {
+        TRACE_ASYNC_SCOPE("Database::addRecurrenceAsync", enqueued);
+        try {
+            return writeTransaction([&] {
+                SQLite::Statement query(*db, "INSERT INTO recurrences (description, rule, nextTime) VALUES (?, ?, ?) RETURNING id");
+                query.bind(1, description);
+                query.bind(2, formatRecurrenceRule(rule));
+                query.bind(3, firstTime);
+                query.executeStep();
+                const int id = query.getColumn(0).getInt();
+                query.executeStep(); // Completes the statement
+                return id;
+            });
+        }
+        catch (const SQLite::Exception &e) {
+            std::cerr << "SQLite error (addRecurrence): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Asynchronous retrieval of every recurring task template.
+ *
+ * @return Future object containing the templates in ID order.
+ */
+future<std::vector<Recurrence>> Database::getRecurrencesAsync() const
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, enqueued]() -> std::vector<Recurrence>
+                 {
+        TRACE_ASYNC_SCOPE("Database::getRecurrencesAsync", enqueued);
+        std::vector<Recurrence> recurrences;
+        try {
+            auto reading = readLock();
+            SQLite::Statement query(*db, "SELECT id, description, rule, nextTime, COALESCE(taskId, 0) FROM recurrences ORDER BY id");
+            while (query.executeStep()) {
+                recurrences.push_back(readRecurrence(query));
+            }
+        }
+        catch (const SQLite::Exception &e) {
+            std::cerr << "SQLite error (getRecurrences): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        }
+        return recurrences; });
+}
+
+/**
+ * @brief Asynchronous deletion of a recurring task template.
+ *
+ * @param id ID of the template.
+ * @return Future object for the delete operation.
+ */
+future<void> Database::deleteRecurrenceAsync(int id)
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, id, enqueued]()
+                 {
+        TRACE_ASYNC_SCOPE("Database::deleteRecurrenceAsync", enqueued);
+        try {
+            writeTransaction([&] {
+                SQLite::Statement query(*db, "DELETE FROM recurrences WHERE id = ?");
+                query.bind(1, id);
+                query.exec();
+            });
+        }
+        catch (const SQLite::Exception &e) {
+            std::cerr << "SQLite error (deleteRecurrence): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Asynchronous creation of a template's next task once its window has arrived.
+ *
+ * The task is created at now, and nextTime moves to the first occurrence
+ * after now, so a template that was not checked for several periods
+ * produces one task rather than one per missed period.
+ *
+ * @param id ID of the template.
+ * @param now Current time.
+ * @return Future object containing the template after the call.
+ */
+future<Recurrence> Database::materializeRecurrenceAsync(int id, int64_t now)
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, id, now, enqueued]() -> Recurrence
+                 {
+        TRACE_ASYNC_SCOPE("Database::materializeRecurrenceAsync", enqueued);
+        try {
+            return writeTransaction([&] {
+                Recurrence recurrence;
+                {
+                    SQLite::Statement query(*db, "SELECT id, description, rule, nextTime, COALESCE(taskId, 0) FROM recurrences WHERE id = ?");
+                    query.bind(1, id);
+                    if (!query.executeStep()) {
+                        return recurrence;
+                    }
+                    recurrence = readRecurrence(query);
+                }
+                if (recurrence.taskId != 0 || recurrence.nextTime > now) {
+                    return recurrence;
+                }
+
+                SQLite::Statement insert(*db, "INSERT INTO tasks (description, done, createdTime, completedTime, updatedTime) VALUES (?1, 0, ?2, 0, ?2) "
+                                              "RETURNING id");
+                insert.bind(1, recurrence.description);
+                insert.bind(2, now);
+                insert.executeStep();
+                recurrence.taskId = insert.getColumn(0).getInt();
+                insert.executeStep(); // Completes the statement
+                recurrence.nextTime = nextOccurrence(recurrence.rule, recurrence.nextTime, now);
+
+                SQLite::Statement update(*db, "UPDATE recurrences SET taskId = ?, nextTime = ? WHERE id = ?");
+                update.bind(1, recurrence.taskId);
+                update.bind(2, recurrence.nextTime);
+                update.bind(3, id);
+                update.exec();
+                return recurrence;
+            });
+        }
+        catch (const SQLite::Exception &e) {
+            std::cerr << "SQLite error (materializeRecurrence): " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
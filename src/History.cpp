@@ -0,0 +1,284 @@
+#include "History.h"
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <string>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+using std::string;
+using std::vector;
+
+namespace
+{
+    constexpr int64_t SECONDS_PER_DAY = 86400;
+    constexpr int64_t MAX_DENSE_BUCKETS = 1 << 16; // About 180 years of days
+    constexpr int64_t MAX_FILLED_GAP = 400;        // Longer runs of empty buckets are drawn as one break
+
+    inline int64_t floorDiv(int64_t value, int64_t divisor)
+    {
+        int64_t quotient = value / divisor;
+        return quotient - ((value % divisor != 0) && ((value < 0) != (divisor < 0)));
+    }
+
+    inline int lowestBit(uint64_t word)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, word);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctzll(word);
+#endif
+    }
+
+    /**
+     * @brief Converts days since 1970-01-01 to a civil date (Howard Hinnant's algorithm).
+     */
+    void civilFromDays(int64_t days, int64_t &year, unsigned &month, unsigned &day)
+    {
+        days += 719468;
+        const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+        const unsigned dayOfEra = static_cast<unsigned>(days - era * 146097);
+        const unsigned yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        const unsigned dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+        const unsigned shiftedMonth = (5 * dayOfYear + 2) / 153;
+        day = dayOfYear - (153 * shiftedMonth + 2) / 5 + 1;
+        month = shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9;
+        year = static_cast<int64_t>(yearOfEra) + era * 400 + (month <= 2);
+    }
+
+    /**
+     * @brief Maps a day number to the week or month bucket containing it.
+     */
+    int64_t bucketOfDay(int64_t days, HistoryGranularity granularity)
+    {
+        switch (granularity) {
+        case HistoryGranularity::Week:
+            return floorDiv(days + 3, 7); // 1970-01-01 was a Thursday; weeks start on Monday
+        case HistoryGranularity::Month: {
+            int64_t year;
+            unsigned month, day;
+            civilFromDays(days, year, month, day);
+            return (year - 1970) * 12 + (month - 1);
+        }
+        case HistoryGranularity::Day:
+        default:
+            return days;
+        }
+    }
+
+    /**
+     * @brief Bucket counters, dense over a bounded window and sparse beyond it.
+     *
+     * The window grows in either direction up to MAX_DENSE_BUCKETS, so an
+     * outlying timestamp goes to a map instead of allocating every bucket
+     * between it and the rest.
+     */
+    class BucketCounts {
+    public:
+        HistoryBucket &at(int64_t bucket)
+        {
+            const uint64_t offset = static_cast<uint64_t>(bucket - base);
+            if (offset < buckets.size()) {
+                return buckets[offset];
+            }
+            if (buckets.empty()) {
+                base = bucket;
+                buckets.resize(1);
+                return buckets.front();
+            }
+            const int64_t last = base + static_cast<int64_t>(buckets.size()) - 1;
+            if (std::max(last, bucket) - std::min(base, bucket) >= MAX_DENSE_BUCKETS) {
+                HistoryBucket &outlier = outliers[bucket];
+                outlier.bucket = bucket;
+                return outlier;
+            }
+            if (bucket < base) {
+                buckets.insert(buckets.begin(), static_cast<size_t>(base - bucket), HistoryBucket{});
+                base = bucket;
+            }
+            else {
+                buckets.resize(static_cast<size_t>(bucket - base + 1));
+            }
+            return buckets[static_cast<size_t>(bucket - base)];
+        }
+
+        /**
+         * @brief Returns the non-empty buckets in ascending order.
+         */
+        vector<HistoryBucket> release()
+        {
+            vector<HistoryBucket> result;
+            auto outlier = outliers.begin();
+            for (size_t i = 0; i < buckets.size(); ++i) {
+                const int64_t bucket = base + static_cast<int64_t>(i);
+                for (; outlier != outliers.end() && outlier->first < bucket; ++outlier) {
+                    result.push_back(outlier->second);
+                }
+                if (buckets[i].created != 0 || buckets[i].completed != 0) {
+                    buckets[i].bucket = bucket;
+                    result.push_back(buckets[i]);
+                }
+            }
+            for (; outlier != outliers.end(); ++outlier) {
+                result.push_back(outlier->second);
+            }
+            buckets.clear();
+            outliers.clear();
+            return result;
+        }
+
+    private:
+        int64_t base = 0;
+        vector<HistoryBucket> buckets;
+        std::map<int64_t, HistoryBucket> outliers;
+    };
+
+    /**
+     * @brief Visits the buckets in order with the empty buckets between them filled in.
+     *
+     * A run of more than MAX_FILLED_GAP empty buckets, as left by an outlying
+     * timestamp, is passed to onBreak once instead.
+     */
+    template <typename OnBucket, typename OnBreak>
+    void forEachRow(const vector<HistoryBucket> &buckets, OnBucket onBucket, OnBreak onBreak)
+    {
+        for (size_t i = 0; i < buckets.size(); ++i) {
+            if (i > 0) {
+                const int64_t previous = buckets[i - 1].bucket;
+                if (buckets[i].bucket - previous - 1 > MAX_FILLED_GAP) {
+                    onBreak();
+                }
+                else {
+                    for (int64_t empty = previous + 1; empty < buckets[i].bucket; ++empty) {
+                        onBucket(HistoryBucket{empty, 0, 0});
+                    }
+                }
+            }
+            onBucket(buckets[i]);
+        }
+    }
+
+    /**
+     * @brief Formats the first day of a bucket: YYYY-MM-DD, or YYYY-MM for months.
+     */
+    string bucketLabel(int64_t bucket, HistoryGranularity granularity)
+    {
+        char buffer[48]; // Room for a 20-character year and two 10-digit fields
+        if (granularity == HistoryGranularity::Month) {
+            const int month = static_cast<int>(bucket - floorDiv(bucket, 12) * 12) + 1; // 1..12
+            std::snprintf(buffer, sizeof(buffer), "%04lld-%02d", static_cast<long long>(floorDiv(bucket, 12) + 1970), month);
+            return buffer;
+        }
+        int64_t days = granularity == HistoryGranularity::Week ? bucket * 7 - 3 : bucket;
+        int64_t year;
+        unsigned month, day;
+        civilFromDays(days, year, month, day);
+        std::snprintf(buffer, sizeof(buffer), "%04lld-%02u-%02u", static_cast<long long>(year), month, day);
+        return buffer;
+    }
+
+    /**
+     * @brief Writes one sparkline row, one block character per bucket scaled to the row maximum.
+     */
+    void writeSparkline(std::ostream &out, const char *label, const vector<HistoryBucket> &buckets,
+                        uint64_t HistoryBucket::*field)
+    {
+        static const char *const BARS[] = {"▁", "▂", "▃", "▄", "▅", "▆", "▇", "█"};
+        uint64_t max = 0, total = 0;
+        for (const auto &bucket : buckets) {
+            max = std::max(max, bucket.*field);
+            total += bucket.*field;
+        }
+        out << label;
+        forEachRow(
+            buckets,
+            [&](const HistoryBucket &bucket) {
+                uint64_t count = bucket.*field;
+                out << (count == 0 ? " " : BARS[count * 7 / max]);
+            },
+            [&] { out << "┆"; });
+        out << "  total " << total << " max " << max << '\n';
+    }
+}
+
+/**
+ * @brief Buckets creation and completion times in a single pass over the columns.
+ *
+ * The pass always counts per day, which needs only a division per timestamp;
+ * weeks and months are then folded from the daily counts, so the calendar
+ * conversion runs once per day rather than once per task.
+ *
+ * @param columns Columns of the tasks to report on.
+ * @param granularity Bucket size.
+ * @param from Inclusive lower bound on the timestamps counted.
+ * @param to Exclusive upper bound on the timestamps counted.
+ * @return Non-empty buckets in ascending order.
+ */
+vector<HistoryBucket> buildHistory(const TaskColumns &columns, HistoryGranularity granularity, int64_t from, int64_t to)
+{
+    BucketCounts daily;
+    for (size_t begin = 0; begin < columns.size(); begin += 64) {
+        const size_t end = std::min(begin + 64, columns.size());
+        for (size_t i = begin; i < end; ++i) {
+            const int64_t created = columns.createdTimes[i];
+            if (created >= from && created < to) {
+                ++daily.at(floorDiv(created, SECONDS_PER_DAY)).created;
+            }
+        }
+        // Visit only the done rows of the block instead of testing every bit.
+        for (uint64_t done = columns.doneBits[begin / 64]; done; done &= done - 1) {
+            const int64_t completed = columns.completedTimes[begin + lowestBit(done)];
+            if (completed >= from && completed < to) {
+                ++daily.at(floorDiv(completed, SECONDS_PER_DAY)).completed;
+            }
+        }
+    }
+    if (granularity == HistoryGranularity::Day) {
+        return daily.release();
+    }
+
+    BucketCounts folded;
+    for (const auto &day : daily.release()) {
+        if (day.created != 0 || day.completed != 0) {
+            HistoryBucket &bucket = folded.at(bucketOfDay(day.bucket, granularity));
+            bucket.created += day.created;
+            bucket.completed += day.completed;
+        }
+    }
+    return folded.release();
+}
+
+/**
+ * @brief Writes buckets as a report in the requested format.
+ *
+ * @param out Stream to write to.
+ * @param buckets Buckets returned by buildHistory.
+ * @param granularity Granularity the buckets were built with.
+ * @param format Output format.
+ */
+void writeHistory(std::ostream &out, const vector<HistoryBucket> &buckets, HistoryGranularity granularity, HistoryFormat format)
+{
+    if (format == HistoryFormat::Csv) {
+        out << "period,created,completed\n";
+        forEachRow(
+            buckets,
+            [&](const HistoryBucket &bucket) {
+                out << bucketLabel(bucket.bucket, granularity) << ',' << bucket.created << ',' << bucket.completed << '\n';
+            },
+            [] {});
+        return;
+    }
+
+    if (buckets.empty()) {
+        out << "No tasks in range.\n";
+        return;
+    }
+    out << bucketLabel(buckets.front().bucket, granularity) << " .. " << bucketLabel(buckets.back().bucket, granularity)
+        << " (" << buckets.size() << " buckets with tasks)\n";
+    writeSparkline(out, "created   ", buckets, &HistoryBucket::created);
+    writeSparkline(out, "completed ", buckets, &HistoryBucket::completed);
+}
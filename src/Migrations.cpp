@@ -0,0 +1,40 @@
+#include "Migrations.h"
+
+/**
+ * @brief Returns every migration in ascending version order.
+ *
+ * Database::createSchema creates new files directly at the latest version,
+ * so every change listed here must also be reflected there.
+ */
+const std::vector<Migration> &migrations()
+{
+    static const std::vector<Migration> list = {
+        {2,
+         "Add tasks.updatedTime",
+         {"ALTER TABLE tasks ADD COLUMN updatedTime INTEGER",
+          // Only user-visible columns are logged, so the backfill does not flood the change log
+          "DROP TRIGGER IF EXISTS task_changes_update",
+          "CREATE TRIGGER task_changes_update AFTER UPDATE OF description, done, createdTime, completedTime ON tasks BEGIN "
+          "INSERT INTO task_changes (taskId, op) VALUES (NEW.id, 'U'); END"},
+         "tasks",
+         "UPDATE tasks SET updatedTime = MAX(createdTime, completedTime) WHERE id > ?1 AND id <= ?2 AND updatedTime IS NULL"},
+        {3,
+         "Add tasks.dueTime",
+         {"ALTER TABLE tasks ADD COLUMN dueTime INTEGER",
+          // Due time changes are logged so every process reschedules its reminders
+          "DROP TRIGGER IF EXISTS task_changes_update",
+          "CREATE TRIGGER task_changes_update AFTER UPDATE OF description, done, createdTime, completedTime, dueTime ON tasks BEGIN "
+          "INSERT INTO task_changes (taskId, op) VALUES (NEW.id, 'U'); END"},
+         nullptr,
+         nullptr},
+    };
+    return list;
+}
+
+/**
+ * @brief Returns the version a fully migrated database has.
+ */
+int latestSchemaVersion()
+{
+    return migrations().empty() ? BASELINE_SCHEMA_VERSION : migrations().back().version;
+}
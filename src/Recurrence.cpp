@@ -0,0 +1,122 @@
+#include "Recurrence.h"
+#include <cctype>
+#include <sstream>
+
+using std::string;
+
+namespace
+{
+    string upper(const string &text)
+    {
+        string result;
+        result.reserve(text.size());
+        for (char c : text) {
+            result += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        }
+        return result;
+    }
+
+    bool parseFrequency(const string &name, Frequency &frequency)
+    {
+        if (name == "HOURLY") {
+            frequency = Frequency::Hourly;
+        }
+        else if (name == "DAILY") {
+            frequency = Frequency::Daily;
+        }
+        else if (name == "WEEKLY") {
+            frequency = Frequency::Weekly;
+        }
+        else {
+            return false;
+        }
+        return true;
+    }
+}
+
+/**
+ * @brief Parses a rule such as "FREQ=WEEKLY;INTERVAL=2" (case-insensitive).
+ *
+ * @param text Rule to parse.
+ * @param rule Set to the parsed rule on success.
+ * @return True if the text is a valid rule.
+ */
+bool parseRecurrenceRule(const string &text, RecurrenceRule &rule)
+{
+    const string normalized = upper(text);
+    RecurrenceRule parsed;
+    if (parseFrequency(normalized, parsed.frequency)) {
+        rule = parsed;
+        return true;
+    }
+
+    bool hasFrequency = false;
+    std::istringstream parts(normalized);
+    string part;
+    while (std::getline(parts, part, ';')) {
+        const size_t equals = part.find('=');
+        if (equals == string::npos) {
+            return false;
+        }
+        const string key = part.substr(0, equals);
+        const string value = part.substr(equals + 1);
+        if (key == "FREQ") {
+            if (!parseFrequency(value, parsed.frequency)) {
+                return false;
+            }
+            hasFrequency = true;
+        }
+        else if (key == "INTERVAL") {
+            if (value.empty() || value.size() > 6 || value.find_first_not_of("0123456789") != string::npos) {
+                return false;
+            }
+            parsed.interval = std::stoi(value);
+            if (parsed.interval < 1) {
+                return false;
+            }
+        }
+        else {
+            return false;
+        }
+    }
+    if (!hasFrequency) {
+        return false;
+    }
+    rule = parsed;
+    return true;
+}
+
+/**
+ * @brief Formats a rule in the form parseRecurrenceRule accepts.
+ */
+string formatRecurrenceRule(const RecurrenceRule &rule)
+{
+    const char *name = rule.frequency == Frequency::Hourly ? "HOURLY" : rule.frequency == Frequency::Weekly ? "WEEKLY" : "DAILY";
+    return string("FREQ=") + name + ";INTERVAL=" + std::to_string(rule.interval);
+}
+
+/**
+ * @brief Returns the length of a rule's period in seconds.
+ */
+int64_t recurrencePeriod(const RecurrenceRule &rule)
+{
+    const int64_t unit = rule.frequency == Frequency::Hourly ? 3600 : rule.frequency == Frequency::Weekly ? 7 * 86400 : 86400;
+    return unit * (rule.interval < 1 ? 1 : rule.interval);
+}
+
+/**
+ * @brief Returns the first occurrence after a time, counting periods from a start.
+ *
+ * @param rule Rule the occurrences follow.
+ * @param start An occurrence.
+ * @param after Time the result must be later than.
+ * @return The next occurrence.
+ */
+int64_t nextOccurrence(const RecurrenceRule &rule, int64_t start, int64_t after)
+{
+    if (start > after) {
+        return start;
+    }
+    const int64_t period = recurrencePeriod(rule);
+    return start + ((after - start) / period + 1) * period;
+}
@@ -0,0 +1,184 @@
+#include "Renderer.h"
+#include "ColorManager.hpp"
+#include <cstdio>
+#include <ctime>
+
+#ifdef _WIN32
+#include <io.h> // for _isatty
+#else
+#include <unistd.h> // for isatty
+#endif
+
+using std::string;
+
+namespace
+{
+    /**
+     * @brief Writes a timestamp as "YYYY-MM-DD HH:MM:SS" in local time.
+     */
+    void writeTime(std::ostream &out, time_t time)
+    {
+        char buffer[32];
+        std::tm tm{}; // Not std::localtime: its shared buffer races when server workers render in parallel
+#ifdef _WIN32
+        localtime_s(&tm, &time);
+#else
+        localtime_r(&time, &tm);
+#endif
+        size_t length = std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &tm);
+        out.write(buffer, static_cast<std::streamsize>(length));
+    }
+
+    /**
+     * @brief Writes a JSON string literal, escaping quotes, backslashes and control characters.
+     */
+    void writeJsonString(std::ostream &out, const string &value)
+    {
+        static const char hex[] = "0123456789abcdef";
+        out.put('"');
+        size_t start = 0;
+        for (size_t i = 0; i < value.size(); ++i) {
+            unsigned char c = static_cast<unsigned char>(value[i]);
+            if (c != '"' && c != '\\' && c >= 0x20) {
+                continue;
+            }
+            out.write(value.data() + start, static_cast<std::streamsize>(i - start));
+            start = i + 1;
+            switch (c) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\r': out << "\\r"; break;
+            case '\t': out << "\\t"; break;
+            default: out << "\\u00" << hex[c >> 4] << hex[c & 0xF];
+            }
+        }
+        out.write(value.data() + start, static_cast<std::streamsize>(value.size() - start));
+        out.put('"');
+    }
+}
+
+/**
+ * @brief Writes one task as plain text.
+ *
+ * @param out Stream to write to.
+ * @param task Task to render.
+ */
+void PlainRenderer::render(std::ostream &out, const Task &task) const
+{
+    out << task.getId() << ". " << task.getDescription() << (task.isDone() ? " [Done]" : " [Not Done]");
+    out << " (Created: ";
+    writeTime(out, task.getCreatedTime());
+    out << ')';
+    if (task.isDone()) {
+        out << " (Completed: ";
+        writeTime(out, task.getCompletedTime());
+        out << ')';
+    }
+    else if (task.getDueTime() != 0) {
+        out << " (Due: ";
+        writeTime(out, task.getDueTime());
+        out << ')';
+    }
+    out << '\n';
+}
+
+/**
+ * @brief Writes one task as colored text.
+ *
+ * ID and description are BLUE, the status GREEN or YELLOW, the timestamps GREEN
+ * and the due time of a pending task YELLOW.
+ *
+ * @param out Stream to write to.
+ * @param task Task to render.
+ */
+void AnsiRenderer::render(std::ostream &out, const Task &task) const
+{
+    out << Color::BLUE() << task.getId() << ". " << task.getDescription() << Color::RESET();
+    if (task.isDone()) {
+        out << Color::GREEN() << " [Done]" << Color::RESET();
+    }
+    else {
+        out << Color::YELLOW() << " [Not Done]" << Color::RESET();
+    }
+    out << " (Created: " << Color::GREEN();
+    writeTime(out, task.getCreatedTime());
+    out << Color::RESET() << ')';
+    if (task.isDone()) {
+        out << Color::GREEN() << " (Completed: ";
+        writeTime(out, task.getCompletedTime());
+        out << ')' << Color::RESET();
+    }
+    else if (task.getDueTime() != 0) {
+        out << Color::YELLOW() << " (Due: ";
+        writeTime(out, task.getDueTime());
+        out << ')' << Color::RESET();
+    }
+    out << '\n';
+}
+
+/**
+ * @brief Writes one task as a single JSON object line.
+ *
+ * @param out Stream to write to.
+ * @param task Task to render.
+ */
+void JsonLinesRenderer::render(std::ostream &out, const Task &task) const
+{
+    out << "{\"id\":" << task.getId() << ",\"description\":";
+    writeJsonString(out, task.getDescription());
+    out << ",\"done\":" << (task.isDone() ? "true" : "false")
+        << ",\"createdTime\":" << static_cast<long long>(task.getCreatedTime())
+        << ",\"completedTime\":" << static_cast<long long>(task.getCompletedTime())
+        << ",\"dueTime\":" << static_cast<long long>(task.getDueTime()) << "}\n";
+}
+
+/**
+ * @brief Creates the renderer for an output format.
+ *
+ * @param format Requested output format.
+ * @return Owning pointer to the renderer.
+ */
+std::unique_ptr<TaskRenderer> makeRenderer(OutputFormat format)
+{
+    switch (format) {
+    case OutputFormat::Ansi:
+        return std::make_unique<AnsiRenderer>();
+    case OutputFormat::JsonLines:
+        return std::make_unique<JsonLinesRenderer>();
+    case OutputFormat::Plain:
+    default:
+        return std::make_unique<PlainRenderer>();
+    }
+}
+
+/**
+ * @brief Picks ANSI colors for terminals and plain text for pipes and files.
+ *
+ * @return Default output format for standard output.
+ */
+OutputFormat detectOutputFormat()
+{
+#ifdef _WIN32
+    bool terminal = _isatty(_fileno(stdout)) != 0;
+#else
+    bool terminal = isatty(fileno(stdout)) != 0;
+#endif
+    return terminal ? OutputFormat::Ansi : OutputFormat::Plain;
+}
+
+/**
+ * @brief Parses a format name ("plain", "ansi" or "json").
+ *
+ * @param name Format name as given on the command line.
+ * @param format Receives the parsed format on success.
+ * @return True if the name was recognized.
+ */
+bool parseOutputFormat(const string &name, OutputFormat &format)
+{
+    if (name == "plain") format = OutputFormat::Plain;
+    else if (name == "ansi") format = OutputFormat::Ansi;
+    else if (name == "json") format = OutputFormat::JsonLines;
+    else return false;
+    return true;
+}
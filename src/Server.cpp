@@ -0,0 +1,495 @@
+#ifdef __linux__
+
+#include "Server.h"
+#include "Trace.h"
+#include <iostream>
+#include <sstream>
+#include <cstring>
+#include <stdexcept>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+
+using std::string;
+
+namespace
+{
+    constexpr int MAX_EVENTS = 256;              ///< Events fetched per epoll_wait call.
+    constexpr size_t MAX_REQUEST_SIZE = 1 << 16; ///< Longest request line accepted from a client.
+    constexpr size_t WORKER_THREADS = 8;         ///< Threads executing requests; writers serialize in TaskManager anyway.
+    constexpr size_t MAX_QUEUED_REQUESTS = 1024; ///< Requests waiting for a worker before new ones are refused.
+
+    /**
+     * @brief Parses the numeric argument of a request, throwing on garbage.
+     */
+    int parseId(const string &argument)
+    {
+        size_t end = 0;
+        int id = 0;
+        try {
+            id = std::stoi(argument, &end);
+        }
+        catch (const std::exception &) {
+            end = string::npos;
+        }
+        if (end != argument.size()) {
+            throw std::invalid_argument("invalid task id: " + argument);
+        }
+        return id;
+    }
+
+    /**
+     * @brief Escapes line breaks so a payload stays on one protocol line.
+     *
+     * An empty line ends a response, so a description or error message
+     * containing "\n\n" would otherwise cut it short.
+     */
+    string escapeLineBreaks(const string &text)
+    {
+        string escaped;
+        escaped.reserve(text.size());
+        for (char c : text) {
+            if (c == '\n') escaped += "\\n";
+            else if (c == '\r') escaped += "\\r";
+            else escaped += c;
+        }
+        return escaped;
+    }
+
+    /**
+     * @brief Renders one task as exactly one protocol line.
+     */
+    void renderLine(std::ostream &out, const TaskRenderer &renderer, const Task &task)
+    {
+        std::ostringstream record;
+        renderer.render(record, task);
+        string line = record.str();
+        if (!line.empty() && line.back() == '\n') line.pop_back();
+        out << escapeLineBreaks(line) << '\n';
+    }
+}
+
+/**
+ * @brief Creates the listening socket and the epoll instance.
+ *
+ * A stale socket file left behind by a crashed server is removed first.
+ *
+ * @param taskManager TaskManager that executes the requests.
+ * @param socketPath Filesystem path of the Unix domain socket.
+ */
+Server::Server(TaskManager &taskManager, const string &socketPath)
+    : taskManager(taskManager), socketPath(socketPath), listenFd(-1), epollFd(-1), wakeFd(-1), doneFd(-1), nextSerial(0),
+      stopping(false)
+{
+    sockaddr_un address{};
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Socket path too long: " + socketPath);
+    }
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) {
+        throw std::runtime_error(string("socket: ") + std::strerror(errno));
+    }
+    unlink(socketPath.c_str());
+    if (bind(listenFd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 ||
+        listen(listenFd, SOMAXCONN) < 0) {
+        int error = errno;
+        close(listenFd);
+        throw std::runtime_error(string("bind/listen: ") + std::strerror(error));
+    }
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    doneFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd < 0 || wakeFd < 0 || doneFd < 0) {
+        throw std::runtime_error(string("epoll/eventfd: ") + std::strerror(errno));
+    }
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = listenFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event);
+    event.data.fd = wakeFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+    event.data.fd = doneFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, doneFd, &event);
+
+    for (size_t i = 0; i < WORKER_THREADS; ++i) {
+        workers.emplace_back(&Server::runWorker, this);
+    }
+}
+
+/**
+ * @brief Stops the workers, closes all client connections and descriptors and
+ * removes the socket file.
+ *
+ * Requests still queued are dropped; those already executing are finished
+ * first, since their workers report to doneFd.
+ */
+Server::~Server()
+{
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueReady.notify_all();
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    for (const auto &entry : connections) {
+        close(entry.first);
+    }
+    if (doneFd >= 0) close(doneFd);
+    if (wakeFd >= 0) close(wakeFd);
+    if (epollFd >= 0) close(epollFd);
+    if (listenFd >= 0) close(listenFd);
+    unlink(socketPath.c_str());
+}
+
+/**
+ * @brief Runs the event loop until stop() is called.
+ *
+ * The loop only moves bytes: complete request lines are queued for the worker
+ * pool by dispatchRequest(), and their responses come back through doneFd.
+ * Requests of different connections may run concurrently; the TaskManager
+ * serializes the mutations itself.
+ */
+void Server::run()
+{
+    epoll_event events[MAX_EVENTS];
+    bool running = true;
+
+    while (running) {
+        int count = epoll_wait(epollFd, events, MAX_EVENTS, -1);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(string("epoll_wait: ") + std::strerror(errno));
+        }
+
+        for (int i = 0; i < count; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == wakeFd) {
+                running = false;
+            }
+            else if (fd == listenFd) {
+                acceptClients();
+            }
+            else if (fd == doneFd) {
+                deliverCompletions();
+            }
+            else if (!connections.count(fd)) {
+                continue; // Closed earlier in this batch
+            }
+            else if (events[i].events & (EPOLLHUP | EPOLLERR)) {
+                closeClient(fd);
+            }
+            else {
+                if (events[i].events & EPOLLIN) readClient(fd);
+                if ((events[i].events & EPOLLOUT) && connections.count(fd)) writeClient(fd);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Wakes the event loop and makes run() return.
+ *
+ * Only performs a write(2), so it may be called from a signal handler.
+ */
+void Server::stop()
+{
+    uint64_t one = 1;
+    ssize_t ignored = write(wakeFd, &one, sizeof(one));
+    (void)ignored;
+}
+
+/**
+ * @brief Accepts every pending connection on the listening socket.
+ */
+void Server::acceptClients()
+{
+    while (true) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                std::cerr << "Server error (accept): " << std::strerror(errno) << std::endl;
+            }
+            if (errno == EINTR) continue;
+            return;
+        }
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+        Connection connection;
+        connection.serial = nextSerial++;
+        connections.emplace(fd, std::move(connection));
+    }
+}
+
+/**
+ * @brief Reads from a client until a complete request line is buffered.
+ *
+ * Reading stops at the first newline, so a client pipelining requests is held
+ * back by its socket buffer rather than by server memory. A line that grows
+ * past MAX_REQUEST_SIZE without a newline closes the connection.
+ *
+ * @param fd Client socket descriptor.
+ */
+void Server::readClient(int fd)
+{
+    Connection &connection = connections[fd];
+    char buffer[4096];
+
+    while (connection.input.find('\n') == string::npos) {
+        ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+        if (received > 0) {
+            connection.input.append(buffer, static_cast<size_t>(received));
+            if (connection.input.size() > MAX_REQUEST_SIZE &&
+                connection.input.find('\n') > MAX_REQUEST_SIZE) {
+                closeClient(fd);
+                return;
+            }
+            continue;
+        }
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (received < 0 && errno == EINTR) continue;
+        connection.closing = true; // Orderly shutdown or hard error; answer what was already received
+        break;
+    }
+
+    dispatchRequest(fd);
+}
+
+/**
+ * @brief Queues the next buffered request line of a client for the worker pool.
+ *
+ * Does nothing while the client already has a request executing; the loop
+ * calls it again when that response is delivered. A request that finds the
+ * queue full is answered "ERR server busy" right away.
+ *
+ * @param fd Client socket descriptor.
+ */
+void Server::dispatchRequest(int fd)
+{
+    Connection &connection = connections[fd];
+    size_t newline;
+
+    while (!connection.busy && (newline = connection.input.find('\n')) != string::npos) {
+        if (newline > MAX_REQUEST_SIZE) {
+            closeClient(fd);
+            return;
+        }
+        string request = connection.input.substr(0, newline);
+        if (!request.empty() && request.back() == '\r') request.pop_back();
+        connection.input.erase(0, newline + 1);
+
+        std::unique_lock<std::mutex> lock(queueMutex);
+        if (queue.size() >= MAX_QUEUED_REQUESTS) {
+            lock.unlock();
+            connection.output += "ERR server busy\n\n";
+            continue;
+        }
+        queue.push_back(Job{fd, connection.serial, std::move(request)});
+        lock.unlock();
+        queueReady.notify_one();
+        connection.busy = true;
+    }
+
+    if (!connection.output.empty()) {
+        writeClient(fd);
+    }
+    else {
+        updateClient(fd);
+    }
+}
+
+/**
+ * @brief Appends the responses finished by workers to their connections.
+ *
+ * Responses for connections closed in the meantime are dropped; the serial
+ * keeps them from reaching a new client that reuses the descriptor.
+ */
+void Server::deliverCompletions()
+{
+    uint64_t count = 0;
+    ssize_t ignored = read(doneFd, &count, sizeof(count));
+    (void)ignored;
+
+    std::vector<Completion> finished;
+    {
+        std::lock_guard<std::mutex> lock(completedMutex);
+        finished.swap(completed);
+    }
+
+    for (auto &completion : finished) {
+        auto entry = connections.find(completion.fd);
+        if (entry == connections.end() || entry->second.serial != completion.serial) continue;
+        entry->second.output += completion.response;
+        entry->second.busy = false;
+        writeClient(completion.fd);
+        if (connections.count(completion.fd)) dispatchRequest(completion.fd);
+    }
+}
+
+/**
+ * @brief Executes queued requests until the Server is destroyed.
+ *
+ * Each response is handed back to the loop through completed and doneFd.
+ */
+void Server::runWorker()
+{
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueReady.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (stopping) return;
+            job = std::move(queue.front());
+            queue.pop_front();
+        }
+
+        string response = handleRequest(job.request);
+        {
+            std::lock_guard<std::mutex> lock(completedMutex);
+            completed.push_back(Completion{job.fd, job.serial, std::move(response)});
+        }
+        uint64_t one = 1;
+        ssize_t ignored = write(doneFd, &one, sizeof(one));
+        (void)ignored;
+    }
+}
+
+/**
+ * @brief Flushes as much pending output as the socket accepts.
+ *
+ * Interest in EPOLLOUT is only registered while output is left over.
+ *
+ * @param fd Client socket descriptor.
+ */
+void Server::writeClient(int fd)
+{
+    Connection &connection = connections[fd];
+    size_t written = 0;
+
+    while (written < connection.output.size()) {
+        ssize_t sent = ::send(fd, connection.output.data() + written, connection.output.size() - written, MSG_NOSIGNAL);
+        if (sent > 0) {
+            written += static_cast<size_t>(sent);
+            continue;
+        }
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        closeClient(fd);
+        return;
+    }
+    connection.output.erase(0, written);
+    updateClient(fd);
+}
+
+/**
+ * @brief Registers the events a client needs next, or closes it once it is done.
+ *
+ * EPOLLIN is only registered while the client has no request executing and
+ * has not shut down, EPOLLOUT only while output is left over.
+ *
+ * @param fd Client socket descriptor.
+ */
+void Server::updateClient(int fd)
+{
+    const Connection &connection = connections[fd];
+    if (connection.closing && !connection.busy && connection.output.empty() &&
+        connection.input.find('\n') == string::npos) {
+        closeClient(fd);
+        return;
+    }
+
+    epoll_event event{};
+    event.events = (connection.busy || connection.closing ? 0u : static_cast<uint32_t>(EPOLLIN)) |
+                   (connection.output.empty() ? 0u : static_cast<uint32_t>(EPOLLOUT));
+    event.data.fd = fd;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event);
+}
+
+/**
+ * @brief Unregisters and closes a client connection.
+ *
+ * @param fd Client socket descriptor.
+ */
+void Server::closeClient(int fd)
+{
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    connections.erase(fd);
+}
+
+/**
+ * @brief Executes one request line and builds its framed response.
+ *
+ * @param request Request line without the trailing newline.
+ * @return Status line, body lines and the terminating empty line.
+ */
+string Server::handleRequest(const string &request)
+{
+    TRACE_SCOPE("Server::handleRequest");
+    size_t space = request.find(' ');
+    string command = request.substr(0, space);
+    string argument = space == string::npos ? "" : request.substr(space + 1);
+    std::ostringstream body;
+
+    try {
+        if (command == "ADD" && !argument.empty()) {
+            taskManager.addTaskAsync(argument).get();
+        }
+        else if (command == "LIST") {
+            OutputFormat format = OutputFormat::Plain;
+            if (!argument.empty() && !parseOutputFormat(argument, format)) {
+                return "ERR unknown format: " + escapeLineBreaks(argument) + "\n\n";
+            }
+            auto renderer = makeRenderer(format);
+            taskManager.refreshAsync().get(); // Other processes may still write the file directly
+            taskManager.forEachTask([&](const Task &task) {
+                renderLine(body, *renderer, task);
+                return true;
+            });
+        }
+        else if (command == "FILTER") {
+            size_t separator = argument.find(' ');
+            string formatName = argument.substr(0, separator);
+            OutputFormat format = OutputFormat::Plain;
+            if (!parseOutputFormat(formatName, format)) {
+                return "ERR unknown format: " + escapeLineBreaks(formatName) + "\n\n";
+            }
+            auto renderer = makeRenderer(format);
+            for (const auto &task : taskManager.filterTasksAsync(separator == string::npos ? "" : argument.substr(separator + 1)).get()) {
+                renderLine(body, *renderer, task);
+            }
+        }
+        else if (command == "DONE") {
+            taskManager.markTaskDoneAsync(parseId(argument)).get();
+        }
+        else if (command == "DELETE") {
+            taskManager.deleteTaskAsync(parseId(argument)).get();
+        }
+        else if (command == "CLEAR") {
+            taskManager.clearAllDataAsync().get();
+        }
+        else {
+            return "ERR unknown request\n\n";
+        }
+    }
+    catch (const std::exception &e) {
+        return "ERR " + escapeLineBreaks(e.what()) + "\n\n";
+    }
+
+    return "OK\n" + body.str() + "\n";
+}
+
+#endif // __linux__
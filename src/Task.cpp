@@ -37,6 +37,18 @@ std::string Task::getDescription() const {
     return description;
 }
 
+/**
+ * @brief Retrieves the heap memory held by the description.
+ *
+ * Short descriptions live inside the string object (the small string
+ * optimization); longer ones own a buffer of capacity plus a terminator.
+ *
+ * @return Bytes allocated for the description, or 0 if it fits in the string itself.
+ */
+size_t Task::getDescriptionHeapBytes() const {
+    return description.capacity() > std::string().capacity() ? description.capacity() + 1 : 0;
+}
+
 /**
  * @brief Checks if the task is marked as done.
  *
@@ -80,3 +92,21 @@ time_t Task::getCompletedTime() const {
 void Task::setCompletedTime(time_t time) {
     completedTime = time;
 }
+
+/**
+ * @brief Retrieves the timestamp the task is due at.
+ *
+ * @return The due time of the task, or 0 if it has none.
+ */
+time_t Task::getDueTime() const {
+    return dueTime;
+}
+
+/**
+ * @brief Sets the due time of the task.
+ *
+ * @param time The due time to set, or 0 to clear it.
+ */
+void Task::setDueTime(time_t time) {
+    dueTime = time;
+}
@@ -0,0 +1,162 @@
+#include "TaskCache.h"
+#include "Trace.h"
+#include <algorithm> // for lower_bound
+#include <limits>
+#include <utility>   // for std::move
+
+using std::vector;
+
+/**
+ * @brief Creates an empty cache.
+ *
+ * @param db Database the pages are read from.
+ * @param budgetBytes Memory the resident pages may use.
+ * @param pageTasks Number of IDs covered by a page.
+ */
+TaskCache::TaskCache(Database &db, size_t budgetBytes, int pageTasks)
+    : database(db), budgetBytes(budgetBytes), pageTasks(std::max(pageTasks, 1))
+{
+}
+
+/**
+ * @brief Returns the task with the given ID, reading its page on a miss.
+ *
+ * The page is read without holding the lock, so lookups of resident pages
+ * never wait for the database. Two threads missing the same page may both
+ * read it; the second insert replaces the first.
+ *
+ * @param id Task ID.
+ * @return The task, or std::nullopt if it does not exist.
+ */
+std::optional<Task> TaskCache::find(int id)
+{
+    const int pageNumber = id / pageTasks;
+    Page page;
+    uint64_t readGeneration;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = pages.find(pageNumber);
+        if (it != pages.end()) {
+            recency.splice(recency.begin(), recency, it->second.position);
+            page = it->second.tasks;
+        }
+        readGeneration = generation;
+    }
+
+    if (page) {
+        hits.fetch_add(1, std::memory_order_relaxed);
+    }
+    else {
+        misses.fetch_add(1, std::memory_order_relaxed);
+        TRACE_SCOPE("TaskCache::load");
+        TaskQuery range;
+        range.idFrom = static_cast<int>(static_cast<int64_t>(pageNumber) * pageTasks);
+        range.idTo = static_cast<int>(std::min<int64_t>(static_cast<int64_t>(pageNumber + 1) * pageTasks,
+                                                         std::numeric_limits<int>::max()));
+        page = std::make_shared<const vector<Task>>(database.getTasksWhereAsync(range).get());
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (generation == readGeneration) {
+            insert(pageNumber, page); // Otherwise a writer committed meanwhile and the page may be stale
+        }
+    }
+
+    auto it = std::lower_bound(page->begin(), page->end(), id,
+                               [](const Task &task, int value) { return task.getId() < value; });
+    if (it == page->end() || it->getId() != id) {
+        return std::nullopt;
+    }
+    return *it;
+}
+
+/**
+ * @brief Drops the pages holding any of the given IDs.
+ *
+ * @param ids IDs of tasks that were inserted, updated or deleted.
+ */
+void TaskCache::invalidate(const vector<int> &ids)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    ++generation;
+    for (int id : ids) {
+        auto it = pages.find(id / pageTasks);
+        if (it != pages.end()) {
+            bytes -= it->second.bytes;
+            recency.erase(it->second.position);
+            pages.erase(it);
+        }
+    }
+}
+
+/**
+ * @brief Drops every page.
+ */
+void TaskCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    ++generation;
+    pages.clear();
+    recency.clear();
+    bytes = 0;
+}
+
+/**
+ * @brief Returns the hit, miss and eviction counts and the current size.
+ */
+TaskCacheStats TaskCache::stats() const
+{
+    TaskCacheStats result;
+    result.hits = hits.load(std::memory_order_relaxed);
+    result.misses = misses.load(std::memory_order_relaxed);
+    result.evictions = evictions.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mutex);
+    result.bytes = bytes;
+    result.pages = pages.size();
+    return result;
+}
+
+/**
+ * @brief Estimates the memory a task takes in a page.
+ *
+ * Descriptions that do not fit the string's inline buffer add their
+ * heap allocation.
+ */
+size_t TaskCache::taskBytes(const Task &task)
+{
+    return sizeof(Task) + task.getDescriptionHeapBytes();
+}
+
+/**
+ * @brief Inserts a freshly read page and evicts until the budget holds.
+ *
+ * A page larger than the whole budget is evicted at once; its caller still
+ * gets the tasks it read. Caller must hold mutex.
+ *
+ * @param pageNumber Page to insert.
+ * @param tasks Tasks of the page.
+ */
+void TaskCache::insert(int pageNumber, Page tasks)
+{
+    size_t pageBytes = sizeof(Entry) + sizeof(vector<Task>);
+    for (const Task &task : *tasks) {
+        pageBytes += taskBytes(task);
+    }
+
+    auto it = pages.find(pageNumber);
+    if (it != pages.end()) {
+        bytes -= it->second.bytes;
+        recency.erase(it->second.position);
+        pages.erase(it);
+    }
+    recency.push_front(pageNumber);
+    pages.emplace(pageNumber, Entry{std::move(tasks), pageBytes, recency.begin()});
+    bytes += pageBytes;
+
+    while (bytes > budgetBytes && !recency.empty()) {
+        auto victim = pages.find(recency.back());
+        bytes -= victim->second.bytes;
+        pages.erase(victim);
+        recency.pop_back();
+        evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+}
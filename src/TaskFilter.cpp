@@ -0,0 +1,364 @@
+#include "TaskFilter.h"
+#include <cctype>
+#include <ctime>     // For std::mktime
+#include <stdexcept> // For std::invalid_argument
+
+using std::string;
+
+namespace
+{
+    constexpr int MAX_DEPTH = 64; ///< Nesting of parentheses and 'not' accepted, to bound the recursion.
+
+    /// Stands for the done column until its conjunction is complete; see Compiler::parseAnd.
+    constexpr const char *DONE_COLUMN = "{done}";
+
+    enum class TokenKind { Word, String, Operator, Open, Close, End };
+
+    struct Token {
+        TokenKind kind = TokenKind::End;
+        string text;       ///< Word, unescaped string or operator.
+        size_t offset = 0; ///< Position in the expression, for errors.
+    };
+
+    /**
+     * @brief Splits an expression into words, strings, operators and parentheses.
+     */
+    std::vector<Token> tokenize(const string &expression)
+    {
+        std::vector<Token> tokens;
+        size_t i = 0;
+        while (i < expression.size()) {
+            const unsigned char c = static_cast<unsigned char>(expression[i]);
+            Token token;
+            token.offset = i;
+            if (std::isspace(c)) {
+                ++i;
+                continue;
+            }
+            if (c == '(' || c == ')') {
+                token.kind = c == '(' ? TokenKind::Open : TokenKind::Close;
+                ++i;
+            }
+            else if (c == '=' || c == '~') {
+                token.kind = TokenKind::Operator;
+                token.text = string(1, static_cast<char>(c));
+                ++i;
+            }
+            else if (c == '!' || c == '<' || c == '>') {
+                token.kind = TokenKind::Operator;
+                token.text = string(1, static_cast<char>(c));
+                ++i;
+                if (i < expression.size() && expression[i] == '=') {
+                    token.text += '=';
+                    ++i;
+                }
+                else if (c == '!') {
+                    throw std::invalid_argument("filter: expected '=' after '!' at offset " + std::to_string(i));
+                }
+            }
+            else if (c == '"') {
+                token.kind = TokenKind::String;
+                ++i;
+                while (i < expression.size() && expression[i] != '"') {
+                    if (expression[i] == '\\' && i + 1 < expression.size()) {
+                        ++i;
+                    }
+                    token.text += expression[i++];
+                }
+                if (i == expression.size()) {
+                    throw std::invalid_argument("filter: unterminated string at offset " + std::to_string(token.offset));
+                }
+                ++i;
+            }
+            else {
+                token.kind = TokenKind::Word;
+                while (i < expression.size()) {
+                    const unsigned char w = static_cast<unsigned char>(expression[i]);
+                    if (std::isspace(w) || w == '(' || w == ')' || w == '"' || w == '=' || w == '~' || w == '!' ||
+                        w == '<' || w == '>') {
+                        break;
+                    }
+                    token.text += static_cast<char>(w);
+                    ++i;
+                }
+            }
+            tokens.push_back(std::move(token));
+        }
+        Token end;
+        end.offset = expression.size();
+        tokens.push_back(end);
+        return tokens;
+    }
+
+    string lower(const string &text)
+    {
+        string result;
+        result.reserve(text.size());
+        for (char c : text) {
+            result += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        return result;
+    }
+
+    /**
+     * @brief Parses the digits of text[begin, begin + count) into value.
+     */
+    bool parseDigits(const string &text, size_t begin, size_t count, int &value)
+    {
+        if (begin + count > text.size()) {
+            return false;
+        }
+        value = 0;
+        for (size_t i = begin; i < begin + count; ++i) {
+            if (!std::isdigit(static_cast<unsigned char>(text[i]))) {
+                return false;
+            }
+            value = value * 10 + (text[i] - '0');
+        }
+        return true;
+    }
+
+    /**
+     * @brief Parses a local date "YYYY-MM-DD", optionally followed by "THH:MM".
+     */
+    bool parseDate(const string &text, int64_t &time)
+    {
+        std::tm parts{};
+        int year, month, day, hour = 0, minute = 0;
+        if (!parseDigits(text, 0, 4, year) || text.size() < 10 || text[4] != '-' || !parseDigits(text, 5, 2, month) ||
+            text[7] != '-' || !parseDigits(text, 8, 2, day)) {
+            return false;
+        }
+        if (text.size() != 10 && (text.size() != 16 || (text[10] != 'T' && text[10] != 't') ||
+                                  !parseDigits(text, 11, 2, hour) || text[13] != ':' || !parseDigits(text, 14, 2, minute))) {
+            return false;
+        }
+        if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59) {
+            return false;
+        }
+        parts.tm_year = year - 1900;
+        parts.tm_mon = month - 1;
+        parts.tm_mday = day;
+        parts.tm_hour = hour;
+        parts.tm_min = minute;
+        parts.tm_isdst = -1; // Let mktime decide whether daylight saving applies
+        const std::time_t result = std::mktime(&parts);
+        if (result == static_cast<std::time_t>(-1)) {
+            return false;
+        }
+        time = static_cast<int64_t>(result);
+        return true;
+    }
+
+    bool parseInteger(const string &text, int64_t &value)
+    {
+        size_t used = 0;
+        try {
+            value = std::stoll(text, &used);
+        }
+        catch (const std::exception &) {
+            return false;
+        }
+        return used == text.size();
+    }
+
+    /**
+     * @brief Escapes LIKE wildcards so a text is matched literally, with '\' as the escape.
+     */
+    string likeContaining(const string &text)
+    {
+        string pattern = "%";
+        for (char c : text) {
+            if (c == '%' || c == '_' || c == '\\') {
+                pattern += '\\';
+            }
+            pattern += c;
+        }
+        return pattern + "%";
+    }
+
+    /**
+     * @brief Recursive-descent parser that emits SQL while it reads.
+     *
+     * or := and ('or' and)*, and := unary ('and' unary)*,
+     * unary := 'not' unary | '(' or ')' | field operator value.
+     */
+    class Compiler {
+    public:
+        explicit Compiler(const string &expression) : tokens(tokenize(expression)) {}
+
+        CompiledFilter compile()
+        {
+            CompiledFilter filter;
+            if (peek().kind == TokenKind::End) {
+                filter.condition = "1";
+                return filter;
+            }
+            filter.condition = parseOr(0);
+            if (peek().kind != TokenKind::End) {
+                fail("expected 'and', 'or' or the end");
+            }
+            // Comparisons directly under 'not' belong to no conjunction
+            for (size_t at; (at = filter.condition.find(DONE_COLUMN)) != string::npos;) {
+                filter.condition.replace(at, std::char_traits<char>::length(DONE_COLUMN), "+done");
+            }
+            filter.parameters = std::move(parameters);
+            return filter;
+        }
+
+    private:
+        const Token &peek() const { return tokens[position]; }
+
+        const Token &next() { return tokens[position < tokens.size() - 1 ? position++ : position]; }
+
+        bool keyword(const char *word) const
+        {
+            return peek().kind == TokenKind::Word && lower(peek().text) == word;
+        }
+
+        [[noreturn]] void fail(const string &message) const
+        {
+            throw std::invalid_argument("filter: " + message + " at offset " + std::to_string(peek().offset));
+        }
+
+        string parseOr(int depth)
+        {
+            string condition = parseAnd(depth);
+            bool combined = false;
+            while (keyword("or")) {
+                next();
+                condition += " OR " + parseAnd(depth);
+                combined = true;
+            }
+            return combined ? "(" + condition + ")" : condition;
+        }
+
+        /**
+         * @brief Parses a conjunction and decides how its done comparisons use the index.
+         *
+         * done has two values, so on its own the (done, completedTime) index
+         * would only be scanned through half the table, and SQLite would pick
+         * it over an ID range of the primary key. done is therefore written
+         * as +done, which keeps it off the index, unless the same conjunction
+         * also compares completed.
+         */
+        string parseAnd(int depth)
+        {
+            std::vector<string> terms{parseUnary(depth)};
+            while (keyword("and")) {
+                next();
+                terms.push_back(parseUnary(depth));
+            }
+            bool completedBound = false;
+            for (const string &term : terms) {
+                completedBound = completedBound || term.compare(0, 14, "completedTime ") == 0;
+            }
+            string condition;
+            for (string &term : terms) {
+                if (term.compare(0, std::char_traits<char>::length(DONE_COLUMN), DONE_COLUMN) == 0) {
+                    term.replace(0, std::char_traits<char>::length(DONE_COLUMN), completedBound ? "done" : "+done");
+                }
+                condition += condition.empty() ? term : " AND " + term;
+            }
+            return condition;
+        }
+
+        string parseUnary(int depth)
+        {
+            if (depth >= MAX_DEPTH) {
+                fail("expression nested too deeply");
+            }
+            if (keyword("not")) {
+                next();
+                return "NOT (" + parseUnary(depth + 1) + ")";
+            }
+            if (peek().kind == TokenKind::Open) {
+                next();
+                string condition = parseOr(depth + 1);
+                if (peek().kind != TokenKind::Close) {
+                    fail("expected ')'");
+                }
+                next();
+                return "(" + condition + ")";
+            }
+            return parseComparison();
+        }
+
+        string parseComparison()
+        {
+            if (peek().kind != TokenKind::Word) {
+                fail("expected a field");
+            }
+            const string field = lower(peek().text);
+            const char *column = field == "id"          ? "id"
+                                 : field == "done"      ? DONE_COLUMN
+                                 : field == "created"   ? "createdTime"
+                                 : field == "completed" ? "completedTime"
+                                 : field == "due"       ? "COALESCE(dueTime, 0)" // No due time compares as 0
+                                                        : nullptr;
+            if (!column && field != "text" && field != "tag") {
+                fail("unknown field '" + peek().text + "'");
+            }
+            next();
+
+            if (peek().kind != TokenKind::Operator) {
+                fail("expected an operator");
+            }
+            const string op = peek().text;
+            if (column ? op == "~" : (op != "=" && op != "!=" && op != "~")) {
+                fail("operator '" + op + "' does not apply to " + field);
+            }
+            next();
+
+            if (peek().kind != TokenKind::Word && peek().kind != TokenKind::String) {
+                fail("expected a value");
+            }
+            const Token &value = peek();
+            const string sqlOp = op == "!=" ? "<>" : op;
+            string condition;
+            if (column) {
+                int64_t number;
+                const bool isTime = field == "created" || field == "completed" || field == "due";
+                if (value.kind != TokenKind::Word ||
+                    !(parseInteger(value.text, number) || (isTime && parseDate(value.text, number)))) {
+                    fail(isTime ? "expected an integer or a date YYYY-MM-DD[THH:MM]" : "expected an integer");
+                }
+                parameters.emplace_back(number);
+                condition = string(column) + " " + sqlOp + " ?";
+            }
+            else if (field == "text") {
+                parameters.emplace_back(op == "~" ? likeContaining(value.text) : value.text);
+                condition = op == "~" ? "description LIKE ? ESCAPE '\\'" : "description " + sqlOp + " ?";
+            }
+            else {
+                parameters.emplace_back(op == "~" ? likeContaining(value.text) : value.text);
+                condition = op == "~" ? "id IN (SELECT taskId FROM task_tags WHERE tagId IN "
+                                        "(SELECT id FROM tags WHERE name LIKE ? ESCAPE '\\'))"
+                                      : string(op == "!=" ? "id NOT IN" : "id IN") +
+                                            " (SELECT taskId FROM task_tags WHERE tagId = (SELECT id FROM tags WHERE name = ?))";
+            }
+            next();
+            return condition;
+        }
+
+        std::vector<Token> tokens;
+        size_t position = 0;
+        std::vector<FilterValue> parameters;
+    };
+}
+
+/**
+ * @brief Compiles a filter expression into a WHERE condition over 'tasks' and its parameters.
+ *
+ * The expression is read once, left to right, and the condition is emitted
+ * as it is parsed. Comparisons are kept sargable: the column stands alone on
+ * the left and the constant is a parameter.
+ *
+ * @param expression Expression to compile; an empty one matches every task.
+ * @return The condition and its parameters.
+ * @throws std::invalid_argument if the expression is malformed, naming the offset.
+ */
+CompiledFilter compileFilter(const string &expression)
+{
+    return Compiler(expression).compile();
+}
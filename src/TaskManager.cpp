@@ -1,47 +1,116 @@
 #include "TaskManager.h"
-#include "ColorManager.hpp" // Include ColorManager.hpp for terminal colors
+#include "Trace.h"
 #include <iostream>
-#include <iomanip> // for put_time
 #include <ctime>
+#include <algorithm> // for lower_bound, set_difference, set_intersection
+#include <iterator>  // for back_inserter
 #include <future> // Add <future> header for std::async and std::launch
+#include <stdexcept> // for std::logic_error
+#include <limits>
+#include <chrono> // for std::chrono::system_clock
 
 using std::async;
 using std::future;
 using std::launch;
 using std::string;
 
+namespace
+{
+    /**
+     * @brief Finds a task in a snapshot by binary search on its ID.
+     *
+     * @return Pointer to the task, or nullptr if it is not cached.
+     */
+    const Task *findTask(const TaskSnapshot &snapshot, int id)
+    {
+        auto it = std::lower_bound(snapshot.tasks.begin(), snapshot.tasks.end(), id,
+                                   [](const Task &task, int value) { return task.getId() < value; });
+        return it != snapshot.tasks.end() && it->getId() == id ? &*it : nullptr;
+    }
+
+    /// Rows per statement when tasks are streamed from the database.
+    constexpr size_t STREAM_BATCH = 4096;
+
+    /// Changes kept in the undo log; older ones can no longer be undone.
+    constexpr size_t UNDO_ENTRIES = 32;
+
+    /**
+     * @brief Returns a filter selecting a single task.
+     */
+    TaskQuery taskById(int id)
+    {
+        TaskQuery filter;
+        filter.idFrom = id;
+        filter.idTo = id == std::numeric_limits<int>::max() ? id : id + 1;
+        return filter;
+    }
+
+    /**
+     * @brief Adds the buckets of one batch of tasks to a running total.
+     */
+    void addHistory(std::map<int64_t, HistoryBucket> &total, const vector<HistoryBucket> &buckets)
+    {
+        for (const HistoryBucket &bucket : buckets) {
+            HistoryBucket &sum = total[bucket.bucket];
+            sum.bucket = bucket.bucket;
+            sum.created += bucket.created;
+            sum.completed += bucket.completed;
+        }
+    }
+}
+
 /**
  * @brief Constructor to initialize TaskManager with a reference to the Database.
  *
  * @param db Reference to the Database object.
+ * @param cacheBudget Memory in bytes for a paged task cache, or 0 to hold every task.
  */
-TaskManager::TaskManager(Database &db) : database(db)
+TaskManager::TaskManager(Database &db, size_t cacheBudget)
+    : database(db), cache(cacheBudget > 0 ? std::make_unique<TaskCache>(db, cacheBudget) : nullptr),
+      current(std::make_shared<const TaskSnapshot>()), renderer(makeRenderer(OutputFormat::Ansi)),
+      reminders(std::time(nullptr))
 {
-    auto futureTasks = database.getTasksAsync();
-    futureTasks.wait();
-    tasks = futureTasks.get();
+    std::lock_guard<std::mutex> lock(writeMutex);
+    // Read before loading, so a commit by a background job racing with the load still triggers a refresh
+    lastDataVersion = database.getDataVersionAsync().get();
+    reloadTasks();
+    loadRecurrences();
+    if (!isReadOnly() && materializeDue(std::time(nullptr)) > 0) {
+        syncChanges();
+    }
+}
+
+/**
+ * @brief Stops the reminder thread, if started, and drops the stashes kept for undo.
+ */
+TaskManager::~TaskManager()
+{
+    stopReminders();
+    std::lock_guard<std::mutex> lock(writeMutex);
+    discardUndoLog();
 }
 
 /**
  * @brief Asynchronous addition of a new task with the given description.
  *
- * Adds a new task to the database asynchronously using the Database object and updates the internal tasks list.
+ * Adds a new task to the database asynchronously using the Database object and publishes a new snapshot of the tasks.
  *
  * @param description Description of the task to be added.
  * @return Future object for the add task operation.
  */
 future<void> TaskManager::addTaskAsync(const string &description)
 {
-    return async(launch::async, [this, description]()
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, description, enqueued]()
                  {
+        TRACE_ASYNC_SCOPE("TaskManager::addTaskAsync", enqueued);
         try {
-            // Add task asynchronously
-            auto future = database.addTaskAsync(description);
-            future.wait(); // Wait for the asynchronous operation to complete
-            // Update tasks asynchronously after addition
-            auto futureTasks = database.getTasksAsync();
-            futureTasks.wait();
-            tasks = futureTasks.get();
+            checkWritable();
+            std::lock_guard<std::mutex> lock(writeMutex);
+            const int id = database.addTaskAsync(description).get();
+            // Publish the changed rows only after addition
+            syncChanges();
+            recordUndo({UndoEntry::Kind::Add, "add task " + std::to_string(id), id, {}, 0});
         }
         catch (const std::exception &e) {
             std::cerr << "Error adding task asynchronously: " << e.what() << std::endl;
@@ -52,46 +121,31 @@ future<void> TaskManager::addTaskAsync(const string &description)
 /**
  * @brief Asynchronous listing of all tasks with their IDs, descriptions, status (done or not done), and timestamps.
  *
- * Lists all tasks from the internal tasks list asynchronously. Uses ColorManager to display colored output.
- * Prints the task ID, description, status (done or not done), creation time, and if done, completion time.
- * Created time is displayed in BLUE, completed time (if applicable) is displayed in GREEN.
+ * Lists all tasks from the current snapshot asynchronously using the configured
+ * TaskRenderer (plain text, ANSI colors or JSON Lines). Tasks are streamed to
+ * stdout one at a time.
  *
  * @return Future object for the list tasks operation.
  */
 future<void> TaskManager::listTasksAsync() const
 {
-    return async(launch::async, [this]()
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, enqueued]()
                  {
+        TRACE_ASYNC_SCOPE("TaskManager::listTasksAsync", enqueued);
         try {
-            auto futureTasks = database.getTasksAsync();
-            futureTasks.wait();
-            auto tasks = futureTasks.get();
-
-            for (const auto &task : tasks) {
-                // Using BLUE for task ID and description
-                std::cout << Color::BLUE() << task.getId() << ". " << task.getDescription() << Color::RESET();
-
-                // Using GREEN for done tasks and YELLOW for not done tasks
-                if (task.isDone()) {
-                    std::cout << Color::GREEN() << " [Done]" << Color::RESET();
-                }
-                else {
-                    std::cout << Color::YELLOW() << " [Not Done]" << Color::RESET();
-                }
+            // Render from a snapshot, or batches with a cache budget, so listing never waits for writers
+            auto activeRenderer = std::atomic_load(&renderer);
 
-                // Display creation time
-                std::time_t createdTime = task.getCreatedTime();
-                std::tm created_tm = *std::localtime(&createdTime);
-                std::cout << " (Created: " << Color::GREEN() << std::put_time(&created_tm, "%Y-%m-%d %H:%M:%S") << Color::RESET();
-
-                // Display completion time if task is done
-                if (task.isDone()) {
-                    std::time_t completedTime = task.getCompletedTime();
-                    std::tm completed_tm = *std::localtime(&completedTime);
-                    std::cout << Color::GREEN() << " (Completed: " << std::put_time(&completed_tm, "%Y-%m-%d %H:%M:%S") << ")" << Color::RESET();
-                }
-        std::cout << '\n';
-            }
+            Trace::Scope render("TaskManager::render");
+            int64_t rendered = 0;
+            forEachTask([&](const Task &task) {
+                activeRenderer->render(std::cout, task);
+                ++rendered;
+                return true;
+            });
+            render.arg("tasks", rendered);
+            std::cout.flush();
         }
         catch (const std::exception &e) {
             std::cerr << "Error listing tasks asynchronously: " << e.what() << std::endl;
@@ -102,23 +156,34 @@ future<void> TaskManager::listTasksAsync() const
 /**
  * @brief Asynchronous marking of a task as done using its ID.
  *
- * Marks a task as done in the database asynchronously using the Database object and updates the internal tasks list.
+ * Marks a task as done in the database asynchronously using the Database object and publishes a new snapshot of the tasks.
  *
  * @param id ID of the task to be marked as done.
  * @return Future object for the mark task done operation.
  */
 future<void> TaskManager::markTaskDoneAsync(int id)
 {
-    return async(launch::async, [this, id]()
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, id, enqueued]()
                  {
+        TRACE_ASYNC_SCOPE("TaskManager::markTaskDoneAsync", enqueued);
         try {
+            checkWritable();
+            std::lock_guard<std::mutex> lock(writeMutex);
+            std::optional<Task> before = getTask(id);
             // Mark task as done asynchronously
             auto future = database.markTaskDoneAsync(id);
             future.wait(); // Wait for the asynchronous operation to complete
-            // Update tasks asynchronously after marking as done
-            auto futureTasks = database.getTasksAsync();
-            futureTasks.wait();
-            tasks = futureTasks.get();
+            if (recurringTasks.count(id)) {
+                // The template was released; its next window may already have arrived
+                loadRecurrences();
+                materializeDue(std::time(nullptr));
+            }
+            // Publish the changed rows only after marking as done
+            syncChanges();
+            if (before && !before->isDone()) {
+                recordUndo({UndoEntry::Kind::Done, "complete task " + std::to_string(id), id, {}, 0});
+            }
         }
         catch (const std::exception &e) {
             std::cerr << "Error marking task as done asynchronously: " << e.what() << std::endl;
@@ -129,23 +194,31 @@ future<void> TaskManager::markTaskDoneAsync(int id)
 /**
  * @brief Asynchronous deletion of a task using its ID.
  *
- * Deletes a task from the database asynchronously using the Database object and updates the internal tasks list.
+ * Deletes a task from the database asynchronously using the Database object and publishes a new snapshot of the tasks.
  *
  * @param id ID of the task to be deleted.
  * @return Future object for the delete task operation.
  */
 future<void> TaskManager::deleteTaskAsync(int id)
 {
-    return async(launch::async, [this, id]()
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, id, enqueued]()
                  {
+        TRACE_ASYNC_SCOPE("TaskManager::deleteTaskAsync", enqueued);
         try {
-            // Delete task asynchronously
-            auto future = database.deleteTaskAsync(id);
-            future.wait(); // Wait for the asynchronous operation to complete
-            // Update tasks asynchronously after deletion
-            auto futureTasks = database.getTasksAsync();
-            futureTasks.wait();
-            tasks = futureTasks.get();
+            checkWritable();
+            std::lock_guard<std::mutex> lock(writeMutex);
+            // Keep the row, its tags and its edges so the deletion can be undone
+            vector<TaskRecord> records = database.takeTasksAsync(taskById(id)).get();
+            if (recurringTasks.count(id)) {
+                loadRecurrences();
+                materializeDue(std::time(nullptr));
+            }
+            // Publish the changed rows only after deletion
+            syncChanges();
+            if (!records.empty()) {
+                recordUndo({UndoEntry::Kind::Delete, "delete task " + std::to_string(id), id, std::move(records), 0});
+            }
         }
         catch (const std::exception &e) {
             std::cerr << "Error deleting task asynchronously: " << e.what() << std::endl;
@@ -154,26 +227,1716 @@ future<void> TaskManager::deleteTaskAsync(int id)
 }
 
 /**
- * @brief Asynchronous clearing of all tasks from the database and reset of the internal tasks list.
+ * @brief Asynchronous deletion of every task matching a filter.
+ *
+ * @param filter Tasks to delete.
+ * @return Future object containing the number of tasks deleted.
+ */
+future<int> TaskManager::deleteWhereAsync(const TaskQuery &filter)
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, filter, enqueued]() -> int
+                 {
+        TRACE_ASYNC_SCOPE("TaskManager::deleteWhereAsync", enqueued);
+        try {
+            checkWritable();
+            std::lock_guard<std::mutex> lock(writeMutex);
+            int deleted = database.deleteWhereAsync(filter).get();
+            if (deleted > 0 && !recurringTasks.empty()) {
+                loadRecurrences(); // Some of them may have been open recurring tasks
+                materializeDue(std::time(nullptr));
+            }
+            syncChanges();
+            return deleted;
+        }
+        catch (const std::exception &e) {
+            std::cerr << "Error deleting tasks by filter asynchronously: " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Asynchronous completion of every pending task matching a filter.
+ *
+ * @param filter Tasks to complete.
+ * @return Future object containing the number of tasks marked done.
+ */
+future<int> TaskManager::markDoneWhereAsync(const TaskQuery &filter)
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, filter, enqueued]() -> int
+                 {
+        TRACE_ASYNC_SCOPE("TaskManager::markDoneWhereAsync", enqueued);
+        try {
+            checkWritable();
+            std::lock_guard<std::mutex> lock(writeMutex);
+            int completed = database.markDoneWhereAsync(filter).get();
+            if (completed > 0 && !recurringTasks.empty()) {
+                loadRecurrences();
+                materializeDue(std::time(nullptr));
+            }
+            syncChanges();
+            return completed;
+        }
+        catch (const std::exception &e) {
+            std::cerr << "Error marking tasks done by filter asynchronously: " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Asynchronous clearing of all tasks from the database and publication of an empty snapshot.
  *
- * Deletes all tasks from the database using the Database object asynchronously and clears the internal tasks list.
+ * Deletes all tasks from the database using the Database object asynchronously and publishes a new snapshot of the tasks.
  *
  * @return Future object for the clear all data operation.
  */
 future<void> TaskManager::clearAllDataAsync()
 {
-    return async(launch::async, [this]()
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, enqueued]()
                  {
+        TRACE_ASYNC_SCOPE("TaskManager::clearAllDataAsync", enqueued);
         try {
-            auto future = database.clearAllDataAsync();
-            future.wait(); // Wait for the asynchronous operation to complete
-            // Update tasks asynchronously after clearing all data
-            auto futureTasks = database.getTasksAsync();
-            futureTasks.wait();
-            tasks = futureTasks.get();
+            checkWritable();
+            std::lock_guard<std::mutex> lock(writeMutex);
+            // Stashing renames the tables instead of dropping them, so undoing is as cheap as clearing
+            const int stash = database.stashAllDataAsync().get();
+            // Publish a new snapshot after clearing all data
+            reloadTasks();
+            loadRecurrences();
+            recordUndo({UndoEntry::Kind::Clear, "clear all data", 0, {}, stash});
         }
         catch (const std::exception &e) {
             std::cerr << "Error clearing all data asynchronously: " << e.what() << std::endl;
             throw; // Rethrow the exception to propagate it further
         } });
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Asynchronously reverts the latest undoable change.
+ *
+ * If the change fails to revert, the whole log is dropped: the older entries
+ * assume it was reverted first.
+ *
+ * @return Future object holding what was undone, or an empty string.
+ */
+future<string> TaskManager::undoAsync()
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, enqueued]() -> string
+                 {
+        TRACE_ASYNC_SCOPE("TaskManager::undoAsync", enqueued);
+        try {
+            checkWritable();
+            std::lock_guard<std::mutex> lock(writeMutex);
+            if (undoLog.empty()) {
+                return string();
+            }
+            UndoEntry entry = std::move(undoLog.back());
+            undoLog.pop_back();
+            try {
+                applyUndo(entry, true);
+            }
+            catch (...) {
+                discardUndo(entry);
+                discardUndoLog();
+                throw;
+            }
+            redoLog.push_back(std::move(entry));
+            return redoLog.back().label;
+        }
+        catch (const std::exception &e) {
+            std::cerr << "Error undoing asynchronously: " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Asynchronously reapplies the latest undone change.
+ *
+ * @return Future object holding what was redone, or an empty string.
+ */
+future<string> TaskManager::redoAsync()
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, enqueued]() -> string
+                 {
+        TRACE_ASYNC_SCOPE("TaskManager::redoAsync", enqueued);
+        try {
+            checkWritable();
+            std::lock_guard<std::mutex> lock(writeMutex);
+            if (redoLog.empty()) {
+                return string();
+            }
+            UndoEntry entry = std::move(redoLog.back());
+            redoLog.pop_back();
+            applyUndo(entry, false);
+            undoLog.push_back(std::move(entry));
+            const string label = undoLog.back().label;
+            if (undoLog.size() > UNDO_ENTRIES) {
+                discardUndo(undoLog.front());
+                undoLog.pop_front();
+            }
+            return label;
+        }
+        catch (const std::exception &e) {
+            std::cerr << "Error redoing asynchronously: " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Appends a change that was just made and empties the redo list.
+ *
+ * The caller must hold writeMutex.
+ *
+ * @param entry The change, with what it takes to revert it.
+ */
+void TaskManager::recordUndo(UndoEntry entry)
+{
+    for (auto &undone : redoLog) {
+        discardUndo(undone);
+    }
+    redoLog.clear();
+    undoLog.push_back(std::move(entry));
+    if (undoLog.size() > UNDO_ENTRIES) {
+        discardUndo(undoLog.front());
+        undoLog.pop_front();
+    }
+}
+
+/**
+ * @brief Forgets every undoable and undone change, dropping their stashes.
+ *
+ * The caller must hold writeMutex.
+ */
+void TaskManager::discardUndoLog()
+{
+    for (auto &entry : undoLog) {
+        discardUndo(entry);
+    }
+    for (auto &entry : redoLog) {
+        discardUndo(entry);
+    }
+    undoLog.clear();
+    redoLog.clear();
+}
+
+/**
+ * @brief Reverts or reapplies a logged change and publishes the result.
+ *
+ * Adding and deleting are inverses of each other: one takes the task out
+ * with its tags and edges, the other restores it under the same ID. A
+ * clear is reverted by renaming the stashed tables back. The caller must
+ * hold writeMutex.
+ *
+ * @param entry Change to revert or reapply; updated with what reverses it.
+ * @param undo True to revert, false to reapply.
+ */
+void TaskManager::applyUndo(UndoEntry &entry, bool undo)
+{
+    TRACE_SCOPE("TaskManager::applyUndo");
+    switch (entry.kind) {
+    case UndoEntry::Kind::Add:
+    case UndoEntry::Kind::Delete:
+        if ((entry.kind == UndoEntry::Kind::Delete) == undo) {
+            database.restoreTasksAsync(entry.records).get();
+            entry.records.clear();
+        }
+        else {
+            entry.records = database.takeTasksAsync(taskById(entry.id)).get();
+            if (entry.records.empty()) {
+                throw std::invalid_argument("task " + std::to_string(entry.id) + " no longer exists");
+            }
+            if (recurringTasks.count(entry.id)) {
+                loadRecurrences();
+                materializeDue(std::time(nullptr));
+            }
+        }
+        syncChanges();
+        break;
+    case UndoEntry::Kind::Done:
+        if (undo) {
+            database.reopenTaskAsync(entry.id).get();
+        }
+        else {
+            database.markTaskDoneAsync(entry.id).get();
+        }
+        syncChanges();
+        break;
+    case UndoEntry::Kind::Clear:
+        if (undo) {
+            database.restoreStashAsync(entry.stash).get();
+            entry.stash = 0;
+        }
+        else {
+            entry.stash = database.stashAllDataAsync().get();
+        }
+        reloadTasks();
+        loadRecurrences();
+        break;
+    }
+}
+
+/**
+ * @brief Releases what an entry that leaves the log holds.
+ *
+ * Only a clear that can still be undone holds something outside memory,
+ * its stash. Failures are logged, not thrown: the stash is then dropped by
+ * a later clear once it has expired.
+ *
+ * @param entry Entry leaving the log.
+ */
+void TaskManager::discardUndo(UndoEntry &entry)
+{
+    if (entry.kind != UndoEntry::Kind::Clear || entry.stash == 0) {
+        return;
+    }
+    try {
+        database.dropStashAsync(entry.stash).get();
+        entry.stash = 0;
+    }
+    catch (const std::exception &e) {
+        std::cerr << "Error dropping undo stash: " << e.what() << std::endl;
+    }
+}
+
+/**
+ * @brief Returns a copy of the cached tasks without touching the database.
+ *
+ * The cache is refreshed by every mutation, so callers that await their
+ * mutations see their own writes.
+ *
+ * @return Vector of the cached Task objects.
+ */
+vector<Task> TaskManager::getTasks() const
+{
+    if (!cache) {
+        return snapshot()->tasks;
+    }
+    vector<Task> tasks;
+    streamTasks(TaskQuery(), [&tasks](const Task &task) {
+        tasks.push_back(task);
+        return true;
+    });
+    return tasks;
+}
+
+/**
+ * @brief Returns the task with the given ID.
+ *
+ * @param id Task ID.
+ * @return The task, or std::nullopt if there is none.
+ */
+std::optional<Task> TaskManager::getTask(int id) const
+{
+    if (cache) {
+        return cache->find(id);
+    }
+    auto view = snapshot();
+    const Task *task = findTask(*view, id);
+    return task ? std::optional<Task>(*task) : std::nullopt;
+}
+
+/**
+ * @brief Visits every task in ascending ID order until visit returns false.
+ *
+ * Without a cache budget the tasks come from one snapshot; with one, from
+ * consecutive batches, which may straddle concurrent writes.
+ *
+ * @param visit Called for each task; returns false to stop.
+ */
+void TaskManager::forEachTask(const std::function<bool(const Task &)> &visit) const
+{
+    if (cache) {
+        streamTasks(TaskQuery(), visit);
+        return;
+    }
+    auto view = snapshot();
+    for (const auto &task : view->tasks) {
+        if (!visit(task)) {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Streams the tasks matching a filter from the database in batches.
+ *
+ * Each batch is a range scan of the primary key starting after the last
+ * ID seen, so memory use is bounded by the batch size.
+ *
+ * @param filter Tasks to visit; its limit is honored across batches.
+ * @param visit Called for each task; returns false to stop.
+ */
+void TaskManager::streamTasks(TaskQuery filter, const std::function<bool(const Task &)> &visit) const
+{
+    size_t remaining = filter.limit;
+    while (remaining > 0) {
+        filter.limit = std::min(remaining, STREAM_BATCH);
+        const vector<Task> batch = database.getTasksWhereAsync(filter).get();
+        for (const auto &task : batch) {
+            if (!visit(task)) {
+                return;
+            }
+        }
+        if (batch.size() < filter.limit || batch.back().getId() == std::numeric_limits<int>::max()) {
+            return;
+        }
+        remaining -= batch.size();
+        filter.idFrom = batch.back().getId() + 1;
+    }
+}
+
+/**
+ * @brief Returns the hit, miss and eviction counts of the task cache.
+ */
+TaskCacheStats TaskManager::cacheStats() const
+{
+    return cache ? cache->stats() : TaskCacheStats();
+}
+
+/**
+ * @brief Estimates the memory held by the cached tasks and the structures derived from them.
+ *
+ * Posting lists shared with older snapshots still held by readers are
+ * counted once, as part of the current one. A std::map node is taken as
+ * three pointers and a color word besides its value, and the control block
+ * a posting list shares its allocation with as a vtable pointer and two counters.
+ */
+TaskMemoryStats TaskManager::memoryStats() const
+{
+    TaskMemoryStats stats;
+    const auto view = snapshot();
+    stats.tasks = view->tasks.size();
+    stats.taskBytes = view->tasks.capacity() * sizeof(Task);
+    for (const Task &task : view->tasks) {
+        stats.descriptionBytes += task.getDescriptionHeapBytes();
+    }
+    const TaskColumns &columns = view->columns;
+    stats.columnBytes = columns.ids.capacity() * sizeof(int) + columns.createdTimes.capacity() * sizeof(int64_t) +
+                        columns.completedTimes.capacity() * sizeof(int64_t) + columns.doneBits.capacity() * sizeof(uint64_t);
+    for (const auto &posting : view->tagPostings) {
+        const string &tag = posting.first;
+        stats.tagBytes += 4 * sizeof(void *) + sizeof(posting) + sizeof(vector<int>) + sizeof(void *) + 2 * sizeof(int) +
+                          posting.second->capacity() * sizeof(int) +
+                          (tag.capacity() > string().capacity() ? tag.capacity() + 1 : 0);
+    }
+    {
+        std::shared_lock<std::shared_mutex> lock(searchMutex);
+        stats.searchIndexBytes = searchIndexBuilt ? searchIndex.memoryBytes() : 0;
+    }
+    if (cache) {
+        stats.cacheBytes = cache->stats().bytes;
+        stats.cacheBudget = cache->budget();
+    }
+    return stats;
+}
+
+/**
+ * @brief Returns the current snapshot of the cached tasks.
+ *
+ * The snapshot is immutable and stays valid for as long as the caller
+ * holds it, even if writers publish newer versions meanwhile.
+ *
+ * @return Shared pointer to the published TaskSnapshot.
+ */
+std::shared_ptr<const TaskSnapshot> TaskManager::snapshot() const
+{
+    return std::atomic_load(&current);
+}
+
+/**
+ * @brief Reloads all tasks from the database and publishes them as the next snapshot.
+ *
+ * The caller must hold writeMutex, which keeps versions strictly increasing.
+ */
+void TaskManager::reloadTasks()
+{
+    TRACE_SCOPE("TaskManager::reloadTasks");
+    // Read the sequence first: changes racing with the load are re-applied later, which is idempotent
+    lastChangeSeq = database.getLastChangeSeqAsync().get();
+    auto next = std::make_shared<TaskSnapshot>();
+    if (cache) {
+        cache->clear(); // Pages are read again on demand
+    }
+    else {
+        next->tasks = database.getTasksAsync().get();
+    }
+
+    // Pairs arrive grouped by tag and sorted by ID, so each posting list is built in order
+    std::map<string, vector<int>> postings;
+    for (auto &pair : database.getTaskTagsAsync().get()) {
+        postings[pair.second].push_back(pair.first);
+    }
+    for (auto &posting : postings) {
+        next->tagPostings.emplace(posting.first, std::make_shared<const vector<int>>(std::move(posting.second)));
+    }
+    next->columns = buildColumns(next->tasks);
+    publish(std::move(next));
+    resetSearchIndex();
+    loadDependencies();
+    loadReminders();
+}
+
+/**
+ * @brief Asynchronously picks up changes committed by other processes.
+ *
+ * PRAGMA data_version only moves when another connection commits, so the
+ * common case of nothing changed costs a single pragma. Otherwise only the
+ * rows recorded in the change log since the last sync are fetched.
+ *
+ * @return Future object holding true if a new snapshot was published.
+ */
+future<bool> TaskManager::refreshAsync()
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, enqueued]()
+                 {
+        TRACE_ASYNC_SCOPE("TaskManager::refreshAsync", enqueued);
+        try {
+            std::lock_guard<std::mutex> lock(writeMutex);
+            int64_t version = database.getDataVersionAsync().get();
+            bool changed = false;
+            if (version != lastDataVersion) {
+                lastDataVersion = version;
+                changed = syncChanges();
+                loadRecurrences(); // Other processes may have completed or materialized recurring tasks
+            }
+            if (!isReadOnly() && materializeDue(std::time(nullptr)) > 0) {
+                changed = syncChanges() || changed;
+            }
+            return changed;
+        }
+        catch (const std::exception &e) {
+            std::cerr << "Error refreshing tasks asynchronously: " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Fetches the change-log delta since lastChangeSeq and publishes it.
+ *
+ * The caller must hold writeMutex.
+ *
+ * @return True if the snapshot changed.
+ */
+bool TaskManager::syncChanges()
+{
+    TRACE_SCOPE("TaskManager::syncChanges");
+    TaskChanges changes = database.getChangesSinceAsync(lastChangeSeq).get();
+    if (changes.cleared) {
+        reloadTasks();
+        return true;
+    }
+    if (changes.upserted.empty() && changes.deleted.empty()) {
+        lastChangeSeq = changes.lastSeq;
+        return false;
+    }
+    applyChanges(changes);
+    return true;
+}
+
+/**
+ * @brief Merges a delta into the current snapshot and publishes the result.
+ *
+ * Both the snapshot and the delta are ordered by ID, so this is a single
+ * linear merge. The columns are merged from the previous snapshot's rather
+ * than rebuilt from every task. The caller must hold writeMutex.
+ *
+ * @param changes Delta returned by Database::getChangesSinceAsync.
+ */
+void TaskManager::applyChanges(const TaskChanges &changes)
+{
+    TRACE_SCOPE("TaskManager::applyChanges");
+    auto previous = std::atomic_load(&current);
+    auto next = std::make_shared<TaskSnapshot>();
+    if (!cache) {
+        next->tasks.reserve(previous->tasks.size() + changes.upserted.size());
+    }
+
+    auto upserted = changes.upserted.begin();
+    auto deleted = changes.deleted.begin();
+    for (const auto &task : previous->tasks) {
+        while (upserted != changes.upserted.end() && upserted->getId() < task.getId()) {
+            next->tasks.push_back(*upserted++);
+        }
+        while (deleted != changes.deleted.end() && *deleted < task.getId()) {
+            ++deleted;
+        }
+        if (upserted != changes.upserted.end() && upserted->getId() == task.getId()) {
+            next->tasks.push_back(*upserted++);
+        }
+        else if (deleted == changes.deleted.end() || *deleted != task.getId()) {
+            next->tasks.push_back(task);
+        }
+    }
+    if (!cache) {
+        next->tasks.insert(next->tasks.end(), upserted, changes.upserted.end());
+        next->columns = mergeColumns(previous->columns, changes.upserted, changes.deleted);
+    }
+
+    // Changed tasks leave every posting list, then rejoin the lists of their current tags
+    vector<int> changedIds = changes.deleted;
+    for (const auto &task : changes.upserted) {
+        changedIds.push_back(task.getId());
+    }
+    std::sort(changedIds.begin(), changedIds.end());
+    if (cache) {
+        cache->invalidate(changedIds);
+    }
+
+    next->tagPostings = previous->tagPostings;
+    for (auto it = next->tagPostings.begin(); it != next->tagPostings.end();) {
+        const vector<int> &ids = *it->second;
+        bool touched = std::any_of(changedIds.begin(), changedIds.end(),
+                                   [&ids](int id) { return std::binary_search(ids.begin(), ids.end(), id); });
+        if (!touched) {
+            ++it;
+            continue;
+        }
+        auto remaining = std::make_shared<vector<int>>();
+        std::set_difference(ids.begin(), ids.end(), changedIds.begin(), changedIds.end(), std::back_inserter(*remaining));
+        if (remaining->empty()) {
+            it = next->tagPostings.erase(it);
+        }
+        else {
+            it->second = std::move(remaining);
+            ++it;
+        }
+    }
+
+    std::map<string, vector<int>> added;
+    for (const auto &pair : changes.tags) {
+        added[pair.second].push_back(pair.first);
+    }
+    for (auto &entry : added) {
+        std::sort(entry.second.begin(), entry.second.end());
+        auto merged = std::make_shared<vector<int>>();
+        auto existing = next->tagPostings.find(entry.first);
+        if (existing != next->tagPostings.end()) {
+            std::merge(existing->second->begin(), existing->second->end(),
+                       entry.second.begin(), entry.second.end(), std::back_inserter(*merged));
+        }
+        else {
+            *merged = std::move(entry.second);
+        }
+        next->tagPostings[entry.first] = std::move(merged);
+    }
+
+    lastChangeSeq = changes.lastSeq;
+    publish(std::move(next));
+    indexChanges(*previous, changes);
+    {
+        std::lock_guard<std::mutex> lock(readyMutex);
+        applyDependencyChanges(changes);
+    }
+    applyReminderChanges(changes);
+}
+
+/**
+ * @brief Updates the search index, if built, with a delta applied on top of previous.
+ *
+ * A lazy build racing with this call may already have indexed the new
+ * snapshot; inserting and erasing are idempotent, so applying the delta
+ * again is harmless. The caller must hold writeMutex.
+ *
+ * @param previous Snapshot the delta was applied to.
+ * @param changes Delta returned by Database::getChangesSinceAsync.
+ */
+void TaskManager::indexChanges(const TaskSnapshot &previous, const TaskChanges &changes)
+{
+    std::unique_lock<std::shared_mutex> lock(searchMutex);
+    if (!searchIndexBuilt) {
+        return;
+    }
+    for (int id : changes.deleted) {
+        if (const Task *task = findTask(previous, id)) {
+            searchIndex.erase(id, task->getDescription());
+        }
+    }
+    for (const auto &task : changes.upserted) {
+        const Task *old = findTask(previous, task.getId());
+        if (old && old->getDescription() == task.getDescription()) {
+            continue; // Marked done; the text is unchanged
+        }
+        if (old) {
+            searchIndex.erase(old->getId(), old->getDescription());
+        }
+        searchIndex.insert(task.getId(), task.getDescription());
+    }
+}
+
+/**
+ * @brief Drops the search index so the next search rebuilds it from the current snapshot.
+ */
+void TaskManager::resetSearchIndex()
+{
+    std::unique_lock<std::shared_mutex> lock(searchMutex);
+    searchIndex.clear();
+    searchIndexBuilt = false;
+}
+
+/**
+ * @brief Returns up to limit cached tasks whose description approximately contains the query.
+ *
+ * Queries shorter than three characters have no trigrams and are matched by
+ * scanning the snapshot. Longer ones take their candidates from the trigram
+ * index, in order of the fewest edits the shared trigrams allow, and verify
+ * each with substringEditDistance. Verification stops once the limit is
+ * filled and no remaining candidate could even tie, which keeps queries
+ * made of common trigrams from verifying every task. Ties are still
+ * verified, since a shorter description ranks first among them.
+ *
+ * @param query Text to search for, compared case-insensitively.
+ * @param limit Maximum number of tasks returned.
+ * @return Matching tasks ordered by edit distance, then description length, then ID.
+ */
+vector<Task> TaskManager::searchTasks(const string &query, size_t limit) const
+{
+    vector<Task> result;
+    auto view = snapshot();
+    if (query.empty() || limit == 0) {
+        return result;
+    }
+    if (query.size() < 3) {
+        forEachTask([&](const Task &task) {
+            if (substringEditDistance(query, task.getDescription(), 0) == 0) {
+                result.push_back(task);
+            }
+            return result.size() < limit;
+        });
+        return result;
+    }
+
+    // One typo per four characters or so, up to two
+    const int maxEdits = query.size() < 4 ? 0 : query.size() < 8 ? 1 : 2;
+    if (cache) {
+        return scanSearch(query, maxEdits, limit);
+    }
+    struct Hit {
+        const Task *task;
+        int distance;
+        size_t length;
+    };
+    vector<Hit> hits;
+    vector<size_t> hitsWithin(static_cast<size_t>(maxEdits) + 1, 0); // Hits at each distance
+    int worstKept = maxEdits + 1; // Largest distance among the best limit hits, once there are that many
+    auto verify = [&](const TrigramCandidate &candidate) {
+        if (candidate.minEdits > worstKept) {
+            return false; // Every remaining candidate ranks below the kept hits
+        }
+        const Task *task = findTask(*view, candidate.id);
+        if (!task) {
+            return true; // Published after the snapshot was taken
+        }
+        const string description = task->getDescription();
+        int distance = substringEditDistance(query, description, maxEdits);
+        if (distance > maxEdits) {
+            return true;
+        }
+        hits.push_back(Hit{task, distance, description.size()});
+        ++hitsWithin[static_cast<size_t>(distance)];
+        size_t kept = 0;
+        for (int edits = 0; edits <= maxEdits; ++edits) {
+            kept += hitsWithin[static_cast<size_t>(edits)];
+            if (kept >= limit) {
+                worstKept = edits;
+                break;
+            }
+        }
+        return true;
+    };
+
+    std::shared_lock<std::shared_mutex> lock(searchMutex);
+    if (!searchIndexBuilt) {
+        lock.unlock();
+        {
+            std::unique_lock<std::shared_mutex> buildLock(searchMutex);
+            if (!searchIndexBuilt) {
+                for (const auto &task : snapshot()->tasks) {
+                    searchIndex.insert(task.getId(), task.getDescription());
+                }
+                searchIndexBuilt = true;
+            }
+        }
+        lock.lock();
+    }
+    searchIndex.forEachCandidate(query, maxEdits, verify);
+    lock.unlock();
+
+    std::sort(hits.begin(), hits.end(), [](const Hit &a, const Hit &b) {
+        if (a.distance != b.distance) {
+            return a.distance < b.distance;
+        }
+        if (a.length != b.length) {
+            return a.length < b.length;
+        }
+        return a.task->getId() < b.task->getId();
+    });
+    for (size_t i = 0; i < hits.size() && i < limit; ++i) {
+        result.push_back(*hits[i].task);
+    }
+    return result;
+}
+
+/**
+ * @brief Verifies every task against the query, for searches without the trigram index.
+ *
+ * With a cache budget the index, which holds every description, is never
+ * built; the tasks are streamed instead and only the best limit hits are kept.
+ *
+ * @param query Text to search for, compared case-insensitively.
+ * @param maxEdits Edit budget of the search.
+ * @param limit Maximum number of tasks returned.
+ * @return Matching tasks ordered as by searchTasks.
+ */
+vector<Task> TaskManager::scanSearch(const string &query, int maxEdits, size_t limit) const
+{
+    struct Hit {
+        Task task;
+        int distance;
+        size_t length;
+    };
+    auto better = [](const Hit &a, const Hit &b) {
+        if (a.distance != b.distance) {
+            return a.distance < b.distance;
+        }
+        if (a.length != b.length) {
+            return a.length < b.length;
+        }
+        return a.task.getId() < b.task.getId();
+    };
+    vector<Hit> hits;
+    forEachTask([&](const Task &task) {
+        const string description = task.getDescription();
+        int distance = substringEditDistance(query, description, maxEdits);
+        if (distance <= maxEdits) {
+            hits.push_back(Hit{task, distance, description.size()});
+            if (hits.size() >= 2 * limit) {
+                std::sort(hits.begin(), hits.end(), better);
+                hits.erase(hits.begin() + static_cast<std::ptrdiff_t>(limit), hits.end());
+            }
+        }
+        return true;
+    });
+    std::sort(hits.begin(), hits.end(), better);
+
+    vector<Task> result;
+    for (size_t i = 0; i < hits.size() && i < limit; ++i) {
+        result.push_back(hits[i].task);
+    }
+    return result;
+}
+
+/**
+ * @brief Returns true if the database is read-only; every mutation then fails.
+ */
+bool TaskManager::isReadOnly() const
+{
+    return database.isReadOnly();
+}
+
+/**
+ * @brief Throws if the database was opened read-only.
+ *
+ * Mutations call this before taking writeMutex, so they fail fast with a
+ * clear message instead of an SQLite error from deep inside a statement.
+ */
+void TaskManager::checkWritable() const
+{
+    if (database.isReadOnly()) {
+        throw std::logic_error("the database is open read-only");
+    }
+}
+
+/**
+ * @brief Sets the renderer used by listTasksAsync.
+ *
+ * @param newRenderer Renderer for subsequent listings.
+ */
+void TaskManager::setRenderer(std::shared_ptr<const TaskRenderer> newRenderer)
+{
+    std::atomic_store(&renderer, std::move(newRenderer));
+}
+
+/**
+ * @brief Asynchronous tagging of a task using its ID.
+ *
+ * @param id ID of the task to tag.
+ * @param tag Tag name.
+ * @return Future object for the add tag operation.
+ */
+future<void> TaskManager::addTagAsync(int id, const string &tag)
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, id, tag, enqueued]()
+                 {
+        TRACE_ASYNC_SCOPE("TaskManager::addTagAsync", enqueued);
+        try {
+            checkWritable();
+            std::lock_guard<std::mutex> lock(writeMutex);
+            database.addTagAsync(id, tag).get();
+            syncChanges();
+        }
+        catch (const std::exception &e) {
+            std::cerr << "Error tagging task asynchronously: " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Asynchronous removal of a tag from a task using its ID.
+ *
+ * @param id ID of the task.
+ * @param tag Tag name.
+ * @return Future object for the remove tag operation.
+ */
+future<void> TaskManager::removeTagAsync(int id, const string &tag)
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, id, tag, enqueued]()
+                 {
+        TRACE_ASYNC_SCOPE("TaskManager::removeTagAsync", enqueued);
+        try {
+            checkWritable();
+            std::lock_guard<std::mutex> lock(writeMutex);
+            database.removeTagAsync(id, tag).get();
+            syncChanges();
+        }
+        catch (const std::exception &e) {
+            std::cerr << "Error untagging task asynchronously: " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Returns the cached tasks that carry all of the given tags.
+ *
+ * Intersects the posting lists starting from the shortest, so the cost is
+ * bounded by the rarest tag rather than by the number of tasks.
+ *
+ * @param tags Tags that every returned task must have.
+ * @param pendingOnly Only return tasks that are not done.
+ * @return Matching tasks in ascending ID order.
+ */
+vector<Task> TaskManager::tasksWithTags(const vector<string> &tags, bool pendingOnly) const
+{
+    auto view = snapshot();
+    vector<const vector<int> *> lists;
+    for (const auto &tag : tags) {
+        auto it = view->tagPostings.find(tag);
+        if (it == view->tagPostings.end()) {
+            return {};
+        }
+        lists.push_back(it->second.get());
+    }
+    if (lists.empty()) {
+        return {};
+    }
+    std::sort(lists.begin(), lists.end(), [](const vector<int> *a, const vector<int> *b) { return a->size() < b->size(); });
+
+    vector<int> ids = *lists.front();
+    for (size_t i = 1; i < lists.size() && !ids.empty(); ++i) {
+        vector<int> narrowed;
+        std::set_intersection(ids.begin(), ids.end(), lists[i]->begin(), lists[i]->end(), std::back_inserter(narrowed));
+        ids.swap(narrowed);
+    }
+
+    vector<Task> result;
+    for (int id : ids) {
+        if (cache) {
+            std::optional<Task> task = cache->find(id);
+            if (task && !(pendingOnly && task->isDone())) {
+                result.push_back(std::move(*task));
+            }
+            continue;
+        }
+        const Task *task = findTask(*view, id);
+        if (task && !(pendingOnly && task->isDone())) {
+            result.push_back(*task);
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Asynchronous listing of the tasks that carry all of the given tags.
+ *
+ * @param tags Tags that every listed task must have.
+ * @param pendingOnly Only list tasks that are not done.
+ * @return Future object for the list operation.
+ */
+future<void> TaskManager::listTasksWithTagsAsync(const vector<string> &tags, bool pendingOnly) const
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, tags, pendingOnly, enqueued]()
+                 {
+        TRACE_ASYNC_SCOPE("TaskManager::listTasksWithTagsAsync", enqueued);
+        try {
+            auto activeRenderer = std::atomic_load(&renderer);
+            auto matches = tasksWithTags(tags, pendingOnly);
+
+            Trace::Scope render("TaskManager::render");
+            render.arg("tasks", static_cast<int64_t>(matches.size()));
+            for (const auto &task : matches) {
+                activeRenderer->render(std::cout, task);
+            }
+            std::cout.flush();
+        }
+        catch (const std::exception &e) {
+            std::cerr << "Error listing tagged tasks asynchronously: " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Asynchronous retrieval of the tasks matching a filter expression.
+ *
+ * The expression is evaluated by the database rather than over the snapshot,
+ * so it works the same whether or not the tasks are all held in memory, and
+ * sees changes other processes made.
+ *
+ * @param expression Filter expression.
+ * @return Future object containing the matching tasks in ascending ID order.
+ */
+future<vector<Task>> TaskManager::filterTasksAsync(const string &expression) const
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, expression, enqueued]() -> vector<Task>
+                 {
+        TRACE_ASYNC_SCOPE("TaskManager::filterTasksAsync", enqueued);
+        try {
+            return database.getTasksMatchingAsync(expression).get();
+        }
+        catch (const std::exception &e) {
+            std::cerr << "Error filtering tasks asynchronously: " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Asynchronous listing of the tasks matching a filter expression.
+ *
+ * @param expression Filter expression.
+ * @return Future object for the listing operation.
+ */
+future<void> TaskManager::listTasksMatchingAsync(const string &expression) const
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, expression, enqueued]()
+                 {
+        TRACE_ASYNC_SCOPE("TaskManager::listTasksMatchingAsync", enqueued);
+        try {
+            auto activeRenderer = std::atomic_load(&renderer);
+            auto matches = database.getTasksMatchingAsync(expression).get();
+
+            Trace::Scope render("TaskManager::render");
+            render.arg("tasks", static_cast<int64_t>(matches.size()));
+            for (const auto &task : matches) {
+                activeRenderer->render(std::cout, task);
+            }
+            std::cout.flush();
+        }
+        catch (const std::exception &e) {
+            std::cerr << "Error listing filtered tasks asynchronously: " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Asynchronous addition of a dependency between two tasks.
+ *
+ * @param id ID of the task that waits.
+ * @param prerequisiteId ID of the task that must be done first.
+ * @return Future object for the add operation.
+ */
+future<void> TaskManager::addDependencyAsync(int id, int prerequisiteId)
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, id, prerequisiteId, enqueued]()
+                 {
+        TRACE_ASYNC_SCOPE("TaskManager::addDependencyAsync", enqueued);
+        try {
+            checkWritable();
+            std::lock_guard<std::mutex> lock(writeMutex);
+            database.addDependencyAsync(id, prerequisiteId).get();
+            syncChanges();
+        }
+        catch (const std::exception &e) {
+            std::cerr << "Error adding dependency asynchronously: " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Asynchronous removal of a dependency between two tasks.
+ *
+ * @param id ID of the task that waits.
+ * @param prerequisiteId ID of the task it waits for.
+ * @return Future object for the remove operation.
+ */
+future<void> TaskManager::removeDependencyAsync(int id, int prerequisiteId)
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, id, prerequisiteId, enqueued]()
+                 {
+        TRACE_ASYNC_SCOPE("TaskManager::removeDependencyAsync", enqueued);
+        try {
+            checkWritable();
+            std::lock_guard<std::mutex> lock(writeMutex);
+            database.removeDependencyAsync(id, prerequisiteId).get();
+            syncChanges();
+        }
+        catch (const std::exception &e) {
+            std::cerr << "Error removing dependency asynchronously: " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Asynchronous retrieval of the pending tasks whose prerequisites are all done.
+ *
+ * Copies the ready set and looks the tasks up, so the cost depends on the
+ * number of ready tasks, not on the size of the graph.
+ *
+ * @return Future object containing the ready tasks in ID order.
+ */
+future<vector<Task>> TaskManager::readyTasksAsync() const
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, enqueued]() -> vector<Task>
+                 {
+        TRACE_ASYNC_SCOPE("TaskManager::readyTasksAsync", enqueued);
+        try {
+            vector<int> ids;
+            {
+                std::lock_guard<std::mutex> lock(readyMutex);
+                ids.assign(readyIds.begin(), readyIds.end());
+            }
+            vector<Task> ready;
+            ready.reserve(ids.size());
+            for (int id : ids) {
+                std::optional<Task> task = getTask(id);
+                if (task && !task->isDone()) {
+                    ready.push_back(std::move(*task)); // Skips tasks a writer changed after the copy
+                }
+            }
+            return ready;
+        }
+        catch (const std::exception &e) {
+            std::cerr << "Error listing ready tasks asynchronously: " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Returns the IDs of the tasks the given task waits for.
+ *
+ * @param id Task ID.
+ * @return Prerequisite IDs in ascending order, done or not.
+ */
+vector<int> TaskManager::prerequisitesOf(int id) const
+{
+    std::lock_guard<std::mutex> lock(readyMutex);
+    auto node = dependencyGraph.find(id);
+    return node != dependencyGraph.end() ? node->second.prerequisites : vector<int>();
+}
+
+/**
+ * @brief Asynchronously sets or clears the due time of a task.
+ *
+ * @param id ID of the task.
+ * @param dueTime Timestamp the task is due at, or 0 to clear it.
+ * @return Future object for the update operation.
+ */
+future<void> TaskManager::setDueTimeAsync(int id, int64_t dueTime)
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, id, dueTime, enqueued]()
+                 {
+        TRACE_ASYNC_SCOPE("TaskManager::setDueTimeAsync", enqueued);
+        try {
+            checkWritable();
+            std::lock_guard<std::mutex> lock(writeMutex);
+            database.setDueTimeAsync(id, dueTime).get();
+            syncChanges();
+        }
+        catch (const std::exception &e) {
+            std::cerr << "Error setting due time asynchronously: " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Starts the reminder thread, or replaces its callback if it runs.
+ *
+ * The wheel is first moved to the current time without notifying, so due
+ * times that passed before anyone listened are dropped.
+ *
+ * @param notify Called on the reminder thread with every task that became due.
+ */
+void TaskManager::startReminders(std::function<void(const Task &)> notify)
+{
+    std::lock_guard<std::mutex> lock(reminderMutex);
+    notifyReminder = std::move(notify);
+    if (reminderThread.joinable()) {
+        return;
+    }
+    reminders.advance(std::time(nullptr), [](int, int64_t) {});
+    reminderStop = false;
+    reminderThread = std::thread(&TaskManager::runReminders, this);
+}
+
+/**
+ * @brief Stops the reminder thread and waits for it to exit.
+ */
+void TaskManager::stopReminders()
+{
+    {
+        std::lock_guard<std::mutex> lock(reminderMutex);
+        reminderStop = true;
+    }
+    reminderWake.notify_all();
+    if (reminderThread.joinable()) {
+        reminderThread.join();
+    }
+}
+
+/**
+ * @brief Returns the number of future due times waiting to fire.
+ */
+size_t TaskManager::pendingReminders() const
+{
+    std::lock_guard<std::mutex> lock(reminderMutex);
+    return reminders.size();
+}
+
+/**
+ * @brief Body of the reminder thread.
+ *
+ * Wakes at every second boundary, refreshes so changes from other processes
+ * reach the wheel, and advances the wheel to the current time. Timers are
+ * collected under the lock but notified outside it, after checking that the
+ * task is still pending with the same due time.
+ */
+void TaskManager::runReminders()
+{
+    std::unique_lock<std::mutex> lock(reminderMutex);
+    for (;;) {
+        const auto tick = std::chrono::system_clock::from_time_t(std::time(nullptr) + 1);
+        if (reminderWake.wait_until(lock, tick, [this] { return reminderStop; })) {
+            return;
+        }
+        lock.unlock();
+        try {
+            refreshAsync().get();
+        }
+        catch (const std::exception &) {
+            // Already logged; the next tick tries again
+        }
+
+        lock.lock();
+        vector<std::pair<int, int64_t>> fired;
+        reminders.advance(std::time(nullptr), [&fired](int id, int64_t due) { fired.emplace_back(id, due); });
+        const auto notify = notifyReminder;
+        lock.unlock();
+        for (const auto &timer : fired) {
+            std::optional<Task> task = getTask(timer.first);
+            if (task && !task->isDone() && task->getDueTime() == timer.second && notify) {
+                notify(*task);
+            }
+        }
+        lock.lock();
+    }
+}
+
+/**
+ * @brief Rebuilds the timer wheel from the pending tasks due in the future.
+ *
+ * Reads only the due times, in both modes. The caller must hold writeMutex.
+ */
+void TaskManager::loadReminders()
+{
+    TRACE_SCOPE("TaskManager::loadReminders");
+    auto dueTimes = database.getDueTimesAsync(std::time(nullptr)).get();
+    std::lock_guard<std::mutex> lock(reminderMutex);
+    reminders.clear(std::max<int64_t>(reminders.now(), std::time(nullptr)));
+    for (const auto &due : dueTimes) {
+        reminders.schedule(due.first, due.second);
+    }
+}
+
+/**
+ * @brief Schedules or cancels the timers of the tasks in a published delta.
+ *
+ * Only due times still in the future are scheduled, so an unrelated update of
+ * a task whose reminder already fired does not fire it again. The caller
+ * must hold writeMutex.
+ *
+ * @param changes Delta returned by Database::getChangesSinceAsync.
+ */
+void TaskManager::applyReminderChanges(const TaskChanges &changes)
+{
+    const int64_t now = std::time(nullptr);
+    std::lock_guard<std::mutex> lock(reminderMutex);
+    for (int id : changes.deleted) {
+        reminders.cancel(id);
+    }
+    for (const Task &task : changes.upserted) {
+        if (!task.isDone() && task.getDueTime() > now) {
+            reminders.schedule(task.getId(), task.getDueTime());
+        }
+        else {
+            reminders.cancel(task.getId());
+        }
+    }
+}
+
+/**
+ * @brief Rebuilds the dependency graph and the ready set.
+ *
+ * Runs after a full reload only; every other change goes through
+ * applyDependencyChanges. The caller must hold writeMutex.
+ */
+void TaskManager::loadDependencies()
+{
+    TRACE_SCOPE("TaskManager::loadDependencies");
+    std::unordered_map<int, DependencyNode> graph;
+    for (const auto &edge : database.getDependenciesAsync().get()) {
+        graph[edge.first].prerequisites.push_back(edge.second); // Edges arrive sorted, so the lists are too
+        graph[edge.second].dependents.push_back(edge.first);
+    }
+    for (auto &entry : graph) {
+        std::optional<Task> task = getTask(entry.first);
+        entry.second.pending = task && !task->isDone();
+    }
+    for (auto &entry : graph) {
+        for (int prerequisite : entry.second.prerequisites) {
+            entry.second.blockers += graph[prerequisite].pending ? 1 : 0;
+        }
+    }
+
+    std::set<int> ready;
+    auto addIfReady = [&graph, &ready](const Task &task) {
+        auto node = graph.find(task.getId());
+        if (!task.isDone() && (node == graph.end() || node->second.blockers == 0)) {
+            ready.insert(ready.end(), task.getId()); // Tasks arrive in ID order
+        }
+        return true;
+    };
+    if (cache) {
+        TaskQuery pending;
+        pending.status = TaskQuery::Status::Pending;
+        streamTasks(pending, addIfReady);
+    }
+    else {
+        auto view = snapshot();
+        for (const auto &task : view->tasks) {
+            addIfReady(task);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(readyMutex);
+    dependencyGraph.swap(graph);
+    readyIds.swap(ready);
+}
+
+/**
+ * @brief Updates the dependency graph and the ready set with a published delta.
+ *
+ * Deletions come first: a deleted prerequisite stops blocking, and the
+ * triggers that removed its edges put its dependents among the upserted
+ * tasks with their remaining prerequisites. Each upserted task then gets
+ * its prerequisites and pending state. A task that was just completed only
+ * touches its own dependents, so the work is proportional to its out-degree.
+ * The caller must hold writeMutex and readyMutex.
+ *
+ * @param changes Delta returned by Database::getChangesSinceAsync.
+ */
+void TaskManager::applyDependencyChanges(const TaskChanges &changes)
+{
+    for (int id : changes.deleted) {
+        if (dependencyGraph.count(id)) {
+            setPrerequisites(id, {});
+            setPending(id, false); // Leaves the graph once its dependents drop their edges
+        }
+        readyIds.erase(id);
+    }
+
+    auto edge = changes.dependencies.begin();
+    vector<int> prerequisites;
+    for (const auto &task : changes.upserted) {
+        const int id = task.getId();
+        prerequisites.clear();
+        while (edge != changes.dependencies.end() && edge->first < id) {
+            ++edge;
+        }
+        for (; edge != changes.dependencies.end() && edge->first == id; ++edge) {
+            prerequisites.push_back(edge->second);
+        }
+
+        auto node = dependencyGraph.find(id);
+        if (node == dependencyGraph.end()) {
+            if (prerequisites.empty()) {
+                if (task.isDone()) {
+                    readyIds.erase(id);
+                }
+                else {
+                    readyIds.insert(id);
+                }
+                continue; // Not part of the graph
+            }
+            dependencyGraph[id].pending = !task.isDone(); // Has no dependents yet, so nothing to propagate
+        }
+        setPrerequisites(id, prerequisites);
+        setPending(id, !task.isDone());
+    }
+}
+
+/**
+ * @brief Records whether a task is pending and adjusts its dependents.
+ *
+ * Each dependent's blocker count moves by one when the task changes state,
+ * and the dependent enters or leaves the ready set as the count reaches or
+ * leaves zero. The caller must hold readyMutex.
+ *
+ * @param id Task ID.
+ * @param pending The task exists and is not done.
+ */
+void TaskManager::setPending(int id, bool pending)
+{
+    auto update = [this](int taskId, const DependencyNode &node) {
+        if (node.pending && node.blockers == 0) {
+            readyIds.insert(taskId);
+        }
+        else {
+            readyIds.erase(taskId);
+        }
+    };
+    auto found = dependencyGraph.find(id);
+    if (found == dependencyGraph.end()) {
+        return;
+    }
+    DependencyNode &node = found->second;
+    if (node.pending != pending) {
+        node.pending = pending;
+        for (int dependentId : node.dependents) {
+            DependencyNode &dependent = dependencyGraph[dependentId];
+            dependent.blockers += pending ? 1 : -1;
+            update(dependentId, dependent);
+        }
+    }
+    update(id, node);
+    if (node.prerequisites.empty() && node.dependents.empty()) {
+        dependencyGraph.erase(found);
+    }
+}
+
+/**
+ * @brief Replaces a task's prerequisites.
+ *
+ * Only the edges that differ are touched. A prerequisite that is not in
+ * the graph yet gets its pending state from the current snapshot (or the
+ * cache), which already reflects the delta being applied. Prerequisites
+ * left without edges drop out of the graph. The caller must hold readyMutex.
+ *
+ * @param id Task ID, which must be in the graph.
+ * @param prerequisites New prerequisite IDs in ascending order.
+ */
+void TaskManager::setPrerequisites(int id, const vector<int> &prerequisites)
+{
+    vector<int> removed;
+    vector<int> added;
+    {
+        const vector<int> &previous = dependencyGraph[id].prerequisites;
+        std::set_difference(previous.begin(), previous.end(), prerequisites.begin(), prerequisites.end(), std::back_inserter(removed));
+        std::set_difference(prerequisites.begin(), prerequisites.end(), previous.begin(), previous.end(), std::back_inserter(added));
+    }
+    int blockers = 0;
+    for (int prerequisiteId : removed) {
+        auto prerequisite = dependencyGraph.find(prerequisiteId);
+        if (prerequisite == dependencyGraph.end()) {
+            continue;
+        }
+        blockers -= prerequisite->second.pending ? 1 : 0;
+        auto &dependents = prerequisite->second.dependents;
+        dependents.erase(std::remove(dependents.begin(), dependents.end(), id), dependents.end());
+        if (dependents.empty() && prerequisite->second.prerequisites.empty()) {
+            dependencyGraph.erase(prerequisite);
+        }
+    }
+    for (int prerequisiteId : added) {
+        auto prerequisite = dependencyGraph.find(prerequisiteId);
+        if (prerequisite == dependencyGraph.end()) {
+            std::optional<Task> task = getTask(prerequisiteId);
+            prerequisite = dependencyGraph.emplace(prerequisiteId, DependencyNode()).first;
+            prerequisite->second.pending = task && !task->isDone();
+        }
+        blockers += prerequisite->second.pending ? 1 : 0;
+        prerequisite->second.dependents.push_back(id);
+    }
+
+    DependencyNode &node = dependencyGraph[id]; // Rehashing may have moved it
+    node.prerequisites = prerequisites;
+    node.blockers += blockers;
+    if (node.pending && node.blockers == 0) {
+        readyIds.insert(id);
+    }
+    else {
+        readyIds.erase(id);
+    }
+}
+
+/**
+ * @brief Numbers the snapshot's version and makes it current.
+ *
+ * The caller must hold writeMutex.
+ *
+ * @param next Fully built snapshot, columns included; it is never modified after this call.
+ */
+void TaskManager::publish(std::shared_ptr<TaskSnapshot> next)
+{
+    TRACE_SCOPE("TaskManager::publish");
+    next->version = std::atomic_load(&current)->version + 1;
+    std::atomic_store(&current, std::shared_ptr<const TaskSnapshot>(std::move(next)));
+}
+
+/**
+ * @brief Returns the cached tasks matching a query.
+ *
+ * With a cache budget the query is translated to SQL instead.
+ *
+ * @param query Predicates and limit.
+ * @return Matching tasks in ascending ID order.
+ */
+vector<Task> TaskManager::queryTasks(const TaskQuery &query) const
+{
+    if (cache) {
+        return database.getTasksWhereAsync(query).get();
+    }
+    auto view = snapshot();
+    vector<Task> result;
+    for (uint32_t row : selectRows(view->columns, query)) {
+        result.push_back(view->tasks[row]);
+    }
+    return result;
+}
+
+/**
+ * @brief Counts the cached tasks matching a query.
+ *
+ * @param query Predicates and limit.
+ * @return Number of matching tasks.
+ */
+size_t TaskManager::countTasks(const TaskQuery &query) const
+{
+    if (cache) {
+        return database.countWhereAsync(query).get();
+    }
+    return countRows(snapshot()->columns, query);
+}
+
+/**
+ * @brief Asynchronous report of tasks created and completed per bucket.
+ *
+ * Runs a single pass over the snapshot's timestamp columns, so no task is
+ * copied and the database is not touched. With a cache budget the tasks
+ * are streamed and bucketed one batch at a time instead.
+ *
+ * @param granularity Bucket size.
+ * @param from Inclusive lower bound of the reported period.
+ * @param to Exclusive upper bound of the reported period.
+ * @param format Sparkline or CSV output.
+ * @return Future object for the report operation.
+ */
+future<void> TaskManager::historyReportAsync(HistoryGranularity granularity, int64_t from, int64_t to, HistoryFormat format) const
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, granularity, from, to, format, enqueued]()
+                 {
+        TRACE_ASYNC_SCOPE("TaskManager::historyReportAsync", enqueued);
+        try {
+            if (!cache) {
+                auto view = snapshot();
+                writeHistory(std::cout, buildHistory(view->columns, granularity, from, to), granularity, format);
+                std::cout.flush();
+                return;
+            }
+
+            // Bucket each batch separately, then merge; writeHistory fills the gaps
+            std::map<int64_t, HistoryBucket> total;
+            vector<Task> batch;
+            auto flush = [&]() {
+                addHistory(total, buildHistory(buildColumns(batch), granularity, from, to));
+                batch.clear();
+            };
+            forEachTask([&](const Task &task) {
+                batch.push_back(task);
+                if (batch.size() == STREAM_BATCH) {
+                    flush();
+                }
+                return true;
+            });
+            flush();
+            vector<HistoryBucket> buckets;
+            buckets.reserve(total.size());
+            for (const auto &entry : total) {
+                buckets.push_back(entry.second);
+            }
+            writeHistory(std::cout, buckets, granularity, format);
+            std::cout.flush();
+        }
+        catch (const std::exception &e) {
+            std::cerr << "Error building history report asynchronously: " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+/**
+ * @brief Asynchronous storage of a recurring task template.
+ *
+ * @param description Description of the tasks made from the template.
+ * @param rule When occurrences fall.
+ * @param firstTime Start of the first occurrence's window.
+ * @return Future object containing the template ID.
+ */
+future<int> TaskManager::addRecurrenceAsync(const string &description, const RecurrenceRule &rule, int64_t firstTime)
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, description, rule, firstTime, enqueued]() -> int
+                 {
+        TRACE_ASYNC_SCOPE("TaskManager::addRecurrenceAsync", enqueued);
+        try {
+            checkWritable();
+            std::lock_guard<std::mutex> lock(writeMutex);
+            int id = database.addRecurrenceAsync(description, rule, firstTime).get();
+            fireTimes.emplace(firstTime, id);
+            if (materializeDue(std::time(nullptr)) > 0) {
+                syncChanges();
+            }
+            return id;
+        }
+        catch (const std::exception &e) {
+            std::cerr << "Error adding recurring task asynchronously: " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Asynchronous retrieval of the recurring task templates.
+ *
+ * @return Future object containing the templates in ID order.
+ */
+future<vector<Recurrence>> TaskManager::getRecurrencesAsync() const
+{
+    return database.getRecurrencesAsync();
+}
+
+/**
+ * @brief Asynchronous deletion of a recurring task template.
+ *
+ * @param id ID of the template.
+ * @return Future object for the delete operation.
+ */
+future<void> TaskManager::deleteRecurrenceAsync(int id)
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, id, enqueued]()
+                 {
+        TRACE_ASYNC_SCOPE("TaskManager::deleteRecurrenceAsync", enqueued);
+        try {
+            checkWritable();
+            std::lock_guard<std::mutex> lock(writeMutex);
+            database.deleteRecurrenceAsync(id).get();
+            loadRecurrences();
+        }
+        catch (const std::exception &e) {
+            std::cerr << "Error deleting recurring task asynchronously: " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Asynchronous creation of the recurring tasks due by a given time.
+ *
+ * @param now Time to materialize up to.
+ * @return Future object containing the number of tasks that appeared.
+ */
+future<int> TaskManager::materializeDueAsync(int64_t now)
+{
+    int64_t enqueued = Trace::now();
+    return async(launch::async, [this, now, enqueued]() -> int
+                 {
+        TRACE_ASYNC_SCOPE("TaskManager::materializeDueAsync", enqueued);
+        try {
+            checkWritable();
+            std::lock_guard<std::mutex> lock(writeMutex);
+            int created = materializeDue(now);
+            if (created > 0) {
+                syncChanges();
+            }
+            return created;
+        }
+        catch (const std::exception &e) {
+            std::cerr << "Error materializing recurring tasks asynchronously: " << e.what() << std::endl;
+            throw; // Rethrow the exception to propagate it further
+        } });
+}
+
+/**
+ * @brief Rebuilds the next-fire heap and the open recurring tasks from the database.
+ *
+ * There are at most a few hundred templates, so rebuilding is cheaper than
+ * tracking every way a template can change; it happens only when an open
+ * recurring task is completed or deleted, or another process wrote the
+ * file. The caller must hold writeMutex.
+ */
+void TaskManager::loadRecurrences()
+{
+    if (isReadOnly()) {
+        return; // Nothing can be materialized, and older files lack the table
+    }
+    fireTimes = {};
+    recurringTasks.clear();
+    for (const Recurrence &recurrence : database.getRecurrencesAsync().get()) {
+        if (recurrence.taskId != 0) {
+            recurringTasks.emplace(recurrence.taskId, recurrence.id);
+        }
+        else {
+            fireTimes.emplace(recurrence.nextTime, recurrence.id);
+        }
+    }
+}
+
+/**
+ * @brief Materializes the heap entries due by now.
+ *
+ * The heap may be stale: another process can have materialized or moved a
+ * template. The database re-checks every entry, so a stale entry is either
+ * dropped (its task is open) or pushed back with its current time.
+ * The caller must hold writeMutex.
+ *
+ * @param now Time to materialize up to.
+ * @return Number of templates that now have an open task.
+ */
+int TaskManager::materializeDue(int64_t now)
+{
+    int appeared = 0;
+    while (!fireTimes.empty() && fireTimes.top().first <= now) {
+        const int id = fireTimes.top().second;
+        fireTimes.pop();
+        Recurrence recurrence = database.materializeRecurrenceAsync(id, now).get();
+        if (recurrence.id == 0) {
+            continue; // Deleted meanwhile
+        }
+        if (recurrence.taskId != 0) {
+            recurringTasks.emplace(recurrence.taskId, id);
+            ++appeared;
+        }
+        else {
+            fireTimes.emplace(recurrence.nextTime, id);
+        }
+    }
+    return appeared;
+}
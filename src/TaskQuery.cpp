@@ -0,0 +1,292 @@
+#include "TaskQuery.h"
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+using std::vector;
+
+namespace
+{
+    constexpr size_t BLOCK = 64; ///< Rows per mask word.
+
+    inline int popcount64(uint64_t word)
+    {
+#ifdef _MSC_VER
+        return static_cast<int>(__popcnt64(word));
+#else
+        return __builtin_popcountll(word);
+#endif
+    }
+
+    inline int lowestBit(uint64_t word)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, word);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctzll(word);
+#endif
+    }
+
+    /**
+     * @brief Builds the mask of rows in [begin, begin + count) whose value lies in [from, to).
+     *
+     * The unsigned subtraction folds both bounds into one comparison and the
+     * loop has no branches, so compilers turn it into vector compares.
+     */
+    inline uint64_t rangeMask(const int64_t *values, size_t count, int64_t from, int64_t to)
+    {
+        if (to <= from) {
+            return 0;
+        }
+        const uint64_t low = static_cast<uint64_t>(from);
+        const uint64_t width = static_cast<uint64_t>(to) - low;
+        uint64_t mask = 0;
+        for (size_t j = 0; j < count; ++j) {
+            mask |= static_cast<uint64_t>(static_cast<uint64_t>(values[j]) - low < width) << j;
+        }
+        return mask;
+    }
+
+    /**
+     * @brief Half-open range [begin, end) of row positions.
+     */
+    struct RowRange {
+        size_t begin;
+        size_t end;
+    };
+
+    /**
+     * @brief Returns the rows whose IDs fall in the query's ID range; IDs are ascending.
+     */
+    RowRange rowRange(const TaskColumns &columns, const TaskQuery &query)
+    {
+        const auto first = std::lower_bound(columns.ids.begin(), columns.ids.end(), query.idFrom);
+        const auto last = query.idTo <= query.idFrom ? first : std::lower_bound(first, columns.ids.end(), query.idTo);
+        return RowRange{static_cast<size_t>(first - columns.ids.begin()), static_cast<size_t>(last - columns.ids.begin())};
+    }
+
+    /**
+     * @brief Evaluates every predicate of the query for one block of rows.
+     *
+     * @param columns Columns to scan.
+     * @param query Predicates to evaluate.
+     * @param block Index of the 64-row block.
+     * @param rows Rows within the query's ID range.
+     * @return Mask of the rows in the block that satisfy the query.
+     */
+    inline uint64_t blockMask(const TaskColumns &columns, const TaskQuery &query, size_t block, RowRange rows)
+    {
+        const size_t begin = block * BLOCK;
+        const size_t count = std::min(BLOCK, rows.end - begin);
+        uint64_t mask = count == BLOCK ? ~uint64_t(0) : (uint64_t(1) << count) - 1;
+        if (rows.begin > begin) {
+            mask &= ~uint64_t(0) << (rows.begin - begin);
+        }
+
+        if (query.status == TaskQuery::Status::Done) {
+            mask &= columns.doneBits[block];
+        }
+        else if (query.status == TaskQuery::Status::Pending) {
+            mask &= ~columns.doneBits[block];
+        }
+        if (mask && (query.createdFrom != std::numeric_limits<int64_t>::min() ||
+                     query.createdTo != std::numeric_limits<int64_t>::max())) {
+            mask &= rangeMask(columns.createdTimes.data() + begin, count, query.createdFrom, query.createdTo);
+        }
+        if (mask && (query.completedFrom != std::numeric_limits<int64_t>::min() ||
+                     query.completedTo != std::numeric_limits<int64_t>::max())) {
+            mask &= rangeMask(columns.completedTimes.data() + begin, count, query.completedFrom, query.completedTo);
+        }
+        return mask;
+    }
+
+    /**
+     * @brief Reads 64 bits of a bitmap starting at any bit position; bits past the end read as 0.
+     */
+    inline uint64_t readBits(const vector<uint64_t> &bits, size_t from)
+    {
+        const size_t word = from / BLOCK;
+        const size_t shift = from % BLOCK;
+        uint64_t value = bits[word] >> shift;
+        if (shift != 0 && word + 1 < bits.size()) {
+            value |= bits[word + 1] << (BLOCK - shift);
+        }
+        return value;
+    }
+
+    /**
+     * @brief Appends the bits [from, from + count) of source to a bitmap of size rows, a word at a time.
+     *
+     * Bits of bits past size must be 0.
+     */
+    void appendBits(vector<uint64_t> &bits, size_t size, const vector<uint64_t> &source, size_t from, size_t count)
+    {
+        bits.resize((size + count + BLOCK - 1) / BLOCK, 0);
+        for (size_t copied = 0; copied < count; copied += BLOCK) {
+            const size_t n = std::min(BLOCK, count - copied);
+            uint64_t chunk = readBits(source, from + copied);
+            if (n < BLOCK) {
+                chunk &= (uint64_t(1) << n) - 1;
+            }
+            const size_t at = size + copied;
+            const size_t shift = at % BLOCK;
+            bits[at / BLOCK] |= chunk << shift;
+            if (shift != 0 && n > BLOCK - shift) {
+                bits[at / BLOCK + 1] |= chunk >> (BLOCK - shift);
+            }
+        }
+    }
+
+    /**
+     * @brief Appends one task as the next row.
+     */
+    void appendRow(TaskColumns &columns, const Task &task)
+    {
+        const size_t row = columns.ids.size();
+        columns.ids.push_back(task.getId());
+        columns.createdTimes.push_back(static_cast<int64_t>(task.getCreatedTime()));
+        columns.completedTimes.push_back(static_cast<int64_t>(task.getCompletedTime()));
+        if (row % BLOCK == 0) {
+            columns.doneBits.push_back(0);
+        }
+        if (task.isDone()) {
+            columns.doneBits[row / BLOCK] |= uint64_t(1) << (row % BLOCK);
+        }
+    }
+
+    /**
+     * @brief Appends the rows [begin, end) of another set of columns.
+     */
+    void appendRows(TaskColumns &columns, const TaskColumns &source, size_t begin, size_t end)
+    {
+        if (begin == end) {
+            return;
+        }
+        const size_t size = columns.ids.size();
+        columns.ids.insert(columns.ids.end(), source.ids.begin() + begin, source.ids.begin() + end);
+        columns.createdTimes.insert(columns.createdTimes.end(), source.createdTimes.begin() + begin,
+                                    source.createdTimes.begin() + end);
+        columns.completedTimes.insert(columns.completedTimes.end(), source.completedTimes.begin() + begin,
+                                      source.completedTimes.begin() + end);
+        appendBits(columns.doneBits, size, source.doneBits, begin, end - begin);
+    }
+}
+
+/**
+ * @brief Builds the columns for a task list.
+ *
+ * @param tasks Tasks to transpose.
+ * @return Columns with one row per task, in the same order.
+ */
+TaskColumns buildColumns(const vector<Task> &tasks)
+{
+    TaskColumns columns;
+    columns.ids.reserve(tasks.size());
+    columns.createdTimes.reserve(tasks.size());
+    columns.completedTimes.reserve(tasks.size());
+    columns.doneBits.assign((tasks.size() + BLOCK - 1) / BLOCK, 0);
+
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        const Task &task = tasks[i];
+        columns.ids.push_back(task.getId());
+        columns.createdTimes.push_back(static_cast<int64_t>(task.getCreatedTime()));
+        columns.completedTimes.push_back(static_cast<int64_t>(task.getCompletedTime()));
+        if (task.isDone()) {
+            columns.doneBits[i / BLOCK] |= uint64_t(1) << (i % BLOCK);
+        }
+    }
+    return columns;
+}
+
+/**
+ * @brief Builds the columns of a task list from those of its previous version and a delta.
+ *
+ * Walks the delta in ID order; the unchanged rows between two changed IDs
+ * are found by binary search and appended as one run.
+ *
+ * @param previous Columns of the list before the delta, in ID order.
+ * @param upserted Added or changed tasks, in ID order.
+ * @param deleted IDs of the removed tasks, in ascending order.
+ * @return Columns of the merged list.
+ */
+TaskColumns mergeColumns(const TaskColumns &previous, const vector<Task> &upserted, const vector<int> &deleted)
+{
+    TaskColumns columns;
+    const size_t capacity = previous.size() + upserted.size();
+    columns.ids.reserve(capacity);
+    columns.createdTimes.reserve(capacity);
+    columns.completedTimes.reserve(capacity);
+    columns.doneBits.reserve((capacity + BLOCK - 1) / BLOCK);
+
+    size_t row = 0;
+    auto upsert = upserted.begin();
+    auto remove = deleted.begin();
+    while (upsert != upserted.end() || remove != deleted.end()) {
+        const bool upserting = remove == deleted.end() || (upsert != upserted.end() && upsert->getId() <= *remove);
+        const int id = upserting ? upsert->getId() : *remove;
+        const size_t next = static_cast<size_t>(
+            std::lower_bound(previous.ids.begin() + row, previous.ids.end(), id) - previous.ids.begin());
+        appendRows(columns, previous, row, next);
+        row = next;
+        if (row < previous.size() && previous.ids[row] == id) {
+            ++row; // Replaced or removed
+        }
+        if (upserting) {
+            appendRow(columns, *upsert++);
+            if (remove != deleted.end() && *remove == id) {
+                ++remove; // Re-added after a delete within the same delta
+            }
+        }
+        else {
+            ++remove;
+        }
+    }
+    appendRows(columns, previous, row, previous.size());
+    return columns;
+}
+
+/**
+ * @brief Evaluates a query and returns the positions of the matching rows.
+ *
+ * @param columns Columns to scan.
+ * @param query Predicates and limit.
+ * @return Ascending row positions, at most query.limit of them.
+ */
+vector<uint32_t> selectRows(const TaskColumns &columns, const TaskQuery &query)
+{
+    vector<uint32_t> selection;
+    const RowRange rows = rowRange(columns, query);
+    const size_t blocks = (rows.end + BLOCK - 1) / BLOCK;
+
+    for (size_t block = rows.begin / BLOCK; block < blocks && selection.size() < query.limit; ++block) {
+        uint64_t mask = blockMask(columns, query, block, rows);
+        while (mask && selection.size() < query.limit) {
+            selection.push_back(static_cast<uint32_t>(block * BLOCK + lowestBit(mask)));
+            mask &= mask - 1;
+        }
+    }
+    return selection;
+}
+
+/**
+ * @brief Counts the rows matching a query without materializing them.
+ *
+ * @param columns Columns to scan.
+ * @param query Predicates and limit.
+ * @return Number of matching rows, capped at query.limit.
+ */
+size_t countRows(const TaskColumns &columns, const TaskQuery &query)
+{
+    size_t count = 0;
+    const RowRange rows = rowRange(columns, query);
+    const size_t blocks = (rows.end + BLOCK - 1) / BLOCK;
+
+    for (size_t block = rows.begin / BLOCK; block < blocks && count < query.limit; ++block) {
+        count += popcount64(blockMask(columns, query, block, rows));
+    }
+    return std::min(count, query.limit);
+}
@@ -0,0 +1,181 @@
+#include "TimerWheel.h"
+#include <algorithm> // for std::max
+
+/**
+ * @brief Creates an empty wheel.
+ *
+ * @param now Current time in seconds; timers due at or before it fire on the next advance.
+ */
+TimerWheel::TimerWheel(int64_t now) : current(now)
+{
+    slots.fill(NONE);
+}
+
+/**
+ * @brief Schedules a timer, replacing the task's earlier one.
+ *
+ * A due time at or before the current tick fires on the next tick, because
+ * the slot of the current tick has already been processed.
+ *
+ * @param id Task ID.
+ * @param due Time in seconds the timer fires at.
+ */
+void TimerWheel::schedule(int id, int64_t due)
+{
+    int32_t timer;
+    auto it = index.find(id);
+    if (it != index.end()) {
+        timer = it->second;
+        unlink(timer);
+    }
+    else if (freeTimers != NONE) {
+        timer = freeTimers;
+        freeTimers = timers[timer].next;
+        index.emplace(id, timer);
+    }
+    else {
+        timer = static_cast<int32_t>(timers.size());
+        timers.emplace_back();
+        index.emplace(id, timer);
+    }
+    timers[timer].id = id;
+    timers[timer].due = due;
+    link(timer, current + 1);
+}
+
+/**
+ * @brief Cancels the task's timer.
+ *
+ * @param id Task ID.
+ * @return True if the task had a pending timer.
+ */
+bool TimerWheel::cancel(int id)
+{
+    auto it = index.find(id);
+    if (it == index.end()) {
+        return false;
+    }
+    unlink(it->second);
+    release(it->second);
+    index.erase(it);
+    return true;
+}
+
+/**
+ * @brief Moves the wheel to a new time, firing every timer due up to it in order.
+ *
+ * On every tick the levels that wrapped cascade their next slot down, highest
+ * last, before the level 0 slot of the tick fires. Timers of a tick fire in
+ * no particular order. fire must not schedule or cancel timers.
+ *
+ * @param now Current time in seconds; earlier times are ignored.
+ * @param fire Called once for every timer that fired, after it was removed.
+ */
+void TimerWheel::advance(int64_t now, const FireFunction &fire)
+{
+    if (index.empty()) {
+        current = std::max(current, now); // Nothing to fire, so skip the ticks
+        return;
+    }
+    while (current < now) {
+        ++current;
+        for (int level = 1; level < LEVELS; ++level) {
+            const int shift = SLOT_BITS * level;
+            if ((current & ((int64_t(1) << shift) - 1)) != 0) {
+                break; // The level below did not wrap
+            }
+            int32_t timer = slots[level * SLOTS + ((current >> shift) & (SLOTS - 1))];
+            slots[level * SLOTS + ((current >> shift) & (SLOTS - 1))] = NONE;
+            while (timer != NONE) {
+                const int32_t next = timers[timer].next;
+                link(timer, current);
+                timer = next;
+            }
+        }
+
+        int32_t timer = slots[current & (SLOTS - 1)];
+        slots[current & (SLOTS - 1)] = NONE;
+        while (timer != NONE) {
+            const int32_t next = timers[timer].next;
+            if (timers[timer].due <= current) {
+                const int id = timers[timer].id;
+                const int64_t due = timers[timer].due;
+                index.erase(id);
+                release(timer);
+                fire(id, due);
+            }
+            else {
+                link(timer, current);
+            }
+            timer = next;
+        }
+    }
+}
+
+/**
+ * @brief Removes every timer and restarts the wheel at a new time.
+ */
+void TimerWheel::clear(int64_t now)
+{
+    timers.clear();
+    freeTimers = NONE;
+    slots.fill(NONE);
+    index.clear();
+    current = now;
+}
+
+/**
+ * @brief Links a timer into the slot its due time falls into, no earlier than earliest.
+ *
+ * The level is the lowest whose range covers the delay. Delays beyond the
+ * top level are linked into its furthest slot and placed again with their
+ * real due time when that slot cascades.
+ */
+void TimerWheel::link(int32_t timer, int64_t earliest)
+{
+    int64_t due = std::max(timers[timer].due, earliest);
+    int level = 0;
+    while (level < LEVELS - 1 && due - current >= (int64_t(1) << (SLOT_BITS * (level + 1)))) {
+        ++level;
+    }
+    const int64_t horizon = int64_t(1) << (SLOT_BITS * LEVELS);
+    if (due - current >= horizon) {
+        due = current + horizon - 1;
+    }
+
+    const int32_t slot = level * SLOTS + static_cast<int32_t>((due >> (SLOT_BITS * level)) & (SLOTS - 1));
+    timers[timer].slot = slot;
+    timers[timer].prev = NONE;
+    timers[timer].next = slots[slot];
+    if (slots[slot] != NONE) {
+        timers[slots[slot]].prev = timer;
+    }
+    slots[slot] = timer;
+}
+
+/**
+ * @brief Unlinks a timer from its slot.
+ */
+void TimerWheel::unlink(int32_t timer)
+{
+    const Timer &linked = timers[timer];
+    if (linked.prev != NONE) {
+        timers[linked.prev].next = linked.next;
+    }
+    else {
+        slots[linked.slot] = linked.next;
+    }
+    if (linked.next != NONE) {
+        timers[linked.next].prev = linked.prev;
+    }
+}
+
+/**
+ * @brief Returns a timer to the pool.
+ */
+void TimerWheel::release(int32_t timer)
+{
+    timers[timer].slot = NONE;
+    timers[timer].next = freeTimers;
+    freeTimers = timer;
+}
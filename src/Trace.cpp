@@ -0,0 +1,270 @@
+#include "Trace.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Trace
+{
+    namespace detail
+    {
+        std::atomic<bool> active{false};
+    }
+
+    namespace
+    {
+        struct Event {
+            const char *name;
+            const char *category;
+            int64_t begin;
+            int64_t duration;
+            uint32_t tid;
+            int argCount;
+            const char *argKeys[3];
+            int64_t argValues[3];
+        };
+
+        /**
+         * @brief Fixed block of events. Only the owning thread appends; count is
+         * published with release so stop() can read a buffer that is still growing.
+         */
+        struct Chunk {
+            static constexpr size_t CAPACITY = 512;
+            Event events[CAPACITY];
+            std::atomic<size_t> count{0};
+            std::atomic<Chunk *> next{nullptr};
+        };
+
+        struct Buffer {
+            Chunk head;
+            Chunk *tail = &head;
+
+            ~Buffer()
+            {
+                clear();
+            }
+
+            void clear()
+            {
+                for (Chunk *chunk = head.next.exchange(nullptr); chunk;) {
+                    Chunk *next = chunk->next.load();
+                    delete chunk;
+                    chunk = next;
+                }
+                head.count.store(0);
+                tail = &head;
+            }
+        };
+
+        /**
+         * @brief Owns every buffer. A thread borrows one for its lifetime and
+         * returns it on exit, so short-lived std::async threads reuse buffers.
+         */
+        struct Registry {
+            std::mutex mutex;
+            std::vector<std::unique_ptr<Buffer>> buffers;
+            std::vector<Buffer *> idle;
+            std::string path;
+            std::chrono::steady_clock::time_point epoch;
+            uint32_t mainTid = 0;
+        };
+
+        // Never destroyed: threads may still return buffers during static destruction
+        Registry &registry()
+        {
+            static Registry *instance = new Registry();
+            return *instance;
+        }
+
+        std::atomic<uint32_t> nextTid{1};
+
+        struct ThreadSlot {
+            Buffer *buffer = nullptr;
+            uint32_t tid = nextTid.fetch_add(1, std::memory_order_relaxed);
+
+            ~ThreadSlot()
+            {
+                if (buffer) {
+                    Registry &reg = registry();
+                    std::lock_guard<std::mutex> lock(reg.mutex);
+                    reg.idle.push_back(buffer);
+                }
+            }
+        };
+
+        thread_local ThreadSlot slot;
+
+        Buffer *threadBuffer()
+        {
+            if (!slot.buffer) {
+                Registry &reg = registry();
+                std::lock_guard<std::mutex> lock(reg.mutex);
+                if (!reg.idle.empty()) {
+                    slot.buffer = reg.idle.back();
+                    reg.idle.pop_back();
+                }
+                else {
+                    reg.buffers.push_back(std::make_unique<Buffer>());
+                    slot.buffer = reg.buffers.back().get();
+                }
+            }
+            return slot.buffer;
+        }
+
+        void append(const Event &event)
+        {
+            Buffer *buffer = threadBuffer();
+            Chunk *chunk = buffer->tail;
+            size_t count = chunk->count.load(std::memory_order_relaxed);
+            if (count == Chunk::CAPACITY) {
+                Chunk *next = new Chunk();
+                chunk->next.store(next, std::memory_order_release);
+                buffer->tail = chunk = next;
+                count = 0;
+            }
+            chunk->events[count] = event;
+            chunk->count.store(count + 1, std::memory_order_release);
+        }
+
+        void writeString(std::FILE *file, const char *text)
+        {
+            std::fputc('"', file);
+            for (const char *c = text; *c; ++c) {
+                if (*c == '"' || *c == '\\') {
+                    std::fputc('\\', file);
+                }
+                std::fputc(*c, file);
+            }
+            std::fputc('"', file);
+        }
+
+        void stopAtExit()
+        {
+            stop();
+        }
+    }
+
+    /**
+     * @brief Starts recording; the trace is written to path by stop() or at exit.
+     *
+     * @param path File to write the Chrome trace JSON to.
+     */
+    void start(const std::string &path)
+    {
+        Registry &reg = registry();
+        {
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            // Owners only append while tracing is on, and the store below publishes the reset
+            for (const auto &buffer : reg.buffers) {
+                buffer->clear();
+            }
+            reg.path = path;
+            reg.epoch = std::chrono::steady_clock::now();
+            reg.mainTid = slot.tid;
+        }
+        static bool registered = (std::atexit(stopAtExit), true);
+        (void)registered;
+        detail::active.store(true, std::memory_order_release);
+    }
+
+    /**
+     * @brief Stops recording and writes every recorded span.
+     *
+     * Spans still being appended by other threads are either published
+     * before the read of their chunk's count or dropped; both are safe.
+     */
+    void stop()
+    {
+        if (!detail::active.exchange(false)) {
+            return;
+        }
+        Registry &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        std::FILE *file = std::fopen(reg.path.c_str(), "w");
+        if (!file) {
+            std::perror(reg.path.c_str());
+            return;
+        }
+
+        std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        std::fprintf(file, "{\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"name\":\"thread_name\",\"args\":{\"name\":\"main\"}}",
+                     reg.mainTid);
+        for (const auto &buffer : reg.buffers) {
+            for (const Chunk *chunk = &buffer->head; chunk; chunk = chunk->next.load(std::memory_order_acquire)) {
+                const size_t count = chunk->count.load(std::memory_order_acquire);
+                for (size_t i = 0; i < count; ++i) {
+                    const Event &event = chunk->events[i];
+                    std::fprintf(file, ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%lld,\"dur\":%lld,\"name\":",
+                                 event.tid, static_cast<long long>(event.begin), static_cast<long long>(event.duration));
+                    writeString(file, event.name);
+                    std::fprintf(file, ",\"cat\":");
+                    writeString(file, event.category);
+                    if (event.argCount > 0) {
+                        std::fprintf(file, ",\"args\":{");
+                        for (int a = 0; a < event.argCount; ++a) {
+                            if (a > 0) {
+                                std::fputc(',', file);
+                            }
+                            writeString(file, event.argKeys[a]);
+                            std::fprintf(file, ":%lld", static_cast<long long>(event.argValues[a]));
+                        }
+                        std::fputc('}', file);
+                    }
+                    std::fputc('}', file);
+                }
+            }
+        }
+        std::fprintf(file, "\n]}\n");
+        std::fclose(file);
+    }
+
+    /**
+     * @brief Returns microseconds since start(), or -1 while tracing is off.
+     */
+    int64_t now() noexcept
+    {
+        if (!enabled()) {
+            return -1;
+        }
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() -
+                                                                     registry().epoch).count();
+    }
+
+    /**
+     * @brief Records a span on the calling thread's track.
+     */
+    void record(const char *name, const char *category, int64_t begin, int64_t end) noexcept
+    {
+        if (!enabled() || begin < 0) {
+            return;
+        }
+        append(Event{name, category, begin, end - begin, slot.tid, 0, {}, {}});
+    }
+
+    /**
+     * @brief Records the span of a scope that began while tracing was on.
+     */
+    void Scope::finish() noexcept
+    {
+        if (!enabled()) {
+            return;
+        }
+        Event event{name, "exec", begin, now() - begin, slot.tid, argCount, {}, {}};
+        for (int i = 0; i < argCount; ++i) {
+            event.argKeys[i] = argKeys[i];
+            event.argValues[i] = argValues[i];
+        }
+        append(event);
+    }
+
+    void Scope::arg(const char *key, int64_t value) noexcept
+    {
+        if (begin >= 0 && argCount < 3) {
+            argKeys[argCount] = key;
+            argValues[argCount] = value;
+            ++argCount;
+        }
+    }
+}
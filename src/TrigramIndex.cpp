@@ -0,0 +1,253 @@
+#include "TrigramIndex.h"
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+using std::string;
+using std::vector;
+
+namespace
+{
+    inline unsigned char fold(char c)
+    {
+        unsigned char byte = static_cast<unsigned char>(c);
+        return byte >= 'A' && byte <= 'Z' ? static_cast<unsigned char>(byte + ('a' - 'A')) : byte;
+    }
+
+    inline int lowestBit(uint64_t word)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, word);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctzll(word);
+#endif
+    }
+}
+
+/**
+ * @brief Returns the case-folded trigrams of a text, without duplicates.
+ *
+ * @param text Text to split.
+ * @return Sorted trigram keys; empty if the text is shorter than three bytes.
+ */
+vector<uint32_t> trigramsOf(const string &text)
+{
+    vector<uint32_t> trigrams;
+    if (text.size() < 3) {
+        return trigrams;
+    }
+    trigrams.reserve(text.size() - 2);
+    uint32_t key = (uint32_t(fold(text[0])) << 8) | fold(text[1]);
+    for (size_t i = 2; i < text.size(); ++i) {
+        key = ((key << 8) | fold(text[i])) & 0xFFFFFF;
+        trigrams.push_back(key);
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    return trigrams;
+}
+
+/**
+ * @brief Adds a task's description to the index.
+ *
+ * @param id Task ID.
+ * @param description Task description.
+ */
+void TrigramIndex::insert(int id, const string &description)
+{
+    for (uint32_t trigram : trigramsOf(description)) {
+        vector<int> &ids = postings[trigram];
+        if (ids.empty() || ids.back() < id) {
+            ids.push_back(id);
+            continue;
+        }
+        auto it = std::lower_bound(ids.begin(), ids.end(), id);
+        if (*it != id) {
+            ids.insert(it, id);
+        }
+    }
+    maxId = std::max(maxId, id);
+}
+
+/**
+ * @brief Removes a task's description from the index.
+ *
+ * @param id Task ID.
+ * @param description Description the task was inserted with.
+ */
+void TrigramIndex::erase(int id, const string &description)
+{
+    for (uint32_t trigram : trigramsOf(description)) {
+        auto posting = postings.find(trigram);
+        if (posting == postings.end()) {
+            continue;
+        }
+        vector<int> &ids = posting->second;
+        auto it = std::lower_bound(ids.begin(), ids.end(), id);
+        if (it != ids.end() && *it == id) {
+            ids.erase(it);
+        }
+        if (ids.empty()) {
+            postings.erase(posting);
+        }
+    }
+}
+
+/**
+ * @brief Removes every entry.
+ */
+void TrigramIndex::clear()
+{
+    postings.clear();
+    maxId = 0;
+}
+
+/**
+ * @brief Estimates the heap memory held by the index.
+ *
+ * Each trigram costs a hash node, taken as a next pointer plus the key and
+ * vector, and its posting list's capacity; the bucket array is added once.
+ */
+size_t TrigramIndex::memoryBytes() const
+{
+    size_t bytes = postings.bucket_count() * sizeof(void *);
+    for (const auto &posting : postings) {
+        bytes += sizeof(void *) + sizeof(posting) + posting.second.capacity() * sizeof(int);
+    }
+    return bytes;
+}
+
+/**
+ * @brief Visits the tasks that may lie within maxEdits of a substring of the query.
+ *
+ * Shared trigrams are counted by sorting the concatenated posting lists when
+ * they are short, and in a dense array indexed by ID when they are long, so
+ * rare trigrams stay cheap and common ones avoid hashing.
+ *
+ * @param query Search text of at least three characters.
+ * @param maxEdits Edit budget of the search.
+ * @param visit Called for each candidate; returns false to stop.
+ */
+void TrigramIndex::forEachCandidate(const string &query, int maxEdits,
+                                    const std::function<bool(const TrigramCandidate &)> &visit) const
+{
+    vector<const vector<int> *> lists;
+    size_t total = 0;
+    const vector<uint32_t> trigrams = trigramsOf(query);
+    for (uint32_t trigram : trigrams) {
+        auto posting = postings.find(trigram);
+        if (posting != postings.end()) {
+            lists.push_back(&posting->second);
+            total += posting->second.size();
+        }
+    }
+
+    const int queryTrigrams = static_cast<int>(trigrams.size());
+    const int threshold = std::max(1, queryTrigrams - 4 * maxEdits);
+    if (static_cast<int>(lists.size()) < threshold) {
+        return;
+    }
+    auto minEdits = [queryTrigrams](int shared) { return (queryTrigrams - shared + 3) / 4; };
+
+    if (total < static_cast<size_t>(maxId) / 16) {
+        vector<int> ids;
+        ids.reserve(total);
+        for (const auto *list : lists) {
+            ids.insert(ids.end(), list->begin(), list->end());
+        }
+        std::sort(ids.begin(), ids.end());
+
+        vector<vector<int>> byMinEdits(static_cast<size_t>(maxEdits) + 1);
+        for (size_t i = 0; i < ids.size();) {
+            size_t run = i;
+            while (run < ids.size() && ids[run] == ids[i]) {
+                ++run;
+            }
+            if (static_cast<int>(run - i) >= threshold) {
+                byMinEdits[static_cast<size_t>(minEdits(static_cast<int>(run - i)))].push_back(ids[i]);
+            }
+            i = run;
+        }
+        for (size_t edits = 0; edits < byMinEdits.size(); ++edits) {
+            for (int id : byMinEdits[edits]) {
+                if (!visit(TrigramCandidate{id, static_cast<int>(edits)})) {
+                    return;
+                }
+            }
+        }
+        return;
+    }
+
+    vector<uint16_t> counts(static_cast<size_t>(maxId) + 1, 0);
+    for (const auto *list : lists) {
+        for (int id : *list) {
+            ++counts[static_cast<size_t>(id)];
+        }
+    }
+    // One sweep per edit level keeps the visiting order without sorting. The
+    // level's counts form the range [low, high], tested 64 IDs at a time
+    // without branches.
+    for (int edits = 0; edits <= maxEdits; ++edits) {
+        const int low = std::max(threshold, queryTrigrams - 4 * edits);
+        const int high = queryTrigrams - 4 * edits + 3;
+        if (high < low) {
+            continue;
+        }
+        const uint16_t width = static_cast<uint16_t>(high - low);
+        for (size_t begin = 0; begin < counts.size(); begin += 64) {
+            const size_t count = std::min<size_t>(64, counts.size() - begin);
+            uint64_t mask = 0;
+            for (size_t j = 0; j < count; ++j) {
+                mask |= static_cast<uint64_t>(static_cast<uint16_t>(counts[begin + j] - low) <= width) << j;
+            }
+            for (; mask; mask &= mask - 1) {
+                const int id = static_cast<int>(begin + lowestBit(mask));
+                if (!visit(TrigramCandidate{id, edits})) {
+                    return;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Computes the smallest edit distance between a pattern and any substring of a text.
+ *
+ * Sellers' variant of the optimal string alignment recurrence: row 0 is all
+ * zeros, so a match may start anywhere in the text, and the answer is the
+ * minimum of the last row. Only the last two columns are kept.
+ *
+ * @param pattern Text searched for.
+ * @param text Text searched in.
+ * @param maxEdits Distance above which the result is capped.
+ * @return The distance, or maxEdits + 1 if it exceeds maxEdits.
+ */
+int substringEditDistance(const string &pattern, const string &text, int maxEdits)
+{
+    const size_t m = pattern.size();
+    vector<int> beforeLast(m + 1), last(m + 1), column(m + 1);
+    for (size_t i = 0; i <= m; ++i) {
+        last[i] = static_cast<int>(i);
+    }
+    int best = last[m];
+
+    for (size_t j = 0; j < text.size() && best > 0; ++j) {
+        const unsigned char folded = fold(text[j]);
+        column[0] = 0;
+        for (size_t i = 1; i <= m; ++i) {
+            const unsigned char wanted = fold(pattern[i - 1]);
+            column[i] = std::min({last[i] + 1, column[i - 1] + 1, last[i - 1] + (wanted == folded ? 0 : 1)});
+            if (i > 1 && j > 0 && wanted == fold(text[j - 1]) && fold(pattern[i - 2]) == folded) {
+                column[i] = std::min(column[i], beforeLast[i - 2] + 1);
+            }
+        }
+        best = std::min(best, column[m]);
+        std::swap(beforeLast, last);
+        std::swap(last, column);
+    }
+    return std::min(best, maxEdits + 1);
+}
@@ -1,10 +1,35 @@
 #include "TaskManager.h"
 #include "Database.h"
 #include "ColorManager.hpp" // Include ColorManager.hpp for terminal colors
+#include "Renderer.h"
+#include "Trace.h"
 #include <iostream>
 #include <limits>     // for std::numeric_limits
 #include <fmt/core.h> // fmt library for formatted output
 #include <future>     // for std::async, std::future
+#include <csignal>    // for std::signal
+#include <sstream>    // for std::istringstream, std::stringstream
+#include <vector>
+#include <ctime>      // for std::time
+#include <chrono>     // for std::chrono::steady_clock
+#include <cctype>     // for std::isprint
+#include <cstdio>     // for std::fflush
+#include <cstdlib>    // for std::atoi
+#include <stdexcept>  // for std::invalid_argument
+
+#ifdef __linux__
+#include "Server.h"
+#include "Client.h"
+#endif
+
+#ifndef _WIN32
+#include <termios.h> // for tcgetattr, tcsetattr
+#include <unistd.h>  // for isatty, read
+#include <spawn.h>     // for posix_spawn
+#include <sys/wait.h>  // for waitpid
+
+extern char **environ; // Inherited by reminder commands
+#endif
 
 using fmt::print;
 using std::async;
@@ -12,35 +37,191 @@ using std::future;
 using std::launch;
 using std::string;
 
+const int MENU_CHOICES = 26; // Highest valid menu choice
+std::FILE *menuOut = stdout;  // Menu, prompts and messages; stderr with --format json, so stdout holds only tasks
+
+/**
+ * @brief Background work requested on the command line.
+ */
+struct BackgroundJobs {
+    string backupPath;      ///< Backup file; empty if periodic backups are off.
+    int backupMinutes = 60; ///< Time between backups.
+    int archiveDays = 0;    ///< Archive tasks completed more than this many days ago; 0 if off.
+    bool remind = false;    ///< Print a line when a pending task becomes due.
+    string remindCommand;   ///< Shell command run when a pending task becomes due; empty if off.
+};
+
 // Function declarations
-void displayMenu();
+void displayMenu(bool readOnly);
+bool isMutation(int choice);
 int getUserChoice();
 void addTask(TaskManager &taskManager);
 void listTasks(TaskManager &taskManager);
 void markTaskDone(TaskManager &taskManager);
 void deleteTask(TaskManager &taskManager);
 void clearAllData(TaskManager &taskManager);
+void tagTask(TaskManager &taskManager);
+void untagTask(TaskManager &taskManager);
+void listTasksByTags(TaskManager &taskManager);
+void historyReport(TaskManager &taskManager);
+void printSearchResults(TaskManager &taskManager, const string &query);
+void searchTasks(TaskManager &taskManager);
+void addRecurringTask(TaskManager &taskManager);
+void listRecurringTasks(TaskManager &taskManager);
+void stopRecurringTask(TaskManager &taskManager);
+void purgeCompletedTasks(TaskManager &taskManager);
+void markRangeDone(TaskManager &taskManager);
+void addDependency(TaskManager &taskManager);
+void removeDependency(TaskManager &taskManager);
+void listReadyTasks(TaskManager &taskManager);
+void setDueTime(TaskManager &taskManager);
+void undo(TaskManager &taskManager);
+void redo(TaskManager &taskManager);
+void filterTasks(TaskManager &taskManager);
+void backupDatabase(Database &database);
+void searchArchive(Database &database);
+void memoryReport(TaskManager &taskManager, Database &database);
+void startBackgroundJobs(Database &database, const BackgroundJobs &jobs);
+void startReminders(TaskManager &taskManager, const BackgroundJobs &jobs);
+void runReminderCommand(const string &command, const Task &task);
+void printUsage();
+int migrate(const string &filename, const BusyPolicy &busy);
+int vacuum(const string &filename, const BusyPolicy &busy);
+int sync(const string &filename, const string &replicaPath, const BusyPolicy &busy);
+int exportArchive(const string &filename, OutputFormat format, const BusyPolicy &busy);
+int printFiltered(const string &filename, AccessMode mode, const BusyPolicy &busy, OutputFormat format,
+                  const string &expression);
+int serve(const string &filename, AccessMode mode, const BusyPolicy &busy, const BackgroundJobs &jobs, size_t cacheBudget,
+          const string &socketPath);
+int forward(const string &socketPath, OutputFormat format, int argc, char *argv[]);
 
 /**
  * @brief Main function for the Todo List CLI application.
  *
  * Initializes the database and task manager, displays a menu,
- * and handles user input to manage tasks.
+ * and handles user input to manage tasks. With --serve it instead runs
+ * as a daemon, and with --connect it forwards one command to a daemon.
+ * --readonly and --snapshot open the database without write access, and
+ * --migrate finishes pending schema migrations in the foreground and exits.
+ * --vacuum lets an older file return freed pages to the OS.
+ * --backup copies the database to a file periodically while running,
+ * --archive-after moves old completed tasks into compressed archive blocks,
+ * --export-archive prints the archived tasks, and --sync brings a replica
+ * file up to date by applying only the changes. --cache-budget bounds the
+ * memory used for tasks instead of holding all of them. --remind and
+ * --remind-command report pending tasks as their due times pass, and
+ * --filter prints the tasks matching a filter expression. --busy-timeout
+ * and --busy-retries bound how long writes wait for other processes.
  *
  * @return 0 on successful completion.
  */
 
-int main() {
+int main(int argc, char *argv[]) {
     string filename = "tasks.db"; // Path of the database file
-    Database database(filename);
 
-    TaskManager taskManager(database);
+    OutputFormat format = detectOutputFormat(); // Colors only when stdout is a terminal
+    AccessMode mode = AccessMode::ReadWrite;
+    BackgroundJobs jobs;
+    bool exportArchived = false;
+    bool filtering = false;
+    string filterExpression;
+    size_t cacheBudget = 0; // Bytes; 0 keeps every task in memory
+    BusyPolicy busy;        // How long writes wait for other processes' locks
+
+    for (int i = 1; i < argc; ++i) {
+        string option = argv[i];
+        if (option == "--format" && i + 1 < argc && parseOutputFormat(argv[i + 1], format)) {
+            ++i;
+        }
+        else if (option == "--trace" && i + 1 < argc) {
+            Trace::start(argv[++i]); // Written when the process exits
+        }
+        else if (option == "--readonly") {
+            mode = AccessMode::ReadOnly;
+        }
+        else if (option == "--snapshot") {
+            mode = AccessMode::Immutable;
+        }
+        else if (option == "--backup" && i + 1 < argc) {
+            jobs.backupPath = argv[++i];
+        }
+        else if (option == "--backup-interval" && i + 1 < argc && std::atoi(argv[i + 1]) > 0) {
+            jobs.backupMinutes = std::atoi(argv[++i]);
+        }
+        else if (option == "--archive-after" && i + 1 < argc && std::atoi(argv[i + 1]) > 0) {
+            jobs.archiveDays = std::atoi(argv[++i]);
+        }
+        else if (option == "--cache-budget" && i + 1 < argc && std::atoi(argv[i + 1]) > 0) {
+            cacheBudget = static_cast<size_t>(std::atoi(argv[++i])) << 20;
+        }
+        else if (option == "--busy-timeout" && i + 1 < argc && std::atoi(argv[i + 1]) >= 0) {
+            busy.timeout = std::chrono::milliseconds(std::atoi(argv[++i]));
+        }
+        else if (option == "--busy-retries" && i + 1 < argc && std::atoi(argv[i + 1]) >= 0) {
+            busy.retries = std::atoi(argv[++i]);
+        }
+        else if (option == "--remind") {
+            jobs.remind = true;
+        }
+        else if (option == "--remind-command" && i + 1 < argc) {
+            jobs.remindCommand = argv[++i];
+        }
+        else if (option == "--export-archive") {
+            exportArchived = true; // After the loop, so a later --format still applies
+        }
+        else if (option == "--filter" && i + 1 < argc) {
+            filtering = true; // After the loop, like --export-archive
+            filterExpression = argv[++i];
+        }
+        else if (option == "--migrate") {
+            return migrate(filename, busy);
+        }
+        else if (option == "--vacuum") {
+            return vacuum(filename, busy);
+        }
+        else if (option == "--sync" && i + 1 < argc) {
+            return sync(filename, argv[i + 1], busy);
+        }
+        else if (option == "--serve" && i + 1 < argc) {
+            return serve(filename, mode, busy, jobs, cacheBudget, argv[i + 1]);
+        }
+        else if (option == "--connect" && i + 2 < argc) {
+            return forward(argv[i + 1], format, argc - i - 2, argv + i + 2);
+        }
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (exportArchived) {
+        return exportArchive(filename, format, busy);
+    }
+    if (filtering) {
+        return printFiltered(filename, mode, busy, format, filterExpression);
+    }
+
+    if (format == OutputFormat::JsonLines) {
+        menuOut = stderr; // Scripts reading the JSON Lines see no menu chrome
+    }
+    Database database(filename, mode, busy);
+    database.startMaintenance(); // Reclaim pages freed by deletes and clears in the background
+    future<bool> migration = database.migrateAsync(); // Backfill in short chunks while the menu stays usable
+    startBackgroundJobs(database, jobs);
+
+    TaskManager taskManager(database, cacheBudget);
+    taskManager.setRenderer(makeRenderer(format));
+    startReminders(taskManager, jobs);
+    const bool readOnly = taskManager.isReadOnly();
 
     int choice;
     do
     {
-        displayMenu();
+        displayMenu(readOnly);
         choice = getUserChoice();
+        if (readOnly && isMutation(choice)) {
+            print(menuOut, "{}Not available in read-only mode.\n{}", Color::RED(), Color::RESET());
+            continue;
+        }
 
         switch (choice)
         {
@@ -57,32 +238,125 @@ int main() {
             deleteTask(taskManager);
             break;
         case 5:
-            print("{}Tasks saved. Exiting...\n{}", Color::MAGENTA(), Color::RESET());
+            print(menuOut, "{}{}Exiting...\n{}", Color::MAGENTA(), readOnly ? "" : "Tasks saved. ", Color::RESET());
             break;
         case 6:
             clearAllData(taskManager);
             break;
+        case 7:
+            tagTask(taskManager);
+            break;
+        case 8:
+            untagTask(taskManager);
+            break;
+        case 9:
+            listTasksByTags(taskManager);
+            break;
+        case 10:
+            historyReport(taskManager);
+            break;
+        case 11:
+            searchTasks(taskManager);
+            break;
+        case 12:
+            addRecurringTask(taskManager);
+            break;
+        case 13:
+            listRecurringTasks(taskManager);
+            break;
+        case 14:
+            stopRecurringTask(taskManager);
+            break;
+        case 15:
+            purgeCompletedTasks(taskManager);
+            break;
+        case 16:
+            markRangeDone(taskManager);
+            break;
+        case 17:
+            backupDatabase(database);
+            break;
+        case 18:
+            searchArchive(database);
+            break;
+        case 19:
+            addDependency(taskManager);
+            break;
+        case 20:
+            removeDependency(taskManager);
+            break;
+        case 21:
+            listReadyTasks(taskManager);
+            break;
+        case 22:
+            setDueTime(taskManager);
+            break;
+        case 23:
+            undo(taskManager);
+            break;
+        case 24:
+            redo(taskManager);
+            break;
+        case 25:
+            filterTasks(taskManager);
+            break;
+        case 26:
+            memoryReport(taskManager, database);
+            break;
         default:
-            print("{}Invalid choice. Try again.\n{}", Color::RED(), Color::RESET());
+            print(menuOut, "{}Invalid choice. Try again.\n{}", Color::RED(), Color::RESET());
         }
     } while (choice != 5);
 
+    database.stopMigrations(); // An unfinished backfill resumes on the next start
     return 0;
 }
 
 /**
  * @brief Displays the menu for the Todo List application.
+ *
+ * @param readOnly Hide the entries that modify the database.
  */
-void displayMenu() {
+void displayMenu(bool readOnly) {
     // Display the menu with color using fmt for formatted output
-    print("{}\nTodo List Menu\n{}\n", Color::CYAN(), Color::RESET());
-    print("1. {}Add Task{}\n", Color::GREEN(), Color::RESET());
-    print("2. {}List Tasks{}\n", Color::YELLOW(), Color::RESET());
-    print("3. {}Mark Task as Done{}\n", Color::BLUE(), Color::RESET());
-    print("4. {}Delete Task{}\n", Color::RED(), Color::RESET());
-    print("5. {}Save and Exit{}\n", Color::MAGENTA(), Color::RESET());
-    print("6. {}Clear All Data{}\n", Color::BRIGHT_RED(), Color::RESET());
-    print("Enter your choice: ");
+    print(menuOut, "{}\nTodo List Menu{}{}\n", Color::CYAN(), readOnly ? " (read-only)" : "", Color::RESET());
+    if (!readOnly) print(menuOut, "1. {}Add Task{}\n", Color::GREEN(), Color::RESET());
+    print(menuOut, "2. {}List Tasks{}\n", Color::YELLOW(), Color::RESET());
+    if (!readOnly) print(menuOut, "3. {}Mark Task as Done{}\n", Color::BLUE(), Color::RESET());
+    if (!readOnly) print(menuOut, "4. {}Delete Task{}\n", Color::RED(), Color::RESET());
+    print(menuOut, "5. {}{}{}\n", Color::MAGENTA(), readOnly ? "Exit" : "Save and Exit", Color::RESET());
+    if (!readOnly) print(menuOut, "6. {}Clear All Data{}\n", Color::BRIGHT_RED(), Color::RESET());
+    if (!readOnly) print(menuOut, "7. {}Tag Task{}\n", Color::GREEN(), Color::RESET());
+    if (!readOnly) print(menuOut, "8. {}Untag Task{}\n", Color::RED(), Color::RESET());
+    print(menuOut, "9. {}List Tasks by Tags{}\n", Color::YELLOW(), Color::RESET());
+    print(menuOut, "10. {}History Report{}\n", Color::CYAN(), Color::RESET());
+    print(menuOut, "11. {}Search Tasks{}\n", Color::BLUE(), Color::RESET());
+    if (!readOnly) print(menuOut, "12. {}Add Recurring Task{}\n", Color::GREEN(), Color::RESET());
+    if (!readOnly) print(menuOut, "13. {}List Recurring Tasks{}\n", Color::YELLOW(), Color::RESET());
+    if (!readOnly) print(menuOut, "14. {}Stop Recurring Task{}\n", Color::RED(), Color::RESET());
+    if (!readOnly) print(menuOut, "15. {}Purge Completed Tasks{}\n", Color::BRIGHT_RED(), Color::RESET());
+    if (!readOnly) print(menuOut, "16. {}Mark Range as Done{}\n", Color::BLUE(), Color::RESET());
+    print(menuOut, "17. {}Back Up Database{}\n", Color::CYAN(), Color::RESET());
+    print(menuOut, "18. {}Search Archive{}\n", Color::CYAN(), Color::RESET());
+    if (!readOnly) print(menuOut, "19. {}Add Dependency{}\n", Color::GREEN(), Color::RESET());
+    if (!readOnly) print(menuOut, "20. {}Remove Dependency{}\n", Color::RED(), Color::RESET());
+    print(menuOut, "21. {}List Ready Tasks{}\n", Color::YELLOW(), Color::RESET());
+    if (!readOnly) print(menuOut, "22. {}Set Due Time{}\n", Color::CYAN(), Color::RESET());
+    if (!readOnly) print(menuOut, "23. {}Undo{}\n", Color::MAGENTA(), Color::RESET());
+    if (!readOnly) print(menuOut, "24. {}Redo{}\n", Color::MAGENTA(), Color::RESET());
+    print(menuOut, "25. {}Filter Tasks{}\n", Color::YELLOW(), Color::RESET());
+    print(menuOut, "26. {}Memory Report{}\n", Color::CYAN(), Color::RESET());
+    print(menuOut, "Enter your choice: ");
+}
+
+/**
+ * @brief Returns true if a menu choice modifies the database.
+ *
+ * @param choice Menu choice.
+ */
+bool isMutation(int choice) {
+    return choice == 1 || choice == 3 || choice == 4 || choice == 6 || choice == 7 || choice == 8 ||
+           (choice >= 12 && choice <= 16) || choice == 19 || choice == 20 || (choice >= 22 && choice <= 24);
 }
 
 /**
@@ -94,13 +368,13 @@ int getUserChoice() {
     int choice;
 
     // Input validation
-    while (!(std::cin >> choice) || choice < 1 || choice > 6)
+    while (!(std::cin >> choice) || choice < 1 || choice > MENU_CHOICES)
     {
         std::cin.clear();                                                   // clear input buffer to restore cin to a usable state
         std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); // ignore bad input
-        print("{}Invalid choice. Please enter a number between 1 and 6.\n{}",
-                   Color::RED(), Color::RESET());
-        print("Enter your choice: ");
+        print(menuOut, "{}Invalid choice. Please enter a number between 1 and {}.\n{}",
+                   Color::RED(), MENU_CHOICES, Color::RESET());
+        print(menuOut, "Enter your choice: ");
     }
     std::cin.ignore();
 
@@ -114,7 +388,7 @@ int getUserChoice() {
  */
 void addTask(TaskManager &taskManager) {
     std::string description;
-    print("Enter task description: ");
+    print(menuOut, "Enter task description: ");
     std::getline(std::cin, description);
 
     // Asynchronously add task
@@ -131,6 +405,9 @@ void addTask(TaskManager &taskManager) {
  * @param taskManager Reference to the TaskManager object.
  */
 void listTasks(TaskManager &taskManager) {
+    // Pick up changes made by other todolist processes sharing the database
+    taskManager.refreshAsync().get();
+
     // Asynchronously list tasks
     auto listTasksFuture = async(launch::async, [&]()
                                  { return taskManager.listTasksAsync(); });
@@ -146,7 +423,7 @@ void listTasks(TaskManager &taskManager) {
  */
 void markTaskDone(TaskManager &taskManager) {
     int id;
-    print("Enter task number to mark as done: ");
+    print(menuOut, "Enter task number to mark as done: ");
     std::cin >> id;
 
     // Asynchronously mark task as done
@@ -164,7 +441,7 @@ void markTaskDone(TaskManager &taskManager) {
  */
 void deleteTask(TaskManager &taskManager) {
     int id;
-    print("Enter task number to delete: ");
+    print(menuOut, "Enter task number to delete: ");
     std::cin >> id;
 
     // Asynchronously delete task
@@ -188,5 +465,836 @@ void clearAllData(TaskManager &taskManager) {
     // Wait for the task to complete before continuing
     clearAllDataFuture.get();
 
-    print("{}All tasks cleared.\n{}", Color::BRIGHT_RED(), Color::RESET());
+    print(menuOut, "{}All tasks cleared.\n{}", Color::BRIGHT_RED(), Color::RESET());
+}
+
+/**
+ * @brief Prompts for a task ID and a tag and adds the tag to the task.
+ *
+ * @param taskManager Reference to the TaskManager object.
+ */
+void tagTask(TaskManager &taskManager) {
+    int id;
+    string tag;
+    print(menuOut, "Enter task number to tag: ");
+    std::cin >> id;
+    print(menuOut, "Enter tag: ");
+    std::cin >> tag;
+
+    try {
+        taskManager.addTagAsync(id, tag).get();
+    }
+    catch (const std::invalid_argument &e) {
+        print(menuOut, "{}Tag not added: {}\n{}", Color::RED(), e.what(), Color::RESET());
+    }
+}
+
+/**
+ * @brief Prompts for a task ID and a tag and removes the tag from the task.
+ *
+ * @param taskManager Reference to the TaskManager object.
+ */
+void untagTask(TaskManager &taskManager) {
+    int id;
+    string tag;
+    print(menuOut, "Enter task number to untag: ");
+    std::cin >> id;
+    print(menuOut, "Enter tag: ");
+    std::cin >> tag;
+
+    taskManager.removeTagAsync(id, tag).get();
+}
+
+/**
+ * @brief Prompts for tags and lists the tasks that carry all of them.
+ *
+ * @param taskManager Reference to the TaskManager object.
+ */
+void listTasksByTags(TaskManager &taskManager) {
+    string line;
+    print(menuOut, "Enter tags separated by spaces: ");
+    std::getline(std::cin, line);
+    print(menuOut, "Pending tasks only? (y/n): ");
+    string answer;
+    std::getline(std::cin, answer);
+
+    std::vector<string> tags;
+    std::istringstream words(line);
+    for (string tag; words >> tag;) {
+        tags.push_back(tag);
+    }
+
+    taskManager.refreshAsync().get();
+    taskManager.listTasksWithTagsAsync(tags, answer == "y" || answer == "Y").get();
+}
+
+/**
+ * @brief Prompts for a filter expression and lists the matching tasks.
+ *
+ * @param taskManager Reference to the TaskManager object.
+ */
+void filterTasks(TaskManager &taskManager) {
+    string expression;
+    print(menuOut, "Filter (e.g. done=0 and created>2026-01-01 and text~\"deploy\"): ");
+    std::getline(std::cin, expression);
+
+    try {
+        taskManager.listTasksMatchingAsync(expression).get();
+    }
+    catch (const std::invalid_argument &e) {
+        print(menuOut, "{}{}\n{}", Color::RED(), e.what(), Color::RESET());
+    }
+}
+
+/**
+ * @brief Prompts for granularity, period and format and prints the history report.
+ *
+ * @param taskManager Reference to the TaskManager object.
+ */
+void historyReport(TaskManager &taskManager) {
+    string granularity, format;
+    int days;
+    print(menuOut, "Granularity (d = day, w = week, m = month): ");
+    std::cin >> granularity;
+    print(menuOut, "Number of days to report (0 = all): ");
+    std::cin >> days;
+    print(menuOut, "Format (s = sparkline, c = csv): ");
+    std::cin >> format;
+
+    HistoryGranularity bucket = granularity == "w" ? HistoryGranularity::Week
+                              : granularity == "m" ? HistoryGranularity::Month
+                                                   : HistoryGranularity::Day;
+    int64_t from = std::numeric_limits<int64_t>::min();
+    if (days > 0) {
+        from = static_cast<int64_t>(std::time(nullptr)) - static_cast<int64_t>(days) * 86400;
+    }
+
+    taskManager.refreshAsync().get();
+    taskManager.historyReportAsync(bucket, from, std::numeric_limits<int64_t>::max(),
+                                   format == "c" ? HistoryFormat::Csv : HistoryFormat::Sparkline).get();
+}
+
+/**
+ * @brief Prints the best matches for a search query and how long the search took.
+ *
+ * @param taskManager Reference to the TaskManager object.
+ * @param query Text searched for.
+ */
+void printSearchResults(TaskManager &taskManager, const string &query) {
+    const size_t SEARCH_RESULTS = 10; // Matches shown per query
+
+    auto start = std::chrono::steady_clock::now();
+    auto matches = taskManager.searchTasks(query, SEARCH_RESULTS);
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+    for (const auto &task : matches) {
+        print(menuOut, "{}{}. {}{}\n", task.isDone() ? Color::GREEN() : Color::YELLOW(), task.getId(),
+              task.getDescription(), Color::RESET());
+    }
+    print(menuOut, "{}{} shown, {:.2f} ms{}\n", Color::BRIGHT_BLACK(), matches.size(), elapsed.count(), Color::RESET());
+}
+
+/**
+ * @brief Searches task descriptions, tolerating typos.
+ *
+ * On a terminal the matches are refreshed after every keystroke, with stdin
+ * switched out of canonical mode; Enter or Escape returns to the menu.
+ * Otherwise a single query line is read.
+ *
+ * @param taskManager Reference to the TaskManager object.
+ */
+void searchTasks(TaskManager &taskManager) {
+    taskManager.refreshAsync().get();
+
+#ifndef _WIN32
+    if (isatty(STDIN_FILENO) && isatty(STDOUT_FILENO)) {
+        termios saved;
+        tcgetattr(STDIN_FILENO, &saved);
+        termios raw = saved;
+        raw.c_lflag &= ~(ICANON | ECHO);
+        raw.c_cc[VMIN] = 1;
+        raw.c_cc[VTIME] = 0;
+        tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+
+        string query;
+        print(menuOut, "\033[2J\033[HSearch (Enter or Esc to return): ");
+        std::fflush(menuOut);
+        char key;
+        while (read(STDIN_FILENO, &key, 1) == 1 && key != '\n' && key != '\r' && key != 27) {
+            if (key == 127 || key == '\b') {
+                if (query.empty()) {
+                    continue;
+                }
+                query.pop_back();
+            }
+            else if (std::isprint(static_cast<unsigned char>(key))) {
+                query += key;
+            }
+            else {
+                continue;
+            }
+            // Redraw the whole screen: prompt first, then the matches below it
+            print(menuOut, "\033[2J\033[HSearch (Enter or Esc to return): {}\n", query);
+            printSearchResults(taskManager, query);
+            print(menuOut, "\033[1;{}H", 34 + query.size()); // Back to the end of the prompt line
+            std::fflush(menuOut);
+        }
+
+        // Drop the rest of an escape sequence such as an arrow key
+        tcsetattr(STDIN_FILENO, TCSAFLUSH, &saved);
+        print(menuOut, "\n");
+        return;
+    }
+#endif
+
+    string query;
+    print(menuOut, "Search: ");
+    std::getline(std::cin, query);
+    printSearchResults(taskManager, query);
+}
+
+/**
+ * @brief Prompts for a description, a rule and a start and stores a recurring task.
+ *
+ * @param taskManager Reference to the TaskManager object.
+ */
+void addRecurringTask(TaskManager &taskManager) {
+    string description, ruleText;
+    print(menuOut, "Enter task description: ");
+    std::getline(std::cin, description);
+    print(menuOut, "Repeat (daily, weekly, hourly or e.g. FREQ=WEEKLY;INTERVAL=2): ");
+    std::getline(std::cin, ruleText);
+    RecurrenceRule rule;
+    if (!parseRecurrenceRule(ruleText, rule)) {
+        print(menuOut, "{}Unknown rule: {}\n{}", Color::RED(), ruleText, Color::RESET());
+        return;
+    }
+    int hours;
+    print(menuOut, "First occurrence in how many hours (0 = now): ");
+    std::cin >> hours;
+
+    const int64_t firstTime = static_cast<int64_t>(std::time(nullptr)) + static_cast<int64_t>(hours) * 3600;
+    int id = taskManager.addRecurrenceAsync(description, rule, firstTime).get();
+    print(menuOut, "{}Recurring task {} added ({}).\n{}", Color::GREEN(), id, formatRecurrenceRule(rule),
+          Color::RESET());
+}
+
+/**
+ * @brief Lists the recurring task templates with their next window and open task.
+ *
+ * @param taskManager Reference to the TaskManager object.
+ */
+void listRecurringTasks(TaskManager &taskManager) {
+    taskManager.refreshAsync().get(); // Also creates the tasks that have become due
+    for (const Recurrence &recurrence : taskManager.getRecurrencesAsync().get()) {
+        char next[32];
+        time_t nextTime = static_cast<time_t>(recurrence.nextTime);
+        std::tm tm{};
+#ifdef _WIN32
+        localtime_s(&tm, &nextTime);
+#else
+        localtime_r(&nextTime, &tm);
+#endif
+        std::strftime(next, sizeof(next), "%Y-%m-%d %H:%M", &tm);
+        print(menuOut, "{}{}. {}{} [{}] next {}", Color::YELLOW(), recurrence.id, recurrence.description, Color::RESET(),
+              formatRecurrenceRule(recurrence.rule), next);
+        if (recurrence.taskId != 0) print(menuOut, ", open as task {}", recurrence.taskId);
+        print(menuOut, "\n");
+    }
+}
+
+/**
+ * @brief Prompts for a recurring task template and deletes it.
+ *
+ * @param taskManager Reference to the TaskManager object.
+ */
+void stopRecurringTask(TaskManager &taskManager) {
+    int id;
+    print(menuOut, "Enter recurring task number to stop: ");
+    std::cin >> id;
+
+    taskManager.deleteRecurrenceAsync(id).get();
+}
+
+/**
+ * @brief Deletes the tasks completed more than a given number of days ago.
+ *
+ * @param taskManager Reference to the TaskManager object.
+ */
+void purgeCompletedTasks(TaskManager &taskManager) {
+    int days;
+    print(menuOut, "Purge tasks completed more than how many days ago (0 = all): ");
+    std::cin >> days;
+
+    TaskQuery filter;
+    filter.status = TaskQuery::Status::Done;
+    if (days > 0) {
+        filter.completedTo = static_cast<int64_t>(std::time(nullptr)) - static_cast<int64_t>(days) * 86400;
+    }
+    int deleted = taskManager.deleteWhereAsync(filter).get();
+    print(menuOut, "{}{} completed task(s) purged.\n{}", Color::BRIGHT_RED(), deleted, Color::RESET());
+}
+
+/**
+ * @brief Prompts for an inclusive ID range and marks its pending tasks as done.
+ *
+ * @param taskManager Reference to the TaskManager object.
+ */
+void markRangeDone(TaskManager &taskManager) {
+    int first, last;
+    print(menuOut, "First task number: ");
+    std::cin >> first;
+    print(menuOut, "Last task number: ");
+    std::cin >> last;
+    if (last < first || last == std::numeric_limits<int>::max()) {
+        print(menuOut, "{}Invalid range.\n{}", Color::RED(), Color::RESET());
+        return;
+    }
+
+    TaskQuery filter;
+    filter.idFrom = first;
+    filter.idTo = last + 1;
+    int completed = taskManager.markDoneWhereAsync(filter).get();
+    print(menuOut, "{}{} task(s) marked as done.\n{}", Color::BLUE(), completed, Color::RESET());
+}
+
+/**
+ * @brief Prompts for a file and backs the database up to it, showing progress.
+ *
+ * @param database Database to back up; the menu keeps working on it meanwhile.
+ */
+void backupDatabase(Database &database) {
+    string path;
+    print(menuOut, "Back up to file: ");
+    std::getline(std::cin, path);
+    if (path.empty()) return;
+
+    try {
+        database.backupAsync(path, 256, [](const BackupProgress &progress) {
+            const int copied = progress.totalPages - progress.remainingPages;
+            print(menuOut, "\rBacking up: {}/{} pages", copied, progress.totalPages);
+            std::fflush(menuOut);
+        }).get();
+        print(menuOut, "\n{}Backed up to {}.\n{}", Color::GREEN(), path, Color::RESET());
+    }
+    catch (const std::exception &e) {
+        print(menuOut, "\n{}Backup failed: {}\n{}", Color::RED(), e.what(), Color::RESET());
+    }
+}
+
+/**
+ * @brief Prints how much memory SQLite and the task structures hold.
+ *
+ * Use it to size PRAGMA cache_size and --cache-budget: the SQLite figures
+ * come from its own allocator, the task figures are estimates by capacity.
+ *
+ * @param taskManager Reference to the TaskManager object.
+ * @param database Database whose connection is reported.
+ */
+void memoryReport(TaskManager &taskManager, Database &database) {
+    const auto size = [](double bytes) {
+        return bytes < (1 << 20) ? fmt::format("{:.1f} KiB", bytes / 1024) : fmt::format("{:.1f} MiB", bytes / (1 << 20));
+    };
+    try {
+        const SqliteMemoryStats sqlite = database.getMemoryStatsAsync().get();
+        const int64_t reads = sqlite.cacheHits + sqlite.cacheMisses;
+        print(menuOut, "{}SQLite{}\n", Color::CYAN(), Color::RESET());
+        print(menuOut, "  Process total  {:>12} (peak {})\n", size(sqlite.processBytes), size(sqlite.processPeakBytes));
+        print(menuOut, "  Page cache     {:>12} of {}, {:.1f}% hits\n", size(sqlite.pageCacheBytes),
+              size(sqlite.pageCacheLimit), reads ? 100.0 * sqlite.cacheHits / reads : 0.0);
+        print(menuOut, "  Schema         {:>12}\n", size(sqlite.schemaBytes));
+        print(menuOut, "  Statements     {:>12}\n", size(sqlite.statementBytes));
+    }
+    catch (const std::exception &e) {
+        print(menuOut, "{}SQLite statistics unavailable: {}\n{}", Color::RED(), e.what(), Color::RESET());
+    }
+
+    const TaskMemoryStats tasks = taskManager.memoryStats();
+    print(menuOut, "{}Tasks{} ({} in memory)\n", Color::CYAN(), Color::RESET(), tasks.tasks);
+    print(menuOut, "  Task objects   {:>12}\n", size(tasks.taskBytes));
+    print(menuOut, "  Descriptions   {:>12}\n", size(tasks.descriptionBytes));
+    print(menuOut, "  Query columns  {:>12}\n", size(tasks.columnBytes));
+    print(menuOut, "  Tag postings   {:>12}\n", size(tasks.tagBytes));
+    print(menuOut, "  Search index   {:>12}\n", size(tasks.searchIndexBytes));
+    if (tasks.cacheBudget) {
+        print(menuOut, "  Task cache     {:>12} of {}\n", size(tasks.cacheBytes), size(tasks.cacheBudget));
+    }
+    print(menuOut, "  Total          {:>12}\n", size(tasks.total()));
+}
+
+/**
+ * @brief Prompts for two task IDs and makes the first wait until the second is done.
+ *
+ * @param taskManager Reference to the TaskManager object.
+ */
+void addDependency(TaskManager &taskManager) {
+    int id, prerequisiteId;
+    print(menuOut, "Enter task number that waits: ");
+    std::cin >> id;
+    print(menuOut, "Enter task number it waits for: ");
+    std::cin >> prerequisiteId;
+
+    try {
+        taskManager.addDependencyAsync(id, prerequisiteId).get();
+    }
+    catch (const std::invalid_argument &e) {
+        print(menuOut, "{}Dependency not added: {}\n{}", Color::RED(), e.what(), Color::RESET());
+    }
+}
+
+/**
+ * @brief Prompts for two task IDs and removes the dependency between them.
+ *
+ * @param taskManager Reference to the TaskManager object.
+ */
+void removeDependency(TaskManager &taskManager) {
+    int id, prerequisiteId;
+    print(menuOut, "Enter task number that waits: ");
+    std::cin >> id;
+    print(menuOut, "Enter task number it waits for: ");
+    std::cin >> prerequisiteId;
+
+    taskManager.removeDependencyAsync(id, prerequisiteId).get();
+}
+
+/**
+ * @brief Lists the pending tasks that no longer wait for anything.
+ *
+ * @param taskManager Reference to the TaskManager object.
+ */
+void listReadyTasks(TaskManager &taskManager) {
+    taskManager.refreshAsync().get();
+    auto ready = taskManager.readyTasksAsync().get();
+    for (const auto &task : ready) {
+        print(menuOut, "{}{}. {}{}\n", Color::YELLOW(), task.getId(), task.getDescription(), Color::RESET());
+    }
+    print(menuOut, "{}{} ready{}\n", Color::BRIGHT_BLACK(), ready.size(), Color::RESET());
+}
+
+/**
+ * @brief Prompts for a task ID and the minutes until it is due, or 0 to clear its due time.
+ *
+ * @param taskManager Reference to the TaskManager object.
+ */
+void setDueTime(TaskManager &taskManager) {
+    int id, minutes;
+    print(menuOut, "Enter task number: ");
+    std::cin >> id;
+    print(menuOut, "Due in how many minutes (0 to clear): ");
+    std::cin >> minutes;
+
+    const int64_t dueTime = minutes > 0 ? static_cast<int64_t>(std::time(nullptr)) + 60LL * minutes : 0;
+    taskManager.setDueTimeAsync(id, dueTime).get();
+}
+
+/**
+ * @brief Reverts the latest change made in this session.
+ *
+ * @param taskManager Reference to the TaskManager object.
+ */
+void undo(TaskManager &taskManager) {
+    try {
+        const string undone = taskManager.undoAsync().get();
+        if (undone.empty()) {
+            print(menuOut, "{}Nothing to undo\n{}", Color::YELLOW(), Color::RESET());
+        }
+        else {
+            print(menuOut, "{}Undid {}\n{}", Color::GREEN(), undone, Color::RESET());
+        }
+    }
+    catch (const std::invalid_argument &e) {
+        print(menuOut, "{}Cannot undo: {}\n{}", Color::RED(), e.what(), Color::RESET());
+    }
+}
+
+/**
+ * @brief Reapplies the latest change undone in this session.
+ *
+ * @param taskManager Reference to the TaskManager object.
+ */
+void redo(TaskManager &taskManager) {
+    try {
+        const string redone = taskManager.redoAsync().get();
+        if (redone.empty()) {
+            print(menuOut, "{}Nothing to redo\n{}", Color::YELLOW(), Color::RESET());
+        }
+        else {
+            print(menuOut, "{}Redid {}\n{}", Color::GREEN(), redone, Color::RESET());
+        }
+    }
+    catch (const std::invalid_argument &e) {
+        print(menuOut, "{}Cannot redo: {}\n{}", Color::RED(), e.what(), Color::RESET());
+    }
+}
+
+/**
+ * @brief Prompts for a text and lists the archived tasks whose description contains it.
+ *
+ * @param database Database whose archive is searched.
+ */
+void searchArchive(Database &database) {
+    const size_t ARCHIVE_RESULTS = 20; // Matches shown per search
+
+    string text;
+    print(menuOut, "Search archived tasks for: ");
+    std::getline(std::cin, text);
+
+    auto matches = database.searchArchiveAsync(text, ARCHIVE_RESULTS).get();
+    for (const auto &archived : matches) {
+        print(menuOut, "{}{}. {}{}", Color::GREEN(), archived.task.getId(), archived.task.getDescription(),
+              Color::RESET());
+        for (const auto &tag : archived.tags) {
+            print(menuOut, " {}#{}{}", Color::CYAN(), tag, Color::RESET());
+        }
+        print(menuOut, "\n");
+    }
+    print(menuOut, "{}{} shown{}\n", Color::BRIGHT_BLACK(), matches.size(), Color::RESET());
+}
+
+/**
+ * @brief Starts the periodic backups and archiving requested on the command line, if any.
+ *
+ * @param database Database to work on.
+ * @param jobs Requested background work.
+ */
+void startBackgroundJobs(Database &database, const BackgroundJobs &jobs) {
+    if (!jobs.backupPath.empty()) {
+        database.startBackups(jobs.backupPath, std::chrono::minutes(jobs.backupMinutes));
+    }
+    if (jobs.archiveDays > 0) {
+        database.startArchiving(std::chrono::hours(24 * jobs.archiveDays));
+    }
+}
+
+/**
+ * @brief Starts the due-date reminders requested on the command line, if any.
+ *
+ * @param taskManager Task manager whose due times are watched.
+ * @param jobs Requested background work.
+ */
+void startReminders(TaskManager &taskManager, const BackgroundJobs &jobs) {
+    if (!jobs.remind && jobs.remindCommand.empty()) {
+        return;
+    }
+    taskManager.startReminders([jobs](const Task &task) {
+        if (jobs.remind) {
+            print(menuOut, "\n{}Reminder: {}. {} is due{}\n", Color::MAGENTA(), task.getId(), task.getDescription(),
+                  Color::RESET());
+            std::fflush(menuOut);
+        }
+        if (!jobs.remindCommand.empty()) {
+            runReminderCommand(jobs.remindCommand, task);
+        }
+    });
+}
+
+#ifndef _WIN32
+/**
+ * @brief Runs a reminder command through /bin/sh and waits for it.
+ *
+ * The task is passed in TODOLIST_TASK_ID, TODOLIST_TASK_DESCRIPTION and
+ * TODOLIST_TASK_DUE (seconds since the epoch) on top of the inherited
+ * environment, so descriptions never need shell quoting.
+ *
+ * @param command Shell command line.
+ * @param task Task that became due.
+ */
+void runReminderCommand(const string &command, const Task &task) {
+    std::vector<string> variables;
+    for (char **variable = environ; *variable; ++variable) {
+        variables.emplace_back(*variable);
+    }
+    variables.push_back("TODOLIST_TASK_ID=" + std::to_string(task.getId()));
+    variables.push_back("TODOLIST_TASK_DESCRIPTION=" + task.getDescription());
+    variables.push_back("TODOLIST_TASK_DUE=" + std::to_string(static_cast<long long>(task.getDueTime())));
+    std::vector<char *> envp;
+    for (string &variable : variables) {
+        envp.push_back(&variable[0]);
+    }
+    envp.push_back(nullptr);
+
+    string shell = "sh", flag = "-c", line = command;
+    char *argv[] = {&shell[0], &flag[0], &line[0], nullptr};
+    pid_t pid;
+    if (posix_spawn(&pid, "/bin/sh", nullptr, nullptr, argv, envp.data()) != 0) {
+        print(stderr, "{}Cannot run reminder command.\n{}", Color::RED(), Color::RESET());
+        return;
+    }
+    waitpid(pid, nullptr, 0);
+}
+#else
+void runReminderCommand(const string &, const Task &) {
+    print(stderr, "Reminder commands are not supported on Windows.\n");
+}
+#endif
+
+/**
+ * @brief Prints the command line usage.
+ */
+void printUsage() {
+    print("Usage: todolist [options]                        Interactive menu\n");
+    print("       todolist [options] --serve <socket>       Serve tasks to local clients\n");
+    print("       todolist [options] --migrate              Finish schema migrations and exit\n");
+    print("       todolist [options] --vacuum               Let the file shrink as tasks are deleted and exit\n");
+    print("       todolist [options] --sync <replica>       Copy new changes to a replica and exit\n");
+    print("       todolist [options] --export-archive       Print the archived tasks and exit\n");
+    print("       todolist [options] --filter <expression>  Print the tasks matching a filter and exit\n");
+    print("       todolist [--format plain|ansi|json] --connect <socket> add <description> | list | done <id> | delete <id> | clear\n");
+    print("                                                 | filter <expression>\n");
+    print("Options: --format plain|ansi|json  --readonly | --snapshot  --trace <file>\n");
+    print("         --backup <file> [--backup-interval <minutes>]  --archive-after <days>\n");
+    print("         --cache-budget <megabytes>  --remind  --remind-command <command>\n");
+    print("         --busy-timeout <milliseconds>  --busy-retries <count>\n");
+}
+
+/**
+ * @brief Prints every archived task in the requested format.
+ *
+ * @param filename Path of the database file, opened read-only.
+ * @param format Output format, as for listing.
+ * @param busy How long to wait for a writer holding the lock.
+ * @return Process exit code.
+ */
+int exportArchive(const string &filename, OutputFormat format, const BusyPolicy &busy) {
+    try {
+        Database database(filename, AccessMode::ReadOnly, busy);
+        auto renderer = makeRenderer(format);
+        for (const auto &archived : database.getArchivedTasksAsync(std::numeric_limits<int64_t>::min(),
+                                                                   std::numeric_limits<int64_t>::max()).get()) {
+            renderer->render(std::cout, archived.task);
+        }
+        std::cout.flush();
+    }
+    catch (const std::exception &e) {
+        print(stderr, "{}Export failed: {}\n{}", Color::RED(), e.what(), Color::RESET());
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Prints the tasks matching a filter expression in the requested format.
+ *
+ * Only the database is opened, not a TaskManager, so no task list is loaded
+ * besides the matches.
+ *
+ * @param filename Path of the database file, opened without write access.
+ * @param mode Immutable to query a snapshot; any other mode opens read-only.
+ * @param busy How long to wait for a writer holding the lock.
+ * @param format Output format, as for listing.
+ * @param expression Filter expression.
+ * @return Process exit code.
+ */
+int printFiltered(const string &filename, AccessMode mode, const BusyPolicy &busy, OutputFormat format,
+                  const string &expression) {
+    try {
+        Database database(filename, mode == AccessMode::Immutable ? mode : AccessMode::ReadOnly, busy);
+        auto renderer = makeRenderer(format);
+        for (const auto &task : database.getTasksMatchingAsync(expression).get()) {
+            renderer->render(std::cout, task);
+        }
+        std::cout.flush();
+    }
+    catch (const std::exception &e) {
+        print(stderr, "{}Filter failed: {}\n{}", Color::RED(), e.what(), Color::RESET());
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Finishes every pending schema migration, printing progress as it goes.
+ *
+ * @param filename Path of the database file.
+ * @param busy Lock wait and retry limits for the migration steps.
+ * @return Process exit code.
+ */
+int migrate(const string &filename, const BusyPolicy &busy) {
+    try {
+        Database database(filename, AccessMode::ReadWrite, busy);
+        bool reported = false;
+        database.migrateAsync(10000, [&reported](const MigrationProgress &progress) {
+            print("\rMigration {} ({}): {}/{} rows", progress.version, progress.description, progress.rowsDone,
+                  progress.rowsTotal);
+            if (progress.finished) print("\n");
+            std::fflush(stdout);
+            reported = true;
+        }).get();
+        if (!reported) print("Nothing to migrate.\n");
+        print("{}Schema is at version {}.\n{}", Color::GREEN(), database.getSchemaVersionAsync().get(), Color::RESET());
+    }
+    catch (const std::exception &e) {
+        print(stderr, "{}Migration failed: {}\n{}", Color::RED(), e.what(), Color::RESET());
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Converts an older file so the maintenance thread can shrink it.
+ *
+ * Files created before incremental auto_vacuum keep freed pages for reuse;
+ * switching them rewrites the whole file once, blocking other writers.
+ *
+ * @param filename Path of the database file.
+ * @param busy Lock wait and retry limits for the rewrite.
+ * @return Process exit code.
+ */
+int vacuum(const string &filename, const BusyPolicy &busy) {
+    try {
+        Database database(filename, AccessMode::ReadWrite, busy);
+        if (database.enableIncrementalVacuumAsync().get()) {
+            print("{}Freed pages are now returned to the OS.\n{}", Color::GREEN(), Color::RESET());
+        }
+        else {
+            print("{}Already in incremental vacuum mode.\n{}", Color::GREEN(), Color::RESET());
+        }
+    }
+    catch (const std::exception &e) {
+        print(stderr, "{}Vacuum failed: {}\n{}", Color::RED(), e.what(), Color::RESET());
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Brings a replica up to date with the changes since its last sync.
+ *
+ * The replica records the primary's change-log sequence it has applied,
+ * so only the entries after it are exported. Once applied, they are
+ * acknowledged and truncated from the primary's log.
+ *
+ * @param filename Path of the primary database file.
+ * @param replicaPath Path of the replica; created if it does not exist.
+ * @param busy Lock wait and retry limits for both files.
+ * @return Process exit code.
+ */
+int sync(const string &filename, const string &replicaPath, const BusyPolicy &busy) {
+    try {
+        Database primary(filename, AccessMode::ReadWrite, busy);
+        Database replica(replicaPath, AccessMode::ReadWrite, busy);
+        const int64_t from = replica.getAppliedSeqAsync().get();
+        std::stringstream batch;
+        primary.exportChangesAsync(from, batch).get();
+        const int64_t applied = replica.applyChangesAsync(batch).get();
+        const int pruned = primary.acknowledgeChangesAsync(applied).get();
+        print("{}Replica synced from change {} to {}; {} log entries truncated.\n{}", Color::GREEN(), from, applied, pruned,
+              Color::RESET());
+    }
+    catch (const std::exception &e) {
+        print(stderr, "{}Sync failed: {}\n{}", Color::RED(), e.what(), Color::RESET());
+        return 1;
+    }
+    return 0;
+}
+
+#ifdef __linux__
+namespace {
+    Server *activeServer = nullptr; ///< Server stopped by the signal handler.
+
+    void stopServer(int) {
+        if (activeServer) activeServer->stop();
+    }
+}
+
+/**
+ * @brief Runs the daemon until SIGINT or SIGTERM.
+ *
+ * @param filename Path of the database file.
+ * @param mode How to open the database; read-only daemons answer mutations with ERR.
+ * @param busy How long writes wait for other processes holding the lock, and how often they retry.
+ * @param jobs Periodic backups, archiving and reminders to run while serving.
+ * @param cacheBudget Memory in bytes for cached tasks, or 0 to hold all of them.
+ * @param socketPath Path of the Unix domain socket to listen on.
+ * @return Process exit code.
+ */
+int serve(const string &filename, AccessMode mode, const BusyPolicy &busy, const BackgroundJobs &jobs, size_t cacheBudget,
+          const string &socketPath) {
+    Database database(filename, mode, busy);
+    database.startMaintenance();
+    startBackgroundJobs(database, jobs);
+    future<bool> migration = database.migrateAsync();
+    TaskManager taskManager(database, cacheBudget);
+    startReminders(taskManager, jobs);
+
+    try {
+        Server server(taskManager, socketPath);
+        activeServer = &server;
+        std::signal(SIGINT, stopServer);
+        std::signal(SIGTERM, stopServer);
+
+        print("{}Serving {} on {}\n{}", Color::GREEN(), filename, socketPath, Color::RESET());
+        server.run();
+        activeServer = nullptr;
+        database.stopMigrations();
+    }
+    catch (const std::exception &e) {
+        activeServer = nullptr;
+        database.stopMigrations();
+        print(stderr, "{}Server error: {}\n{}", Color::RED(), e.what(), Color::RESET());
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Forwards one command to a running daemon and prints its response.
+ *
+ * @param socketPath Path of the daemon's Unix domain socket.
+ * @param format Output format requested for listings.
+ * @param argc Number of command words.
+ * @param argv Command words, e.g. {"done", "3"}.
+ * @return Process exit code.
+ */
+int forward(const string &socketPath, OutputFormat format, int argc, char *argv[]) {
+    string command = argv[0];
+    string argument;
+    for (int i = 1; i < argc; ++i) {
+        if (i > 1) argument += ' ';
+        argument += argv[i];
+    }
+
+    string request;
+    if (command == "add" && !argument.empty()) request = "ADD " + argument;
+    else if (command == "list") {
+        request = format == OutputFormat::JsonLines ? "LIST json" : format == OutputFormat::Ansi ? "LIST ansi" : "LIST plain";
+    }
+    else if (command == "done" && !argument.empty()) request = "DONE " + argument;
+    else if (command == "delete" && !argument.empty()) request = "DELETE " + argument;
+    else if (command == "clear") request = "CLEAR";
+    else if (command == "filter") {
+        request = format == OutputFormat::JsonLines ? "FILTER json " : format == OutputFormat::Ansi ? "FILTER ansi " : "FILTER plain ";
+        request += argument;
+    }
+    else {
+        printUsage();
+        return 1;
+    }
+
+    try {
+        Client client(socketPath);
+        string body;
+        string status = client.send(request, body);
+        print("{}", body);
+        if (status != "OK") {
+            print(stderr, "{}{}\n{}", Color::RED(), status, Color::RESET());
+            return 1;
+        }
+    }
+    catch (const std::exception &e) {
+        print(stderr, "{}{}\n{}", Color::RED(), e.what(), Color::RESET());
+        return 1;
+    }
+    return 0;
+}
+#else
+int serve(const string &, AccessMode, const BusyPolicy &, const BackgroundJobs &, size_t, const string &) {
+    print(stderr, "Daemon mode is only supported on Linux.\n");
+    return 1;
+}
+
+int forward(const string &, OutputFormat, int, char *[]) {
+    print(stderr, "Daemon mode is only supported on Linux.\n");
+    return 1;
 }
+#endif
@@ -1,6 +1,15 @@
 #include <benchmark/benchmark.h>
 #include "TaskManager.h"
 #include "Database.h"
+#include "TaskQuery.h"
+#include "History.h"
+#include "TrigramIndex.h"
+#include "Trace.h"
+#include <random>
+#include <cstdio>
+#include <memory>
+#include <sstream>
+#include <filesystem>
 
 static void BM_AddTask(benchmark::State &state) {
     Database database("tasks_bench.db");
@@ -77,4 +86,526 @@ static void BM_ClearAllData(benchmark::State &state) {
 }
 BENCHMARK(BM_ClearAllData);
 
+static void BM_SnapshotReads(benchmark::State &state) {
+    // Shared by all benchmark threads; readers never take the writer lock
+    static Database database("tasks_bench.db");
+    static TaskManager taskManager(database);
+
+    for (auto _ : state) {
+        auto snapshot = taskManager.snapshot();
+        benchmark::DoNotOptimize(snapshot->tasks.size());
+    }
+}
+BENCHMARK(BM_SnapshotReads)->ThreadRange(1, 8);
+
+// Half the tasks done, creation times spread over one year
+static std::vector<Task> makeSyntheticTasks(size_t count) {
+    std::vector<Task> tasks;
+    tasks.reserve(count);
+    std::mt19937 rng(42);
+    for (size_t i = 0; i < count; ++i) {
+        time_t created = 1700000000 + static_cast<time_t>(rng() % 31536000);
+        bool done = rng() % 2 == 0;
+        tasks.emplace_back(static_cast<int>(i + 1), "Synthetic task", done, created, done ? created + 3600 : 0);
+    }
+    return tasks;
+}
+
+static const time_t QUERY_CUTOFF = 1700000000 + 31536000 / 2;
+
+static void BM_QueryNaiveLoop(benchmark::State &state) {
+    auto tasks = makeSyntheticTasks(state.range(0));
+
+    for (auto _ : state) {
+        std::vector<uint32_t> selection;
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            if (!tasks[i].isDone() && tasks[i].getCreatedTime() < QUERY_CUTOFF) {
+                selection.push_back(static_cast<uint32_t>(i));
+            }
+        }
+        benchmark::DoNotOptimize(selection.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_QueryNaiveLoop)->Arg(1 << 20);
+
+static void BM_QueryColumnarSelect(benchmark::State &state) {
+    TaskColumns columns = buildColumns(makeSyntheticTasks(state.range(0)));
+    TaskQuery query;
+    query.status = TaskQuery::Status::Pending;
+    query.createdTo = QUERY_CUTOFF;
+
+    for (auto _ : state) {
+        auto selection = selectRows(columns, query);
+        benchmark::DoNotOptimize(selection.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_QueryColumnarSelect)->Arg(1 << 20);
+
+static void BM_QueryColumnarCount(benchmark::State &state) {
+    TaskColumns columns = buildColumns(makeSyntheticTasks(state.range(0)));
+    TaskQuery query;
+    query.status = TaskQuery::Status::Pending;
+    query.createdTo = QUERY_CUTOFF;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(countRows(columns, query));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_QueryColumnarCount)->Arg(1 << 20);
+
+static void BM_HistoryReport(benchmark::State &state) {
+    TaskColumns columns = buildColumns(makeSyntheticTasks(state.range(0)));
+
+    for (auto _ : state) {
+        auto buckets = buildHistory(columns, static_cast<HistoryGranularity>(state.range(1)));
+        benchmark::DoNotOptimize(buckets.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_HistoryReport)->Args({1 << 20, 0})->Args({1 << 20, 1})->Args({1 << 20, 2});
+
+// Three to five words from a small vocabulary plus a ticket number
+static std::vector<std::string> makeSyntheticDescriptions(size_t count) {
+    static const char *const WORDS[] = {"buy", "milk", "write", "report", "fix", "login", "bug", "call", "mom",
+                                        "review", "pull", "request", "deploy", "server", "update", "docs", "clean",
+                                        "kitchen", "book", "flight", "dentist", "groceries", "refactor", "parser",
+                                        "meeting", "budget", "renew", "passport", "backup", "laptop", "plan", "sprint"};
+    std::vector<std::string> descriptions;
+    descriptions.reserve(count);
+    std::mt19937 rng(7);
+    for (size_t i = 0; i < count; ++i) {
+        std::string description;
+        for (size_t words = 3 + rng() % 3; words > 0; --words) {
+            description += WORDS[rng() % (sizeof(WORDS) / sizeof(WORDS[0]))];
+            description += ' ';
+        }
+        description += '#' + std::to_string(rng() % 100000);
+        descriptions.push_back(std::move(description));
+    }
+    return descriptions;
+}
+
+// Candidate generation plus verification until ten matches; TaskManager::searchTasks
+// goes on through the candidates that could tie with the tenth
+static void BM_TrigramSearch(benchmark::State &state) {
+    auto descriptions = makeSyntheticDescriptions(state.range(0));
+    TrigramIndex index;
+    for (size_t i = 0; i < descriptions.size(); ++i) {
+        index.insert(static_cast<int>(i + 1), descriptions[i]);
+    }
+    const std::string queries[] = {"grocries", "deploy srever", "#4242", "pasport renew", "kitchen"};
+    const int edits[] = {1, 2, 0, 2, 1};
+
+    size_t query = 0;
+    for (auto _ : state) {
+        size_t hits = 0;
+        index.forEachCandidate(queries[query], edits[query], [&](const TrigramCandidate &candidate) {
+            const std::string &text = descriptions[static_cast<size_t>(candidate.id - 1)];
+            return substringEditDistance(queries[query], text, edits[query]) > edits[query] || ++hits < 10;
+        });
+        benchmark::DoNotOptimize(hits);
+        query = (query + 1) % 5;
+    }
+}
+BENCHMARK(BM_TrigramSearch)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+
+// Cost of a span while tracing is off, which is what every traced call pays by default
+static void BM_TraceScopeDisabled(benchmark::State &state) {
+    for (auto _ : state) {
+        TRACE_SCOPE("BM_TraceScopeDisabled");
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_TraceScopeDisabled);
+
+static void BM_TraceScopeEnabled(benchmark::State &state) {
+    Trace::start("trace_bench.json");
+    for (auto _ : state) {
+        TRACE_SCOPE("BM_TraceScopeEnabled");
+        benchmark::ClobberMemory();
+    }
+    Trace::stop();
+}
+BENCHMARK(BM_TraceScopeEnabled)->Iterations(1 << 16);
+
+
+// Deletes half of range(0) tasks with one filtered statement and one cache update
+static void BM_PurgeCompletedWhere(benchmark::State &state) {
+    Database database("tasks_bench.db");
+    TaskManager taskManager(database);
+    TaskQuery completed;
+    completed.status = TaskQuery::Status::Done;
+    for (auto _ : state) {
+        state.PauseTiming();
+        taskManager.clearAllDataAsync().get();
+        {
+            SQLite::Database writer("tasks_bench.db", SQLite::OPEN_READWRITE, 5000);
+            SQLite::Transaction transaction(writer);
+            SQLite::Statement insert(writer, "INSERT INTO tasks (description, done, createdTime, completedTime) VALUES ('bulk', ?, 1000, ?)");
+            for (int64_t i = 0; i < state.range(0); ++i) {
+                insert.reset();
+                insert.bind(1, static_cast<int>(i % 2));
+                insert.bind(2, i % 2 ? int64_t(2000) : int64_t(0));
+                insert.exec();
+            }
+            transaction.commit();
+        }
+        taskManager.refreshAsync().get();
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(taskManager.deleteWhereAsync(completed).get());
+    }
+    state.counters["rows/s"] = benchmark::Counter(static_cast<double>(state.range(0) / 2 * state.iterations()),
+                                                  benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_PurgeCompletedWhere)->Arg(1 << 16)->Iterations(5)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// Writes a file at the baseline schema, as created before migrations were tracked
+static void makeLegacyDatabase(const char *file, int64_t rows) {
+    std::remove(file);
+    SQLite::Database legacy(file, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+    legacy.exec("CREATE TABLE tasks (id INTEGER PRIMARY KEY, description TEXT, done INTEGER, createdTime INTEGER, completedTime INTEGER)");
+    SQLite::Transaction transaction(legacy);
+    SQLite::Statement insert(legacy, "INSERT INTO tasks (description, done, createdTime, completedTime) VALUES ('legacy task', ?, ?, ?)");
+    for (int64_t i = 0; i < rows; ++i) {
+        insert.reset();
+        insert.bind(1, static_cast<int>(i % 2));
+        insert.bind(2, 1000 + i);
+        insert.bind(3, i % 2 ? 2000 + i : 0);
+        insert.exec();
+    }
+    transaction.commit();
+}
+
+// Backfill throughput by chunk size: smaller chunks hold the write lock for less time per commit
+static void BM_MigrationBackfill(benchmark::State &state) {
+    const char *file = "tasks_migration_bench.db";
+    for (auto _ : state) {
+        state.PauseTiming();
+        makeLegacyDatabase(file, state.range(0));
+        auto database = std::make_unique<Database>(file);
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(database->migrateAsync(static_cast<int>(state.range(1))).get());
+        state.PauseTiming();
+        database.reset();
+        state.ResumeTiming();
+    }
+    state.counters["rows/s"] = benchmark::Counter(static_cast<double>(state.range(0) * state.iterations()),
+                                                  benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_MigrationBackfill)->Args({1 << 18, 1000})->Args({1 << 18, 10000})->Args({1 << 18, 100000})
+    ->Iterations(3)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// Fills a fresh primary with rows tasks in one transaction
+static void makeSyncPrimary(const char *file, int64_t rows) {
+    std::remove(file);
+    Database(file).finalizeAsync().get(); // Creates the schema and change-log triggers
+    SQLite::Database writer(file, SQLite::OPEN_READWRITE, 5000);
+    SQLite::Transaction transaction(writer);
+    SQLite::Statement insert(writer, "INSERT INTO tasks (description, done, createdTime, completedTime) VALUES ('synced task', 0, ?, 0)");
+    for (int64_t i = 0; i < rows; ++i) {
+        insert.reset();
+        insert.bind(1, 1000 + i);
+        insert.exec();
+    }
+    transaction.commit();
+}
+
+// Ships the changes to the newest range(1) of range(0) rows to an up-to-date replica:
+// export, apply and acknowledge. Compare with BM_SyncFullCopy.
+static void BM_SyncDelta(benchmark::State &state) {
+    const char *primaryFile = "tasks_sync_bench.db";
+    const char *replicaFile = "tasks_sync_replica_bench.db";
+    makeSyncPrimary(primaryFile, state.range(0));
+    std::remove(replicaFile);
+    Database primary(primaryFile);
+    Database replica(replicaFile);
+    SQLite::Database writer(primaryFile, SQLite::OPEN_READWRITE, 5000);
+    int64_t round = 0;
+    size_t shipped = 0;
+    auto sync = [&primary, &replica, &shipped] {
+        std::stringstream batch;
+        primary.exportChangesAsync(replica.getAppliedSeqAsync().get(), batch).get();
+        shipped = batch.str().size();
+        primary.acknowledgeChangesAsync(replica.applyChangesAsync(batch).get()).get();
+    };
+    sync(); // Initial full copy
+    for (auto _ : state) {
+        state.PauseTiming();
+        SQLite::Statement touch(writer, "UPDATE tasks SET done = 1 - done, completedTime = ? WHERE id > ?");
+        touch.bind(1, 5000 + round++);
+        touch.bind(2, state.range(0) - state.range(1));
+        touch.exec();
+        state.ResumeTiming();
+        sync();
+    }
+    state.counters["bytes"] = static_cast<double>(shipped);
+}
+BENCHMARK(BM_SyncDelta)->Args({1 << 20, 1 << 10})->Args({1 << 20, 1 << 14})->Iterations(3)->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// Refreshes the replica the old way, by copying the whole range(0)-row file
+static void BM_SyncFullCopy(benchmark::State &state) {
+    const char *primaryFile = "tasks_sync_bench.db";
+    makeSyncPrimary(primaryFile, state.range(0));
+    Database primary(primaryFile);
+    for (auto _ : state) {
+        primary.backupAsync("tasks_sync_replica_bench.db", 1 << 20).get();
+    }
+    state.counters["bytes"] = static_cast<double>(std::filesystem::file_size("tasks_sync_replica_bench.db"));
+}
+BENCHMARK(BM_SyncFullCopy)->Arg(1 << 20)->Iterations(3)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// Fills a fresh file with rows tasks, nine in ten of them completed long ago
+static void makeArchivableDatabase(const char *file, int64_t rows) {
+    makeSyncPrimary(file, rows);
+    SQLite::Database writer(file, SQLite::OPEN_READWRITE, 5000);
+    writer.exec("UPDATE tasks SET done = 1, completedTime = 2000 + id, description = 'water the plants in room ' || (id % 40) "
+                "WHERE id % 10 <> 0");
+}
+
+// Moves nine in ten of range(0) tasks into compressed blocks
+static void BM_ArchiveCompleted(benchmark::State &state) {
+    const char *file = "tasks_archive_bench.db";
+    int archived = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        makeArchivableDatabase(file, state.range(0));
+        auto database = std::make_unique<Database>(file);
+        state.ResumeTiming();
+        archived = database->archiveCompletedAsync(1 << 30).get();
+    }
+    SQLite::Database reader(file, SQLite::OPEN_READONLY);
+    state.counters["compression"] = reader.execAndGet("SELECT 1.0 * SUM(rawSize) / SUM(LENGTH(data)) FROM archive_blocks").getDouble();
+    state.counters["rows/s"] = benchmark::Counter(static_cast<double>(archived) * state.iterations(), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_ArchiveCompleted)->Arg(1 << 20)->Iterations(1)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// Startup load of range(0) tasks, nine in ten completed long ago, without (0) or with (1) archiving
+static void BM_LoadWithArchive(benchmark::State &state) {
+    const char *file = "tasks_archive_bench.db";
+    makeArchivableDatabase(file, state.range(0));
+    Database database(file);
+    if (state.range(1)) {
+        database.archiveCompletedAsync(1 << 30).get();
+    }
+    size_t hot = 0;
+    for (auto _ : state) {
+        TaskManager taskManager(database);
+        hot = taskManager.snapshot()->tasks.size();
+    }
+    state.counters["cached tasks"] = static_cast<double>(hot);
+}
+BENCHMARK(BM_LoadWithArchive)->Args({1 << 20, 0})->Args({1 << 20, 1})->Iterations(3)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// Looks up single tasks among range(0), the newest ones far more often, holding
+// every task (range(1) == 0) or through a task cache of range(1) megabytes
+static void BM_CachedLookup(benchmark::State &state) {
+    const char *file = "tasks_cache_bench.db";
+    static int64_t madeRows = 0;
+    if (madeRows != state.range(0)) {
+        makeSyncPrimary(file, state.range(0));
+        madeRows = state.range(0);
+    }
+    Database database(file);
+    TaskManager taskManager(database, static_cast<size_t>(state.range(1)) << 20);
+    const int newest = taskManager.getTasks().back().getId();
+
+    std::mt19937 generator(42);
+    std::exponential_distribution<double> age(16.0 / static_cast<double>(state.range(0))); // Mean: a sixteenth of the list
+    size_t found = 0;
+    for (auto _ : state) {
+        const int id = newest - static_cast<int>(std::min(age(generator), static_cast<double>(state.range(0) - 1)));
+        found += taskManager.getTask(id).has_value();
+    }
+    benchmark::DoNotOptimize(found);
+    const TaskCacheStats stats = taskManager.cacheStats();
+    if (stats.hits + stats.misses > 0) {
+        state.counters["hit ratio"] = static_cast<double>(stats.hits) / static_cast<double>(stats.hits + stats.misses);
+        state.counters["cache MB"] = static_cast<double>(stats.bytes) / (1 << 20);
+    }
+    else {
+        state.counters["cache MB"] = static_cast<double>(state.range(0) * TaskCache::taskBytes(Task(0, "synced task", false, 0))) / (1 << 20);
+    }
+}
+BENCHMARK(BM_CachedLookup)->Args({1 << 20, 0})->Args({1 << 20, 1})->Args({1 << 20, 4})->Args({1 << 20, 16})
+    ->Args({1 << 20, 64})->UseRealTime();
+
+// Completes one task after another among range(0) tasks linked in chains of eight,
+// each unblocking the next link. A 16 MB task cache keeps the snapshot from being
+// republished, so what remains is the write and the ready-set update, which should
+// not grow with the graph
+static void BM_CompleteWithDependents(benchmark::State &state) {
+    const char *file = "tasks_deps_bench.db";
+    makeSyncPrimary(file, state.range(0));
+    {
+        SQLite::Database writer(file, SQLite::OPEN_READWRITE, 5000);
+        writer.exec("INSERT INTO task_deps (taskId, dependsOn) SELECT id, id - 1 FROM tasks WHERE id % 8 <> 1");
+    }
+    Database database(file);
+    TaskManager taskManager(database, 16 << 20);
+    int id = 1;
+    for (auto _ : state) {
+        taskManager.markTaskDoneAsync(id++).get();
+    }
+    state.counters["ready"] = static_cast<double>(taskManager.readyTasksAsync().get().size());
+}
+BENCHMARK(BM_CompleteWithDependents)->Arg(1 << 14)->Arg(1 << 20)->Iterations(2000)->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
+// Moves a random timer to a new due time within a week while range(0) timers are
+// pending. Scheduling and cancelling touch one slot each, so from a thousand to
+// four million timers the cost only grows by the cache misses of a larger pool
+static void BM_TimerWheelReschedule(benchmark::State &state) {
+    const int timers = static_cast<int>(state.range(0));
+    const int64_t week = 7 * 24 * 3600;
+    TimerWheel wheel(0);
+    std::mt19937 generator(42);
+    for (int id = 0; id < timers; ++id) {
+        wheel.schedule(id, 1 + static_cast<int64_t>(generator() % week));
+    }
+    for (auto _ : state) {
+        const int id = static_cast<int>(generator() % timers);
+        wheel.cancel(id);
+        wheel.schedule(id, 1 + static_cast<int64_t>(generator() % week));
+    }
+    state.counters["pending"] = static_cast<double>(wheel.size());
+}
+BENCHMARK(BM_TimerWheelReschedule)->Arg(1 << 10)->Arg(1 << 16)->Arg(1 << 22);
+
+// Fires range(0) timers spread over one day by advancing the wheel through all
+// 86400 ticks, cascades included
+static void BM_TimerWheelFireDay(benchmark::State &state) {
+    const int timers = static_cast<int>(state.range(0));
+    const int64_t day = 24 * 3600;
+    std::mt19937 generator(42);
+    size_t fired = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        TimerWheel wheel(0);
+        for (int id = 0; id < timers; ++id) {
+            wheel.schedule(id, 1 + static_cast<int64_t>(generator() % day));
+        }
+        state.ResumeTiming();
+        wheel.advance(day, [&fired](int, int64_t) { ++fired; });
+    }
+    benchmark::DoNotOptimize(fired);
+    state.SetItemsProcessed(static_cast<int64_t>(fired));
+}
+BENCHMARK(BM_TimerWheelFireDay)->Arg(1 << 16)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+
+// Clears range(0) tasks into an undo stash and restores them. Both directions
+// rename the task tables without copying rows; the stash drops the indexes so the
+// live tables keep theirs, and the restore rebuilds them, which dominates at a
+// million tasks (about 0.65 s a round trip, against 20 ms at sixteen thousand)
+static void BM_UndoClear(benchmark::State &state) {
+    const char *file = "tasks_undo_bench.db";
+    makeSyncPrimary(file, state.range(0));
+    Database database(file);
+    for (auto _ : state) {
+        const int stash = database.stashAllDataAsync().get();
+        database.restoreStashAsync(stash).get();
+    }
+    state.counters["tasks"] = static_cast<double>(database.countWhereAsync(TaskQuery()).get());
+}
+BENCHMARK(BM_UndoClear)->Arg(1 << 14)->Arg(1 << 20)->Iterations(20)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// Reads 16 pending tasks at a different offset among range(0) tasks each time.
+// range(1) = 0 goes through a filter expression, which binds new constants into
+// the statement cached for its shape; range(1) = 1 asks getTasksWhereAsync for
+// the same rows, which prepares its statement on every call
+static void BM_FilterExpression(benchmark::State &state) {
+    const char *file = "tasks_filter_bench.db";
+    makeSyncPrimary(file, state.range(0));
+    Database database(file);
+    std::mt19937 generator(42);
+    size_t rows = 0;
+    for (auto _ : state) {
+        const int from = 1 + static_cast<int>(generator() % (state.range(0) - 16));
+        if (state.range(1) == 0) {
+            rows += database.getTasksMatchingAsync("done=0 and id>=" + std::to_string(from) + " and id<" +
+                                                  std::to_string(from + 16)).get().size();
+        }
+        else {
+            TaskQuery query;
+            query.status = TaskQuery::Status::Pending;
+            query.idFrom = from;
+            query.idTo = from + 16;
+            rows += database.getTasksWhereAsync(query).get().size();
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(rows));
+}
+BENCHMARK(BM_FilterExpression)->Args({1 << 20, 0})->Args({1 << 20, 1})->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+// Loads range(0) tasks with synthetic descriptions, every eighth tagged, holding every
+// task (range(1) == 0) or through a task cache of range(1) megabytes that a pass of
+// lookups fills, searches once so the trigram index exists, then times the memory
+// report. The counters are the point: they show how memory splits between SQLite
+// and the task structures
+static void BM_MemoryFootprint(benchmark::State &state) {
+    const char *file = "tasks_memory_bench.db";
+    static int64_t madeRows = 0;
+    if (madeRows != state.range(0)) {
+        std::remove(file);
+        Database(file).finalizeAsync().get();
+        SQLite::Database writer(file, SQLite::OPEN_READWRITE, 5000);
+        SQLite::Transaction transaction(writer);
+        SQLite::Statement insert(writer, "INSERT INTO tasks (description, done, createdTime, completedTime) VALUES (?, 0, ?, 0)");
+        int64_t i = 0;
+        for (const std::string &description : makeSyntheticDescriptions(state.range(0))) {
+            insert.reset();
+            insert.bind(1, description);
+            insert.bind(2, 1000 + i++);
+            insert.exec();
+        }
+        writer.exec("INSERT INTO tags (name) VALUES ('weekly'), ('urgent')");
+        writer.exec("INSERT INTO task_tags (taskId, tagId) SELECT id, 1 + id % 16 / 8 FROM tasks WHERE id % 8 = 0");
+        transaction.commit();
+        madeRows = state.range(0);
+    }
+    Database database(file);
+    TaskManager taskManager(database, static_cast<size_t>(state.range(1)) << 20);
+    for (int id = 1; state.range(1) > 0 && id <= state.range(0); id += 64) {
+        benchmark::DoNotOptimize(taskManager.getTask(id));
+    }
+    benchmark::DoNotOptimize(taskManager.searchTasks("deploy server", 10));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(taskManager.memoryStats());
+    }
+    const double mib = 1 << 20;
+    const SqliteMemoryStats sqlite = database.getMemoryStatsAsync().get();
+    state.counters["sqlite MiB"] = static_cast<double>(sqlite.processBytes) / mib;
+    state.counters["page cache MiB"] = static_cast<double>(sqlite.pageCacheBytes) / mib;
+    state.counters["statements MiB"] = static_cast<double>(sqlite.statementBytes) / mib;
+    const TaskMemoryStats tasks = taskManager.memoryStats();
+    state.counters["task objects MiB"] = static_cast<double>(tasks.taskBytes) / mib;
+    state.counters["descriptions MiB"] = static_cast<double>(tasks.descriptionBytes) / mib;
+    state.counters["columns MiB"] = static_cast<double>(tasks.columnBytes) / mib;
+    state.counters["search index MiB"] = static_cast<double>(tasks.searchIndexBytes) / mib;
+    state.counters["task cache MiB"] = static_cast<double>(tasks.cacheBytes) / mib;
+    state.counters["task total MiB"] = static_cast<double>(tasks.total()) / mib;
+}
+BENCHMARK(BM_MemoryFootprint)->Args({1 << 20, 0})->Args({1 << 20, 16})->Iterations(3)->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// Columns of the next snapshot after one task among range(0) is completed: rebuilt
+// from every task (range(1) == 0) or merged from the previous columns and the
+// one-row delta (range(1) == 1), as TaskManager publishes them
+static void BM_PublishColumns(benchmark::State &state) {
+    const std::vector<Task> tasks = makeSyntheticTasks(state.range(0));
+    const TaskColumns columns = buildColumns(tasks);
+    const Task &middle = tasks[tasks.size() / 2];
+    const std::vector<Task> upserted = {Task(middle.getId(), middle.getDescription(), true, middle.getCreatedTime(),
+                                             middle.getCreatedTime() + 60)};
+
+    for (auto _ : state) {
+        TaskColumns next = state.range(1) == 0 ? buildColumns(tasks) : mergeColumns(columns, upserted, {});
+        benchmark::DoNotOptimize(next.ids.data());
+    }
+}
+BENCHMARK(BM_PublishColumns)->Args({1 << 20, 0})->Args({1 << 20, 1})->Unit(benchmark::kMillisecond);
+
 BENCHMARK_MAIN();
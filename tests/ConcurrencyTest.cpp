@@ -0,0 +1,1926 @@
+#include "TaskManager.h"
+#include "Database.h"
+#include "History.h"
+#include "TaskFilter.h"
+#include "Renderer.h"
+#include "ColorManager.hpp"
+#include "TimerWheel.h"
+#include "TrigramIndex.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <cstdio>
+#include <filesystem>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <random>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include "Client.h"
+#include "Server.h"
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Concurrency tests for TaskManager and Database.
+ *
+ * Meant to be run under ThreadSanitizer (configure with -DTODOLIST_TSAN=ON);
+ * each test also checks functional invariants so it is useful without it.
+ */
+
+namespace
+{
+    int failures = 0;
+
+#define CHECK(condition)                                                              \
+    do {                                                                              \
+        if (!(condition)) {                                                           \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK failed: " #condition \
+                      << std::endl;                                                   \
+            ++failures;                                                               \
+        }                                                                             \
+    } while (0)
+
+    /**
+     * @brief Readers take snapshots while writers add, complete and delete tasks.
+     *
+     * Every snapshot a reader sees must be internally consistent (ids strictly
+     * increasing) and versions must never go backwards for a single reader.
+     */
+    void testSnapshotReadsDuringMutations()
+    {
+        const int writers = 4;
+        const int tasksPerWriter = 50;
+        const int total = writers * tasksPerWriter;
+
+        Database database("tasks_concurrency.db");
+        TaskManager taskManager(database);
+        taskManager.clearAllDataAsync().get();
+
+        std::atomic<int> writersAdded{0};
+        std::atomic<int> writersFinished{0};
+        std::atomic<long> snapshotsRead{0};
+
+        std::vector<std::thread> threads;
+        for (int w = 0; w < writers; ++w) {
+            threads.emplace_back([&, w] {
+                for (int i = 0; i < tasksPerWriter; ++i) {
+                    taskManager.addTaskAsync("writer " + std::to_string(w) + " task " + std::to_string(i)).get();
+                }
+                ++writersAdded;
+                while (writersAdded < writers) std::this_thread::yield();
+
+                // Each writer owns the ids congruent to w modulo the writer count
+                for (int id = w + 1; id <= total; id += writers) {
+                    if (id % 3 == 0) taskManager.deleteTaskAsync(id).get();
+                    else if (id % 3 == 1) taskManager.markTaskDoneAsync(id).get();
+                }
+                ++writersFinished;
+            });
+        }
+        for (int r = 0; r < 4; ++r) {
+            threads.emplace_back([&] {
+                uint64_t lastVersion = 0;
+                while (writersFinished < writers) {
+                    auto snapshot = taskManager.snapshot();
+                    CHECK(snapshot->version >= lastVersion);
+                    lastVersion = snapshot->version;
+                    for (size_t i = 1; i < snapshot->tasks.size(); ++i) {
+                        CHECK(snapshot->tasks[i - 1].getId() < snapshot->tasks[i].getId());
+                    }
+                    ++snapshotsRead;
+                }
+            });
+        }
+        for (auto &thread : threads) thread.join();
+
+        auto final = taskManager.snapshot();
+        int expectedDone = 0;
+        for (int id = 1; id <= total; ++id) expectedDone += id % 3 == 1;
+        int done = 0;
+        for (const auto &task : final->tasks) done += task.isDone();
+        CHECK(final->tasks.size() == static_cast<size_t>(total - total / 3));
+        CHECK(done == expectedDone);
+        CHECK(snapshotsRead > 0);
+    }
+
+    /**
+     * @brief A second connection stands in for another todolist process.
+     *
+     * refreshAsync must pick up its commits through the change log and
+     * report nothing to do when the file has not changed.
+     */
+    void testRefreshPicksUpExternalChanges()
+    {
+        Database database("tasks_concurrency.db");
+        TaskManager taskManager(database);
+        taskManager.clearAllDataAsync().get();
+        taskManager.addTaskAsync("first").get();
+        taskManager.addTaskAsync("second").get();
+        CHECK(!taskManager.refreshAsync().get());
+
+        {
+            Database other("tasks_concurrency.db");
+            other.addTaskAsync("third").get();
+            other.markTaskDoneAsync(1).get();
+            other.deleteTaskAsync(2).get();
+        }
+
+        CHECK(taskManager.refreshAsync().get());
+        auto snapshot = taskManager.snapshot();
+        CHECK(snapshot->tasks.size() == 2);
+        CHECK(snapshot->tasks.size() == 2 && snapshot->tasks[0].getId() == 1 && snapshot->tasks[0].isDone());
+        CHECK(snapshot->tasks.size() == 2 && snapshot->tasks[1].getDescription() == "third");
+        CHECK(!taskManager.refreshAsync().get());
+    }
+
+    /**
+     * @brief Read-only readers run next to a writer process.
+     *
+     * A ReadOnly reader sees the writer's commits on refresh, an Immutable
+     * one keeps the state it copied, and both reject every mutation.
+     */
+    void testReadOnlyReadersBesideWriter()
+    {
+        Database database("tasks_concurrency.db");
+        TaskManager writer(database);
+        writer.clearAllDataAsync().get();
+        writer.addTaskAsync("first").get();
+
+        Database readOnlyDatabase("tasks_concurrency.db", AccessMode::ReadOnly);
+        Database snapshotDatabase("tasks_concurrency.db", AccessMode::Immutable);
+        TaskManager reader(readOnlyDatabase);
+        TaskManager snapshotReader(snapshotDatabase);
+        CHECK(reader.isReadOnly() && snapshotReader.isReadOnly() && !writer.isReadOnly());
+
+        std::thread adder([&writer] {
+            for (int i = 0; i < 20; ++i) {
+                writer.addTaskAsync("more").get();
+            }
+        });
+        for (int i = 0; i < 20; ++i) {
+            reader.refreshAsync().get();
+            CHECK(!reader.snapshot()->tasks.empty());
+        }
+        adder.join();
+
+        reader.refreshAsync().get();
+        CHECK(reader.snapshot()->tasks.size() == 21);
+        snapshotReader.refreshAsync().get();
+        CHECK(snapshotReader.snapshot()->tasks.size() == 1);
+
+        bool rejected = false;
+        try {
+            reader.addTaskAsync("denied").get();
+        }
+        catch (const std::logic_error &) {
+            rejected = true;
+        }
+        CHECK(rejected);
+        CHECK(readOnlyDatabase.getTasksAsync().get().size() == 21);
+    }
+
+    /**
+     * @brief A backfill runs in chunks next to a writer, is interrupted, and resumes.
+     *
+     * The file starts at the baseline schema. The writer must never fail
+     * while a chunk holds the write lock, every row must be filled in the
+     * end, and the backfill itself must leave no entries in the change log.
+     */
+    void testMigrationBackfillBesideWriter()
+    {
+        const char *file = "tasks_migration.db";
+        const int legacyRows = 5000;
+        std::remove(file);
+        {
+            SQLite::Database legacy(file, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+            legacy.exec("CREATE TABLE tasks (id INTEGER PRIMARY KEY, description TEXT, done INTEGER, createdTime INTEGER, completedTime INTEGER)");
+            SQLite::Transaction transaction(legacy);
+            SQLite::Statement insert(legacy, "INSERT INTO tasks (description, done, createdTime, completedTime) VALUES ('legacy', ?, ?, ?)");
+            for (int i = 0; i < legacyRows; ++i) {
+                insert.reset();
+                insert.bind(1, i % 2);
+                insert.bind(2, 1000 + i);
+                insert.bind(3, i % 2 ? 2000 + i : 0);
+                insert.exec();
+            }
+            transaction.commit();
+        }
+
+        auto backfillBesideWriter = [file](int chunkRows, int stopAfterChunks) {
+            Database database(file);
+            TaskManager writer(database);
+            int chunks = 0;
+            std::atomic<bool> running{true};
+            std::thread adder([&writer, &running] {
+                while (running) {
+                    writer.addTaskAsync("during backfill").get();
+                }
+            });
+            bool finished = database.migrateAsync(chunkRows, [&](const MigrationProgress &progress) {
+                CHECK(progress.rowsDone <= progress.rowsTotal);
+                if (++chunks == stopAfterChunks) {
+                    database.stopMigrations();
+                }
+            }).get();
+            running = false;
+            adder.join();
+            return finished;
+        };
+
+        CHECK(!backfillBesideWriter(100, 10));
+        {
+            Database database(file);
+            CHECK(database.getSchemaVersionAsync().get() == BASELINE_SCHEMA_VERSION);
+        }
+        CHECK(backfillBesideWriter(700, 0));
+
+        Database database(file);
+        CHECK(database.getSchemaVersionAsync().get() == latestSchemaVersion());
+        SQLite::Database check(file, SQLite::OPEN_READONLY);
+        CHECK(check.execAndGet("SELECT COUNT(*) FROM tasks WHERE updatedTime IS NULL").getInt() == 0);
+        CHECK(check.execAndGet("SELECT updatedTime FROM tasks WHERE id = 2").getInt() == 2001);
+        CHECK(check.execAndGet("SELECT COUNT(*) FROM task_changes WHERE op = 'U'").getInt() == 0);
+        CHECK(!check.tableExists("schema_migrations") ||
+              check.execAndGet("SELECT COUNT(*) FROM schema_migrations").getInt() == 0);
+    }
+
+    /**
+     * @brief Two processes materialize the same recurring templates at once.
+     *
+     * Each template must get exactly one open task however many periods were
+     * missed, and the next one only after that task is done and its window
+     * has arrived.
+     */
+    void testRecurringTasksMaterializeOnce()
+    {
+        const int64_t now = std::time(nullptr);
+        const int64_t day = 86400;
+        Database firstDatabase("tasks_concurrency.db");
+        Database secondDatabase("tasks_concurrency.db");
+        TaskManager first(firstDatabase);
+        TaskManager second(secondDatabase);
+        first.clearAllDataAsync().get();
+        second.refreshAsync().get();
+
+        RecurrenceRule daily;
+        CHECK(parseRecurrenceRule("FREQ=DAILY;INTERVAL=1", daily));
+        const int templates = 20;
+        for (int i = 0; i < templates; ++i) {
+            // Windows three days in the future; nothing is due yet
+            first.addRecurrenceAsync("chore", daily, now + 3 * day).get();
+        }
+        CHECK(first.snapshot()->tasks.empty());
+        second.refreshAsync().get();
+
+        std::thread racer([&second, now, day] { second.materializeDueAsync(now + 10 * day).get(); });
+        first.materializeDueAsync(now + 10 * day).get();
+        racer.join();
+        first.refreshAsync().get();
+        CHECK(first.snapshot()->tasks.size() == templates);
+
+        // Still open: later windows add nothing
+        first.materializeDueAsync(now + 20 * day).get();
+        CHECK(first.snapshot()->tasks.size() == templates);
+
+        const int done = first.snapshot()->tasks.front().getId();
+        first.markTaskDoneAsync(done).get();
+        CHECK(first.snapshot()->tasks.size() == templates); // The next window is tomorrow
+        CHECK(first.materializeDueAsync(now + 11 * day).get() == 1);
+        CHECK(first.snapshot()->tasks.size() == templates + 1);
+
+        for (const Recurrence &recurrence : first.getRecurrencesAsync().get()) {
+            CHECK(recurrence.taskId != 0 && recurrence.nextTime > now + 10 * day);
+        }
+    }
+
+    /**
+     * @brief Bulk operations by filter run while readers take snapshots.
+     *
+     * Each bulk operation must publish its effect at once: a reader sees
+     * either none or all of the affected tasks changed, and the counts
+     * returned match the cache.
+     */
+    void testBulkOperationsBesideReaders()
+    {
+        Database database("tasks_concurrency.db");
+        TaskManager manager(database);
+        manager.clearAllDataAsync().get();
+        for (int i = 0; i < 300; ++i) {
+            manager.addTaskAsync("bulk").get();
+        }
+        const int firstId = manager.snapshot()->tasks.front().getId();
+
+        std::atomic<bool> running{true};
+        std::thread reader([&manager, &running, firstId] {
+            while (running) {
+                auto view = manager.snapshot();
+                TaskQuery range;
+                range.idFrom = firstId + 100;
+                range.idTo = firstId + 200;
+                range.status = TaskQuery::Status::Done;
+                const size_t done = countRows(view->columns, range);
+                CHECK(done == 0 || done == 100 || done == 60); // Before, after marking, after each purge
+            }
+        });
+
+        TaskQuery range;
+        range.idFrom = firstId + 100;
+        range.idTo = firstId + 200;
+        CHECK(manager.markDoneWhereAsync(range).get() == 100);
+        CHECK(manager.markDoneWhereAsync(range).get() == 0); // Already done
+
+        TaskQuery completed;
+        completed.status = TaskQuery::Status::Done;
+        completed.limit = 40;
+        CHECK(manager.deleteWhereAsync(completed).get() == 40);
+        completed.limit = std::numeric_limits<size_t>::max();
+        CHECK(manager.deleteWhereAsync(completed).get() == 60);
+        running = false;
+        reader.join();
+
+        auto view = manager.snapshot();
+        CHECK(view->tasks.size() == 200);
+        CHECK(manager.countTasks(completed) == 0);
+        CHECK(database.getTasksAsync().get().size() == 200);
+    }
+
+    /**
+     * @brief An online backup runs in small steps while a writer adds tasks.
+     *
+     * Writes through the same connection are carried into the copy, so the
+     * backup must be a valid database holding every task committed before it
+     * finished, and the writer must never fail.
+     */
+    void testBackupUnderWriteLoad()
+    {
+        const char *backupFile = "tasks_concurrency_backup.db";
+        std::remove(backupFile);
+        Database database("tasks_concurrency.db");
+        TaskManager manager(database);
+        manager.clearAllDataAsync().get();
+        for (int i = 0; i < 500; ++i) {
+            manager.addTaskAsync(std::string(200, 'x') + std::to_string(i)).get(); // About 30 pages
+        }
+
+        std::atomic<bool> running{true};
+        std::atomic<int> added{0};
+        std::thread writer([&manager, &running, &added] {
+            while (running) {
+                manager.addTaskAsync("during backup").get();
+                ++added;
+            }
+        });
+        int steps = 0;
+        BackupProgress last;
+        database.backupAsync(backupFile, 4, [&steps, &last](const BackupProgress &progress) {
+            ++steps;
+            last = progress;
+        }).get();
+        const size_t before = 500 + static_cast<size_t>(added.load());
+        running = false;
+        writer.join();
+
+        CHECK(steps > 1);
+        CHECK(last.remainingPages == 0 && last.totalPages > 0);
+        SQLite::Database copy(backupFile, SQLite::OPEN_READONLY);
+        CHECK(copy.execAndGet("PRAGMA integrity_check").getText() == std::string("ok"));
+        const int copied = copy.execAndGet("SELECT COUNT(*) FROM tasks").getInt();
+        CHECK(copied >= 500 && static_cast<size_t>(copied) <= before + 1);
+    }
+
+    /**
+     * @brief Ships one change batch from primary to replica and acknowledges it.
+     *
+     * @return The batch, for checks on its contents.
+     */
+    std::string syncReplica(Database &primary, Database &replica)
+    {
+        std::stringstream batch;
+        primary.exportChangesAsync(replica.getAppliedSeqAsync().get(), batch).get();
+        const std::string text = batch.str();
+        primary.acknowledgeChangesAsync(replica.applyChangesAsync(batch).get()).get();
+        return text;
+    }
+
+    /**
+     * @brief Returns true if both databases hold the same tasks and tags.
+     */
+    bool sameContents(Database &first, Database &second)
+    {
+        const std::vector<Task> a = first.getTasksAsync().get();
+        const std::vector<Task> b = second.getTasksAsync().get();
+        if (a.size() != b.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (a[i].getId() != b[i].getId() || a[i].getDescription() != b[i].getDescription() ||
+                a[i].isDone() != b[i].isDone() || a[i].getCreatedTime() != b[i].getCreatedTime() ||
+                a[i].getCompletedTime() != b[i].getCompletedTime() || a[i].getDueTime() != b[i].getDueTime()) {
+                return false;
+            }
+        }
+        return first.getTaskTagsAsync().get() == second.getTaskTagsAsync().get();
+    }
+
+    /**
+     * @brief A replica follows the primary through delta batches while the log is truncated.
+     *
+     * The first batch is a full copy, later ones carry only the changed
+     * tasks. A cache on the primary that fell behind the truncated log must
+     * reload instead of missing changes, and a truncated batch changes nothing.
+     */
+    void testDeltaSyncToReplica()
+    {
+        const char *replicaFile = "tasks_concurrency_replica.db";
+        std::remove(replicaFile);
+        Database primary("tasks_concurrency.db");
+        TaskManager manager(primary);
+        manager.clearAllDataAsync().get();
+        for (int i = 0; i < 100; ++i) {
+            manager.addTaskAsync("task " + std::to_string(i)).get();
+        }
+        manager.addTaskAsync("tab\there, newline\nthere, backslash \\").get();
+        const std::vector<Task> tasks = manager.getTasks();
+        manager.addTagAsync(tasks[0].getId(), "home").get();
+        manager.addTagAsync(tasks[1].getId(), "work\tday").get();
+        manager.setDueTimeAsync(tasks[6].getId(), 2000000000).get();
+
+        Database replica(replicaFile);
+        const std::string first = syncReplica(primary, replica);
+        CHECK(first.substr(0, first.find('\n')).back() == '1'); // Full batch
+        CHECK(sameContents(primary, replica));
+
+        Database replicaReader(replicaFile); // Another process reading the replica
+        TaskManager replicaManager(replicaReader);
+        manager.markTaskDoneAsync(tasks[2].getId()).get();
+        manager.deleteTaskAsync(tasks[3].getId()).get();
+        manager.removeTagAsync(tasks[0].getId(), "home").get();
+        manager.addTagAsync(tasks[4].getId(), "home").get();
+        manager.addTaskAsync("added after the first sync").get();
+        const std::string second = syncReplica(primary, replica);
+        CHECK(second.substr(0, second.find('\n')).back() == '0'); // Delta batch
+        CHECK(std::count(second.begin(), second.end(), '\n') < 12);
+        CHECK(sameContents(primary, replica));
+        CHECK(replicaManager.refreshAsync().get());
+        CHECK(replicaManager.getTasks().size() == tasks.size());
+
+        // Changes from another connection, acknowledged before this cache saw them
+        {
+            Database other("tasks_concurrency.db");
+            other.deleteTaskAsync(tasks[5].getId()).get();
+            other.addTaskAsync("added by another process").get();
+        }
+        manager.setDueTimeAsync(tasks[6].getId(), 0).get();
+        manager.setDueTimeAsync(tasks[7].getId(), 2100000000).get();
+        syncReplica(primary, replica);
+        CHECK(sameContents(primary, replica));
+        manager.refreshAsync().get();
+        CHECK(manager.getTasks().size() == primary.getTasksAsync().get().size());
+
+        manager.addTaskAsync("never arrives").get();
+        std::stringstream batch;
+        primary.exportChangesAsync(replica.getAppliedSeqAsync().get(), batch).get();
+        std::string text = batch.str();
+        std::istringstream truncated(text.substr(0, text.rfind("end")));
+        bool rejected = false;
+        try {
+            replica.applyChangesAsync(truncated).get();
+        }
+        catch (const std::runtime_error &) {
+            rejected = true;
+        }
+        CHECK(rejected);
+        CHECK(replica.getTasksAsync().get().size() + 1 == primary.getTasksAsync().get().size());
+    }
+
+    /**
+     * @brief Old completed tasks move to the archive while a reader keeps refreshing.
+     *
+     * Every task must be either in the hot table or in the archive, never
+     * both or neither; archived ones keep their tags and stay searchable,
+     * and a second run tops up the partly filled newest block.
+     */
+    void testArchiveBesideReaders()
+    {
+        Database database("tasks_concurrency.db");
+        TaskManager manager(database);
+        manager.clearAllDataAsync().get();
+        for (int i = 0; i < 300; ++i) {
+            manager.addTaskAsync("chore " + std::to_string(i)).get();
+        }
+        const std::vector<Task> tasks = manager.getTasks();
+        manager.addTagAsync(tasks[10].getId(), "garden").get();
+        {
+            // Complete 200 tasks long ago, 50 of them a little later than the rest
+            SQLite::Database writer("tasks_concurrency.db", SQLite::OPEN_READWRITE, 5000);
+            writer.exec("UPDATE tasks SET done = 1, completedTime = 1000 + id WHERE id <= " + std::to_string(tasks[149].getId()));
+            writer.exec("UPDATE tasks SET done = 1, completedTime = 5000 + id WHERE id > " + std::to_string(tasks[149].getId()) +
+                        " AND id <= " + std::to_string(tasks[199].getId()));
+        }
+        manager.refreshAsync().get();
+
+        std::atomic<bool> running{true};
+        std::atomic<bool> consistent{true};
+        std::thread reader([&manager, &running, &consistent] {
+            while (running) {
+                manager.refreshAsync().get();
+                auto snapshot = manager.snapshot();
+                for (size_t i = 1; i < snapshot->tasks.size(); ++i) {
+                    if (snapshot->tasks[i - 1].getId() >= snapshot->tasks[i].getId()) {
+                        consistent = false;
+                    }
+                }
+            }
+        });
+        const int first = database.archiveCompletedAsync(5000, 64).get();
+        const int second = database.archiveCompletedAsync(10000, 64).get();
+        running = false;
+        reader.join();
+
+        CHECK(consistent);
+        CHECK(first == 150 && second == 50);
+        manager.refreshAsync().get();
+        CHECK(manager.getTasks().size() == 100);
+        const auto archived = database.getArchivedTasksAsync(0, 10000).get();
+        CHECK(archived.size() == 200);
+        CHECK(archived.front().task.getId() == tasks[0].getId() && archived.back().task.getId() == tasks[199].getId());
+        SQLite::Database check("tasks_concurrency.db", SQLite::OPEN_READONLY);
+        CHECK(check.execAndGet("SELECT COUNT(*) FROM archive_blocks").getInt() == 4); // ceil(200 / 64)
+
+        const auto found = database.searchArchiveAsync("CHORE 10", 20).get();
+        bool tagged = false;
+        for (const auto &match : found) {
+            tagged = tagged || (match.task.getId() == tasks[10].getId() && match.tags == std::vector<std::string>{"garden"});
+        }
+        CHECK(tagged);
+        CHECK(database.searchArchiveAsync("chore 250", 5).get().empty()); // Still pending, so still hot
+    }
+
+    /**
+     * @brief Lookups through a small task cache while a writer completes and deletes tasks.
+     *
+     * Every lookup must return the task asked for, the cache must stay
+     * within its budget, and once the writer is done every lookup must
+     * agree with the database.
+     */
+    void testBoundedCacheBesideWriter()
+    {
+        const int total = 5000;
+        Database database("tasks_concurrency.db");
+        database.clearAllDataAsync().get();
+        {
+            SQLite::Database writer("tasks_concurrency.db", SQLite::OPEN_READWRITE, 5000);
+            SQLite::Transaction transaction(writer);
+            SQLite::Statement insert(writer, "INSERT INTO tasks (description, done, createdTime, completedTime) VALUES (?, 0, 1000, 0)");
+            for (int i = 1; i <= total; ++i) {
+                insert.bind(1, "task " + std::to_string(i));
+                insert.exec();
+                insert.reset();
+            }
+            transaction.commit();
+        }
+        const size_t budget = 64 * 1024; // A few pages
+        TaskManager manager(database, budget);
+        CHECK(manager.snapshot()->tasks.empty());
+        const int firstId = manager.getTasks().front().getId();
+        manager.addTagAsync(firstId + 42, "errand").get();
+
+        std::atomic<bool> running{true};
+        std::atomic<bool> consistent{true};
+        std::vector<std::thread> readers;
+        for (int r = 0; r < 3; ++r) {
+            readers.emplace_back([&, r] {
+                unsigned seed = 12345u + static_cast<unsigned>(r);
+                while (running) {
+                    seed = seed * 1103515245u + 12345u;
+                    const int id = firstId + static_cast<int>((seed >> 8) % total);
+                    auto task = manager.getTask(id);
+                    if (task && (task->getId() != id || task->getDescription() != "task " + std::to_string(id - firstId + 1))) {
+                        consistent = false;
+                    }
+                }
+            });
+        }
+        for (int i = 0; i < 200; ++i) {
+            manager.markTaskDoneAsync(firstId + i * 7).get();
+            manager.deleteTaskAsync(firstId + i * 7 + 1).get();
+        }
+        running = false;
+        for (auto &reader : readers) {
+            reader.join();
+        }
+
+        CHECK(consistent);
+        for (int i = 0; i < 200; ++i) {
+            auto done = manager.getTask(firstId + i * 7);
+            CHECK(done && done->isDone());
+            CHECK(!manager.getTask(firstId + i * 7 + 1));
+        }
+        const TaskCacheStats stats = manager.cacheStats();
+        CHECK(stats.bytes <= budget);
+        CHECK(stats.hits > 0 && stats.misses > 0 && stats.evictions > 0);
+
+        CHECK(manager.getTasks().size() == static_cast<size_t>(total - 200));
+        TaskQuery completed;
+        completed.status = TaskQuery::Status::Done;
+        CHECK(manager.countTasks(completed) == 200);
+        CHECK(manager.queryTasks(completed).size() == 200);
+        const auto tagged = manager.tasksWithTags({"errand"}, false);
+        CHECK(tagged.size() == 1 && tagged.front().getId() == firstId + 42);
+        const auto found = manager.searchTasks("task 4999", 3);
+        CHECK(!found.empty() && found.front().getDescription() == "task 4999");
+    }
+
+    /**
+     * @brief Returns the IDs of the tasks carrying all of the given tags, in order.
+     */
+    std::vector<int> taggedIds(const TaskManager &manager, const std::vector<std::string> &tags, bool pendingOnly)
+    {
+        std::vector<int> ids;
+        for (const auto &task : manager.tasksWithTags(tags, pendingOnly)) {
+            ids.push_back(task.getId());
+        }
+        return ids;
+    }
+
+    /**
+     * @brief Tagging and untagging keep the in-memory posting lists in step with the
+     * database, including changes from another process and readers running alongside.
+     */
+    void testTagPostings()
+    {
+        Database database("tasks_concurrency.db");
+        TaskManager manager(database);
+        manager.clearAllDataAsync().get();
+        for (int i = 0; i < 4; ++i) {
+            manager.addTaskAsync("tagged " + std::to_string(i)).get();
+        }
+        const std::vector<Task> tasks = manager.getTasks();
+        const int a = tasks[0].getId(), b = tasks[1].getId(), c = tasks[2].getId(), d = tasks[3].getId();
+        manager.addTagAsync(a, "home").get();
+        manager.addTagAsync(b, "home").get();
+        manager.addTagAsync(b, "home").get(); // Tagging twice has no effect
+        manager.addTagAsync(b, "urgent").get();
+        manager.addTagAsync(c, "urgent").get();
+        manager.addTagAsync(d, "home").get();
+        manager.markTaskDoneAsync(d).get();
+        bool rejected = false;
+        try {
+            manager.addTagAsync(d + 1000, "orphan").get();
+        }
+        catch (const std::invalid_argument &) {
+            rejected = true;
+        }
+        CHECK(rejected);
+        CHECK(SQLite::Database("tasks_concurrency.db", SQLite::OPEN_READONLY)
+                  .execAndGet("SELECT COUNT(*) FROM tags WHERE name = 'orphan'").getInt() == 0);
+
+        CHECK(taggedIds(manager, {"home"}, false) == (std::vector<int>{a, b, d}));
+        CHECK(taggedIds(manager, {"home"}, true) == (std::vector<int>{a, b}));
+        CHECK(taggedIds(manager, {"home", "urgent"}, false) == std::vector<int>{b});
+        CHECK(taggedIds(manager, {"urgent", "home", "home"}, false) == std::vector<int>{b}); // Duplicates do not narrow
+        CHECK(taggedIds(manager, {"home", "missing"}, false).empty());
+        CHECK(taggedIds(manager, {}, false).empty());
+
+        manager.removeTagAsync(b, "home").get();
+        CHECK(taggedIds(manager, {"home"}, false) == (std::vector<int>{a, d}));
+        manager.removeTagAsync(b, "home").get(); // Untagging twice has no effect
+        manager.deleteTaskAsync(a).get();
+        CHECK(taggedIds(manager, {"home"}, false) == std::vector<int>{d});
+        CHECK((database.getTaskTagsAsync().get() ==
+               std::vector<std::pair<int, std::string>>{{d, "home"}, {b, "urgent"}, {c, "urgent"}}));
+
+        {
+            Database otherDatabase("tasks_concurrency.db");
+            TaskManager other(otherDatabase);
+            CHECK(taggedIds(other, {"urgent"}, false) == (std::vector<int>{b, c}));
+            other.addTagAsync(c, "home").get();
+        }
+        manager.refreshAsync().get();
+        CHECK(taggedIds(manager, {"home", "urgent"}, false) == std::vector<int>{c});
+
+        std::atomic<bool> stop{false};
+        std::vector<std::thread> readers;
+        for (int r = 0; r < 4; ++r) {
+            readers.emplace_back([&] {
+                while (!stop) {
+                    const std::vector<int> ids = taggedIds(manager, {"busy"}, false);
+                    CHECK(std::is_sorted(ids.begin(), ids.end()));
+                }
+            });
+        }
+        for (int i = 0; i < 100; ++i) {
+            manager.addTagAsync(i % 2 ? b : c, "busy").get();
+            manager.removeTagAsync(i % 2 ? c : b, "busy").get();
+        }
+        stop = true;
+        for (auto &reader : readers) {
+            reader.join();
+        }
+        CHECK(taggedIds(manager, {"busy"}, false) == std::vector<int>{b});
+    }
+
+    /**
+     * @brief Returns the IDs of the ready tasks.
+     */
+    std::vector<int> readyIds(const TaskManager &manager)
+    {
+        std::vector<int> ids;
+        for (const auto &task : manager.readyTasksAsync().get()) {
+            ids.push_back(task.getId());
+        }
+        return ids;
+    }
+
+    /**
+     * @brief Dependencies unblock tasks as their prerequisites are completed or deleted.
+     *
+     * Cycles are rejected. While readers list ready tasks, a writer completes
+     * a chain in order; no reader may ever see two links of the chain ready
+     * at once, and the final ready set must match one computed from scratch.
+     */
+    void testDependencyReadyQueue()
+    {
+        Database database("tasks_concurrency.db");
+        TaskManager manager(database);
+        manager.clearAllDataAsync().get();
+        for (int i = 0; i < 6; ++i) {
+            manager.addTaskAsync("step " + std::to_string(i)).get();
+        }
+        const std::vector<Task> tasks = manager.getTasks();
+        const int a = tasks[0].getId(), b = tasks[1].getId(), c = tasks[2].getId();
+        const int d = tasks[3].getId(), e = tasks[4].getId(), f = tasks[5].getId();
+        manager.addDependencyAsync(b, a).get();
+        manager.addDependencyAsync(c, b).get();
+        manager.addDependencyAsync(d, a).get();
+        CHECK(readyIds(manager) == (std::vector<int>{a, e, f}));
+
+        auto rejected = [&manager](int id, int prerequisiteId) {
+            try {
+                manager.addDependencyAsync(id, prerequisiteId).get();
+            }
+            catch (const std::invalid_argument &) {
+                return true;
+            }
+            return false;
+        };
+        CHECK(rejected(a, c)); // c -> b -> a
+        CHECK(rejected(a, a));
+        CHECK(rejected(a, f + 1000));
+
+        manager.markTaskDoneAsync(a).get();
+        CHECK(readyIds(manager) == (std::vector<int>{b, d, e, f}));
+        manager.deleteTaskAsync(b).get(); // c loses its only prerequisite
+        CHECK(readyIds(manager) == (std::vector<int>{c, d, e, f}));
+        {
+            Database otherDatabase("tasks_concurrency.db");
+            TaskManager other(otherDatabase);
+            other.addDependencyAsync(e, f).get();
+        }
+        manager.refreshAsync().get();
+        CHECK(readyIds(manager) == (std::vector<int>{c, d, f}));
+        CHECK(manager.prerequisitesOf(e) == std::vector<int>{f});
+
+        const int links = 100;
+        for (int i = 0; i < links; ++i) {
+            manager.addTaskAsync("link " + std::to_string(i)).get();
+        }
+        std::vector<int> chain;
+        for (const auto &task : manager.getTasks()) {
+            if (task.getId() > f) {
+                chain.push_back(task.getId());
+            }
+        }
+        for (int i = 1; i < links; ++i) {
+            manager.addDependencyAsync(chain[i], chain[i - 1]).get();
+        }
+
+        std::atomic<bool> running{true};
+        std::atomic<bool> consistent{true};
+        std::vector<std::thread> readers;
+        for (int r = 0; r < 2; ++r) {
+            readers.emplace_back([&] {
+                while (running) {
+                    const auto ready = readyIds(manager);
+                    const auto readyLinks = std::count_if(ready.begin(), ready.end(), [&chain](int id) { return id >= chain.front(); });
+                    if (readyLinks > 1) {
+                        consistent = false;
+                    }
+                }
+            });
+        }
+        for (int id : chain) {
+            manager.markTaskDoneAsync(id).get();
+        }
+        running = false;
+        for (auto &reader : readers) {
+            reader.join();
+        }
+        CHECK(consistent);
+        CHECK(readyIds(manager) == (std::vector<int>{c, d, f}));
+
+        // From scratch, and through a task cache too small for every task
+        TaskManager reloaded(database);
+        TaskManager paged(database, 4 * 1024);
+        CHECK(readyIds(reloaded) == readyIds(manager));
+        CHECK(readyIds(paged) == readyIds(manager));
+    }
+
+    /**
+     * @brief Timers spread over every wheel level fire exactly on their tick.
+     *
+     * Due times in the past fire on the first tick; cancelled and replaced
+     * timers never fire with their old due time, and timers beyond the
+     * simulated span stay pending.
+     */
+    void testTimerWheelFiresOnTime()
+    {
+        const int64_t start = 1000000;
+        const int64_t span = 3 * 24 * 3600;
+        TimerWheel wheel(start);
+        std::mt19937 random(42);
+        std::map<int, int64_t> expected; // Timers that must fire, by ID
+        int far = 0;
+        const int64_t ranges[] = {70, 5000, 300000, 20000000, int64_t(1) << 40};
+        for (int id = 0; id < 20000; ++id) {
+            const int64_t due = start - 100 + static_cast<int64_t>(random() % ranges[id % 5]);
+            wheel.schedule(id, due);
+            if (id % 7 == 0) {
+                wheel.cancel(id);
+            }
+            else if (id % 11 == 0) {
+                wheel.schedule(id, due + 1000); // Replaces the first timer
+                expected[id] = due + 1000;
+            }
+            else {
+                expected[id] = due;
+            }
+        }
+        for (auto it = expected.begin(); it != expected.end();) {
+            if (it->second > start + span) {
+                ++far;
+                it = expected.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+
+        std::map<int, int64_t> fired;
+        bool onTime = true;
+        for (int64_t now = start + 1; now <= start + span; ++now) {
+            wheel.advance(now, [&](int id, int64_t due) {
+                onTime = onTime && now == std::max(due, start + 1) && fired.count(id) == 0;
+                fired[id] = due;
+            });
+        }
+        CHECK(onTime);
+        CHECK(fired == expected);
+        CHECK(wheel.size() == static_cast<size_t>(far));
+    }
+
+    /**
+     * @brief Reminders fire once for pending tasks, including due times set by another process.
+     *
+     * Cleared, completed and past due times never fire.
+     */
+    void testRemindersFire()
+    {
+        Database database("tasks_concurrency.db");
+        TaskManager manager(database);
+        manager.clearAllDataAsync().get();
+        for (int i = 0; i < 6; ++i) {
+            manager.addTaskAsync("due " + std::to_string(i)).get();
+        }
+        const std::vector<Task> tasks = manager.getTasks();
+        const int64_t now = std::time(nullptr);
+        manager.setDueTimeAsync(tasks[0].getId(), now + 1).get();
+        manager.setDueTimeAsync(tasks[1].getId(), now + 2).get();
+        manager.setDueTimeAsync(tasks[2].getId(), now + 2).get();
+        manager.setDueTimeAsync(tasks[2].getId(), 0).get();
+        manager.setDueTimeAsync(tasks[3].getId(), now + 1).get();
+        manager.markTaskDoneAsync(tasks[3].getId()).get();
+        manager.setDueTimeAsync(tasks[4].getId(), now - 10).get();
+        CHECK(manager.pendingReminders() == 2);
+        CHECK(manager.getTask(tasks[1].getId())->getDueTime() == now + 2);
+
+        std::mutex mutex;
+        std::vector<int> reminded;
+        manager.startReminders([&](const Task &task) {
+            std::lock_guard<std::mutex> lock(mutex);
+            reminded.push_back(task.getId());
+        });
+        {
+            Database otherDatabase("tasks_concurrency.db");
+            TaskManager other(otherDatabase);
+            other.setDueTimeAsync(tasks[5].getId(), now + 2).get();
+        }
+
+        const std::vector<int> expected{tasks[0].getId(), tasks[1].getId(), tasks[5].getId()};
+        for (int i = 0; i < 50; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            std::lock_guard<std::mutex> lock(mutex);
+            if (reminded.size() >= expected.size()) {
+                break;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1200)); // Nothing fires twice
+        manager.stopReminders();
+        std::sort(reminded.begin(), reminded.end());
+        CHECK(reminded == expected);
+        CHECK(manager.pendingReminders() == 0);
+    }
+
+    // Counts the schema objects of a kind attached to a table.
+    int schemaObjects(const char *file, const std::string &type, const std::string &table)
+    {
+        SQLite::Database check(file, SQLite::OPEN_READONLY);
+        SQLite::Statement query(check, "SELECT COUNT(*) FROM sqlite_master WHERE type = ? AND tbl_name GLOB ?");
+        query.bind(1, type);
+        query.bind(2, table);
+        query.executeStep();
+        return query.getColumn(0).getInt();
+    }
+
+    // Undo brings deleted tasks back with their ID, tags, dependencies and due
+    // time, and a cleared database back from its stash, indexes included.
+    void testUndoRedo()
+    {
+        const char *file = "tasks_undo.db"; // Fresh, since a killed run leaves its stashes behind for a day
+        std::remove(file);
+        Database database(file);
+        const int taskIndexes = schemaObjects(file, "index", "tasks");
+        const int tagIndexes = schemaObjects(file, "index", "task_tags");
+        CHECK(taskIndexes > 0 && tagIndexes > 0);
+        {
+            TaskManager manager(database);
+            for (int i = 0; i < 4; ++i) {
+                manager.addTaskAsync("undo " + std::to_string(i)).get();
+            }
+            const std::vector<Task> tasks = manager.getTasks();
+            const int a = tasks[0].getId(), b = tasks[1].getId(), c = tasks[2].getId(), d = tasks[3].getId();
+            const int64_t due = std::time(nullptr) + 3600;
+            manager.addTagAsync(b, "home").get();
+            manager.addDependencyAsync(b, a).get();
+            manager.addDependencyAsync(c, b).get();
+            manager.setDueTimeAsync(b, due).get();
+
+            manager.deleteTaskAsync(b).get();
+            CHECK(!manager.getTask(b));
+            CHECK(manager.pendingReminders() == 0);
+            CHECK(manager.undoAsync().get() == "delete task " + std::to_string(b));
+            CHECK(manager.getTask(b) && manager.getTask(b)->getDueTime() == due);
+            CHECK(manager.prerequisitesOf(b) == std::vector<int>{a});
+            CHECK(manager.prerequisitesOf(c) == std::vector<int>{b});
+            CHECK(readyIds(manager) == (std::vector<int>{a, d}));
+            CHECK(manager.pendingReminders() == 1);
+            CHECK((database.getTaskTagsAsync().get() == std::vector<std::pair<int, std::string>>{{b, "home"}}));
+            CHECK(manager.redoAsync().get() == "delete task " + std::to_string(b));
+            CHECK(!manager.getTask(b));
+            CHECK(manager.redoAsync().get().empty());
+            manager.undoAsync().get();
+
+            manager.markTaskDoneAsync(a).get();
+            CHECK(readyIds(manager) == (std::vector<int>{b, d}));
+            CHECK(manager.undoAsync().get() == "complete task " + std::to_string(a));
+            CHECK(!manager.getTask(a)->isDone());
+            CHECK(readyIds(manager) == (std::vector<int>{a, d}));
+
+            manager.clearAllDataAsync().get();
+            manager.addTaskAsync("after clear").get();
+            CHECK(manager.getTasks().size() == 1);
+            // The new live tables are indexed at once; the stash keeps no indexes under their names
+            CHECK(schemaObjects(file, "index", "tasks") == taskIndexes);
+            CHECK(schemaObjects(file, "index", "task_tags") == tagIndexes);
+            CHECK(schemaObjects(file, "index", "undo_[0-9]*") == 0);
+            CHECK(manager.undoAsync().get() == "add task " + std::to_string(manager.getTasks()[0].getId()));
+            CHECK(manager.undoAsync().get() == "clear all data");
+            CHECK(manager.getTasks().size() == 4);
+            CHECK(manager.prerequisitesOf(c) == std::vector<int>{b});
+            CHECK(manager.pendingReminders() == 1);
+            CHECK(schemaObjects(file, "index", "tasks") == taskIndexes);
+            CHECK(schemaObjects(file, "index", "task_tags") == tagIndexes);
+            CHECK(schemaObjects(file, "table", "undo_[0-9]*") == 0);
+            {
+                Database otherDatabase(file);
+                TaskManager other(otherDatabase);
+                CHECK(other.getTasks().size() == 4);
+                CHECK((database.getTaskTagsAsync().get() == std::vector<std::pair<int, std::string>>{{b, "home"}}));
+
+                // Another process reuses the ID of a deleted task, so its undo fails
+                manager.deleteTaskAsync(d).get();
+                other.refreshAsync().get();
+                other.addTaskAsync("reused").get();
+            }
+            bool rejected = false;
+            try {
+                manager.undoAsync().get();
+            }
+            catch (const std::invalid_argument &) {
+                rejected = true;
+            }
+            CHECK(rejected);
+            CHECK(manager.undoAsync().get().empty()); // Older entries assumed the delete was reverted
+
+            manager.clearAllDataAsync().get();
+            CHECK(schemaObjects(file, "table", "undo_[0-9]*") > 0);
+        }
+        // The manager dropped its stash; the live tables kept their indexes throughout
+        CHECK(schemaObjects(file, "table", "undo_[0-9]*") == 0);
+        CHECK(schemaObjects(file, "index", "tasks") == taskIndexes);
+    }
+
+    // Readers on a Database's shared connection never see another thread's
+    // open transaction: neither part of a batch restore nor the moment a
+    // stash has renamed the task tables away.
+    void testReadersBesideOpenTransactions()
+    {
+        const char *file = "tasks_readers.db";
+        std::remove(file);
+        Database database(file);
+        constexpr int BATCH = 10;
+
+        std::atomic<bool> running{true};
+        std::atomic<int> failedReads{0};
+        std::vector<std::thread> readers;
+        for (int r = 0; r < 3; ++r) {
+            readers.emplace_back([&] {
+                while (running) {
+                    try {
+                        const size_t count = database.getTasksAsync().get().size();
+                        CHECK(count % BATCH == 0);
+                        database.getChangesSinceAsync(0).get();
+                    }
+                    catch (const std::exception &) {
+                        ++failedReads;
+                    }
+                }
+            });
+        }
+
+        int nextId = 1;
+        for (int round = 0; round < 60; ++round) {
+            std::vector<TaskRecord> batch;
+            for (int i = 0; i < BATCH; ++i, ++nextId) {
+                batch.push_back(TaskRecord{Task(nextId, "batch " + std::to_string(round), false, 1, 0), {}, {}});
+            }
+            database.restoreTasksAsync(batch).get();
+            if (round % 5 == 4) {
+                database.restoreStashAsync(database.stashAllDataAsync().get()).get();
+            }
+        }
+        running = false;
+        for (auto &reader : readers) {
+            reader.join();
+        }
+        CHECK(failedReads == 0);
+        CHECK(database.getTasksAsync().get().size() == static_cast<size_t>(60 * BATCH));
+    }
+
+    // IDs of the tasks matching a filter expression, in order.
+    std::vector<int> matchingIds(const TaskManager &manager, const std::string &expression)
+    {
+        std::vector<int> ids;
+        for (const auto &task : manager.filterTasksAsync(expression).get()) {
+            ids.push_back(task.getId());
+        }
+        return ids;
+    }
+
+    bool rejectedFilter(const std::string &expression)
+    {
+        try {
+            compileFilter(expression);
+        }
+        catch (const std::invalid_argument &) {
+            return true;
+        }
+        return false;
+    }
+
+    // Filter expressions of the same shape share one cached statement, which
+    // keeps working across a clear and under concurrent readers and a writer.
+    void testFilterExpressions()
+    {
+        CHECK(compileFilter("done=0 and text~\"deploy\"").condition ==
+              compileFilter("DONE = 1 AND text ~ release").condition);
+        CHECK(compileFilter("done=0 and text~deploy").condition != compileFilter("done=0 or text~deploy").condition);
+        CHECK(compileFilter("").condition == "1");
+        CHECK(compileFilter("done=0 and id<5").condition == "+done = ? AND id < ?");
+        CHECK(compileFilter("done=1 and completed<5").condition == "done = ? AND completedTime < ?");
+        CHECK(rejectedFilter("done"));
+        CHECK(rejectedFilter("done=0 and"));
+        CHECK(rejectedFilter("size>3"));
+        CHECK(rejectedFilter("text<3"));
+        CHECK(rejectedFilter("id~3"));
+        CHECK(rejectedFilter("created>yesterday"));
+        CHECK(rejectedFilter("(done=0"));
+        CHECK(rejectedFilter("text=\"open"));
+        CHECK(rejectedFilter(std::string(1000, '(') + "done=0" + std::string(1000, ')')));
+
+        Database database("tasks_concurrency.db");
+        TaskManager manager(database);
+        manager.clearAllDataAsync().get();
+        const char *descriptions[] = {"deploy api", "Deploy web", "write 100% docs", "review deploy_notes", "lunch"};
+        for (const char *description : descriptions) {
+            manager.addTaskAsync(description).get();
+        }
+        const std::vector<Task> tasks = manager.getTasks();
+        const int a = tasks[0].getId(), b = tasks[1].getId(), c = tasks[2].getId();
+        const int d = tasks[3].getId(), e = tasks[4].getId();
+        manager.markTaskDoneAsync(b).get();
+        manager.addTagAsync(a, "ops").get();
+        manager.addTagAsync(d, "ops").get();
+        manager.addTagAsync(d, "docs").get();
+        manager.setDueTimeAsync(e, 2000000000).get();
+
+        CHECK(matchingIds(manager, "text~deploy") == (std::vector<int>{a, b, d}));
+        CHECK(matchingIds(manager, "done=0 and text~\"deploy\"") == (std::vector<int>{a, d}));
+        CHECK(matchingIds(manager, "text~\"100%\"") == std::vector<int>{c});
+        CHECK(matchingIds(manager, "text~\"deploy_\"") == std::vector<int>{d});
+        CHECK(matchingIds(manager, "tag=ops and not tag=docs") == std::vector<int>{a});
+        CHECK(matchingIds(manager, "tag!=ops") == (std::vector<int>{b, c, e}));
+        CHECK(matchingIds(manager, "tag~o and (id=" + std::to_string(d) + " or done=1)") == std::vector<int>{d});
+        CHECK(matchingIds(manager, "due>2030-01-01") == std::vector<int>{e});
+        CHECK(matchingIds(manager, "due=0 and created<2100-01-01T00:00 and created>=1970-01-02") ==
+              (std::vector<int>{a, b, c, d}));
+        CHECK(matchingIds(manager, "") == (std::vector<int>{a, b, c, d, e}));
+        CHECK(matchingIds(manager, "not done=0") == std::vector<int>{b});
+        CHECK(matchingIds(manager, "done=1 and completed>0") == std::vector<int>{b});
+
+        // A clear renames the tables under the cached statements
+        manager.clearAllDataAsync().get();
+        CHECK(matchingIds(manager, "text~deploy").empty());
+        manager.undoAsync().get();
+        CHECK(matchingIds(manager, "text~deploy") == (std::vector<int>{a, b, d}));
+
+        std::atomic<bool> stop{false};
+        std::thread writer([&] {
+            for (int i = 0; i < 50; ++i) {
+                manager.addTaskAsync("deploy " + std::to_string(i)).get();
+            }
+            stop = true;
+        });
+        std::vector<std::thread> readers;
+        for (int r = 0; r < 4; ++r) {
+            readers.emplace_back([&, r] {
+                while (!stop) {
+                    const auto matches = manager.filterTasksAsync("id>=" + std::to_string(r) + " and text~deploy").get();
+                    bool ordered = std::is_sorted(matches.begin(), matches.end(),
+                                                  [](const Task &x, const Task &y) { return x.getId() < y.getId(); });
+                    CHECK(ordered && matches.size() >= 2);
+                }
+            });
+        }
+        writer.join();
+        for (auto &reader : readers) {
+            reader.join();
+        }
+        CHECK(matchingIds(manager, "text~deploy").size() == 53);
+    }
+
+    /**
+     * @brief Memory statistics track the tasks and stay readable while a writer runs.
+     */
+    void testMemoryStats()
+    {
+        CHECK(Task(1, "short", false, 0).getDescriptionHeapBytes() == 0);
+        CHECK(Task(1, std::string(100, 'x'), false, 0).getDescriptionHeapBytes() > 100);
+
+        Database database("tasks_concurrency.db");
+        TaskManager manager(database);
+        manager.clearAllDataAsync().get();
+        const TaskMemoryStats empty = manager.memoryStats();
+        CHECK(empty.tasks == 0 && empty.descriptionBytes == 0 && empty.searchIndexBytes == 0);
+
+        std::atomic<bool> stop{false};
+        std::thread writer([&] {
+            for (int i = 0; i < 100; ++i) {
+                manager.addTaskAsync("a description long enough to leave the string object " + std::to_string(i)).get();
+            }
+            stop = true;
+        });
+        while (!stop) {
+            const TaskMemoryStats stats = manager.memoryStats();
+            CHECK(stats.taskBytes >= stats.tasks * sizeof(Task));
+            const SqliteMemoryStats sqlite = database.getMemoryStatsAsync().get();
+            CHECK(sqlite.processBytes > 0 && sqlite.processPeakBytes >= sqlite.processBytes);
+        }
+        writer.join();
+
+        manager.searchTasks("description", 10);
+        const TaskMemoryStats stats = manager.memoryStats();
+        CHECK(stats.tasks == 100);
+        CHECK(stats.descriptionBytes > 100 * 50);
+        CHECK(stats.columnBytes >= 100 * (sizeof(int) + 2 * sizeof(int64_t)));
+        CHECK(stats.searchIndexBytes > 0);
+        CHECK(stats.cacheBudget == 0 && stats.total() > stats.descriptionBytes);
+
+        const SqliteMemoryStats sqlite = database.getMemoryStatsAsync().get();
+        CHECK(sqlite.pageCacheBytes > 0 && sqlite.pageCacheLimit > 0);
+        CHECK(sqlite.schemaBytes > 0);
+
+        TaskManager bounded(database, 1 << 16);
+        for (const Task &task : manager.getTasks()) {
+            bounded.getTask(task.getId());
+        }
+        const TaskMemoryStats paged = bounded.memoryStats();
+        CHECK(paged.tasks == 0 && paged.cacheBudget == 1 << 16);
+        CHECK(paged.cacheBytes > 0 && paged.cacheBytes <= 1 << 16);
+    }
+
+    /**
+     * @brief Threads writing through one Database at once lose no operations.
+     *
+     * Calls Database directly, without TaskManager's writer lock, so the
+     * write transactions of all threads share one connection.
+     */
+    void testSameProcessWritersLoseNothing()
+    {
+        Database database("tasks_concurrency.db");
+        database.clearAllDataAsync().get();
+        constexpr int WRITERS = 4;
+        constexpr int TASKS = 200;
+        std::atomic<int> failed{0};
+        std::vector<std::thread> writers;
+        for (int w = 0; w < WRITERS; ++w) {
+            writers.emplace_back([&, w] {
+                std::vector<future<int>> adds;
+                for (int i = 0; i < TASKS; ++i) {
+                    adds.push_back(database.addTaskAsync("writer " + std::to_string(w) + " task " + std::to_string(i)));
+                }
+                for (auto &add : adds) {
+                    try {
+                        const int id = add.get();
+                        if (id % 3 == 0) {
+                            database.markTaskDoneAsync(id).get();
+                        }
+                    }
+                    catch (const std::exception &) {
+                        ++failed;
+                    }
+                }
+            });
+        }
+        for (auto &writer : writers) {
+            writer.join();
+        }
+        CHECK(failed == 0);
+        const std::vector<Task> tasks = database.getTasksAsync().get();
+        CHECK(tasks.size() == WRITERS * TASKS);
+        for (const Task &task : tasks) {
+            CHECK(task.isDone() == (task.getId() % 3 == 0));
+        }
+    }
+
+    /**
+     * @brief Renders one task with the renderer for a format.
+     */
+    std::string rendered(OutputFormat format, const Task &task)
+    {
+        std::ostringstream out;
+        makeRenderer(format)->render(out, task);
+        return out.str();
+    }
+
+    /**
+     * @brief Formats a timestamp the way the text renderers do.
+     */
+    std::string localTime(time_t time)
+    {
+        char buffer[32];
+        std::tm tm = *std::localtime(&time);
+        return std::string(buffer, std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &tm));
+    }
+
+    /**
+     * @brief The plain, ANSI and JSON Lines renderers write the exact expected lines.
+     *
+     * JSON strings must escape quotes, backslashes and control characters
+     * and pass UTF-8 through unchanged.
+     */
+    void testRenderers()
+    {
+        Task pending(7, "Buy milk", false, 1700000000);
+        pending.setDueTime(1700086400);
+        const Task done(3, "say \"hi\" \\ \n\t\r\x01\x1f caf\xc3\xa9 \xe2\x9c\x93", true, 100, 200);
+        const std::string created = localTime(1700000000);
+        const std::string due = localTime(1700086400);
+
+        CHECK(rendered(OutputFormat::Plain, pending) ==
+              "7. Buy milk [Not Done] (Created: " + created + ") (Due: " + due + ")\n");
+        CHECK(rendered(OutputFormat::Plain, Task(8, "", false, 1700000000)) ==
+              "8.  [Not Done] (Created: " + created + ")\n");
+        CHECK(rendered(OutputFormat::Plain, Task(9, "Ship", true, 1700000000, 1700086400)) ==
+              "9. Ship [Done] (Created: " + created + ") (Completed: " + due + ")\n");
+
+        const std::string blue(Color::BLUE()), green(Color::GREEN()), yellow(Color::YELLOW()), reset(Color::RESET());
+        CHECK(rendered(OutputFormat::Ansi, pending) == blue + "7. Buy milk" + reset + yellow + " [Not Done]" + reset +
+                                                          " (Created: " + green + created + reset + ")" + yellow +
+                                                          " (Due: " + due + ")" + reset + "\n");
+        CHECK(rendered(OutputFormat::Ansi, Task(9, "Ship", true, 1700000000, 1700086400)) ==
+              blue + "9. Ship" + reset + green + " [Done]" + reset + " (Created: " + green + created + reset + ")" +
+                  green + " (Completed: " + due + ")" + reset + "\n");
+
+        CHECK(rendered(OutputFormat::JsonLines, pending) ==
+              "{\"id\":7,\"description\":\"Buy milk\",\"done\":false,\"createdTime\":1700000000,"
+              "\"completedTime\":0,\"dueTime\":1700086400}\n");
+        CHECK(rendered(OutputFormat::JsonLines, done) ==
+              "{\"id\":3,\"description\":\"say \\\"hi\\\" \\\\ \\n\\t\\r\\u0001\\u001f caf\xc3\xa9 \xe2\x9c\x93\","
+              "\"done\":true,\"createdTime\":100,\"completedTime\":200,\"dueTime\":0}\n");
+
+        OutputFormat format = OutputFormat::Plain;
+        CHECK(parseOutputFormat("json", format) && format == OutputFormat::JsonLines);
+        CHECK(parseOutputFormat("ansi", format) && format == OutputFormat::Ansi);
+        CHECK(!parseOutputFormat("xml", format) && format == OutputFormat::Ansi);
+    }
+
+    /**
+     * @brief Returns the positions of the tasks matching a query, testing one task at a time.
+     */
+    std::vector<uint32_t> naiveSelect(const std::vector<Task> &tasks, const TaskQuery &query)
+    {
+        std::vector<uint32_t> rows;
+        for (size_t i = 0; i < tasks.size() && rows.size() < query.limit; ++i) {
+            const Task &task = tasks[i];
+            const int64_t created = task.getCreatedTime();
+            const int64_t completed = task.getCompletedTime();
+            if ((query.status == TaskQuery::Status::Done && !task.isDone()) ||
+                (query.status == TaskQuery::Status::Pending && task.isDone()) || created < query.createdFrom ||
+                created >= query.createdTo || completed < query.completedFrom || completed >= query.completedTo ||
+                task.getId() < query.idFrom || task.getId() >= query.idTo) {
+                continue;
+            }
+            rows.push_back(static_cast<uint32_t>(i));
+        }
+        return rows;
+    }
+
+    /**
+     * @brief Returns true if two sets of columns hold the same rows.
+     */
+    bool sameColumns(const TaskColumns &a, const TaskColumns &b)
+    {
+        return a.ids == b.ids && a.createdTimes == b.createdTimes && a.completedTimes == b.completedTimes &&
+               a.doneBits == b.doneBits;
+    }
+
+    /**
+     * @brief The columnar query engine agrees with a task-at-a-time filter.
+     *
+     * Sizes straddle the 64-row blocks. Random queries are mixed with the
+     * all-match and empty cases, and columns merged from a random delta must
+     * equal columns rebuilt from the merged list.
+     */
+    void testColumnarQueries()
+    {
+        std::mt19937 rng(7);
+        auto random = [&rng](int64_t low, int64_t high) {
+            return std::uniform_int_distribution<int64_t>(low, high)(rng);
+        };
+        auto makeTask = [&](int id) {
+            const int64_t created = random(1000, 1999);
+            const bool done = random(0, 1) == 1;
+            return Task(id, "task", done, created, done ? created + random(0, 500) : 0);
+        };
+
+        for (size_t size : {0, 1, 63, 64, 65, 127, 128, 129, 1000}) {
+            std::vector<Task> tasks;
+            int id = 0;
+            for (size_t i = 0; i < size; ++i) {
+                id += static_cast<int>(random(1, 3));
+                tasks.push_back(makeTask(id));
+            }
+            const TaskColumns columns = buildColumns(tasks);
+
+            TaskQuery all;
+            CHECK(selectRows(columns, all) == naiveSelect(tasks, all));
+            CHECK(countRows(columns, all) == size);
+            TaskQuery none;
+            none.createdFrom = none.createdTo = 1500;
+            CHECK(selectRows(columns, none).empty());
+            CHECK(countRows(columns, none) == 0);
+
+            for (int round = 0; round < 200; ++round) {
+                TaskQuery query;
+                query.status = static_cast<TaskQuery::Status>(random(0, 2));
+                if (random(0, 2) == 0) {
+                    query.createdFrom = random(900, 2100);
+                    query.createdTo = random(900, 2100);
+                }
+                if (random(0, 2) == 0) {
+                    query.completedFrom = random(0, 2500);
+                    query.completedTo = random(0, 2500);
+                }
+                if (random(0, 2) == 0) {
+                    query.idFrom = static_cast<int>(random(-5, id + 5));
+                    query.idTo = static_cast<int>(random(-5, id + 5));
+                }
+                if (random(0, 4) == 0) {
+                    query.limit = static_cast<size_t>(random(0, static_cast<int64_t>(size)));
+                }
+                const std::vector<uint32_t> expected = naiveSelect(tasks, query);
+                CHECK(selectRows(columns, query) == expected);
+                CHECK(countRows(columns, query) == expected.size());
+            }
+
+            // Changes, deletes, inserts into the gaps and appends past the end
+            std::map<int, Task> merged;
+            for (const Task &task : tasks) {
+                merged.emplace(task.getId(), task);
+            }
+            std::vector<Task> upserted;
+            std::vector<int> deleted;
+            for (int candidate = 1; candidate <= id + 70; ++candidate) {
+                const int64_t roll = random(0, 9);
+                if (merged.count(candidate) && roll == 0) {
+                    deleted.push_back(candidate);
+                }
+                else if (roll == 1) {
+                    upserted.push_back(makeTask(candidate));
+                }
+            }
+            for (int removed : deleted) {
+                merged.erase(removed);
+            }
+            for (const Task &task : upserted) {
+                merged.erase(task.getId());
+                merged.emplace(task.getId(), task);
+            }
+            std::vector<Task> after;
+            for (const auto &entry : merged) {
+                after.push_back(entry.second);
+            }
+            CHECK(sameColumns(mergeColumns(columns, upserted, deleted), buildColumns(after)));
+            CHECK(sameColumns(mergeColumns(columns, {}, {}), columns));
+        }
+    }
+
+    /**
+     * @brief Returns the candidates of a trigram search in the order they are visited.
+     */
+    std::vector<std::pair<int, int>> candidates(const TrigramIndex &index, const std::string &query, int maxEdits,
+                                                size_t stopAfter = std::numeric_limits<size_t>::max())
+    {
+        std::vector<std::pair<int, int>> visited;
+        index.forEachCandidate(query, maxEdits, [&](const TrigramCandidate &candidate) {
+            visited.emplace_back(candidate.id, candidate.minEdits);
+            return visited.size() < stopAfter;
+        });
+        return visited;
+    }
+
+    /**
+     * @brief Returns the IDs of a search's results in order.
+     */
+    std::vector<int> searchIds(const TaskManager &manager, const std::string &query, size_t limit)
+    {
+        std::vector<int> ids;
+        for (const Task &task : manager.searchTasks(query, limit)) {
+            ids.push_back(task.getId());
+        }
+        return ids;
+    }
+
+    /**
+     * @brief Fuzzy search finds typos and ranks ties by description length, then ID.
+     *
+     * Checks the edit distance on its own, the trigram candidates through
+     * both of the index's counting paths, and searchTasks with and without a
+     * cache budget, which verify candidates from the index or scan every task.
+     * Queries under three characters have no trigrams and take the exact scan.
+     */
+    void testFuzzySearch()
+    {
+        CHECK(substringEditDistance("deploy", "Fix deploy script", 2) == 0);
+        CHECK(substringEditDistance("DEPLOY", "fix deploy", 2) == 0);
+        CHECK(substringEditDistance("depoly", "fix deploy", 2) == 1);  // Adjacent swap
+        CHECK(substringEditDistance("deply", "fix deploy", 2) == 1);   // Deletion
+        CHECK(substringEditDistance("deeploy", "fix deploy", 2) == 1); // Insertion
+        CHECK(substringEditDistance("dwploy", "fix deploy", 2) == 1);  // Substitution
+        CHECK(substringEditDistance("xyzxyz", "deploy", 1) == 2);      // Capped at maxEdits + 1
+
+        // A large ID makes the postings short relative to maxId, so this index sorts them instead
+        TrigramIndex dense, sorted;
+        for (TrigramIndex *index : {&dense, &sorted}) {
+            index->insert(1, "Fix deploy script");
+            index->insert(2, "Deploy the app");
+            index->insert(3, "write docs");
+            index->insert(5, "depoly typo");
+            index->insert(1, "Fix deploy script"); // Inserting twice has no effect
+        }
+        sorted.insert(1000, "unrelated words");
+        const std::vector<std::pair<int, int>> expected = {{1, 0}, {2, 0}, {5, 1}};
+        CHECK(candidates(dense, "deploy", 1) == expected);
+        CHECK(candidates(sorted, "deploy", 1) == expected);
+        CHECK(candidates(dense, "deploy", 1, 1).size() == 1);
+        CHECK(candidates(sorted, "deploy", 1, 1).size() == 1);
+        CHECK(candidates(dense, "deploy", 0) == (std::vector<std::pair<int, int>>{{1, 0}, {2, 0}}));
+        dense.erase(2, "Deploy the app");
+        CHECK(candidates(dense, "deploy", 1) == (std::vector<std::pair<int, int>>{{1, 0}, {5, 1}}));
+
+        Database database("tasks_concurrency.db");
+        TaskManager manager(database);
+        manager.clearAllDataAsync().get();
+        for (const char *description : {"Fix deploy script", "redeploy", "depoly typo", "deploy docs", "tab stop",
+                                        "Label", "deploy menu"}) {
+            manager.addTaskAsync(description).get();
+        }
+        std::vector<int> id;
+        for (const Task &task : manager.getTasks()) {
+            id.push_back(task.getId());
+        }
+        TaskManager budgeted(database, 1 << 20);
+        for (const TaskManager *searcher : {&manager, &budgeted}) {
+            // Distance, then length, then ID; the swapped "depoly" comes last
+            CHECK(searchIds(*searcher, "deploy", 10) == (std::vector<int>{id[1], id[3], id[6], id[0], id[2]}));
+            CHECK(searchIds(*searcher, "deploy", 3) == (std::vector<int>{id[1], id[3], id[6]}));
+            CHECK(searchIds(*searcher, "dep", 10) == (std::vector<int>{id[1], id[2], id[3], id[6], id[0]}));
+            CHECK(searchIds(*searcher, "ab", 10) == (std::vector<int>{id[4], id[5]}));
+            CHECK(searchIds(*searcher, "AB", 1) == std::vector<int>{id[4]});
+            CHECK(searchIds(*searcher, "", 10).empty());
+        }
+    }
+
+    /**
+     * @brief Writes the history of some tasks as CSV.
+     */
+    std::string historyCsv(const std::vector<Task> &tasks, HistoryGranularity granularity)
+    {
+        std::ostringstream out;
+        writeHistory(out, buildHistory(buildColumns(tasks), granularity), granularity, HistoryFormat::Csv);
+        return out.str();
+    }
+
+    /**
+     * @brief Days, ISO weeks and months are folded and labelled on the right side of each edge.
+     *
+     * Covers timestamps before 1970, weeks spanning a new year, a leap day,
+     * and outlying timestamps that must not fill in the buckets between them.
+     */
+    void testHistoryBuckets()
+    {
+        const std::vector<Task> epoch = {
+            Task(1, "sunday before", false, -302400),  // 1969-12-28 12:00
+            Task(2, "monday before", false, -216000),  // 1969-12-29 12:00
+            Task(3, "last second", true, -1, 1),       // 1969-12-31 23:59:59, done 1970-01-01
+            Task(4, "sunday after", false, 302400),    // 1970-01-04 12:00
+            Task(5, "monday after", false, 388800),    // 1970-01-05 12:00
+        };
+        CHECK(historyCsv(epoch, HistoryGranularity::Day) == "period,created,completed\n"
+                                                            "1969-12-28,1,0\n1969-12-29,1,0\n1969-12-30,0,0\n"
+                                                            "1969-12-31,1,0\n1970-01-01,0,1\n1970-01-02,0,0\n"
+                                                            "1970-01-03,0,0\n1970-01-04,1,0\n1970-01-05,1,0\n");
+        CHECK(historyCsv(epoch, HistoryGranularity::Week) == "period,created,completed\n"
+                                                             "1969-12-22,1,0\n1969-12-29,3,1\n1970-01-05,1,0\n");
+        CHECK(historyCsv(epoch, HistoryGranularity::Month) == "period,created,completed\n"
+                                                              "1969-12,3,0\n1970-01,2,1\n");
+
+        const std::vector<Task> newYear = {
+            Task(1, "sunday", false, 1609070400),   // 2020-12-27
+            Task(2, "monday", false, 1609156800),   // 2020-12-28, ISO week 53 of 2020
+            Task(3, "thursday", false, 1609416000), // 2020-12-31
+            Task(4, "sunday", false, 1609675200),   // 2021-01-03, still week 53
+            Task(5, "monday", false, 1609761600),   // 2021-01-04, week 1 of 2021
+            Task(6, "leap day", false, 1709208000), // 2024-02-29
+            Task(7, "after it", false, 1709294400), // 2024-03-01
+        };
+        const std::string weeks = historyCsv(newYear, HistoryGranularity::Week);
+        CHECK(weeks.rfind("period,created,completed\n2020-12-21,1,0\n2020-12-28,3,0\n2021-01-04,1,0\n", 0) == 0);
+        const std::string months = historyCsv(newYear, HistoryGranularity::Month);
+        CHECK(months.find("\n2020-12,3,0\n2021-01,2,0\n") != std::string::npos);
+        CHECK(months.find("\n2024-02,1,0\n2024-03,1,0\n") != std::string::npos);
+
+        const std::vector<Task> outliers = {
+            Task(1, "epoch", false, 0),
+            Task(2, "recent", true, 1709208000, 1709294400),
+            Task(3, "far future", false, 253402257600), // 9999-12-31
+        };
+        const std::vector<HistoryBucket> days = buildHistory(buildColumns(outliers), HistoryGranularity::Day);
+        CHECK(days.size() == 4);
+        CHECK(historyCsv(outliers, HistoryGranularity::Day) == "period,created,completed\n"
+                                                               "1970-01-01,1,0\n2024-02-29,1,0\n2024-03-01,0,1\n"
+                                                               "9999-12-31,1,0\n");
+        std::ostringstream sparkline;
+        writeHistory(sparkline, days, HistoryGranularity::Day, HistoryFormat::Sparkline);
+        CHECK(sparkline.str().size() < 512);
+    }
+
+    /**
+     * @brief An older file is converted only on request, then shrunk beside writers.
+     *
+     * Opening a file without auto_vacuum must leave it as it is; the explicit
+     * conversion switches it once. The maintenance thread then reclaims the
+     * pages of a bulk delete while other threads keep writing on the shared
+     * connection, and none of those writes may fail.
+     */
+    void testIncrementalVacuumBesideWriters()
+    {
+        const char *file = "tasks_migration.db";
+        std::remove(file);
+        {
+            SQLite::Database legacy(file, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+            legacy.exec("CREATE TABLE tasks (id INTEGER PRIMARY KEY, description TEXT, done INTEGER, createdTime INTEGER, completedTime INTEGER)");
+        }
+        Database database(file);
+        auto autoVacuum = [file] {
+            SQLite::Database check(file, SQLite::OPEN_READONLY);
+            return check.execAndGet("PRAGMA auto_vacuum").getInt();
+        };
+        CHECK(autoVacuum() == 0);
+        CHECK(database.enableIncrementalVacuumAsync().get());
+        CHECK(!database.enableIncrementalVacuumAsync().get());
+        CHECK(autoVacuum() == 2);
+
+        const std::string padding(512, 'x');
+        for (int i = 0; i < 2000; ++i) {
+            database.addTaskAsync("bulk " + padding).get();
+        }
+        TaskQuery all;
+        CHECK(database.deleteWhereAsync(all).get() == 2000);
+
+        std::atomic<int> failed{0};
+        std::atomic<bool> running{true};
+        std::vector<std::thread> writers;
+        for (int w = 0; w < 2; ++w) {
+            writers.emplace_back([&] {
+                while (running) {
+                    try {
+                        database.markTaskDoneAsync(database.addTaskAsync("during vacuum").get()).get();
+                    }
+                    catch (const std::exception &) {
+                        ++failed;
+                    }
+                }
+            });
+        }
+        database.startMaintenance(16, std::chrono::milliseconds(10));
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        running = false;
+        for (auto &writer : writers) {
+            writer.join();
+        }
+        CHECK(failed == 0);
+
+        // Polled once the writers are gone, so the check itself never competes for the lock
+        int freePages = -1;
+        for (int i = 0; i < 200 && freePages != 0; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            SQLite::Database check(file, SQLite::OPEN_READONLY, 5000);
+            freePages = check.execAndGet("PRAGMA freelist_count").getInt();
+        }
+        database.stopMaintenance();
+        CHECK(freePages == 0);
+    }
+
+#ifdef __linux__
+    /**
+     * @brief Separate processes writing one file lose no operations.
+     *
+     * Each child adds tasks, completes, tags and deletes some of them. The
+     * busy timeout is kept at 1 ms so lock conflicts reach the retry path
+     * instead of being absorbed by SQLite's own wait. Children report their
+     * retry counts through a pipe; the parent then checks every operation
+     * landed. Nothing is open in the parent while it forks.
+     */
+    void testForkedWritersLoseNothing()
+    {
+        const char *file = "tasks_contention.db";
+        std::remove(file);
+        {
+            Database schema(file); // Created once, so children do not race to set it up
+        }
+
+        constexpr int WRITERS = 6;
+        constexpr int TASKS = 100; // Per writer; every 4th is done, every 5th tagged, every 10th deleted
+        int report[2];
+        CHECK(pipe(report) == 0);
+
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<pid_t> children;
+        for (int w = 0; w < WRITERS; ++w) {
+            const pid_t pid = fork();
+            if (pid == 0) {
+                int status = 0;
+                try {
+                    BusyPolicy busy;
+                    busy.timeout = std::chrono::milliseconds(1);
+                    busy.retries = 200;
+                    busy.backoff = std::chrono::milliseconds(1);
+                    busy.maxBackoff = std::chrono::milliseconds(20);
+                    Database database(file, AccessMode::ReadWrite, busy);
+                    for (int i = 1; i <= TASKS; ++i) {
+                        const int id = database.addTaskAsync("writer " + std::to_string(w) + " task " + std::to_string(i)).get();
+                        if (i % 4 == 0) {
+                            database.markTaskDoneAsync(id).get();
+                        }
+                        if (i % 5 == 0) {
+                            database.addTagAsync(id, "writer" + std::to_string(w)).get();
+                        }
+                        if (i % 10 == 0) {
+                            database.deleteTaskAsync(id).get();
+                        }
+                    }
+                    const uint64_t retries = database.busyRetryCount();
+                    status = write(report[1], &retries, sizeof retries) == sizeof retries ? 0 : 1;
+                }
+                catch (const std::exception &e) {
+                    std::cerr << "writer " << w << ": " << e.what() << std::endl;
+                    status = 1;
+                }
+                _exit(status); // Skip the parent's atexit handlers and buffered output
+            }
+            CHECK(pid > 0);
+            children.push_back(pid);
+        }
+        close(report[1]);
+
+        for (pid_t pid : children) {
+            int status = 0;
+            CHECK(waitpid(pid, &status, 0) == pid);
+            CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        uint64_t retries = 0, reported = 0, count = 0;
+        while (read(report[0], &reported, sizeof reported) == sizeof reported) {
+            retries += reported;
+            ++count;
+        }
+        close(report[0]);
+        CHECK(count == WRITERS);
+
+        Database database(file, AccessMode::ReadOnly);
+        const std::vector<Task> tasks = database.getTasksAsync().get();
+        const long done = std::count_if(tasks.begin(), tasks.end(), [](const Task &task) { return task.isDone(); });
+        CHECK(tasks.size() == WRITERS * (TASKS - TASKS / 10));
+        CHECK(done == WRITERS * (TASKS / 4 - TASKS / 20)); // Multiples of 20 were done, then deleted
+        CHECK(database.getTaskTagsAsync().get().size() == WRITERS * (TASKS / 5 - TASKS / 10));
+
+        const int operations = WRITERS * (TASKS + TASKS / 4 + TASKS / 5 + TASKS / 10);
+        std::cout << "Forked writers: " << operations << " writes from " << WRITERS << " processes in " << seconds
+                  << " s (" << static_cast<int>(operations / seconds) << " writes/s), " << retries << " busy retries"
+                  << std::endl;
+    }
+
+    /**
+     * @brief Opens a raw connection to a Server, bypassing Client's framing.
+     */
+    int connectRaw(const std::string &socketPath)
+    {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+        const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        CHECK(connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0);
+        return fd;
+    }
+
+    /**
+     * @brief Reads from a raw connection until the server closes it.
+     */
+    std::string readUntilClosed(int fd)
+    {
+        std::string received;
+        char buffer[4096];
+        ssize_t count;
+        while ((count = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+            received.append(buffer, static_cast<size_t>(count));
+        }
+        return received;
+    }
+
+    /**
+     * @brief Clients talk to a Server whose requests run off the event loop.
+     *
+     * Concurrent clients lose no additions, pipelined requests are answered in
+     * order even after the client shuts down its side, and a request line
+     * longer than the limit closes the connection instead of being buffered.
+     */
+    void testServerRequests()
+    {
+        const std::string socketPath = "todolist_concurrency.sock";
+        Database database("tasks_concurrency.db");
+        TaskManager manager(database);
+        manager.clearAllDataAsync().get();
+        Server server(manager, socketPath);
+        std::thread loop([&server] { server.run(); });
+
+        constexpr int CLIENTS = 8;
+        constexpr int TASKS = 25; // Per client
+        std::vector<std::thread> clients;
+        for (int c = 0; c < CLIENTS; ++c) {
+            clients.emplace_back([&socketPath, c] {
+                Client client(socketPath);
+                std::string body;
+                for (int i = 0; i < TASKS; ++i) {
+                    CHECK(client.send("ADD client " + std::to_string(c) + " task " + std::to_string(i), body) == "OK");
+                }
+                CHECK(client.send("DONE nonsense", body) == "ERR invalid task id: nonsense");
+            });
+        }
+        for (auto &client : clients) {
+            client.join();
+        }
+        CHECK(manager.snapshot()->tasks.size() == static_cast<size_t>(CLIENTS * TASKS));
+
+        const int pipelined = connectRaw(socketPath);
+        const std::string requests = "CLEAR\nADD first\r\nADD second\nLIST plain\nBOGUS\n";
+        CHECK(send(pipelined, requests.data(), requests.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(requests.size()));
+        shutdown(pipelined, SHUT_WR);
+        const std::string answers = readUntilClosed(pipelined);
+        close(pipelined);
+        CHECK(answers.compare(0, 12, "OK\n\nOK\n\nOK\n\n") == 0);
+        const size_t first = answers.find("first");
+        const size_t second = answers.find("second");
+        CHECK(first != std::string::npos && second != std::string::npos && first < second);
+        const std::string last = "\n\nERR unknown request\n\n"; // End of the LIST response, then BOGUS
+        CHECK(answers.size() >= last.size() && answers.compare(answers.size() - last.size(), last.size(), last) == 0);
+        CHECK(manager.snapshot()->tasks.size() == 2);
+
+        const int flooding = connectRaw(socketPath);
+        const std::string chunk(4096, 'x');
+        size_t flooded = 0;
+        while (flooded <= (1 << 20)) { // Far past the limit; stops once the server hangs up
+            const ssize_t sent = send(flooding, chunk.data(), chunk.size(), MSG_NOSIGNAL);
+            if (sent <= 0) break;
+            flooded += static_cast<size_t>(sent);
+        }
+        CHECK(flooded < (1 << 20));
+        shutdown(flooding, SHUT_WR);
+        CHECK(readUntilClosed(flooding).empty());
+        close(flooding);
+
+        Client after(socketPath);
+        std::string body;
+        CHECK(after.send("LIST", body) == "OK");
+        CHECK(body.find("second") != std::string::npos);
+
+        manager.addTaskAsync("two\n\nlines").get(); // Stored descriptions may hold line breaks
+        for (const char *format : {"LIST plain", "LIST ansi", "LIST json"}) {
+            CHECK(after.send(format, body) == "OK");
+            CHECK(std::count(body.begin(), body.end(), '\n') == 3);
+            CHECK(body.find("two\\n\\nlines") != std::string::npos);
+        }
+        CHECK(after.send("BOGUS", body) == "ERR unknown request"); // Still in step with the responses
+        CHECK(body.empty());
+
+        server.stop();
+        loop.join();
+    }
+#endif
+}
+
+int main()
+{
+    // Keep the test databases out of the directory the test is started from
+    const auto scratch = std::filesystem::temp_directory_path() / "todolist_concurrency_test";
+    std::filesystem::create_directories(scratch);
+    std::filesystem::current_path(scratch);
+
+    testSnapshotReadsDuringMutations();
+    testRefreshPicksUpExternalChanges();
+    testReadOnlyReadersBesideWriter();
+    testMigrationBackfillBesideWriter();
+    testRecurringTasksMaterializeOnce();
+    testBulkOperationsBesideReaders();
+    testBackupUnderWriteLoad();
+    testDeltaSyncToReplica();
+    testArchiveBesideReaders();
+    testBoundedCacheBesideWriter();
+    testDependencyReadyQueue();
+    testTimerWheelFiresOnTime();
+    testRemindersFire();
+    testUndoRedo();
+    testReadersBesideOpenTransactions();
+    testFilterExpressions();
+    testMemoryStats();
+    testTagPostings();
+    testSameProcessWritersLoseNothing();
+    testIncrementalVacuumBesideWriters();
+    testHistoryBuckets();
+    testFuzzySearch();
+    testColumnarQueries();
+    testRenderers();
+#ifdef __linux__
+    testForkedWritersLoseNothing();
+    testServerRequests();
+#endif
+
+    if (failures) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "All concurrency tests passed" << std::endl;
+    return 0;
+}
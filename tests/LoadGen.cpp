@@ -0,0 +1,318 @@
+#include "Database.h"
+#include "TaskManager.h"
+#include <SQLiteCpp/SQLiteCpp.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fmt/core.h>
+
+using fmt::print;
+using std::string;
+using std::vector;
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Multi-threaded mixed-workload load generator.
+ *
+ * Every worker thread opens its own Database and TaskManager on the same
+ * file, the way separate todolist processes would, and issues a random mix of
+ * read/add/done/delete operations for a fixed duration. Going through
+ * TaskManager measures what the CLI and the server run: each read refreshes
+ * the snapshot from the other workers' changes before walking it, and each
+ * write publishes a new one. Reports throughput, latency percentiles and how
+ * often SQLITE_BUSY forced a retry.
+ *
+ * Usage: todolist_loadgen [--db FILE] [--threads N] [--duration SECONDS]
+ *                         [--mix READ:ADD:DONE:DELETE] [--dist uniform|zipfian]
+ *                         [--keys N] [--busy-timeout MS] [--busy-retries N]
+ *
+ * --busy-timeout and --busy-retries set the BusyPolicy of the workers'
+ * connections; a short timeout turns lock waits into counted retries.
+ */
+
+namespace
+{
+    enum Operation { READ, ADD, DONE, DELETE, OPERATION_COUNT };
+    const char *const OPERATION_NAMES[OPERATION_COUNT] = {"read", "add", "done", "delete"};
+
+    struct Options {
+        string dbFilename = "tasks_loadgen.db";
+        int threads = 4;
+        int durationSeconds = 10;
+        int mix[OPERATION_COUNT] = {70, 10, 10, 10};
+        bool zipfian = false;
+        int keys = 1000;
+        BusyPolicy busy;
+    };
+
+    /**
+     * @brief Zipfian key generator (Gray et al., "Quickly Generating Billion-Record Synthetic Databases").
+     *
+     * Draws values in [1, n] where low ranks are exponentially more popular.
+     */
+    class ZipfianGenerator {
+    public:
+        ZipfianGenerator(int n, double theta = 0.99) : n(n), theta(theta)
+        {
+            zetaN = zeta(n);
+            double zeta2 = zeta(2);
+            alpha = 1.0 / (1.0 - theta);
+            eta = (1.0 - std::pow(2.0 / n, 1.0 - theta)) / (1.0 - zeta2 / zetaN);
+        }
+
+        int next(std::mt19937_64 &rng) const
+        {
+            double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+            double uz = u * zetaN;
+            if (uz < 1.0) return 1;
+            if (uz < 1.0 + std::pow(0.5, theta)) return 2;
+            return std::min(n, 1 + static_cast<int>(n * std::pow(eta * u - eta + 1.0, alpha)));
+        }
+
+    private:
+        double zeta(int count) const
+        {
+            double sum = 0;
+            for (int i = 1; i <= count; ++i) sum += 1.0 / std::pow(i, theta);
+            return sum;
+        }
+
+        int n;
+        double theta, zetaN, alpha, eta;
+    };
+
+    /**
+     * @brief Stream buffer that forwards whole lines to another one, except busy-lock noise.
+     *
+     * Database and TaskManager log every failed statement. SQLITE_BUSY failures
+     * are expected under load and counted instead; every other error still
+     * reaches the terminal. Each thread collects its own line, so concurrent
+     * loggers do not interleave.
+     */
+    class BusyNoiseFilter : public std::streambuf {
+    public:
+        explicit BusyNoiseFilter(std::streambuf *target) : target(target) {}
+
+    protected:
+        int overflow(int c) override
+        {
+            if (c != traits_type::eof()) {
+                const char character = static_cast<char>(c);
+                xsputn(&character, 1);
+            }
+            return traits_type::not_eof(c);
+        }
+
+        std::streamsize xsputn(const char *text, std::streamsize count) override
+        {
+            thread_local string line;
+            for (std::streamsize i = 0; i < count; ++i) {
+                line += text[i];
+                if (text[i] != '\n') continue;
+                if (line.find("database is locked") == string::npos &&
+                    line.find("database table is locked") == string::npos) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    target->sputn(line.data(), static_cast<std::streamsize>(line.size()));
+                }
+                line.clear();
+            }
+            return count;
+        }
+
+    private:
+        std::streambuf *target;
+        std::mutex mutex;
+    };
+
+    struct WorkerResult {
+        vector<uint32_t> latenciesUs[OPERATION_COUNT];
+        uint64_t busyRetries = 0;  ///< Retries Database made internally after SQLITE_BUSY.
+        uint64_t busyFailures = 0; ///< Operations still busy once Database gave up, run again here.
+        uint64_t errors = 0;
+    };
+
+    bool parseOptions(int argc, char *argv[], Options &options)
+    {
+        for (int i = 1; i < argc; ++i) {
+            string arg = argv[i];
+            if (i + 1 >= argc) return false;
+            string value = argv[++i];
+            if (arg == "--db") options.dbFilename = value;
+            else if (arg == "--threads") options.threads = std::max(1, std::stoi(value));
+            else if (arg == "--duration") options.durationSeconds = std::max(1, std::stoi(value));
+            else if (arg == "--keys") options.keys = std::max(2, std::stoi(value));
+            else if (arg == "--dist") options.zipfian = value == "zipfian";
+            else if (arg == "--busy-timeout") options.busy.timeout = std::chrono::milliseconds(std::max(0, std::stoi(value)));
+            else if (arg == "--busy-retries") options.busy.retries = std::max(0, std::stoi(value));
+            else if (arg == "--mix") {
+                std::istringstream in(value);
+                string part;
+                for (int op = 0; op < OPERATION_COUNT; ++op) {
+                    if (!std::getline(in, part, ':')) return false;
+                    options.mix[op] = std::stoi(part);
+                }
+            }
+            else return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Runs one operation, running it again while it fails with the database busy.
+     *
+     * Database already retries SQLITE_BUSY with backoff, so this only sees
+     * operations whose retries were exhausted.
+     */
+    template <typename Op>
+    void runWithRetry(Op op, WorkerResult &result)
+    {
+        while (true) {
+            try {
+                op();
+                return;
+            }
+            catch (const SQLite::Exception &e) {
+                if (e.getErrorCode() != SQLITE_BUSY && e.getErrorCode() != SQLITE_LOCKED) {
+                    ++result.errors;
+                    return;
+                }
+                ++result.busyFailures;
+                std::this_thread::yield();
+            }
+            catch (const std::exception &) {
+                ++result.errors;
+                return;
+            }
+        }
+    }
+
+    void worker(const Options &options, const ZipfianGenerator &zipf, unsigned seed,
+                std::atomic<bool> &stop, WorkerResult &result)
+    {
+        Database database(options.dbFilename, AccessMode::ReadWrite, options.busy);
+        std::unique_ptr<TaskManager> loaded; // The initial load can find the file locked too
+        runWithRetry([&] { loaded = std::make_unique<TaskManager>(database); }, result);
+        if (!loaded) return;
+        TaskManager &manager = *loaded;
+        std::mt19937_64 rng(seed);
+        std::uniform_int_distribution<int> uniform(1, options.keys);
+        int mixTotal = 0;
+        for (int weight : options.mix) mixTotal += weight;
+        std::uniform_int_distribution<int> pick(0, std::max(0, mixTotal - 1));
+
+        while (!stop.load(std::memory_order_relaxed)) {
+            int roll = pick(rng);
+            int op = 0;
+            while (op < OPERATION_COUNT - 1 && roll >= options.mix[op]) roll -= options.mix[op++];
+            int key = options.zipfian ? zipf.next(rng) : uniform(rng);
+
+            auto start = Clock::now();
+            switch (op) {
+            case READ:
+                runWithRetry([&] {
+                    manager.refreshAsync().get(); // As the server's LIST does
+                    size_t pending = 0;
+                    manager.forEachTask([&pending](const Task &task) {
+                        pending += !task.isDone();
+                        return true;
+                    });
+                }, result);
+                break;
+            case ADD:
+                runWithRetry([&] { manager.addTaskAsync("loadgen task").get(); }, result);
+                break;
+            case DONE:
+                runWithRetry([&] { manager.markTaskDoneAsync(key).get(); }, result);
+                break;
+            case DELETE:
+                runWithRetry([&] { manager.deleteTaskAsync(key).get(); }, result);
+                break;
+            }
+            auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+            result.latenciesUs[op].push_back(static_cast<uint32_t>(elapsed.count()));
+        }
+        result.busyRetries = database.busyRetryCount();
+    }
+
+    uint32_t percentile(const vector<uint32_t> &sorted, double p)
+    {
+        if (sorted.empty()) return 0;
+        size_t index = static_cast<size_t>(p * (sorted.size() - 1));
+        return sorted[index];
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        print("Usage: todolist_loadgen [--db FILE] [--threads N] [--duration SECONDS]\n"
+              "                        [--mix READ:ADD:DONE:DELETE] [--dist uniform|zipfian] [--keys N]\n"
+              "                        [--busy-timeout MS] [--busy-retries N]\n");
+        return 1;
+    }
+
+    // Preload the key space so done/delete have rows to hit
+    {
+        Database database(options.dbFilename);
+        database.clearAllDataAsync().get();
+        for (int i = 0; i < options.keys; ++i) {
+            database.addTaskAsync("preloaded task " + std::to_string(i)).get();
+        }
+    }
+
+    BusyNoiseFilter filter(std::cerr.rdbuf());
+    std::streambuf *cerrBuffer = std::cerr.rdbuf(&filter);
+
+    ZipfianGenerator zipf(options.keys);
+    std::atomic<bool> stop{false};
+    vector<WorkerResult> results(options.threads);
+    vector<std::thread> threads;
+    auto begin = Clock::now();
+    for (int i = 0; i < options.threads; ++i) {
+        threads.emplace_back(worker, std::cref(options), std::cref(zipf), 1234u + i, std::ref(stop), std::ref(results[i]));
+    }
+    std::this_thread::sleep_for(std::chrono::seconds(options.durationSeconds));
+    stop = true;
+    for (auto &thread : threads) thread.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+
+    std::cerr.rdbuf(cerrBuffer);
+
+    uint64_t busyRetries = 0, busyFailures = 0, errors = 0;
+    vector<uint32_t> all;
+    print("threads={} duration={:.1f}s dist={} keys={}\n", options.threads, seconds,
+          options.zipfian ? "zipfian" : "uniform", options.keys);
+    print("{:<8} {:>10} {:>12} {:>10} {:>10} {:>10}\n", "op", "count", "ops/sec", "p50(us)", "p99(us)", "p999(us)");
+    for (int op = 0; op < OPERATION_COUNT; ++op) {
+        vector<uint32_t> latencies;
+        for (auto &result : results) {
+            latencies.insert(latencies.end(), result.latenciesUs[op].begin(), result.latenciesUs[op].end());
+        }
+        std::sort(latencies.begin(), latencies.end());
+        print("{:<8} {:>10} {:>12.1f} {:>10} {:>10} {:>10}\n", OPERATION_NAMES[op], latencies.size(),
+              latencies.size() / seconds, percentile(latencies, 0.50), percentile(latencies, 0.99),
+              percentile(latencies, 0.999));
+        all.insert(all.end(), latencies.begin(), latencies.end());
+    }
+    for (auto &result : results) {
+        busyRetries += result.busyRetries;
+        busyFailures += result.busyFailures;
+        errors += result.errors;
+    }
+    std::sort(all.begin(), all.end());
+    print("{:<8} {:>10} {:>12.1f} {:>10} {:>10} {:>10}\n", "total", all.size(), all.size() / seconds,
+          percentile(all, 0.50), percentile(all, 0.99), percentile(all, 0.999));
+    print("SQLITE_BUSY retries: {}  busy after retries: {}  errors: {}\n", busyRetries, busyFailures, errors);
+    return 0;
+}